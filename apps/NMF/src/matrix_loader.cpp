@@ -6,9 +6,103 @@
 #include <mutex>
 #include <iostream>
 #include <glog/logging.h>
+#include <io/block_stream.hpp>
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <type_traits>
 
 namespace NMF {
 
+namespace {
+
+// Streams the values of a matrix file, column by column, through
+// io::PrefetchReader so the next chunk is read (and decompressed) while the
+// current one is parsed.
+template <class T>
+class MatrixValueReader {
+public:
+    MatrixValueReader(const std::string &data_file,
+            const std::string &data_format)
+        : data_file_(data_file), reader_(data_file), chunk_(NULL),
+        chunk_size_(0), chunk_pos_(0), line_pos_(0) {
+        if (data_format == "binary") {
+            binary_ = true;
+        } else if (data_format == "text") {
+            binary_ = false;
+        } else {
+            LOG(FATAL) << "Unrecognized data format: " << data_format;
+        }
+    }
+
+    T Next() {
+        T value;
+        bool ok = binary_ ? NextBinary(&value) : NextText(&value);
+        CHECK(ok) << "Fails to read " << data_file_ << ": file too short";
+        return value;
+    }
+
+private:
+    // Values may span chunk boundaries.
+    bool NextBinary(T *value) {
+        char *dst = reinterpret_cast<char *>(value);
+        size_t need = sizeof(T);
+        while (need > 0) {
+            if (chunk_pos_ == chunk_size_) {
+                if (!reader_.NextChunk(&chunk_, &chunk_size_)) {
+                    return false;
+                }
+                chunk_pos_ = 0;
+                continue;
+            }
+            size_t n = std::min(need, chunk_size_ - chunk_pos_);
+            memcpy(dst, chunk_ + chunk_pos_, n);
+            dst += n;
+            need -= n;
+            chunk_pos_ += n;
+        }
+        return true;
+    }
+
+    bool NextText(T *value) {
+        while (true) {
+            while (line_pos_ < line_.size() && isspace(line_[line_pos_])) {
+                ++line_pos_;
+            }
+            if (line_pos_ == line_.size()) {
+                if (!reader_.GetLine(&line_)) {
+                    return false;
+                }
+                line_pos_ = 0;
+                continue;
+            }
+            const char *begin = line_.c_str() + line_pos_;
+            char *end;
+            if (std::is_integral<T>::value) {
+                *value = static_cast<T>(strtol(begin, &end, 10));
+            } else {
+                *value = static_cast<T>(strtod(begin, &end));
+            }
+            CHECK(end != begin) << "Cannot parse " << data_file_ << ": "
+                << line_;
+            line_pos_ += end - begin;
+            return true;
+        }
+    }
+
+    const std::string data_file_;
+    petuum::io::PrefetchReader reader_;
+    bool binary_;
+    const char *chunk_;
+    size_t chunk_size_;
+    size_t chunk_pos_;
+    std::string line_;
+    size_t line_pos_;
+};
+
+}  // anonymous namespace
+
 // Constructor
 template <class T>
 MatrixLoader<T>::MatrixLoader() {
@@ -26,22 +120,12 @@ MatrixLoader<T>::~MatrixLoader() {
 template <class T>
 void MatrixLoader<T>::Init(std::string data_file, std::string data_format, 
         int m, int n, int client_id, int num_clients) {
-    FILE * fp = NULL;
-    if (data_format == "binary") {
-        CHECK((fp = fopen(data_file.c_str(), "rb")) != NULL) 
-            << "Fails to open " << data_file;
-    } else if (data_format == "text") {
-        CHECK((fp = fopen(data_file.c_str(), "r")) != NULL)
-            << "Fails to open " << data_file;
-    } else {
-        LOG(FATAL) << "Unrecognized data format: " << data_format;
-    }
-
     m_ = m;
     if (client_id >= n) {
         client_n_ = 0;
     }
     else {
+        MatrixValueReader<T> reader(data_file, data_format);
         // Calculate number of columns on given client
         client_n_ = (n - (n / num_clients) * num_clients > client_id)?
             n / num_clients + 1: n / num_clients;
@@ -51,29 +135,15 @@ void MatrixLoader<T>::Init(std::string data_file, std::string data_format,
         }
 
         // Read data from file
-        T temp;
         for (int j = 0; j < n; ++j) {
             for (int i = 0; i < m; ++i) {
-                if (data_format == "binary") {
-                    fread(&temp, sizeof(T), 1, fp);
-                } else if (data_format == "text") {
-                    if (typeid(T) == typeid(int)) {
-                        fscanf(fp, "%d", (int *)&temp);
-                    } else if (typeid(T) == typeid(float)) {
-                        fscanf(fp, "%f", (float *)&temp);
-                    } else if (typeid(T) == typeid(double)) {
-                        fscanf(fp, "%lf", (double *)&temp);
-                    } else {
-                        LOG(FATAL) << "Unsupported type: " << typeid(T).name();
-                    }
-                }
+                T temp = reader.Next();
                 if (j % num_clients == client_id) {
                     data_[j / num_clients][i] = temp;
                 }
             }
         }
         mtx_ = new std::mutex[client_n_];
-        fclose(fp);
     }
 }
 
@@ -81,16 +151,7 @@ void MatrixLoader<T>::Init(std::string data_file, std::string data_format,
 template <class T>
 void MatrixLoader<T>::Init(std::string data_file, std::string data_format,
         int m, int client_n) { 
-    FILE * fp = NULL;
-    if (data_format == "binary") {
-        CHECK((fp = fopen(data_file.c_str(), "rb")) != NULL) 
-            << "Fails to open " << data_file;
-    } else if (data_format == "text") {
-        CHECK((fp = fopen(data_file.c_str(), "r")) != NULL)
-            << "Fails to open " << data_file;
-    } else {
-        LOG(FATAL) << "Unrecognized data format: " << data_format;
-    }
+    MatrixValueReader<T> reader(data_file, data_format);
 
     m_ = m;
     client_n_ = client_n;
@@ -104,27 +165,12 @@ void MatrixLoader<T>::Init(std::string data_file, std::string data_format,
         }
 
         // Read data from file
-        T temp;
         for (int j = 0; j < client_n; ++j) {
             for (int i = 0; i < m_; ++i) {
-                if (data_format == "binary") {
-                    fread(&temp, sizeof(T), 1, fp);
-                } else if (data_format == "text") {
-                    if (typeid(T) == typeid(int)) {
-                        fscanf(fp, "%d", (int *)&temp);
-                    } else if (typeid(T) == typeid(float)) {
-                        fscanf(fp, "%f", (float *)&temp);
-                    } else if (typeid(T) == typeid(double)) {
-                        fscanf(fp, "%lf", (double *)&temp);
-                    } else {
-                        LOG(FATAL) << "Unsupported type: " << typeid(T).name();
-                    }
-                }
-                data_[j][i] = temp;
+                data_[j][i] = reader.Next();
             }
         }
         mtx_ = new std::mutex[client_n];
-        fclose(fp);
     }
 }
 
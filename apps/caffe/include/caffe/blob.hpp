@@ -131,6 +131,15 @@ class Blob {
   Dtype* mutable_gpu_diff();
   void Update();
   void SyncWithPSTable();
+  /// @brief Read the PS table into a newly allocated host buffer. Can be
+  ///        called from a thread other than the one computing on the blob.
+  Dtype* ReadPSTable() const;
+  /// @brief Take ownership of data (as returned by ReadPSTable) as the data.
+  void SetPSData(Dtype* data);
+  /// @brief Use data, shared with other blobs and read-only, as the data.
+  void SetSharedPSData(const shared_ptr<Dtype>& data);
+  /// @brief Add -update (of count() values) to the PS table.
+  void UpdatePSTable(const Dtype* update);
 
   void FromProto(const BlobProto& proto, const bool init_ps_table = false);
   void ToProto(BlobProto* proto, bool write_diff = false) const;
@@ -161,7 +170,6 @@ class Blob {
 
  protected:
   void UpdatePSTable();
-  Dtype* ReadPSTable() const;
 
   shared_ptr<SyncedMemory> data_;
   shared_ptr<SyncedMemory> diff_;
@@ -177,6 +185,8 @@ class Blob {
   petuum::Table<Dtype>* global_table_ptr_;
   // MULTIROW
   int global_table_row_capacity_;
+  // Keeps the data set by SetSharedPSData() alive.
+  shared_ptr<Dtype> shared_ps_data_;
 
   DISABLE_COPY_AND_ASSIGN(Blob);
 };  // class Blob
@@ -7,6 +7,7 @@
 #include <atomic>
 
 #include "caffe/net.hpp"
+#include "caffe/shared_ps_weights.hpp"
 #include "leveldb/db.h"
 
 namespace caffe {
@@ -48,6 +49,10 @@ class CaffeEngine {
   //
   std::atomic<int> thread_counter_;
   int loss_table_staleness_;
+  // Give each solver thread a PSCommWorker (see Solver::Solve).
+  bool pipeline_ps_comm_;
+  // If not NULL, the solver threads share one copy of the weights.
+  shared_ptr<SharedPSWeights<Dtype> > shared_ps_weights_;
 
   DISABLE_COPY_AND_ASSIGN(CaffeEngine);
 };
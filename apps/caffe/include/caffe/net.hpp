@@ -11,6 +11,7 @@
 #include "caffe/common.hpp"
 #include "caffe/layer.hpp"
 #include "caffe/proto/caffe.pb.h"
+#include "caffe/shared_ps_weights.hpp"
 
 namespace caffe {
 
@@ -37,7 +38,8 @@ class Net {
   /// @brief 
   const int InitPS(const NetParameter& param, const bool create_ps_tables,
       const int num_additional_tables,
-      map<string, vector<int> >* layer_name_to_blob_global_idx);
+      map<string, vector<int> >* layer_name_to_blob_global_idx,
+      const int num_ps_comm_threads = 0);
   
   /**
    * @brief Run Forward with the input Blob%s already fed separately.
@@ -93,8 +95,15 @@ class Net {
 
   /// @brief Updates the network weights based on the diff values computed.
   void Update();
+  /// @brief Add the diff of the shared parameter param_id to its owner's.
+  void AccumulateOwnerDiff(const int param_id);
+  /// @brief Like Update(), but global blobs' diffs go to shared_weights,
+  ///        which pushes them once per process.
+  void Update(SharedPSWeights<Dtype>* shared_weights, const int clock);
 
   void SyncWithPS();
+  /// @brief Use shared_weights' copy of the weights of clock.
+  void SyncWithPS(SharedPSWeights<Dtype>* shared_weights, const int clock);
   void RegisterNetOutputPSTable(const int num_rows);
 
   /**
@@ -147,6 +156,12 @@ class Net {
   inline vector<float>& params_lr() { return params_lr_; }
   inline vector<float>& params_weight_decay() { return params_weight_decay_; }
   const map<string, int>& param_names_index() { return param_names_index_; }
+  /// @brief index of the owner of each shared parameter, -1 if not shared
+  inline const vector<int>& param_owners() { return param_owners_; }
+  /// @brief (layer index, blob index in the layer) of each parameter
+  inline const vector<pair<int, int> >& param_layer_indices() {
+    return param_layer_indices_;
+  }
   /// @brief Input and output blob numbers
   inline int num_inputs() { return net_input_blobs_.size(); }
   inline int num_outputs() { return net_output_blobs_.size(); }
@@ -0,0 +1,80 @@
+#ifndef CAFFE_PS_COMM_WORKER_HPP_
+#define CAFFE_PS_COMM_WORKER_HPP_
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+#include "caffe/blob.hpp"
+#include "caffe/common.hpp"
+#include "caffe/internal_thread.hpp"
+
+namespace caffe {
+
+/**
+ * @brief Moves the PS traffic of one solver thread off its critical path.
+ *
+ * The worker runs its own thread, registered with the PS table group as an
+ * app thread, and serves a FIFO of requests: push a param blob's diff to
+ * its table, clock, read (prefetch) a param blob's table. The solver pushes
+ * each blob as soon as its gradient is final in backward and queues the
+ * reads of the next iteration after the clock, so that they are served
+ * while the tail of backward and the head of the next forward compute.
+ *
+ * The worker thread clocks once per Clock() request; as the table group
+ * clock is the minimum over its app threads, the worker must be clocked as
+ * many times as the solver thread (GlobalBarrier() included).
+ */
+template <typename Dtype>
+class PSCommWorker : public InternalThread {
+ public:
+  PSCommWorker();
+  virtual ~PSCommWorker();
+
+  /// @brief Start the thread. As every app thread waits for the others in
+  ///        PSTableGroup::RegisterThread(), call this before the solver
+  ///        thread registers.
+  void Start();
+  /// @brief Deregister the thread from the PS and join it.
+  void Stop();
+
+  /// @brief The param blobs that requests refer to by index. Must be set
+  ///        before the first Push or Prefetch.
+  void set_params(const vector<shared_ptr<Blob<Dtype> > >& params);
+
+  /// @brief Push params[param_id]'s diff to its table. The diff must be on
+  ///        the host and must not change until the next WaitPrefetched().
+  void Push(const int param_id);
+  void Clock();
+  void GlobalBarrier();
+  void Prefetch(const int param_id);
+  /// @brief Block until the prefetch of params[param_id] is served and
+  ///        return its buffer, to be handed to Blob::SetPSData().
+  Dtype* WaitPrefetched(const int param_id);
+
+ protected:
+  virtual void InternalThreadEntry();
+
+  enum RequestType { kPush, kClock, kGlobalBarrier, kPrefetch, kStop };
+  struct Request {
+    RequestType type;
+    int param_id;
+  };
+  void Enqueue(const RequestType type, const int param_id = -1);
+
+  vector<shared_ptr<Blob<Dtype> > > params_;
+
+  std::mutex mtx_;
+  std::condition_variable request_cv_;
+  std::condition_variable prefetch_cv_;
+  std::deque<Request> requests_;
+  // params_ index => prefetched buffer not yet taken, NULL if none.
+  vector<Dtype*> prefetched_;
+
+  DISABLE_COPY_AND_ASSIGN(PSCommWorker);
+};
+
+}  // namespace caffe
+
+#endif  // CAFFE_PS_COMM_WORKER_HPP_
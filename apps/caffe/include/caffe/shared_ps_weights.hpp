@@ -0,0 +1,69 @@
+#ifndef CAFFE_SHARED_PS_WEIGHTS_HPP_
+#define CAFFE_SHARED_PS_WEIGHTS_HPP_
+
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include "caffe/blob.hpp"
+#include "caffe/common.hpp"
+
+namespace caffe {
+
+/**
+ * @brief One copy of the PS-backed weights for all solver threads of a
+ *        process.
+ *
+ * Each global blob (keyed by its table id) is read from the PS once per
+ * clock, by the first thread to ask for it, into a buffer that the threads'
+ * blobs point to without owning it. The buffer is read-only to the threads
+ * and freed once no thread uses its version. Gradients of the threads are
+ * summed here and the sum is pushed once, by the last thread to contribute.
+ *
+ * The read for clock c waits until the sum for clock c - 1 is pushed, so
+ * that a thread reads its own updates; threads of a process therefore run
+ * within one clock of each other. SSP staleness applies across processes.
+ */
+template <typename Dtype>
+class SharedPSWeights {
+ public:
+  explicit SharedPSWeights(const int num_threads);
+  ~SharedPSWeights() {}
+
+  /// @brief Point blob's data at the shared weights of clock (the solver
+  ///        iteration), reading them from the PS if no thread did yet.
+  void Sync(Blob<Dtype>* blob, const int clock);
+  /// @brief Add blob's diff to the sum of clock; the last of the
+  ///        num_threads contributions pushes the sum to the PS.
+  void Update(Blob<Dtype>* blob, const int clock);
+
+ protected:
+  struct Entry {
+    Entry() : clock(-1), reading(false), pushed_clock(-1),
+        num_contributed(0) {}
+    std::mutex mtx;
+    std::condition_variable cv;
+    // Weights read at clock.
+    int clock;
+    shared_ptr<Dtype> data;
+    bool reading;
+    // Sum of the diffs of pushed_clock + 1.
+    int pushed_clock;
+    vector<Dtype> diff_sum;
+    int num_contributed;
+  };
+
+  Entry* GetEntry(const int global_id);
+
+  const int num_threads_;
+  std::mutex entries_mtx_;
+  // global table id => entry
+  map<int, shared_ptr<Entry> > entries_;
+
+  DISABLE_COPY_AND_ASSIGN(SharedPSWeights);
+};
+
+}  // namespace caffe
+
+#endif  // CAFFE_SHARED_PS_WEIGHTS_HPP_
@@ -7,6 +7,7 @@
 #include <fstream>
 #include <petuum_ps_common/include/petuum_ps.hpp>
 #include "caffe/net.hpp"
+#include "caffe/ps_comm_worker.hpp"
 
 namespace caffe {
 
@@ -40,12 +41,40 @@ class Solver {
 
   void PrintNetOutputs(const string& filename);  
 
+  /// @brief If not NULL, Solve() overlaps the PS reads and updates with
+  ///        computation on this worker; see ForwardBackwardPipelined().
+  inline void set_ps_comm_worker(PSCommWorker<Dtype>* ps_comm_worker) {
+    ps_comm_worker_ = ps_comm_worker;
+  }
+  /// @brief If not NULL, the weights are read from and the updates reduced
+  ///        on the process' shared copy.
+  inline void set_shared_ps_weights(SharedPSWeights<Dtype>* shared_weights) {
+    shared_ps_weights_ = shared_weights;
+  }
+
  protected:
   // PreSolve is run before any solving iteration starts, allowing one to
   // put up some scaffold.
   virtual void PreSolve() {}
   // Get the update value for the current iteration.
   virtual void ComputeUpdateValue() = 0;
+  // Get the update value of the param_id-th parameter blob only.
+  virtual void ComputeUpdateValue(int param_id, Dtype rate) = 0;
+  virtual Dtype GetLearningRate() = 0;
+
+  // ======== Pipelined PS communication (ps_comm_worker_) ========
+  // Forward each layer once its parameters are read from the PS, and push
+  // each parameter's update as soon as backward is done with it, i.e.,
+  // after the lowest layer using it (parameters shared across layers
+  // included). Returns the loss.
+  Dtype ForwardBackwardPipelined();
+  void InitPipeline();
+  // Queue the reads of all owned parameters, in forward order.
+  void PrefetchParams();
+  // Install the prefetched data of owned parameter param_id, if pending.
+  void WaitParam(const int param_id);
+  void WaitAllParams();
+  void PushParam(const int param_id, const Dtype rate);
   // The Solver::Snapshot function implements the basic snapshotting utility
   // that stores the learned net. You should implement the SnapshotSolverState()
   // function that produces a SolverState protocol buffer that needs to be
@@ -79,6 +108,19 @@ class Solver {
   int num_clients_;
   petuum::HighResolutionTimer total_timer_;
 
+  // Not owned.
+  PSCommWorker<Dtype>* ps_comm_worker_;
+  SharedPSWeights<Dtype>* shared_ps_weights_;
+  // layer => owned parameters used in the layer
+  vector<vector<int> > layer_params_;
+  // layer => owned parameters whose gradients are final after the layer's
+  // backward
+  vector<vector<int> > layer_final_params_;
+  // owned parameter => the parameters sharing it
+  vector<vector<int> > param_sharers_;
+  // owned parameter => its prefetch is not installed yet
+  vector<bool> param_pending_;
+
   DISABLE_COPY_AND_ASSIGN(Solver);
 };
 
@@ -103,8 +145,9 @@ class SGDSolver : public Solver<Dtype> {
 
  protected:
   virtual void PreSolve();
-  Dtype GetLearningRate();
+  virtual Dtype GetLearningRate();
   virtual void ComputeUpdateValue();
+  virtual void ComputeUpdateValue(int param_id, Dtype rate);
   virtual void SnapshotSolverState(SolverState * state);
   virtual void RestoreSolverState(const SolverState& state);
   // history maintains the historical momentum data.
@@ -129,7 +172,7 @@ class NesterovSolver : public SGDSolver<Dtype> {
       param_file, layer_blobs_global_idx_ptr, thread_id) {}
 
  protected:
-  virtual void ComputeUpdateValue();
+  virtual void ComputeUpdateValue(int param_id, Dtype rate);
 
   DISABLE_COPY_AND_ASSIGN(NesterovSolver);
 };
@@ -151,7 +194,7 @@ class AdaGradSolver : public SGDSolver<Dtype> {
   }
 
  protected:
-  virtual void ComputeUpdateValue();
+  virtual void ComputeUpdateValue(int param_id, Dtype rate);
   void constructor_sanity_check() {
     CHECK_EQ(0, this->param_.momentum())
         << "Momentum cannot be used with AdaGrad.";
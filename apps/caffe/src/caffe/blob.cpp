@@ -221,15 +221,33 @@ void Blob<Dtype>::Update() {
 template <typename Dtype>
 void Blob<Dtype>::SyncWithPSTable() {
   CHECK(blob_mode_ == BlobProto_BlobMode_GLOBAL);
-  Dtype* data_temp = ReadPSTable();
-  data_->set_cpu_ps_data(data_temp);
+  SetPSData(ReadPSTable());
+}
+
+template <typename Dtype>
+void Blob<Dtype>::SetPSData(Dtype* data) {
+  CHECK(blob_mode_ == BlobProto_BlobMode_GLOBAL);
+  data_->set_cpu_ps_data(data);
+  shared_ps_data_.reset();
+}
+
+template <typename Dtype>
+void Blob<Dtype>::SetSharedPSData(const shared_ptr<Dtype>& data) {
+  CHECK(blob_mode_ == BlobProto_BlobMode_GLOBAL);
+  data_->set_cpu_data(data.get());
+  shared_ps_data_ = data;
 }
 
 // MULTIROW
 template <typename Dtype>
 void Blob<Dtype>::UpdatePSTable() {
   // flush diff_
-  const Dtype* update = static_cast<const Dtype*>(diff_->cpu_data());
+  UpdatePSTable(static_cast<const Dtype*>(diff_->cpu_data()));
+}
+
+// MULTIROW
+template <typename Dtype>
+void Blob<Dtype>::UpdatePSTable(const Dtype* update) {
   int update_idx = 0;
   
   for (int r = 0; r < util::Context::num_rows_per_table(); ++r) {
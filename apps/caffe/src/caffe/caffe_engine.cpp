@@ -14,18 +14,21 @@
 #include "caffe/util/upgrade_proto.hpp"
 #include "caffe/caffe.hpp"
 #include "caffe/feature_extractor.hpp"
+#include "caffe/ps_comm_worker.hpp"
 
 namespace caffe {
 
 template <typename Dtype>
 CaffeEngine<Dtype>::CaffeEngine(const SolverParameter& param)
-    : net_(), num_tables_(0), thread_counter_(0) {
+    : net_(), num_tables_(0), thread_counter_(0),
+      pipeline_ps_comm_(false) {
   Init(param);
 }
 
 template <typename Dtype>
 CaffeEngine<Dtype>::CaffeEngine(const string& param_file)
-    : net_(), num_tables_(0), thread_counter_(0) {
+    : net_(), num_tables_(0), thread_counter_(0),
+      pipeline_ps_comm_(false) {
   SolverParameter param;
   ReadProtoFromTextFile(param_file, &param);
   Init(param);
@@ -33,7 +36,8 @@ CaffeEngine<Dtype>::CaffeEngine(const string& param_file)
 
 template <typename Dtype>
 CaffeEngine<Dtype>::CaffeEngine(const NetParameter& net_param) : 
-    net_(), num_tables_(0), thread_counter_(0) {
+    net_(), num_tables_(0), thread_counter_(0),
+      pipeline_ps_comm_(false) {
   util::Context& context = util::Context::get_instance();
   const int num_threads = context.get_int32("num_app_threads");
   Caffe::initialize_phases(num_threads);
@@ -56,7 +60,13 @@ void CaffeEngine<Dtype>::Init(const SolverParameter& param) {
   }
   util::Context& context = util::Context::get_instance();
   loss_table_staleness_ = context.get_int32("loss_table_staleness");
+  pipeline_ps_comm_ = context.get_bool("pipeline_ps_comm");
   const int num_threads = context.get_int32("num_app_threads");
+  if (context.get_bool("share_ps_weights")) {
+    CHECK(!pipeline_ps_comm_)
+        << "share_ps_weights cannot be used with pipeline_ps_comm.";
+    shared_ps_weights_.reset(new SharedPSWeights<Dtype>(num_threads));
+  }
   Caffe::initialize_phases(num_threads);
 
   // Scaffolding code
@@ -103,8 +113,10 @@ void CaffeEngine<Dtype>::InitPSForTrainNet(const int num_additional_tables) {
   // set as train net
   net_.reset(new Net<Dtype>(0, -1));
   // create ps tables for train net parameter blobs
+  const int num_ps_comm_threads = pipeline_ps_comm_ ?
+      util::Context::get_instance().get_int32("num_app_threads") : 0;
   num_tables_ += net_->InitPS(net_param, true, num_additional_tables, 
-                              &layer_blobs_global_idx_);
+                              &layer_blobs_global_idx_, num_ps_comm_threads);
   // create ps table for train net outputs
   string train_net_output_name("train_net_outputs");
   if (param_.display()) {
@@ -234,6 +246,13 @@ const int CaffeEngine<Dtype>::GetNumTestNets() {
 
 template <typename Dtype>
 void CaffeEngine<Dtype>::Start() {
+  // The comm thread registers itself; all app threads must register before
+  // any of them returns from RegisterThread().
+  shared_ptr<PSCommWorker<Dtype> > ps_comm_worker;
+  if (pipeline_ps_comm_) {
+    ps_comm_worker.reset(new PSCommWorker<Dtype>());
+    ps_comm_worker->Start();
+  }
   petuum::PSTableGroup::RegisterThread();
 
   // Initialize local thread data structures.
@@ -249,6 +268,8 @@ void CaffeEngine<Dtype>::Start() {
   shared_ptr<caffe::Solver<Dtype> >
     solver(caffe::GetSolver<Dtype>(param_, &layer_blobs_global_idx_, 
            thread_id)); 
+  solver->set_ps_comm_worker(ps_comm_worker.get());
+  solver->set_shared_ps_weights(shared_ps_weights_.get());
 
   //petuum::PSTableGroup::GlobalBarrier();
 
@@ -267,6 +288,12 @@ void CaffeEngine<Dtype>::Start() {
     solver->Solve();
   }
   
+  // The comm thread clocks along so that the table group clock advances.
+  if (ps_comm_worker) {
+    ps_comm_worker->GlobalBarrier();
+    ps_comm_worker->GlobalBarrier();
+    ps_comm_worker->Stop();
+  }
   petuum::PSTableGroup::GlobalBarrier();
   if (client_id == 0 && thread_id == 0) {
     solver->PrintNetOutputs(net_outputs_prefix + ".netoutputs");
@@ -249,7 +249,8 @@ void Net<Dtype>::Init(const NetParameter& in_param) {
 template <typename Dtype>
 const int Net<Dtype>::InitPS(const NetParameter& in_param, 
     bool create_ps_tables, int num_additional_tables,
-    map<string, vector<int> >* layer_name_to_blob_global_idx) {
+    map<string, vector<int> >* layer_name_to_blob_global_idx,
+    const int num_ps_comm_threads) {
   // Filter layers based on their include/exclude rules and
   // the current NetState.
   NetParameter filtered_param;
@@ -263,9 +264,9 @@ const int Net<Dtype>::InitPS(const NetParameter& in_param,
     table_group_config.num_comm_channels_per_client
         = context.get_int32("num_comm_channels_per_client");
     table_group_config.num_total_clients = context.get_int32("num_clients");
-    // + 1 for main() thread.
+    // + 1 for main() thread, + the solver threads' PS comm threads.
     table_group_config.num_local_app_threads 
-        = context.get_int32("num_app_threads") + 1;
+        = context.get_int32("num_app_threads") + 1 + num_ps_comm_threads;
     table_group_config.client_id = context.get_int32("client_id");
     table_group_config.stats_path = context.get_string("stats_path");
     petuum::GetHostInfos(context.get_string("hostfile"), 
@@ -983,27 +984,7 @@ void Net<Dtype>::Update() {
   for (int i = 0; i < params_.size(); ++i) {
     if (param_owners_[i] < 0) { continue; }
     if (debug_info_) { UpdateDebugInfo(i); }
-    const int count = params_[i]->count();
-    const Dtype* this_diff;
-    Dtype* owner_diff;
-    switch (Caffe::mode()) {
-    case Caffe::CPU:
-      this_diff = params_[i]->cpu_diff();
-      owner_diff = params_[param_owners_[i]]->mutable_cpu_diff();
-      caffe_add(count, this_diff, owner_diff, owner_diff);
-      break;
-#ifndef CPU_ONLY
-    case Caffe::GPU:
-      this_diff = params_[i]->gpu_diff();
-      owner_diff = params_[param_owners_[i]]->mutable_gpu_diff();
-      caffe_gpu_add(count, this_diff, owner_diff, owner_diff);
-      break;
-#else
-      NO_GPU;
-#endif
-    default:
-      LOG(FATAL) << "Unknown caffe mode: " << Caffe::mode();
-    }
+    AccumulateOwnerDiff(i);
   }
   // Now, update the owned parameters.
   for (int i = 0; i < params_.size(); ++i) {
@@ -1013,6 +994,51 @@ void Net<Dtype>::Update() {
   }
 }
 
+template <typename Dtype>
+void Net<Dtype>::Update(SharedPSWeights<Dtype>* shared_weights,
+    const int clock) {
+  for (int i = 0; i < params_.size(); ++i) {
+    if (param_owners_[i] < 0) { continue; }
+    if (debug_info_) { UpdateDebugInfo(i); }
+    AccumulateOwnerDiff(i);
+  }
+  for (int i = 0; i < params_.size(); ++i) {
+    if (param_owners_[i] >= 0) { continue; }
+    if (debug_info_) { UpdateDebugInfo(i); }
+    if (params_[i]->blob_mode() == BlobProto_BlobMode_GLOBAL) {
+      shared_weights->Update(params_[i].get(), clock);
+    } else {
+      params_[i]->Update();
+    }
+  }
+}
+
+template <typename Dtype>
+void Net<Dtype>::AccumulateOwnerDiff(const int param_id) {
+  CHECK_GE(param_owners_[param_id], 0);
+  const int count = params_[param_id]->count();
+  const Dtype* this_diff;
+  Dtype* owner_diff;
+  switch (Caffe::mode()) {
+  case Caffe::CPU:
+    this_diff = params_[param_id]->cpu_diff();
+    owner_diff = params_[param_owners_[param_id]]->mutable_cpu_diff();
+    caffe_add(count, this_diff, owner_diff, owner_diff);
+    break;
+#ifndef CPU_ONLY
+  case Caffe::GPU:
+    this_diff = params_[param_id]->gpu_diff();
+    owner_diff = params_[param_owners_[param_id]]->mutable_gpu_diff();
+    caffe_gpu_add(count, this_diff, owner_diff, owner_diff);
+    break;
+#else
+    NO_GPU;
+#endif
+  default:
+    LOG(FATAL) << "Unknown caffe mode: " << Caffe::mode();
+  }
+}
+
 template <typename Dtype>
 void Net<Dtype>::SyncWithPS() {
   for (int i = 0; i < params_.size(); ++i) {
@@ -1021,6 +1047,15 @@ void Net<Dtype>::SyncWithPS() {
   }
 }
 
+template <typename Dtype>
+void Net<Dtype>::SyncWithPS(SharedPSWeights<Dtype>* shared_weights,
+    const int clock) {
+  for (int i = 0; i < params_.size(); ++i) {
+    if (param_owners_[i] >= 0) { continue; }
+    shared_weights->Sync(params_[i].get(), clock);
+  }
+}
+
 template <typename Dtype>
 void Net<Dtype>::RegisterNetOutputPSTable(const int num_rows) {
   // register rows of loss tables
@@ -0,0 +1,126 @@
+#include <petuum_ps_common/include/petuum_ps.hpp>
+
+#include "caffe/ps_comm_worker.hpp"
+#include "caffe/syncedmem.hpp"
+
+namespace caffe {
+
+template <typename Dtype>
+PSCommWorker<Dtype>::PSCommWorker() {}
+
+template <typename Dtype>
+PSCommWorker<Dtype>::~PSCommWorker() {
+  CHECK(!is_started()) << "Stop() PSCommWorker before destroying it.";
+  for (int i = 0; i < prefetched_.size(); ++i) {
+    if (prefetched_[i] != NULL) {
+      CaffeFreeHost(prefetched_[i]);
+    }
+  }
+}
+
+template <typename Dtype>
+void PSCommWorker<Dtype>::Start() {
+  CHECK(StartInternalThread()) << "Failed to start PS comm thread.";
+}
+
+template <typename Dtype>
+void PSCommWorker<Dtype>::Stop() {
+  Enqueue(kStop);
+  CHECK(WaitForInternalThreadToExit()) << "Failed to join PS comm thread.";
+}
+
+template <typename Dtype>
+void PSCommWorker<Dtype>::set_params(
+    const vector<shared_ptr<Blob<Dtype> > >& params) {
+  std::lock_guard<std::mutex> lock(mtx_);
+  params_ = params;
+  prefetched_.resize(params_.size(), NULL);
+}
+
+template <typename Dtype>
+void PSCommWorker<Dtype>::Push(const int param_id) {
+  Enqueue(kPush, param_id);
+}
+
+template <typename Dtype>
+void PSCommWorker<Dtype>::Clock() {
+  Enqueue(kClock);
+}
+
+template <typename Dtype>
+void PSCommWorker<Dtype>::GlobalBarrier() {
+  Enqueue(kGlobalBarrier);
+}
+
+template <typename Dtype>
+void PSCommWorker<Dtype>::Prefetch(const int param_id) {
+  Enqueue(kPrefetch, param_id);
+}
+
+template <typename Dtype>
+Dtype* PSCommWorker<Dtype>::WaitPrefetched(const int param_id) {
+  std::unique_lock<std::mutex> lock(mtx_);
+  prefetch_cv_.wait(lock,
+      [this, param_id] { return prefetched_[param_id] != NULL; });
+  Dtype* data = prefetched_[param_id];
+  prefetched_[param_id] = NULL;
+  return data;
+}
+
+template <typename Dtype>
+void PSCommWorker<Dtype>::Enqueue(const RequestType type, const int param_id) {
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    Request request;
+    request.type = type;
+    request.param_id = param_id;
+    requests_.push_back(request);
+  }
+  request_cv_.notify_one();
+}
+
+template <typename Dtype>
+void PSCommWorker<Dtype>::InternalThreadEntry() {
+  petuum::PSTableGroup::RegisterThread();
+  while (true) {
+    Request request;
+    {
+      std::unique_lock<std::mutex> lock(mtx_);
+      request_cv_.wait(lock, [this] { return !requests_.empty(); });
+      request = requests_.front();
+      requests_.pop_front();
+    }
+    switch (request.type) {
+    case kPush:
+      params_[request.param_id]->Update();
+      break;
+    case kClock:
+      petuum::PSTableGroup::Clock();
+      break;
+    case kGlobalBarrier:
+      petuum::PSTableGroup::GlobalBarrier();
+      break;
+    case kPrefetch:
+      {
+        Dtype* data = params_[request.param_id]->ReadPSTable();
+        {
+          std::lock_guard<std::mutex> lock(mtx_);
+          CHECK(prefetched_[request.param_id] == NULL)
+              << "Param " << request.param_id << " prefetched twice.";
+          prefetched_[request.param_id] = data;
+        }
+        prefetch_cv_.notify_all();
+      }
+      break;
+    case kStop:
+      petuum::PSTableGroup::DeregisterThread();
+      return;
+    default:
+      LOG(FATAL) << "Unknown PS comm request: " << request.type;
+    }
+  }
+}
+
+INSTANTIATE_CLASS(PSCommWorker);
+
+}  // namespace caffe
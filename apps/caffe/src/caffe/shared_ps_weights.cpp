@@ -0,0 +1,82 @@
+#include <algorithm>
+
+#include "caffe/shared_ps_weights.hpp"
+#include "caffe/syncedmem.hpp"
+#include "caffe/util/math_functions.hpp"
+
+namespace caffe {
+
+template <typename Dtype>
+SharedPSWeights<Dtype>::SharedPSWeights(const int num_threads)
+    : num_threads_(num_threads) {
+  CHECK_GT(num_threads_, 0);
+}
+
+template <typename Dtype>
+typename SharedPSWeights<Dtype>::Entry* SharedPSWeights<Dtype>::GetEntry(
+    const int global_id) {
+  std::lock_guard<std::mutex> lock(entries_mtx_);
+  shared_ptr<Entry>& entry = entries_[global_id];
+  if (!entry) {
+    entry.reset(new Entry());
+  }
+  return entry.get();
+}
+
+template <typename Dtype>
+void SharedPSWeights<Dtype>::Sync(Blob<Dtype>* blob, const int clock) {
+  CHECK_EQ(blob->blob_mode(), BlobProto_BlobMode_GLOBAL);
+  Entry* entry = GetEntry(blob->global_id());
+  std::unique_lock<std::mutex> lock(entry->mtx);
+  if (entry->clock < 0) {
+    // First read; training may resume from a snapshot.
+    entry->pushed_clock = std::max(entry->pushed_clock, clock - 1);
+  }
+  entry->cv.wait(lock, [entry, clock] {
+      return entry->pushed_clock >= clock - 1; });
+  while (entry->clock != clock) {
+    CHECK_LT(entry->clock, clock);
+    if (entry->reading) {
+      entry->cv.wait(lock);
+      continue;
+    }
+    entry->reading = true;
+    lock.unlock();
+    Dtype* data = blob->ReadPSTable();
+    lock.lock();
+    entry->data.reset(data, CaffeFreeHost);
+    entry->clock = clock;
+    entry->reading = false;
+    entry->cv.notify_all();
+  }
+  shared_ptr<Dtype> data = entry->data;
+  lock.unlock();
+  blob->SetSharedPSData(data);
+}
+
+template <typename Dtype>
+void SharedPSWeights<Dtype>::Update(Blob<Dtype>* blob, const int clock) {
+  CHECK_EQ(blob->blob_mode(), BlobProto_BlobMode_GLOBAL);
+  Entry* entry = GetEntry(blob->global_id());
+  const int count = blob->count();
+  const Dtype* diff = blob->cpu_diff();
+  std::lock_guard<std::mutex> lock(entry->mtx);
+  CHECK_EQ(entry->pushed_clock, clock - 1);
+  if (entry->diff_sum.empty()) {
+    entry->diff_sum.resize(count, Dtype(0));
+  }
+  caffe_add(count, diff, entry->diff_sum.data(), entry->diff_sum.data());
+  if (++entry->num_contributed < num_threads_) {
+    return;
+  }
+  // Others block in Sync() until pushed_clock advances.
+  blob->UpdatePSTable(entry->diff_sum.data());
+  std::fill(entry->diff_sum.begin(), entry->diff_sum.end(), Dtype(0));
+  entry->num_contributed = 0;
+  entry->pushed_clock = clock;
+  entry->cv.notify_all();
+}
+
+INSTANTIATE_CLASS(SharedPSWeights);
+
+}  // namespace caffe
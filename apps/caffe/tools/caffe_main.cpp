@@ -45,6 +45,13 @@ DEFINE_string(process_storage_type, "BoundedDense",
     "process storage type");
 DEFINE_int32(num_rows_per_table, 1, 
     "Number of rows per parameter table.");
+DEFINE_bool(pipeline_ps_comm, false,
+    "True to push each layer's update as soon as its backward is done and "
+    "read the next iteration's weights during compute, on a separate "
+    "thread per solver.");
+DEFINE_bool(share_ps_weights, false,
+    "True for the app threads of a client to share one copy of the weights, "
+    "read once per clock, and to push the sum of their updates.");
 
 // Caffe Parameters
 DEFINE_int32(gpu, -1,
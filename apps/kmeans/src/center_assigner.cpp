@@ -0,0 +1,262 @@
+/*
+ * center_assigner.cpp
+ *
+ *  See center_assigner.h.
+ */
+
+#include "center_assigner.h"
+#include <assert.h>
+#include <algorithm>
+#include <cmath>
+#include <float.h>
+#include <limits>
+
+namespace {
+
+// Tile sizes of the blocked kernel: a block of points times kCenterTile
+// centers over kDimTile dimensions stays in L1/L2.
+const int kCenterTile = 32;
+const int kDimTile = 512;
+
+// Dense point block is capped at this many floats.
+const int kMaxBlockFloats = 1 << 20;
+const int kMaxBlockPoints = 64;
+
+// Yinyang uses about k / 10 groups of centers; each costs a double per
+// point, so cap them.
+const int kCentersPerGroup = 10;
+const int kMaxGroups = 32;
+
+const double kInf = std::numeric_limits<double>::infinity();
+
+}  // anonymous namespace
+
+center_assigner::center_assigner() :
+		dimensionality_(0), number_of_clusters_(0), has_centers_(false),
+		number_of_groups_(0), num_distances_(0) {
+}
+
+center_assigner::center_assigner(int dimensionality, int number_of_clusters,
+		int number_of_points) :
+		dimensionality_(dimensionality), number_of_clusters_(number_of_clusters),
+		has_centers_(false), num_distances_(0) {
+	centers_.resize((size_t) number_of_clusters_ * dimensionality_);
+	centers_t_.resize(centers_.size());
+	center_sq_norms_.resize(number_of_clusters_);
+	center_drift_.resize(number_of_clusters_);
+
+	number_of_groups_ = std::max(1, std::min(kMaxGroups,
+			number_of_clusters_ / kCentersPerGroup));
+	group_begin_.resize(number_of_groups_ + 1);
+	group_of_center_.resize(number_of_clusters_);
+	for (int g = 0; g <= number_of_groups_; g++) {
+		group_begin_[g] = (long) g * number_of_clusters_ / number_of_groups_;
+	}
+	for (int g = 0; g < number_of_groups_; g++) {
+		for (int c = group_begin_[g]; c < group_begin_[g + 1]; c++) {
+			group_of_center_[c] = g;
+		}
+	}
+	group_drift_.resize(number_of_groups_);
+	group_first_.resize(number_of_groups_);
+	group_second_.resize(number_of_groups_);
+	group_first_center_.resize(number_of_groups_);
+	group_scanned_.resize(number_of_groups_);
+
+	assignment_.resize(number_of_points, -1);
+	upper_.resize(number_of_points);
+	lower_.resize((size_t) number_of_points * number_of_groups_);
+}
+
+void center_assigner::SetCenters(const cluster_centers& centers) {
+	assert(centers.NumOfCenters() == number_of_clusters_);
+	vector<double> group_max_move(number_of_groups_, 0.);
+	for (int c = 0; c < number_of_clusters_; c++) {
+		const sparse_vector& center = centers.getCenterAt(c);
+		float* row = &centers_[(size_t) c * dimensionality_];
+		double sq_move = 0;
+		double sq_norm = 0;
+		for (int j = 0; j < dimensionality_; j++) {
+			float v = center.ValueAt(j);
+			double diff = v - row[j];
+			sq_move += diff * diff;
+			sq_norm += (double) v * v;
+			row[j] = v;
+			centers_t_[(size_t) j * number_of_clusters_ + c] = v;
+		}
+		center_sq_norms_[c] = sq_norm;
+		if (has_centers_) {
+			double move = std::sqrt(sq_move);
+			center_drift_[c] += move;
+			double& group_move = group_max_move[group_of_center_[c]];
+			group_move = std::max(group_move, move);
+		}
+	}
+	for (int g = 0; g < number_of_groups_; g++) {
+		group_drift_[g] += group_max_move[g];
+	}
+	has_centers_ = true;
+}
+
+float center_assigner::SqDistanceToCenter(int center_id,
+		const sparse_vector& x) const {
+	// Feature ids are 1-based, as in sparse_vector::getInnerProduct.
+	const float* row = &centers_[(size_t) center_id * dimensionality_];
+	float prod = 0;
+	for (int i = 0; i < x.size(); i++) {
+		prod += row[x.FeatureAt(i) - 1] * x.ValueAt(i);
+	}
+	float sq_distance = x.getSquareNorm() - 2 * prod
+			+ center_sq_norms_[center_id];
+	return std::max(sq_distance, 0.f);
+}
+
+int center_assigner::Assign(int point_id, const sparse_vector& x) {
+	assert(has_centers_);
+	int a = assignment_[point_id];
+	double* lower = &lower_[(size_t) point_id * number_of_groups_];
+
+	// Global filter: no group can hold a closer center.
+	double upper_a = kInf;
+	if (a >= 0) {
+		double min_lower = kInf;
+		for (int g = 0; g < number_of_groups_; g++) {
+			min_lower = std::min(min_lower, lower[g] - group_drift_[g]);
+		}
+		double upper = upper_[point_id] + center_drift_[a];
+		if (upper <= min_lower) {
+			return a;
+		}
+		upper_a = std::sqrt(SqDistanceToCenter(a, x));
+		++num_distances_;
+		if (upper_a <= min_lower) {
+			upper_[point_id] = upper_a - center_drift_[a];
+			return a;
+		}
+	}
+
+	// Group filter: scan the groups whose lower bound is below the best
+	// distance so far, keeping the two closest centers of each.
+	double best = upper_a;
+	int best_center = a;
+	double* first = &group_first_[0];
+	double* second = &group_second_[0];
+	int* first_center = &group_first_center_[0];
+	char* scanned = &group_scanned_[0];
+	for (int g = 0; g < number_of_groups_; g++) {
+		first[g] = kInf;
+		second[g] = kInf;
+		first_center[g] = -1;
+		scanned[g] = a < 0 || lower[g] - group_drift_[g] < best;
+		if (!scanned[g]) {
+			continue;
+		}
+		for (int c = group_begin_[g]; c < group_begin_[g + 1]; c++) {
+			if (c == a) {
+				continue;
+			}
+			double distance_c = std::sqrt(SqDistanceToCenter(c, x));
+			++num_distances_;
+			if (distance_c < first[g]) {
+				second[g] = first[g];
+				first[g] = distance_c;
+				first_center[g] = c;
+			} else if (distance_c < second[g]) {
+				second[g] = distance_c;
+			}
+			if (distance_c < best) {
+				best = distance_c;
+				best_center = c;
+			}
+		}
+	}
+
+	// New lower bounds exclude best_center but must cover the old center.
+	for (int g = 0; g < number_of_groups_; g++) {
+		double bound;
+		if (scanned[g]) {
+			bound = first_center[g] == best_center ? second[g] : first[g];
+		} else {
+			bound = lower[g] - group_drift_[g];
+		}
+		if (a >= 0 && best_center != a && group_of_center_[a] == g) {
+			bound = std::min(bound, upper_a);
+		}
+		lower[g] = bound + group_drift_[g];
+	}
+	assignment_[point_id] = best_center;
+	upper_[point_id] = best - center_drift_[best_center];
+	return best_center;
+}
+
+void center_assigner::BlockedInnerProducts(const float* x, int nx,
+		const float* c_t, int nc, float* out) const {
+	// Outer product form: out_i[tile] += x_ij * c_t[j][tile] runs over
+	// contiguous centers, so it vectorizes and zeros of x are skipped.
+	std::fill(out, out + (size_t) nx * nc, 0.f);
+	for (int c0 = 0; c0 < nc; c0 += kCenterTile) {
+		int c1 = std::min(c0 + kCenterTile, nc);
+		for (int j0 = 0; j0 < dimensionality_; j0 += kDimTile) {
+			int j1 = std::min(j0 + kDimTile, dimensionality_);
+			for (int i = 0; i < nx; i++) {
+				const float* xi = x + (size_t) i * dimensionality_;
+				float* out_i = out + (size_t) i * nc;
+				for (int j = j0; j < j1; j++) {
+					float x_ij = xi[j];
+					if (x_ij == 0) {
+						continue;
+					}
+					const float* c_j = c_t + (size_t) j * nc;
+					for (int k = c0; k < c1; k++) {
+						out_i[k] += x_ij * c_j[k];
+					}
+				}
+			}
+		}
+	}
+}
+
+float center_assigner::AssignBlock(const dataset& data, int start, int end,
+		int* center_ids) {
+	assert(has_centers_);
+	int block_points = std::max(1,
+			std::min(kMaxBlockPoints, kMaxBlockFloats / std::max(dimensionality_, 1)));
+	vector<float> x_block((size_t) block_points * dimensionality_);
+	vector<float> products((size_t) block_points * number_of_clusters_);
+
+	double total_sq_distance = 0;
+	for (int b0 = start; b0 < end; b0 += block_points) {
+		int nx = std::min(block_points, end - b0);
+		// Scatter the sparse points into a dense block.
+		std::fill(x_block.begin(), x_block.end(), 0.f);
+		for (int i = 0; i < nx; i++) {
+			const sparse_vector& x = data.getDataPointAt(b0 + i);
+			float* xi = &x_block[(size_t) i * dimensionality_];
+			for (int f = 0; f < x.size(); f++) {
+				xi[x.FeatureAt(f) - 1] = x.ValueAt(f);
+			}
+		}
+		BlockedInnerProducts(&x_block[0], nx, &centers_t_[0], number_of_clusters_,
+				&products[0]);
+		num_distances_ += (long) nx * number_of_clusters_;
+
+		for (int i = 0; i < nx; i++) {
+			const float* prod_i = &products[(size_t) i * number_of_clusters_];
+			float x_sq_norm = data.getDataPointAt(b0 + i).getSquareNorm();
+			float best = FLT_MAX;
+			int best_center = 0;
+			for (int c = 0; c < number_of_clusters_; c++) {
+				float distance_c = x_sq_norm - 2 * prod_i[c] + center_sq_norms_[c];
+				if (distance_c < best) {
+					best = distance_c;
+					best_center = c;
+				}
+			}
+			if (center_ids != NULL) {
+				center_ids[b0 + i - start] = best_center;
+			}
+			total_sq_distance += std::max(best, 0.f);
+		}
+	}
+	return total_sq_distance;
+}
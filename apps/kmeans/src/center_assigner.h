@@ -0,0 +1,92 @@
+/*
+ * center_assigner.h
+ *
+ *  Assigns points to their closest center. Minibatch assignment keeps
+ *  Yinyang bounds per point (an upper bound on the distance to its center
+ *  and a lower bound per group of centers) and only scans the groups whose
+ *  bound does not prove the assignment unchanged; with one group this is
+ *  Hamerly's algorithm. Full passes over the data go through a blocked
+ *  dense dot product kernel.
+ */
+
+#ifndef CENTER_ASSIGNER_H_
+#define CENTER_ASSIGNER_H_
+
+#include <vector>
+#include "cluster_centers.h"
+#include "dataset.h"
+#include "sparse_vector.h"
+
+using std::vector;
+
+class center_assigner {
+public:
+	center_assigner();
+	// Bounds are kept for points 0 .. number_of_points - 1.
+	center_assigner(int dimensionality, int number_of_clusters,
+			int number_of_points);
+
+	// Take a snapshot of the centers. The distance each center moved since
+	// the previous snapshot loosens the bounds of the points assigned to it.
+	void SetCenters(const cluster_centers& centers);
+
+	// Closest center of point point_id (x) under the current snapshot.
+	int Assign(int point_id, const sparse_vector& x);
+
+	// Assign points [start, end) of data, writing the closest centers to
+	// center_ids (if not NULL). Returns the sum of squared distances.
+	float AssignBlock(const dataset& data, int start, int end,
+			int* center_ids);
+
+	// Number of exact point-center distances computed, for profiling.
+	long NumDistanceComputations() const {
+		return num_distances_;
+	}
+
+private:
+	float SqDistanceToCenter(int center_id, const sparse_vector& x) const;
+
+	// out[i * nc + c] = <x_i, c_c> for the row-major nx x d block x and the
+	// d x nc (transposed) block c_t, tiled over centers and dimensions.
+	void BlockedInnerProducts(const float* x, int nx, const float* c_t, int nc,
+			float* out) const;
+
+	int dimensionality_;
+	int number_of_clusters_;
+
+	// number_of_clusters_ x dimensionality_, row-major.
+	vector<float> centers_;
+	// The same, dimensionality_ x number_of_clusters_.
+	vector<float> centers_t_;
+	vector<float> center_sq_norms_;
+	bool has_centers_;
+
+	// Centers [group_begin_[g], group_begin_[g + 1]) form group g.
+	int number_of_groups_;
+	vector<int> group_begin_;
+	vector<int> group_of_center_;
+
+	// Total distance each center moved over all snapshots, and per group the
+	// sum over snapshots of the largest move in the group.
+	vector<double> center_drift_;
+	vector<double> group_drift_;
+
+	// Per point: assigned center (-1 if never assigned), upper bound on the
+	// distance to it, and per group a lower bound on the distance to any
+	// center of the group other than the assigned one. Bounds are stored
+	// shifted by the drift totals when they were set (upper - center drift,
+	// lower + group drift), so they never need a pass over all points.
+	vector<int> assignment_;
+	vector<double> upper_;
+	vector<double> lower_;
+
+	// Scratch of Assign(), per group.
+	vector<double> group_first_;
+	vector<double> group_second_;
+	vector<int> group_first_center_;
+	vector<char> group_scanned_;
+
+	long num_distances_;
+};
+
+#endif /* CENTER_ASSIGNER_H_ */
@@ -7,12 +7,13 @@
 
 #include "dataset.h"
 #include "assert.h"
+#include <io/block_stream.hpp>
+#include <algorithm>
 #include <cstring>
 #include <cstdio>
 #include <cstdlib>
 #include <iostream>
 #include <sstream>
-#include <fstream>
 
 using std::string;
 using std::cout;
@@ -27,33 +28,29 @@ dataset::~dataset() {
 
 
 dataset::dataset(const string& file_name, int buffer_mb, int start_index, int end_index) {
-	long int buffer_size = buffer_mb * 1024 * 1024;
-	char* local_buffer = new char[buffer_size];
-	std::ifstream file_stream(file_name.c_str(), std::ifstream::in);
-	file_stream.rdbuf()->pubsetbuf(local_buffer, buffer_size);
-	if (!file_stream) {
-		std::cerr << "Error reading file " << file_name << std::endl;
-		exit(1);
-	}
+	// buffer_mb bounds the read-ahead: that many MB of chunks are prefetched
+	// (and decompressed) on the reader thread while lines are parsed here.
+	int num_buffers = std::max<long>(2,
+			(long) buffer_mb * 1024 * 1024 / petuum::io::BUFFER_SIZE);
+	petuum::io::PrefetchReader reader(file_name, petuum::io::kAutoCodec,
+			num_buffers);
 
 	string line_string;
 	int line_count=0;
-	while (getline(file_stream, line_string)) {
+	while (line_count < end_index && reader.GetLine(&line_string)) {
 
-		if(line_count>=start_index && line_count < end_index){
+		if(line_count>=start_index){
 			AddDataPoint(line_string);
 		}
 		line_count++;
 	}
-
-	delete[] local_buffer;
 }
 
 int dataset::Size() const{
 	return dataset_.size();
 }
 
-const sparse_vector dataset::getDataPointAt(long x) const {
+const sparse_vector& dataset::getDataPointAt(long x) const {
 	assert(x<dataset_.size());
 	return dataset_[x];
 }
@@ -22,7 +22,7 @@ public:
 	virtual ~dataset();
 	int Size() const;
 	dataset(const string& file_name, int buffer_mb, int start_index, int end_index);
-	const sparse_vector getDataPointAt(long x) const;
+	const sparse_vector& getDataPointAt(long x) const;
 	// Adds the vector represented by this svm-light format string
 	// to the data set.
 	void AddDataPoint(const string& vector_string);
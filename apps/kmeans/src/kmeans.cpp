@@ -75,13 +75,9 @@ void KMeans::Start() {
 	string cluster_centers_input_location = context.get_string("cluster_centers_input_location");
 	int center_table_id = context.get_int32("centres_table_id");
 
-	int delta_center_table_id=context.get_int32("update_centres_table_id");
 	int objective_value_table_id = context.get_int32("objective_function_value_tableId");
 	centres_ = petuum::PSTableGroup::GetTableOrDie<float>(center_table_id);
 	objective_values_ = petuum::PSTableGroup::GetTableOrDie<float>(objective_value_table_id);
-	int center_count_table_id = context.get_int32("center_count_tableId");
-	count_of_centers_ = petuum::PSTableGroup::GetTableOrDie<int>(center_count_table_id);
-	delta_centers_ = petuum::PSTableGroup::GetTableOrDie<int>(delta_center_table_id);
 
 	petuum::HighResolutionTimer center_initialization_timer;
 	cluster_centers initial_centres(dimensionality, num_centers);
@@ -102,17 +98,19 @@ void KMeans::Start() {
 		LOG(INFO)<< "pushing the initial centers to petuum.";
 	}
 
-	for (int i = 0; i < num_centers; i++) {
-		petuum::UpdateBatch<float> update_batch;
-		for (int j = 0; j < dimensionality; j++) {
-			if (client_id == 0 && thread_id == 0) {
+	// The initial centers weigh 1 / learning_rate points, so the first
+	// point assigned to a center moves it by learning_rate / (1 + learning_rate).
+	if (client_id == 0 && thread_id == 0) {
+		float initial_weight = 1. / context.get_double("learning_rate");
+		for (int i = 0; i < num_centers; i++) {
+			petuum::UpdateBatch<float> update_batch(dimensionality + 1);
+			for (int j = 0; j < dimensionality; j++) {
 				update_batch.Update(j,
-						initial_centres.getCenterAt(i).ValueAt(j));
-			} else {
-				update_batch.Update(j, 0);
+						initial_centres.getCenterAt(i).ValueAt(j) * initial_weight);
 			}
+			update_batch.Update(dimensionality, initial_weight);
+			centres_.BatchInc(i, update_batch);
 		}
-		centres_.BatchInc(i, update_batch);
 	}
 	petuum::PSTableGroup::Clock();
 	process_barrier_->wait();
@@ -122,12 +120,10 @@ void KMeans::Start() {
 	config.machine_id_ = client_id;
 	config.num_threads_=context.get_int32("num_app_threads");
 	config.examples_per_batch_=examples_per_batch_;
-	config.delta_centers_=delta_centers_;
 	config.num_centers = num_centers;
 	config.centers_=centres_;
 	config.objective_values_ = objective_values_;
 	config.dimensionality=dimensionality;
-	config.center_counts = count_of_centers_;
 	config.size_of_mini_batch = mini_batch_size;
 	config.assignment_output_location_ = context.get_string("output_assignments_folder");
 	config.sparse_data=false;
@@ -135,8 +131,6 @@ void KMeans::Start() {
 	config.threadid = thread_id;
 	config.start_example = (thread_id * examples_per_thread_);
 	config.end_example = config.start_example + examples_per_thread_;
-	config.learning_rate_= context.get_double("learning_rate");
-	config.process_barrier_ = process_barrier_.get();
 	KMeansWorker workerThread(config);
 	workerThread.RefreshParams();
 	workerThread.PushObjective(0,num_epochs+1,false);
@@ -51,7 +51,9 @@ DEFINE_bool(load_clusters_from_disk,false,"Load centers from external source.");
 DEFINE_string(cluster_centers_input_location,"","location for file containing initial centers");
 
 //todo decide on the following
-DEFINE_double(learning_rate, 0.1, "Learning rate for miniBatch itertions");
+DEFINE_double(learning_rate, 0.1, "Step size of the first point assigned to "
+		"a center; later points are averaged in (the initial centers weigh "
+		"1 / learning_rate points).");
 
 // Misc
 DEFINE_string(output_centers_file, "", "File location for centers information");
@@ -59,15 +61,12 @@ DEFINE_string(output_assignments_folder,"","File location for storing the output
 DEFINE_string(output_file_prefix, "", "Results go here.");
 
 //petuum tables.
-DEFINE_int32(centres_table_id, 0, "Weight table's ID in PS.");
-DEFINE_int32(update_centres_table_id, 3, "Delta Weight table's ID in PS. This is used to accumulate changes and then apply them.");
-DEFINE_int32(center_count_tableId, 1, "center count's ID in PS.");
+DEFINE_int32(centres_table_id, 0, "Center table's ID in PS. Row i holds the "
+		"sum of the points assigned to center i and their count.");
 DEFINE_int32(objective_function_value_tableId, 4, "objective function value table id");
 
 DEFINE_int32(staleness, 0, "staleness for centers tables.");
-DEFINE_int32(count_table_staleness, 0, "staleness for center count table.");
 DEFINE_int32(objective_table_stalesness,0,"staleness for objective function table");
-DEFINE_int32(update_centres_table_stalenss,0,"staleness for the table which hold the ith epochs number of centers");
 
 
 DEFINE_int32(row_oplog_type, petuum::RowOpLogType::kSparseRowOpLog,
@@ -79,7 +78,6 @@ DEFINE_int32(num_secs_per_checkpoint, 600, "# of seconds between each saving "
 DEFINE_int32(total_num_of_training_samples, 100, "Total number of training samples");
 
 const int32_t kDenseRowFloatTypeID = 0;
-const int32_t kDenseRowIntTypeID = 1;
 
 int main(int argc, char *argv[]) {
 	google::ParseCommandLineFlags(&argc, &argv, true);
@@ -98,7 +96,7 @@ int main(int argc, char *argv[]) {
 			FLAGS_num_comm_channels_per_client;
 	table_group_config.num_total_clients = FLAGS_num_clients;
 
-	table_group_config.num_tables = 4;
+	table_group_config.num_tables = 2;
 	//  // + 1 for main() thread.
 	table_group_config.num_local_app_threads = FLAGS_num_app_threads + 1;
 	table_group_config.client_id = FLAGS_client_id;
@@ -117,8 +115,6 @@ int main(int argc, char *argv[]) {
 
 	petuum::PSTableGroup::RegisterRow<petuum::DenseRow<float> >(
 			kDenseRowFloatTypeID);
-	petuum::PSTableGroup::RegisterRow<petuum::DenseRow<int> >(
-			kDenseRowIntTypeID);
 	//
 
 	petuum::PSTableGroup::Init(table_group_config, false);
@@ -128,11 +124,12 @@ int main(int argc, char *argv[]) {
 	table_config.table_info.row_type = kDenseRowFloatTypeID;
 	table_config.table_info.table_staleness = FLAGS_staleness;
 	//  //table_config.table_info.row_capacity = feature_dim * num_labels;
-	table_config.table_info.row_capacity = FLAGS_dimensionality;
+	// + 1 for the count of points summed into the row.
+	table_config.table_info.row_capacity = FLAGS_dimensionality + 1;
 	table_config.table_info.row_oplog_type = FLAGS_row_oplog_type;
 	table_config.table_info.oplog_dense_serialized =
 			FLAGS_oplog_dense_serialized;
-	table_config.table_info.dense_row_oplog_capacity = FLAGS_dimensionality;
+	table_config.table_info.dense_row_oplog_capacity = FLAGS_dimensionality + 1;
 	//  //table_config.process_cache_capacity = 1;
 	table_config.process_cache_capacity = FLAGS_num_centers;
 	table_config.oplog_capacity = table_config.process_cache_capacity;
@@ -142,25 +139,12 @@ int main(int argc, char *argv[]) {
 
 
 	//Objective Function table.
+	table_config.table_info.row_capacity = FLAGS_num_epochs+1;
 	table_config.table_info.dense_row_oplog_capacity = FLAGS_num_epochs+1;
 	table_config.table_info.table_staleness = 0;
 	petuum::PSTableGroup::CreateTable(FLAGS_objective_function_value_tableId, table_config);
 	LOG(INFO) << "created objective values table";
 
-
-	// Centers table
-	table_config.table_info.row_type = kDenseRowIntTypeID;
-	table_config.table_info.table_staleness = FLAGS_count_table_staleness;
-	table_config.table_info.row_capacity = FLAGS_num_centers;
-	table_config.process_cache_capacity = 1000;
-	table_config.oplog_capacity = table_config.process_cache_capacity;
-	petuum::PSTableGroup::CreateTable(FLAGS_center_count_tableId, table_config);
-
-
-	// Table to hold the local deltas.
-	petuum::PSTableGroup::CreateTable(FLAGS_update_centres_table_id, table_config);
-
-
 	LOG(INFO) << "Completed creating tables" ;
 
 	petuum::PSTableGroup::CreateTableDone();
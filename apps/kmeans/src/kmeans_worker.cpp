@@ -21,6 +21,7 @@
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <algorithm>
 
 using std::cout;
 using std::endl;
@@ -32,14 +33,9 @@ int KMeansWorker::GetRandInteger() {
 
 float KMeansWorker::ComputeObjective() {
 
-	int center_id;
-	float total_sq_distance = 0.0;
-	for (int i = 0; i < training_data_->Size(); ++i) {
-
-		total_sq_distance += centers_local_.SqDistanceToClosestCenter(
-				training_data_->getDataPointAt(i), center_id);
-	}
-	return total_sq_distance;
+	assigner_.SetCenters(centers_local_);
+	return assigner_.AssignBlock(*training_data_, 0, training_data_->Size(),
+			NULL);
 }
 
 
@@ -50,22 +46,22 @@ KMeansWorker::KMeansWorker(KMeansWorkerConfig config) :
 
 		dimensions_(config.dimensionality), num_centers_(config.num_centers), size_of_miniBatch_(
 				config.size_of_mini_batch),machine_id_(config.machine_id_),num_threads_(config.num_threads_), thread_id_(config.threadid), start_range_(
-				config.start_example), end_range_(config.end_example),examples_per_batch_(config.examples_per_batch_), learning_rate_(config.learning_rate_)
+				config.start_example), end_range_(config.end_example),examples_per_batch_(config.examples_per_batch_)
 				{
 
 	assignment_output_location_ = config.assignment_output_location_;
 	centers_ = config.centers_;
-	delta_centers_ = config.delta_centers_;
-	center_count_ = config.center_counts;
 	objective_values_ = config.objective_values_;
 
 	centers_local_ = cluster_centers(dimensions_, num_centers_);
 	delta_local_ = cluster_centers(dimensions_, num_centers_);
 	center_count_local_.resize(num_centers_);
 	center_count_delta_.resize(num_centers_);
-	center_count_delta_accross_machines.resize(num_centers_);
+	center_weight_local_.resize(num_centers_);
 	training_data_ = config.dataset_;
-	process_barrier_ = config.process_barrier_;
+	// Minibatches only sample this thread's range; keep bounds for it.
+	assigner_ = center_assigner(dimensions_, num_centers_,
+			end_range_ - start_range_);
 	std::random_device rd;
 	generator_ = std::mt19937(rd());
 	distribution_ = std::uniform_int_distribution<>(start_range_,
@@ -89,101 +85,68 @@ void KMeansWorker::PushObjective(int epoch, int totalEpochs, bool writeAssignmen
 	objective_values_.BatchInc(0, objective_update_batch);
 }
 void KMeansWorker::RefreshParams() {
-
-	//updating the centers counts and the number of centers processes per count.
-	petuum::UpdateBatch<int> center_count_update_batch(num_centers_);
-	petuum::UpdateBatch<int> center_count_update_batch_delta(num_centers_);
-
+	// Push the sums and counts of the points assigned since the last refresh.
 	for (int i = 0; i < num_centers_; i++) {
-		center_count_update_batch.Update(i, center_count_delta_[i]);
-		center_count_update_batch_delta.Update(i, center_count_delta_[i]);
-	}
-	center_count_.BatchInc(0, center_count_update_batch);
-	delta_centers_.BatchInc(0,center_count_update_batch_delta);
-
-	
-	process_barrier_->wait();
-	petuum::PSTableGroup::Clock();
-	petuum::PSTableGroup::GlobalBarrier();
-
-
-
-	std::vector<int> tmp_row1(num_centers_);
-	petuum::RowAccessor row_acc;	
-	
-	const auto& r = delta_centers_.Get<petuum::DenseRow<int> >(0,&row_acc);
-
-	r.CopyToVector(&tmp_row1);
-	for (int j = 0; j < num_centers_; j++) {
-		center_count_delta_accross_machines[j] = tmp_row1[j];
-	}
-	for (int i = 0; i < num_centers_; i++) {
-		petuum::UpdateBatch<float> center_update_batch(dimensions_);
+		if (center_count_delta_[i] == 0) {
+			continue;
+		}
+		petuum::UpdateBatch<float> center_update_batch(dimensions_ + 1);
 		for (int j = 0; j < dimensions_; j++) {
-			if (center_count_delta_accross_machines[i] == 0) {
-				center_update_batch.Update(j, 0);
-			} else {
-				center_update_batch.Update(j,
-						delta_local_.getCenterAt(i).ValueAt(j)
-								* (((double) center_count_delta_[i])
-										/ center_count_delta_accross_machines[i]));
-			}
+			center_update_batch.Update(j, delta_local_.getCenterAt(i).ValueAt(j));
 		}
+		center_update_batch.Update(dimensions_, center_count_delta_[i]);
 		centers_.BatchInc(i, center_update_batch);
 	}
-	delta_local_.clear();
-	petuum::UpdateBatch<int> center_count_update_batch_delta1(num_centers_);
-	for (int i = 0; i < num_centers_; i++) {
-		center_count_update_batch_delta1.Update(i, -1 * (center_count_delta_[i]));
-	}
-	delta_centers_.BatchInc(0, center_count_update_batch_delta1);
-
-	std::fill(center_count_delta_.begin(), center_count_delta_.end(), 0);
-	std::fill(center_count_delta_accross_machines.begin(), center_count_delta_accross_machines.end(), 0);
+	ClearLocalCenters();
 
-
-	process_barrier_->wait();
-	std::vector<float> tmp_row(dimensions_);
+	// Read the centers within the table's staleness.
+	std::vector<float> tmp_row(dimensions_ + 1);
 	for (int i = 0; i < num_centers_; i++) {
 		petuum::RowAccessor row_acc;
 		const auto&  r1 = centers_.Get<petuum::DenseRow<float> >(i,&row_acc);
 		r1.CopyToVector(&tmp_row);
+		float weight = tmp_row[dimensions_];
+		if (weight <= 0) {
+			continue;
+		}
 		for (int j = 0; j < dimensions_; j++) {
-			centers_local_.setValueToFeature(i, j, tmp_row[j]);
+			centers_local_.setValueToFeature(i, j, tmp_row[j] / weight);
 		}
 		centers_local_.getPointerToCenterAt(i)->reComputeSquaredNorm();
+		center_weight_local_[i] = weight;
 	}
 }
 
 
 void KMeansWorker::ClearLocalCenters(){
 	delta_local_.clear();
+	std::fill(center_count_delta_.begin(), center_count_delta_.end(), 0);
 }
 
 void KMeansWorker::SolveOneMiniBatchIteration() {
 	vector<vector<int> > mini_batch_centers(centers_local_.NumOfCenters());
+	assigner_.SetCenters(centers_local_);
 	for (int i = 0; i < size_of_miniBatch_; ++i) {
 		// Find the closest center for a training point.
 
 		int x_id = GetRandInteger();
-		int closest_center;
-		centers_local_.SqDistanceToClosestCenter(
-				training_data_->getDataPointAt(x_id), closest_center);
+		int closest_center = assigner_.Assign(x_id - start_range_,
+				training_data_->getDataPointAt(x_id));
 		mini_batch_centers[closest_center].push_back(x_id);
 	}
 
 	// Apply the mini-batch.
 	for (unsigned int i = 0; i < mini_batch_centers.size(); ++i) {
 		for (unsigned int j = 0; j < mini_batch_centers[i].size(); ++j) {
-			float eta = learning_rate_
-					/ (++(center_count_local_[i]) + learning_rate_);
+			// The local center stays the running mean of everything
+			// assigned to it that this worker knows of.
+			center_count_local_[i]++;
+			float eta = 1.0 / ++(center_weight_local_[i]);
 
 			center_count_delta_[i]++;
 			delta_local_.getPointerToCenterAt(i)->Add(
 					training_data_->getDataPointAt(mini_batch_centers[i][j]),
-					eta);
-			delta_local_.getPointerToCenterAt(i)->Add(
-					centers_local_.getCenterAt(i), -1.0 * eta);
+					1.0);
 			centers_local_.getPointerToCenterAt(i)->scaleBy(1.0 - eta);
 			centers_local_.getPointerToCenterAt(i)->Add(
 					training_data_->getDataPointAt(mini_batch_centers[i][j]),
@@ -212,7 +175,6 @@ int KMeansWorker::ComputeNumberOfPointsObserved() {
 }
 
 float KMeansWorker::ComputeObjective(int startPoint, int endPoint, bool write_assignments){
-	int center_id;
 	float total_sq_distance = 0.0;
 	FILE* output;
 	int base = machine_id_*examples_per_batch_;
@@ -223,11 +185,15 @@ float KMeansWorker::ComputeObjective(int startPoint, int endPoint, bool write_as
 		output_assignments_file.append(".txt");
 		output = fopen(output_assignments_file.c_str(), "w");
 
-	for (int i = startPoint; (i<endPoint && i < training_data_->Size()); ++i) {
-
-		total_sq_distance += centers_local_.SqDistanceToClosestCenter(
-				training_data_->getDataPointAt(i), center_id);
-		fprintf(output, "%d %d\n",i + base, center_id );
+	endPoint = std::min(endPoint, training_data_->Size());
+	if (startPoint < endPoint) {
+		vector<int> center_ids(endPoint - startPoint);
+		assigner_.SetCenters(centers_local_);
+		total_sq_distance = assigner_.AssignBlock(*training_data_, startPoint,
+				endPoint, &center_ids[0]);
+		for (int i = startPoint; i < endPoint; ++i) {
+			fprintf(output, "%d %d\n", i + base, center_ids[i - startPoint]);
+		}
 	}
 
 	fclose(output);
@@ -16,6 +16,7 @@
 #include <vector>
 #include <functional>
 #include "cluster_centers.h"
+#include "center_assigner.h"
 #include "dataset.h"
 #include "random"
 
@@ -25,18 +26,16 @@ struct KMeansWorkerConfig {
 	int32_t num_centers;bool sparse_data;
 	int32_t size_of_mini_batch;
 	string assignment_output_location_;
+	// Row i is the sum of the points assigned to center i (scaled initial
+	// center included) followed by their total weight.
 	petuum::Table<float> centers_;
-	petuum::Table<int> delta_centers_;
-	petuum::Table<int> center_counts;
 	petuum::Table<float> objective_values_;
 	const dataset* dataset_;
 	int examples_per_batch_;
 	int start_example;
 	int end_example;
-	float learning_rate_;
 	int machine_id_;
 	int num_threads_;
-	boost::barrier* process_barrier_;
 
 };
 
@@ -69,27 +68,28 @@ private:
 	int start_range_;
 	int end_range_;
 	int examples_per_batch_;
-	float learning_rate_;
 	string assignment_output_location_;
 	// ======== PS Tables ==========
-	// The weight of each class (stored as single feature-major row).
+	// Center sums and weights (see KMeansWorkerConfig). Sums and weights
+	// only ever grow by BatchInc, so any SSP-consistent read gives a
+	// valid center as sum / weight and no barrier is needed to refresh.
 	petuum::Table<float> centers_;
-	petuum::Table<int> center_count_;
-	petuum::Table<int> delta_centers_;
 	petuum::Table<float> objective_values_;
 
 
 
 	cluster_centers centers_local_;
+	// Nearest center search over a snapshot of centers_local_.
+	center_assigner assigner_;
+	// Weight of each of centers_local_ (as read, plus local points).
+	std::vector<float> center_weight_local_;
+	// Sum and count of the points assigned locally since the last refresh.
 	cluster_centers delta_local_;
 	std::vector<int> center_count_local_;
-	std::vector<int> center_count_delta_accross_machines;
 
 	std::vector<int> center_count_delta_;
 	const dataset* training_data_;
 
-
-	boost::barrier * process_barrier_;
 	std::mt19937 generator_;
 	std::uniform_int_distribution<> distribution_;
 
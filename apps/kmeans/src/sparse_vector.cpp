@@ -80,20 +80,6 @@ void sparse_vector::push_back(int id, float value) {
 	square_norm+=(value*value);
 }
 
-int sparse_vector::size() const {
-	return vectors_.size();
-}
-
-
-int sparse_vector::FeatureAt(int i) const {
-	return vectors_[i].id_;
-}
-
-
-
-float sparse_vector::ValueAt(int i) const {
-	return vectors_[i].value_;
-}
 
 
 string sparse_vector::AsString() const {
@@ -31,9 +31,9 @@ public:
 	sparse_vector(const sparse_vector& s);
 	virtual ~sparse_vector();
 	void push_back(int id, float value);
-	int FeatureAt (int i) const;
-	float ValueAt (int i) const;
-	int size() const;
+	int FeatureAt (int i) const {return vectors_[i].id_;};
+	float ValueAt (int i) const {return vectors_[i].value_;};
+	int size() const {return vectors_.size();};
 	string AsString() const;
 	float getSquareNorm() const{return square_norm;};
 	void reComputeSquaredNorm();
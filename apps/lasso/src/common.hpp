@@ -23,3 +23,5 @@ DECLARE_int32(num_epochs_per_eval);
 DECLARE_double(learning_rate);
 DECLARE_int32(num_unused_rows);
 DECLARE_int32(num_unused_cols);
+DECLARE_bool(fused_prox_step);
+DECLARE_int32(num_prox_threads);
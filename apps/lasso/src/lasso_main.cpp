@@ -40,6 +40,10 @@ DEFINE_bool(oplog_dense_serialized, false, "True to not squeeze out the 0's "
     "in dense oplog.");
 DEFINE_int32(num_unused_rows, 100000, "# of zero rows to increase communication.");
 DEFINE_int32(num_unused_cols, 1000, "# of columns in the unused table.");
+DEFINE_bool(fused_prox_step, true, "Compute gradient, soft-threshold and "
+    "X * delta in one pass over a CSC copy of the worker's columns.");
+DEFINE_int32(num_prox_threads, 1, "# of threads splitting each worker's "
+    "column block in the fused prox step.");
 
 const int32_t kDenseRowFloatTypeID = 0;
 const int32_t kDenseRowIntTypeID = 1;
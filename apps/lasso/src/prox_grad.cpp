@@ -4,6 +4,7 @@
 #include <vector>
 #include <ml/include/ml.hpp>
 #include <cstdint>
+#include <algorithm>
 
 namespace lasso {
 
@@ -15,7 +16,10 @@ ProxGrad::ProxGrad(const ProxGradConfig& config) :
   feature_end_(config.feature_end),
   num_features_(feature_end_ - feature_start_),
   beta_(num_features_),
-  r_(num_samples_) {
+  r_(num_samples_),
+  X_block_ready_(false),
+  residual_(num_samples_),
+  X_delta_(num_samples_) {
     w_table_ =
       petuum::PSTableGroup::GetTableOrDie<float>(FLAGS_w_table_id);
     unused_table_ =
@@ -36,7 +40,7 @@ void ProxGrad::ProxStep(
   }
   w_table_.Get(0, &row_acc);
   const auto& w_all_row = row_acc.Get<petuum::DenseRow<float>>();
-  std::vector<float> row_vec;
+  std::vector<float>& row_vec = row_vec_;
   w_all_row.CopyToVector(&row_vec);
 
   // Record clock differences. staleness_dist[0] corresponds to
@@ -61,40 +65,55 @@ void ProxGrad::ProxStep(
   }
   staleness_table_.BatchInc(0, staleness_update);
 
-  std::vector<float> w_only_vec(row_vec.begin(),
-      row_vec.begin() + num_samples_);
-  petuum::ml::DenseFeature<float> w_all(w_only_vec);
-  CHECK_EQ(num_samples_, w_all.GetFeatureDim());
   CHECK_EQ(num_samples_, y.GetFeatureDim());
-  // w -= y
-  FeatureScaleAndAdd(-1, y, &w_all);
-
-  // gradient = 2 * X_k^T (w_all - y)
-  petuum::ml::DenseFeature<float> grad(num_features_);
-  for (int j = 0; j < num_features_; ++j) {
-    grad[j] = 2 * SparseDenseFeatureDotProduct(
-        *(X_cols[feature_start_ + j]), w_all);
-  }
+  petuum::UpdateBatch<float> update(num_samples_ + 1);
+  if (FLAGS_fused_prox_step) {
+    if (!X_block_ready_) {
+      X_block_.Init(X_cols, feature_start_, feature_end_);
+      X_block_ready_ = true;
+    }
+    // residual = w_all - y
+    for (int i = 0; i < num_samples_; ++i) {
+      residual_[i] = row_vec[i] - y[i];
+    }
+    FusedProxStep(lr);
+    for (int i = 0; i < num_samples_; ++i) {
+      update.UpdateSet(i, i, X_delta_[i]);
+    }
+  } else {
+    std::vector<float> w_only_vec(row_vec.begin(),
+        row_vec.begin() + num_samples_);
+    petuum::ml::DenseFeature<float> w_all(w_only_vec);
+    CHECK_EQ(num_samples_, w_all.GetFeatureDim());
+    // w -= y
+    FeatureScaleAndAdd(-1, y, &w_all);
+
+    // gradient = 2 * X_k^T (w_all - y)
+    petuum::ml::DenseFeature<float> grad(num_features_);
+    for (int j = 0; j < num_features_; ++j) {
+      grad[j] = 2 * SparseDenseFeatureDotProduct(
+          *(X_cols[feature_start_ + j]), w_all);
+    }
 
-  petuum::ml::DenseFeature<float> new_beta = beta_;
-  FeatureScaleAndAdd(-lr, grad, &new_beta);
-  SoftThreshold(lr * FLAGS_lambda, &new_beta);
+    petuum::ml::DenseFeature<float> new_beta = beta_;
+    FeatureScaleAndAdd(-lr, grad, &new_beta);
+    SoftThreshold(lr * FLAGS_lambda, &new_beta);
 
-  // delta_k^{c+1} = beta_k^{c+1} - beta_k^c
-  petuum::ml::DenseFeature<float> delta = new_beta;
-  FeatureScaleAndAdd(-1, beta_, &delta);
-  beta_ = new_beta;
+    // delta_k^{c+1} = beta_k^{c+1} - beta_k^c
+    petuum::ml::DenseFeature<float> delta = new_beta;
+    FeatureScaleAndAdd(-1, beta_, &delta);
+    beta_ = new_beta;
 
-  // X_k * delta_k^{c+1}
-  petuum::ml::DenseFeature<float> X_delta(num_samples_);
-  for (int j = 0; j < num_features_; ++j) {
-    FeatureScaleAndAdd(delta[j],
-        *(X_cols[feature_start_ + j]), &X_delta);
-  }
+    // X_k * delta_k^{c+1}
+    petuum::ml::DenseFeature<float> X_delta(num_samples_);
+    for (int j = 0; j < num_features_; ++j) {
+      FeatureScaleAndAdd(delta[j],
+          *(X_cols[feature_start_ + j]), &X_delta);
+    }
 
-  petuum::UpdateBatch<float> update(num_samples_ + 1);
-  for (int i = 0; i < num_samples_; ++i) {
-    update.UpdateSet(i, i, X_delta[i]);
+    for (int i = 0; i < num_samples_; ++i) {
+      update.UpdateSet(i, i, X_delta[i]);
+    }
   }
   // Increment clock by 1.
   update.UpdateSet(num_samples_, worker_rank_ + num_samples_, 1);
@@ -110,6 +129,54 @@ void ProxGrad::ProxStep(
   }
 }
 
+void ProxGrad::FusedProxStep(float lr) {
+  int num_threads = std::max(1, std::min(FLAGS_num_prox_threads,
+        num_features_));
+  X_delta_parts_.resize(num_threads - 1);
+  float threshold = lr * FLAGS_lambda;
+  float* beta = beta_.GetVector().data();
+  const float* residual = residual_.data();
+
+  // Thread t owns features [begin, end) and accumulates into its own
+  // X_delta; the columns' sample ids overlap across features.
+  auto prox_range = [&](int t) {
+    float* X_delta = X_delta_.data();
+    if (t > 0) {
+      X_delta_parts_[t - 1].assign(num_samples_, 0.);
+      X_delta = X_delta_parts_[t - 1].data();
+    }
+    int begin = static_cast<int64_t>(num_features_) * t / num_threads;
+    int end = static_cast<int64_t>(num_features_) * (t + 1) / num_threads;
+    for (int j = begin; j < end; ++j) {
+      // gradient = 2 * X_j^T (w_all - y)
+      float b = beta[j] - lr * 2 * X_block_.Dot(j, residual);
+      if (b > threshold) {
+        b -= threshold;
+      } else if (b < -threshold) {
+        b += threshold;
+      } else {
+        b = 0.;
+      }
+      float delta = b - beta[j];
+      beta[j] = b;
+      if (delta != 0) {
+        X_block_.Axpy(j, delta, X_delta);
+      }
+    }
+  };
+
+  std::fill(X_delta_.begin(), X_delta_.end(), 0.);
+  if (prox_pool_ == nullptr || prox_pool_->get_num_threads() != num_threads) {
+    prox_pool_.reset(new petuum::ml::ForkJoinPool(num_threads));
+  }
+  prox_pool_->Run(prox_range);
+  for (const auto& part : X_delta_parts_) {
+    for (int i = 0; i < num_samples_; ++i) {
+      X_delta_[i] += part[i];
+    }
+  }
+}
+
 // Sum of sqloss for all data.
 float ProxGrad::EvalSqLoss(
     const petuum::ml::DenseFeature<float>& y) {
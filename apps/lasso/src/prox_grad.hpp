@@ -1,5 +1,6 @@
 #pragma once
 
+#include <memory>
 #include <vector>
 #include <ml/include/ml.hpp>
 #include <petuum_ps_common/include/petuum_ps.hpp>
@@ -34,6 +35,10 @@ private:
   void SoftThreshold(float threshold,
       petuum::ml::DenseFeature<float>* x);
 
+  // One pass over X_block_ computing the gradient, the soft-thresholded
+  // beta_ and X_delta_ = X_k * delta_k, with residual_ = w_all - y.
+  void FusedProxStep(float lr);
+
 private:
   int worker_rank_;
   int num_workers_;
@@ -47,6 +52,17 @@ private:
   petuum::Table<float> w_table_;
   petuum::Table<float> unused_table_;
   petuum::Table<int64_t> staleness_table_;
+
+  // Fused path (--fused_prox_step). Buffers are reused across steps.
+  petuum::ml::CscBlock X_block_;
+  bool X_block_ready_;
+  std::vector<float> row_vec_;
+  std::vector<float> residual_;       // [num_samples_]
+  std::vector<float> X_delta_;        // [num_samples_]
+  // X_delta of threads 1.. of --num_prox_threads.
+  std::vector<std::vector<float> > X_delta_parts_;
+  // Workers of the prox step, kept across steps.
+  std::unique_ptr<petuum::ml::ForkJoinPool> prox_pool_;
 };
 
 }  // namespace lasso
@@ -23,6 +23,7 @@ decay_rate=0.95
 num_batches_per_eval=300
 num_train_eval=10000   # large number to use all data.
 num_test_eval=20
+work_stealing=false  # true to balance batches across local threads.
 
 # System parameters:
 host_filename="scripts/localserver"
@@ -99,6 +100,7 @@ for ip in $unique_host_list; do
       --use_weight_file=$use_weight_file \
       --weight_file=$weight_file \
       --sparse_weight=false \
+      --work_stealing=$work_stealing \
       --output_file_prefix=$output_file_prefix"
 
   ssh $ssh_options $ip $cmd &
@@ -27,6 +27,7 @@ DECLARE_double(learning_rate);
 DECLARE_double(decay_rate);
 DECLARE_int32(num_batches_per_eval);
 DECLARE_bool(sparse_weight);
+DECLARE_bool(work_stealing);
 
 DECLARE_string(output_file_prefix);
 DECLARE_int32(w_table_id);
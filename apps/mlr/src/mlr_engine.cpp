@@ -60,6 +60,18 @@ MLREngine::MLREngine() : thread_counter_(0) {
     CHECK_EQ(feature_one_based_, mreader_test.get_bool("feature_one_based"));
     CHECK_EQ(label_one_based_, mreader_test.get_bool("label_one_based"));
   }
+
+  if (FLAGS_work_stealing) {
+    petuum::ml::WorkloadManagerConfig workload_mgr_config;
+    workload_mgr_config.client_id = FLAGS_client_id;
+    workload_mgr_config.num_clients = FLAGS_num_clients;
+    workload_mgr_config.num_threads = FLAGS_num_app_threads;
+    workload_mgr_config.num_batches_per_epoch = FLAGS_num_batches_per_epoch;
+    workload_mgr_config.num_data = num_train_data_;
+    workload_mgr_config.global_data = FLAGS_global_data;
+    work_stealing_pool_.reset(
+        new petuum::ml::WorkStealingPool(workload_mgr_config));
+  }
 }
 
 
@@ -188,9 +200,10 @@ void MLREngine::Start() {
   workload_mgr_config.num_batches_per_epoch = num_batches_per_epoch;
   workload_mgr_config.num_data = num_train_data_;
   workload_mgr_config.global_data = global_data;
-  petuum::ml::WorkloadManager workload_mgr(workload_mgr_config);
   // For training error.
   petuum::ml::WorkloadManager workload_mgr_train_error(workload_mgr_config);
+  workload_mgr_config.work_stealing_pool = work_stealing_pool_.get();
+  petuum::ml::WorkloadManager workload_mgr(workload_mgr_config);
 
   LOG_IF(INFO, client_id == 0 && thread_id == 0)
     << "Batch size: " << workload_mgr.GetBatchSize();
@@ -87,6 +87,10 @@ private:
 
   std::unique_ptr<boost::barrier> process_barrier_;
 
+  // Shared by the training WorkloadManager of all threads. nullptr unless
+  // FLAGS_work_stealing.
+  std::unique_ptr<petuum::ml::WorkStealingPool> work_stealing_pool_;
+
   // ============ PS Tables ============
   petuum::Table<float> loss_table_;
   petuum::Table<float> w_table_;
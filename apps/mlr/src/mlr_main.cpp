@@ -49,6 +49,8 @@ DEFINE_double(learning_rate, 0.1, "Initial step size");
 DEFINE_double(decay_rate, 1, "multiplicative decay");
 DEFINE_int32(num_batches_per_eval, 10, "Number of batches per evaluation");
 DEFINE_bool(sparse_weight, false, "Use sparse feature for model parameters");
+DEFINE_bool(work_stealing, false, "True to let threads that finish their "
+    "batch early take data from the batches of slower threads on this client");
 
 // Misc
 DEFINE_string(output_file_prefix, "", "Results go here.");
@@ -0,0 +1,98 @@
+#include "binned_features.hpp"
+#include <glog/logging.h>
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+namespace tree {
+
+namespace {
+
+// Quantiles are computed on at most this many evenly strided data.
+const int32_t kMaxBinSampleSize = 100000;
+
+}  // anonymous namespace
+
+BinnedFeatures::BinnedFeatures(
+    const std::vector<petuum::ml::AbstractFeature<float>*>& features,
+    int32_t feature_dim, int32_t num_bins) :
+  num_data_(features.size()), feature_dim_(feature_dim),
+  bin_upper_(feature_dim) {
+  CHECK_GT(num_bins, 1);
+  CHECK_LE(num_bins, 256) << "Bin ids are stored in uint8";
+
+  // Gather the non-zero values of the sampled data per feature. Zeros are
+  // implicit so that sparse data stays cheap.
+  int32_t num_sample = std::min(num_data_, kMaxBinSampleSize);
+  std::vector<std::vector<float> > sample_vals(feature_dim_);
+  for (int i = 0; i < num_sample; ++i) {
+    const petuum::ml::AbstractFeature<float>& x =
+      *features[static_cast<int64_t>(i) * num_data_ / num_sample];
+    for (int j = 0; j < x.GetNumEntries(); ++j) {
+      float val = x.GetFeatureVal(j);
+      if (val != 0) {
+        sample_vals[x.GetFeatureId(j)].push_back(val);
+      }
+    }
+  }
+
+  for (int f = 0; f < feature_dim_; ++f) {
+    std::vector<float>& vals = sample_vals[f];
+    std::sort(vals.begin(), vals.end());
+    int32_t num_zeros = num_sample - vals.size();
+
+    // Distinct values and their counts, zeros merged in.
+    std::vector<std::pair<float, int32_t> > distinct;
+    bool zero_added = (num_zeros == 0);
+    for (int j = 0; j < vals.size(); ++j) {
+      if (!zero_added && vals[j] > 0) {
+        distinct.push_back(std::make_pair(0.f, num_zeros));
+        zero_added = true;
+      }
+      if (distinct.empty() || distinct.back().first != vals[j]) {
+        distinct.push_back(std::make_pair(vals[j], 0));
+      }
+      ++distinct.back().second;
+    }
+    if (!zero_added) {
+      distinct.push_back(std::make_pair(0.f, num_zeros));
+    }
+    std::vector<float>().swap(vals);
+
+    // Close a bin whenever it holds its share of the sample.
+    std::vector<float>& upper = bin_upper_[f];
+    int64_t bin_size = std::max(1, num_sample / num_bins);
+    int64_t accum = 0;
+    for (int j = 0; j + 1 < distinct.size(); ++j) {
+      accum += distinct[j].second;
+      if (accum >= bin_size && upper.size() + 1 < num_bins) {
+        upper.push_back(distinct[j].first);
+        accum = 0;
+      }
+    }
+    // Last bin catches everything, including values unseen in the sample.
+    upper.push_back(std::numeric_limits<float>::max());
+  }
+
+  bins_.resize(static_cast<size_t>(feature_dim_) * num_data_);
+  for (int f = 0; f < feature_dim_; ++f) {
+    uint8_t zero_bin = GetBin(f, 0.);
+    std::fill(bins_.begin() + static_cast<size_t>(f) * num_data_,
+        bins_.begin() + static_cast<size_t>(f + 1) * num_data_, zero_bin);
+  }
+  for (int i = 0; i < num_data_; ++i) {
+    const petuum::ml::AbstractFeature<float>& x = *features[i];
+    for (int j = 0; j < x.GetNumEntries(); ++j) {
+      int32_t f = x.GetFeatureId(j);
+      bins_[static_cast<size_t>(f) * num_data_ + i] =
+        GetBin(f, x.GetFeatureVal(j));
+    }
+  }
+}
+
+uint8_t BinnedFeatures::GetBin(int32_t feature_id, float val) const {
+  const std::vector<float>& upper = bin_upper_[feature_id];
+  return std::lower_bound(upper.begin(), upper.end(), val) - upper.begin();
+}
+
+}  // namespace tree
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <ml/include/ml.hpp>
+
+namespace tree {
+
+// BinnedFeatures quantizes every feature once into at most num_bins
+// (<= 256) bins and stores the bin ids column-major, so that split finding
+// reads one contiguous uint8 column per feature instead of calling the
+// (possibly binary-searching) AbstractFeature::operator[] per sample.
+//
+// Bin b of feature f holds values in (GetBinUpper(f, b-1), GetBinUpper(f, b)],
+// so "bin <= b" is the same test as "value <= GetBinUpper(f, b)" and trees
+// split on bins still predict on raw features. Bin boundaries are quantiles
+// of (a sample of) the training data. Read only after construction; shared
+// by all threads.
+class BinnedFeatures {
+public:
+  BinnedFeatures(
+      const std::vector<petuum::ml::AbstractFeature<float>*>& features,
+      int32_t feature_dim, int32_t num_bins);
+
+  int32_t GetNumData() const {
+    return num_data_;
+  }
+
+  int32_t GetNumBins(int32_t feature_id) const {
+    return bin_upper_[feature_id].size();
+  }
+
+  // Bin ids of feature_id for all data.
+  const uint8_t* GetColumn(int32_t feature_id) const {
+    return &bins_[static_cast<size_t>(feature_id) * num_data_];
+  }
+
+  float GetBinUpper(int32_t feature_id, int32_t bin) const {
+    return bin_upper_[feature_id][bin];
+  }
+
+private:
+  // Smallest bin id whose upper bound is >= val.
+  uint8_t GetBin(int32_t feature_id, float val) const;
+
+  int32_t num_data_;
+  int32_t feature_dim_;
+
+  // feature_dim_ x num_data_, column-major.
+  std::vector<uint8_t> bins_;
+
+  // bin_upper_[f] is sorted; the last one is FLT_MAX.
+  std::vector<std::vector<float> > bin_upper_;
+};
+
+}  // namespace tree
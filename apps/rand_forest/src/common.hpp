@@ -27,6 +27,8 @@ DECLARE_int32(num_data_subsample);
 DECLARE_int32(num_features_subsample);
 DECLARE_int32(num_feat_split_vals);
 DECLARE_int32(num_stop_split);
+DECLARE_int32(num_feature_bins);
+DECLARE_int32(num_tree_build_threads);
 
 // Save and Load
 DECLARE_bool(save_pred);
@@ -15,14 +15,16 @@ namespace tree {
 
 DecisionTree::DecisionTree(): features_(0), labels_(0),
   num_data_(0), max_depth_(0), num_data_subsample_(0),
-  num_features_subsample_(0), num_labels_(0), feature_dim_(0) {
+  num_features_subsample_(0), num_labels_(0), feature_dim_(0),
+  binned_features_(0), work_pool_(0) {
   std::random_device rd;
   rng_engine_.reset(new std::mt19937(rd()));
 }
 
 DecisionTree::DecisionTree(const std::string& input): features_(0), labels_(0),
   num_data_(0), max_depth_(0), num_data_subsample_(0),
-  num_features_subsample_(0), num_labels_(0), feature_dim_(0) {
+  num_features_subsample_(0), num_labels_(0), feature_dim_(0),
+  binned_features_(0), work_pool_(0) {
   std::random_device rd;
   rng_engine_.reset(new std::mt19937(rd()));
 
@@ -61,7 +63,37 @@ void DecisionTree::Init(const DecisionTreeConfig& config) {
   for (int i = 0; i < feature_dim_; ++i) {
     feature_ids[i] = i;
   }
-  root_.reset(RecursiveBuild(0, data_idx, feature_ids));
+
+  binned_features_ = config.binned_features;
+  work_pool_ = config.work_pool;
+  if (binned_features_ == 0 && work_pool_ == 0) {
+    root_.reset(RecursiveBuild(0, data_idx, feature_ids));
+    return;
+  }
+
+  if (binned_features_ != 0) {
+    CHECK_EQ(num_data_, binned_features_->GetNumData());
+    hist_split_finder_.reset(new HistSplitFinder(num_labels_, num_data_));
+  }
+
+  // Subsample data at the root, as RecursiveBuild does.
+  std::vector<int32_t> sub_data_idx = data_idx;
+  int k = num_data_subsample_;
+  if (k > 0 && num_data_ > k) {
+    std::vector<int> samples = sampler_.SampleWithoutReplacement(num_data_, k);
+    sub_data_idx.resize(k);
+    for (int i = 0; i < k; ++i) {
+      sub_data_idx[i] = data_idx[samples[i]];
+    }
+  }
+  if (work_pool_ != 0) {
+    LevelWiseBuild(sub_data_idx, feature_ids);
+    return;
+  }
+  root_.reset(new TreeNode());
+  NodeHists root_hists;
+  RecursiveBuildHist(0, sub_data_idx, feature_ids, root_.get(), 0, 0,
+      &root_hists);
 }
 
 int32_t DecisionTree::Predict(
@@ -211,10 +243,334 @@ void DecisionTree::PartitionData(int32_t feature_id, float feature_val,
   }
 }
 
-int32_t DecisionTree::ComputeLeafVal(const std::vector<int32_t>& data_idx)
-  const {
+void DecisionTree::RecursiveBuildHist(int32_t depth,
+    const std::vector<int32_t>& data_idx,
+    const std::vector<int32_t>& available_feature_ids, TreeNode* curr_node,
+    const NodeHists* parent_hists, const NodeHists* sibling_hists,
+    NodeHists* node_hists) {
+  // Base case.
+  if (depth == max_depth_ - 1 || available_feature_ids.size() == 0 ||
+      AllSameLabels(data_idx) || data_idx.size() < FLAGS_num_stop_split) {
+    curr_node->SetLeafVal(ComputeLeafVal(data_idx));
+    return;
+  }
+
+  // Subsample features if we have more than num_features_subsample_.
+  int N = available_feature_ids.size();
+  int k = num_features_subsample_;
+  std::vector<int32_t> sub_feature_ids(k);
+  if (k > 0 && N > k) {
+    std::vector<int> samples = sampler_.SampleWithoutReplacement(N, k);
+    for (int i = 0; i < k; ++i) {
+      sub_feature_ids[i] = available_feature_ids[samples[i]];
+    }
+  } else {
+    sub_feature_ids = available_feature_ids;
+  }
+
+  // Histograms of the candidate features, then the best bin of each.
+  int32_t split_feature_idx = 0;
+  int32_t split_bin = binned_features_->GetNumBins(sub_feature_ids[0]) - 1;
+  float best_gain_ratio = 0.;
+  for (int i = 0; i < sub_feature_ids.size(); ++i) {
+    int32_t feature_id = sub_feature_ids[i];
+    std::vector<int32_t>& hist = (*node_hists)[feature_id];
+    NodeHists::const_iterator parent_iter, sibling_iter;
+    if (parent_hists != 0 && sibling_hists != 0
+        && (parent_iter = parent_hists->find(feature_id))
+        != parent_hists->end()
+        && (sibling_iter = sibling_hists->find(feature_id))
+        != sibling_hists->end()) {
+      const std::vector<int32_t>& parent_hist = parent_iter->second;
+      const std::vector<int32_t>& sibling_hist = sibling_iter->second;
+      hist.resize(parent_hist.size());
+      for (int j = 0; j < hist.size(); ++j) {
+        hist[j] = parent_hist[j] - sibling_hist[j];
+      }
+    } else {
+      ComputeHist(feature_id, data_idx.data(), data_idx.size(), &hist);
+    }
+
+    float gain_ratio;
+    int32_t bin = hist_split_finder_->FindSplitBin(hist.data(),
+        binned_features_->GetNumBins(feature_id), &gain_ratio);
+    if (gain_ratio > best_gain_ratio) {
+      best_gain_ratio = gain_ratio;
+      split_feature_idx = i;
+      split_bin = bin;
+    }
+  }
+  int32_t split_feature_id = sub_feature_ids[split_feature_idx];
+  curr_node->Split(split_feature_id,
+      binned_features_->GetBinUpper(split_feature_id, split_bin));
+
+  // Partition the data on the bin column.
+  const uint8_t* column = binned_features_->GetColumn(split_feature_id);
+  std::vector<int32_t> left_partition;
+  std::vector<int32_t> right_partition;
+  for (int i = 0; i < data_idx.size(); ++i) {
+    if (column[data_idx[i]] <= split_bin) {
+      left_partition.push_back(data_idx[i]);
+    } else {
+      right_partition.push_back(data_idx[i]);
+    }
+  }
+
+  // Remove split_feature_id from available_feature_ids. sub_feature_ids
+  // is a subset, so find it in available_feature_ids.
+  std::vector<int32_t> available_feature_ids_copy = available_feature_ids;
+  auto split_iter = std::find(available_feature_ids_copy.begin(),
+      available_feature_ids_copy.end(), split_feature_id);
+  *split_iter = available_feature_ids_copy.back();
+  available_feature_ids_copy.pop_back();
+
+  TreeNode* left_child = curr_node->GetLeftChild();
+  TreeNode* right_child = curr_node->GetRightChild();
+  NodeHists child_hists;
+  if (left_partition.size() == 0) {
+    left_child->SetLeafVal(ComputeLeafVal(data_idx));
+    RecursiveBuildHist(depth + 1, right_partition, available_feature_ids_copy,
+        right_child, node_hists, 0, &child_hists);
+    return;
+  }
+  if (right_partition.size() == 0) {
+    right_child->SetLeafVal(ComputeLeafVal(data_idx));
+    RecursiveBuildHist(depth + 1, left_partition, available_feature_ids_copy,
+        left_child, node_hists, 0, &child_hists);
+    return;
+  }
+
+  bool left_smaller = left_partition.size() <= right_partition.size();
+  NodeHists small_hists;
+  NodeHists large_hists;
+  RecursiveBuildHist(depth + 1,
+      left_smaller ? left_partition : right_partition,
+      available_feature_ids_copy, left_smaller ? left_child : right_child,
+      node_hists, 0, &small_hists);
+  RecursiveBuildHist(depth + 1,
+      left_smaller ? right_partition : left_partition,
+      available_feature_ids_copy, left_smaller ? right_child : left_child,
+      node_hists, &small_hists, &large_hists);
+}
+
+void DecisionTree::ComputeHist(int32_t feature_id, const int32_t* data_idx,
+    int32_t num_data, std::vector<int32_t>* hist) const {
+  const uint8_t* column = binned_features_->GetColumn(feature_id);
+  hist->assign(binned_features_->GetNumBins(feature_id) * num_labels_, 0);
+  int32_t* h = hist->data();
+  for (int i = 0; i < num_data; ++i) {
+    int32_t idx = data_idx[i];
+    ++h[column[idx] * num_labels_ + (*labels_)[idx]];
+  }
+}
+
+void DecisionTree::LevelWiseBuild(const std::vector<int32_t>& data_idx,
+    const std::vector<int32_t>& feature_ids) {
+  perm_ = data_idx;
+  root_.reset(new TreeNode());
+
+  std::vector<FrontierNode> prev_level;
+  std::vector<FrontierNode> level(1);
+  level[0].node = root_.get();
+  level[0].begin = 0;
+  level[0].end = perm_.size();
+  level[0].available_feature_ids = feature_ids;
+  level[0].parent_hists = 0;
+  level[0].sibling = -1;
+
+  std::vector<WorkPool::Task> tasks;
+  for (int32_t depth = 0; !level.empty(); ++depth) {
+    // Base cases and feature subsampling; the rest of the level is split.
+    std::vector<FrontierNode*> to_split;
+    for (int n = 0; n < level.size(); ++n) {
+      FrontierNode& fnode = level[n];
+      const int32_t* node_data = perm_.data() + fnode.begin;
+      int32_t num_node_data = fnode.end - fnode.begin;
+      if (depth == max_depth_ - 1 || fnode.available_feature_ids.size() == 0
+          || AllSameLabels(node_data, num_node_data)
+          || num_node_data < FLAGS_num_stop_split) {
+        fnode.node->SetLeafVal(ComputeLeafVal(node_data, num_node_data));
+        continue;
+      }
+      int N = fnode.available_feature_ids.size();
+      int k = num_features_subsample_;
+      if (k > 0 && N > k) {
+        std::vector<int> samples = sampler_.SampleWithoutReplacement(N, k);
+        fnode.sub_feature_ids.resize(k);
+        for (int i = 0; i < k; ++i) {
+          fnode.sub_feature_ids[i] = fnode.available_feature_ids[samples[i]];
+        }
+      } else {
+        fnode.sub_feature_ids = fnode.available_feature_ids;
+      }
+      int32_t num_sub_features = fnode.sub_feature_ids.size();
+      fnode.gain_ratios.assign(num_sub_features, 0.);
+      fnode.split_vals.assign(num_sub_features, 0.);
+      fnode.split_bins.assign(num_sub_features, 0);
+      if (binned_features_ != 0) {
+        // Create the entries here; tasks only fill them.
+        for (int i = 0; i < num_sub_features; ++i) {
+          fnode.hists[fnode.sub_feature_ids[i]];
+        }
+      }
+      to_split.push_back(&fnode);
+    }
+    if (to_split.empty()) {
+      break;
+    }
+
+    // Evaluate all (node, feature) pairs. A node deriving its histograms
+    // from its sibling's waits for the sibling's to be computed.
+    for (int pass = 0; pass < 2; ++pass) {
+      for (int n = 0; n < to_split.size(); ++n) {
+        FrontierNode* fnode = to_split[n];
+        bool derived = binned_features_ != 0 && fnode->sibling >= 0
+          && !level[fnode->sibling].sub_feature_ids.empty();
+        if (derived != (pass == 1)) {
+          continue;
+        }
+        for (int i = 0; i < fnode->sub_feature_ids.size(); ++i) {
+          tasks.push_back([this, fnode, i, &level] {
+              EvaluateSplit(fnode, i, level); });
+        }
+      }
+      work_pool_->RunAll(&tasks);
+    }
+
+    // Split each node on its best feature, then partition its range.
+    std::vector<int32_t> split_feature_ids(to_split.size());
+    std::vector<int32_t> mids(to_split.size());
+    for (int n = 0; n < to_split.size(); ++n) {
+      FrontierNode* fnode = to_split[n];
+      int32_t split_feature_idx = 0;
+      float best_gain_ratio = binned_features_ != 0 ? 0.
+        : std::numeric_limits<float>::min();
+      for (int i = 0; i < fnode->sub_feature_ids.size(); ++i) {
+        if (fnode->gain_ratios[i] > best_gain_ratio) {
+          best_gain_ratio = fnode->gain_ratios[i];
+          split_feature_idx = i;
+        }
+      }
+      int32_t split_feature_id = fnode->sub_feature_ids[split_feature_idx];
+      int32_t split_bin = fnode->split_bins[split_feature_idx];
+      float split_val = fnode->split_vals[split_feature_idx];
+      if (binned_features_ != 0 && best_gain_ratio == 0.) {
+        // No gain anywhere: put all data left, as RecursiveBuildHist does.
+        split_bin = binned_features_->GetNumBins(split_feature_id) - 1;
+        split_val = binned_features_->GetBinUpper(split_feature_id, split_bin);
+      }
+      split_feature_ids[n] = split_feature_id;
+      fnode->node->Split(split_feature_id, split_val);
+
+      int32_t* mid = &mids[n];
+      tasks.push_back([this, fnode, split_feature_id, split_bin, split_val,
+          mid] {
+          auto begin = perm_.begin() + fnode->begin;
+          auto end = perm_.begin() + fnode->end;
+          if (binned_features_ != 0) {
+            const uint8_t* column =
+              binned_features_->GetColumn(split_feature_id);
+            *mid = std::stable_partition(begin, end,
+                [column, split_bin] (int32_t i) {
+                return column[i] <= split_bin; }) - perm_.begin();
+          } else {
+            *mid = std::stable_partition(begin, end,
+                [this, split_feature_id, split_val] (int32_t i) {
+                return (*(*features_)[i])[split_feature_id] <= split_val; })
+              - perm_.begin();
+          }
+          });
+    }
+    work_pool_->RunAll(&tasks);
+
+    // Next frontier. The smaller child of each split computes its
+    // histograms, the larger one derives them.
+    std::vector<FrontierNode> next_level;
+    for (int n = 0; n < to_split.size(); ++n) {
+      FrontierNode* fnode = to_split[n];
+      TreeNode* left_child = fnode->node->GetLeftChild();
+      TreeNode* right_child = fnode->node->GetRightChild();
+      int32_t split_feature_id = split_feature_ids[n];
+      int32_t mid = mids[n];
+
+      std::vector<int32_t> available_feature_ids =
+        fnode->available_feature_ids;
+      auto split_iter = std::find(available_feature_ids.begin(),
+          available_feature_ids.end(), split_feature_id);
+      *split_iter = available_feature_ids.back();
+      available_feature_ids.pop_back();
+
+      int32_t num_left = mid - fnode->begin;
+      int32_t num_right = fnode->end - mid;
+      if (num_left == 0 || num_right == 0) {
+        int32_t leaf_val = ComputeLeafVal(perm_.data() + fnode->begin,
+            fnode->end - fnode->begin);
+        (num_left == 0 ? left_child : right_child)->SetLeafVal(leaf_val);
+      }
+      bool left_smaller = num_left <= num_right;
+      for (int c = 0; c < 2; ++c) {
+        bool left = (c == 0) == left_smaller;
+        if ((left ? num_left : num_right) == 0) {
+          continue;
+        }
+        next_level.emplace_back();
+        FrontierNode& child = next_level.back();
+        child.node = left ? left_child : right_child;
+        child.begin = left ? fnode->begin : mid;
+        child.end = left ? mid : fnode->end;
+        child.available_feature_ids = available_feature_ids;
+        child.parent_hists = &fnode->hists;
+        child.sibling = (c == 1 && num_left > 0 && num_right > 0) ?
+          next_level.size() - 2 : -1;
+      }
+    }
+    prev_level.swap(level);
+    level.swap(next_level);
+  }
+  perm_.clear();
+}
+
+void DecisionTree::EvaluateSplit(FrontierNode* fnode, int32_t i,
+    const std::vector<FrontierNode>& level) const {
+  int32_t feature_id = fnode->sub_feature_ids[i];
+  const int32_t* node_data = perm_.data() + fnode->begin;
+  int32_t num_node_data = fnode->end - fnode->begin;
+  if (binned_features_ == 0) {
+    SplitFinder split_finder(num_labels_);
+    for (int j = 0; j < num_node_data; ++j) {
+      split_finder.AddInstance((*(*features_)[node_data[j]])[feature_id],
+          (*labels_)[node_data[j]]);
+    }
+    fnode->split_vals[i] = split_finder.FindSplitValue(&fnode->gain_ratios[i]);
+    return;
+  }
+
+  std::vector<int32_t>& hist = fnode->hists.find(feature_id)->second;
+  NodeHists::const_iterator parent_iter, sibling_iter;
+  if (fnode->sibling >= 0 && fnode->parent_hists != 0
+      && (parent_iter = fnode->parent_hists->find(feature_id))
+      != fnode->parent_hists->end()
+      && (sibling_iter = level[fnode->sibling].hists.find(feature_id))
+      != level[fnode->sibling].hists.end()) {
+    const std::vector<int32_t>& parent_hist = parent_iter->second;
+    const std::vector<int32_t>& sibling_hist = sibling_iter->second;
+    hist.resize(parent_hist.size());
+    for (int j = 0; j < hist.size(); ++j) {
+      hist[j] = parent_hist[j] - sibling_hist[j];
+    }
+  } else {
+    ComputeHist(feature_id, node_data, num_node_data, &hist);
+  }
+  fnode->split_bins[i] = hist_split_finder_->FindSplitBin(hist.data(),
+      binned_features_->GetNumBins(feature_id), &fnode->gain_ratios[i]);
+  fnode->split_vals[i] =
+    binned_features_->GetBinUpper(feature_id, fnode->split_bins[i]);
+}
+
+int32_t DecisionTree::ComputeLeafVal(const int32_t* data_idx,
+    int32_t num_data) const {
     std::vector<int32_t> count_each_label(num_labels_);
-    for (int i = 0; i < data_idx.size(); ++i) {
+    for (int i = 0; i < num_data; ++i) {
       int32_t label = (*labels_)[data_idx[i]];
       count_each_label[label]++;
     }
@@ -227,12 +583,13 @@ int32_t DecisionTree::ComputeLeafVal(const std::vector<int32_t>& data_idx)
     return max_label;
   }
 
-bool DecisionTree::AllSameLabels(const std::vector<int32_t>& data_idx) const {
-  if (data_idx.size() == 0) {
+bool DecisionTree::AllSameLabels(const int32_t* data_idx,
+    int32_t num_data) const {
+  if (num_data == 0) {
     return true;  // vacuously true.
   }
   int32_t label = (*labels_)[data_idx[0]];
-  for (int i = 1; i < data_idx.size(); ++i) {
+  for (int i = 1; i < num_data; ++i) {
     if (label != (*labels_)[data_idx[i]]) {
       return false;
     }
@@ -13,6 +13,9 @@
 #include <string>
 #include <sstream>
 #include "sampler.hpp"
+#include "binned_features.hpp"
+#include "work_pool.hpp"
+#include <unordered_map>
 
 namespace tree {
 
@@ -36,6 +39,14 @@ struct DecisionTreeConfig {
   // Data
   std::vector<petuum::ml::AbstractFeature<float>*>* features;
   std::vector<int32_t>* labels;
+
+  // Pre-binned features. If not null, splits are found from label
+  // histograms of the bins instead of random thresholds.
+  const BinnedFeatures* binned_features;
+
+  // If not null, the tree is grown level by level with the split search
+  // of each level spread over the pool's threads.
+  WorkPool* work_pool;
 };
 
 class DecisionTree {
@@ -79,14 +90,71 @@ private:    // private methods.
       std::vector<int32_t>* right_partition) const;
 
   // Find majority vote to get leaf value.
-  int32_t ComputeLeafVal(const std::vector<int32_t>& data_idx) const;
+  int32_t ComputeLeafVal(const int32_t* data_idx, int32_t num_data) const;
+
+  int32_t ComputeLeafVal(const std::vector<int32_t>& data_idx) const {
+    return ComputeLeafVal(data_idx.data(), data_idx.size());
+  }
 
   // True if all labels in data_idx are the same.
-  bool AllSameLabels(const std::vector<int32_t>& data_idx) const;
+  bool AllSameLabels(const int32_t* data_idx, int32_t num_data) const;
+
+  bool AllSameLabels(const std::vector<int32_t>& data_idx) const {
+    return AllSameLabels(data_idx.data(), data_idx.size());
+  }
 
   // Serialize the tree with pre-order traversal
   void Serialize(TreeNode *p, std::string &out);
 
+  // ============= Histogram split finding (binned_features_) =============
+  // feature id -> label histogram of the node's data over its bins.
+  typedef std::unordered_map<int32_t, std::vector<int32_t> > NodeHists;
+
+  // Like RecursiveBuild but splits on bins. Histograms of the features
+  // considered at this node are left in node_hists for the children. A
+  // child derives a histogram as parent - sibling when both have it, so
+  // the smaller child is built first and only it scans its data.
+  void RecursiveBuildHist(int32_t depth, const std::vector<int32_t>& data_idx,
+      const std::vector<int32_t>& available_feature_ids, TreeNode* curr_node,
+      const NodeHists* parent_hists, const NodeHists* sibling_hists,
+      NodeHists* node_hists);
+
+  // Fill hist with the label histogram of feature_id over data_idx.
+  void ComputeHist(int32_t feature_id, const int32_t* data_idx,
+      int32_t num_data, std::vector<int32_t>* hist) const;
+
+  // ============= Level-wise build (work_pool_) =============
+  // A node of the frontier being split. Its data is perm_[begin, end).
+  struct FrontierNode {
+    TreeNode* node;
+    int32_t begin;
+    int32_t end;
+    std::vector<int32_t> available_feature_ids;
+    std::vector<int32_t> sub_feature_ids;
+
+    // Histograms of the parent (in the previous level) and of the sibling
+    // (in this level, built first) when derived by subtraction.
+    const NodeHists* parent_hists;
+    int32_t sibling;  // index in the level, -1 if none
+    NodeHists hists;
+
+    // Best split of each of sub_feature_ids.
+    std::vector<float> gain_ratios;
+    std::vector<float> split_vals;
+    std::vector<int32_t> split_bins;
+  };
+
+  // Grow the tree one depth at a time. perm_ holds the data indices of
+  // all frontier nodes as disjoint ranges and is partitioned in place.
+  // All (node, candidate feature) split evaluations of a level, and the
+  // partitions of the level, run as tasks on work_pool_.
+  void LevelWiseBuild(const std::vector<int32_t>& data_idx,
+      const std::vector<int32_t>& feature_ids);
+
+  // Evaluate the best split of the i-th candidate feature of node.
+  void EvaluateSplit(FrontierNode* node, int32_t i,
+      const std::vector<FrontierNode>& level) const;
+
 private:
   // Underlying data (features and labels).
   const std::vector<petuum::ml::AbstractFeature<float>*>* features_;
@@ -105,6 +173,13 @@ private:
   int32_t num_features_subsample_;
   int32_t num_labels_;
   int32_t feature_dim_;
+
+  const BinnedFeatures* binned_features_;
+  std::unique_ptr<HistSplitFinder> hist_split_finder_;
+
+  // Not owned. If not null, the tree is built level-wise on it.
+  WorkPool* work_pool_;
+  std::vector<int32_t> perm_;
 };
 
 }  // namespace tree
@@ -111,6 +111,14 @@ void RandForestEngine::ReadData(std::string type) {
           &train_features_, &train_labels_, feature_one_based_,
           label_one_based_);
     }
+    if (FLAGS_num_feature_bins > 0) {
+      petuum::HighResolutionTimer bin_timer;
+      binned_features_.reset(new BinnedFeatures(train_features_, feature_dim_,
+            FLAGS_num_feature_bins));
+      LOG(INFO) << "Binned " << feature_dim_ << " features into at most "
+        << FLAGS_num_feature_bins << " bins in " << bin_timer.elapsed()
+        << " seconds";
+    }
   }
   if (type == "test") {
     if (read_format_ == "bin") {
@@ -140,6 +148,14 @@ void RandForestEngine::Start() {
   dt_config.feature_dim = feature_dim_;
   dt_config.features = &train_features_;
   dt_config.labels = &train_labels_;
+  dt_config.binned_features = binned_features_.get();
+
+  // Each app thread grows its trees on its own pool.
+  std::unique_ptr<WorkPool> work_pool;
+  if (FLAGS_num_tree_build_threads > 0) {
+    work_pool.reset(new WorkPool(FLAGS_num_tree_build_threads));
+  }
+  dt_config.work_pool = work_pool.get();
 
   // Set number of trees assigned to each thread
   int num_trees_per_thread = std::floor(static_cast<float>(FLAGS_num_trees) /
@@ -5,6 +5,7 @@
 
 #include "decision_tree.hpp"
 #include "rand_forest.hpp"
+#include "binned_features.hpp"
 #include <ml/include/ml.hpp>
 #include <petuum_ps_common/include/petuum_ps.hpp>
 #include <boost/thread.hpp>
@@ -79,6 +80,9 @@ private:
   std::vector<petuum::ml::AbstractFeature<float>*> test_features_;
   std::vector<int32_t> test_labels_;
 
+  // Train features binned once for all trees (FLAGS_num_feature_bins > 0).
+  std::unique_ptr<BinnedFeatures> binned_features_;
+
   // ============= Concurrency Management ==============
   std::atomic<int32_t> thread_counter_;
 
@@ -43,6 +43,12 @@ DEFINE_int32(num_features_subsample, 0, "# of randomly selected features to "
 DEFINE_int32(num_feat_split_vals, 3, "# of feature split values to consider "
     "when finding best feature to split.");
 DEFINE_int32(num_stop_split, 10, "least number of samples used to split a node");
+DEFINE_int32(num_feature_bins, 0, "If > 0, quantize each feature into at most "
+    "this many (2 to 256) bins once and find splits from bin label histograms "
+    "instead of num_feat_split_vals random thresholds. 0 to disable.");
+DEFINE_int32(num_tree_build_threads, 0, "If > 0, each app thread grows a "
+    "tree level by level, evaluating the splits of all nodes of a level on "
+    "this many threads (including itself). 0 to build depth-first.");
 // Save and Load
 DEFINE_bool(save_pred, false, "Prediction of test set will be saved "
     "if true.");
@@ -82,6 +88,11 @@ int main(int argc, char *argv[]) {
     << "Number of data subsample cannot be negative.";
   CHECK(FLAGS_num_features_subsample >= 0) 
     << "Number of feature subsample cannot be negative.";
+  CHECK(FLAGS_num_feature_bins == 0
+      || (FLAGS_num_feature_bins >= 2 && FLAGS_num_feature_bins <= 256))
+    << "Number of feature bins must be 0 (no binning) or in [2, 256].";
+  CHECK(FLAGS_num_tree_build_threads >= 0)
+    << "Number of tree build threads cannot be negative.";
 
   LOG(INFO) << "Starting Rand Forest with " << FLAGS_num_app_threads
     << " threads";
@@ -9,6 +9,7 @@
 #include <limits>
 #include <random>
 #include <math.h>
+#include <numeric>
 
 namespace tree {
 
@@ -130,4 +131,64 @@ float SplitFinder::ComputeGainRatio(float split_val) {
   return gain_ratio;
 }
 
+// ================== HistSplitFinder ===============
+
+HistSplitFinder::HistSplitFinder(int32_t num_labels, int32_t num_data) :
+  num_labels_(num_labels), xlogx_(num_data + 1) {
+  xlogx_[0] = 0.;
+  for (int c = 1; c <= num_data; ++c) {
+    xlogx_[c] = c * log2(static_cast<double>(c));
+  }
+}
+
+int32_t HistSplitFinder::FindSplitBin(const int32_t* hist, int32_t num_bins,
+    float* gain_ratio) const {
+  // With n, n_l, n_r data and S = \sum_label c*log2(c) on each side:
+  //   info_gain = (n log n - S - n_l log n_l + S_l - n_r log n_r + S_r) / n
+  //   split_info = (n log n - n_l log n_l - n_r log n_r) / n
+  // so the 1/n cancels in the ratio.
+  std::vector<int32_t> total(num_labels_, 0);
+  for (int b = 0; b < num_bins; ++b) {
+    const int32_t* bin_hist = hist + b * num_labels_;
+    for (int l = 0; l < num_labels_; ++l) {
+      total[l] += bin_hist[l];
+    }
+  }
+  int32_t n = 0;
+  double total_s = 0.;
+  for (int l = 0; l < num_labels_; ++l) {
+    n += total[l];
+    total_s += xlogx_[total[l]];
+  }
+  double n_logn = xlogx_[n];
+
+  std::vector<int32_t> left(num_labels_, 0);
+  int32_t best_bin = num_bins - 1;
+  float best_gain_ratio = 0.;
+  int32_t n_left = 0;
+  for (int b = 0; b < num_bins - 1; ++b) {
+    const int32_t* bin_hist = hist + b * num_labels_;
+    double left_s = 0.;
+    double right_s = 0.;
+    for (int l = 0; l < num_labels_; ++l) {
+      left[l] += bin_hist[l];
+      left_s += xlogx_[left[l]];
+      right_s += xlogx_[total[l] - left[l]];
+    }
+    n_left += std::accumulate(bin_hist, bin_hist + num_labels_, 0);
+    if (n_left == 0 || n_left == n) {
+      continue;
+    }
+    double split_info = n_logn - xlogx_[n_left] - xlogx_[n - n_left];
+    double info_gain = split_info - total_s + left_s + right_s;
+    float ratio = info_gain / split_info;
+    if (ratio > best_gain_ratio) {
+      best_gain_ratio = ratio;
+      best_bin = b;
+    }
+  }
+  *gain_ratio = best_gain_ratio;
+  return best_bin;
+}
+
 }  // namespace tree
@@ -51,4 +51,28 @@ private:
   float pre_split_entropy_;
 };
 
+// HistSplitFinder finds the split of a binned feature (see BinnedFeatures)
+// from its label histogram hist[bin * num_labels + label] using the same
+// gain ratio criterion as SplitFinder, but over every bin boundary in one
+// prefix scan. Entropies are computed from counts through a c*log2(c)
+// table, so no per-threshold pass over the data is needed.
+class HistSplitFinder {
+public:
+  // num_data bounds any count in a histogram.
+  HistSplitFinder(int32_t num_labels, int32_t num_data);
+
+  // Return the bin b maximizing the gain ratio of the split bin <= b; the
+  // gain ratio is returned in gain_ratio. A histogram with a single
+  // non-empty bin returns b = num_bins - 1 and gain_ratio 0.
+  int32_t FindSplitBin(const int32_t* hist, int32_t num_bins,
+      float* gain_ratio) const;
+
+private:
+  int32_t num_labels_;
+
+  // xlogx_[c] = c * log2(c). double since the differences of these sums
+  // lose too many digits in float on large nodes.
+  std::vector<double> xlogx_;
+};
+
 }  // namespace tree
@@ -0,0 +1,107 @@
+#include "work_pool.hpp"
+#include <glog/logging.h>
+
+namespace tree {
+
+WorkPool::WorkPool(int32_t num_threads) : num_threads_(num_threads),
+  batch_(0), num_busy_workers_(0), shutdown_(false), num_pending_(0) {
+  CHECK_GT(num_threads_, 0);
+  for (int i = 0; i < num_threads_; ++i) {
+    queues_.emplace_back(new WorkQueue());
+  }
+  // Queue 0 belongs to the thread calling RunAll().
+  for (int i = 1; i < num_threads_; ++i) {
+    workers_.emplace_back(&WorkPool::WorkerLoop, this, i);
+  }
+}
+
+WorkPool::~WorkPool() {
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    shutdown_ = true;
+  }
+  start_cv_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+void WorkPool::RunAll(std::vector<Task>* tasks) {
+  if (tasks->empty()) {
+    return;
+  }
+  num_pending_ = tasks->size();
+  for (int i = 0; i < tasks->size(); ++i) {
+    WorkQueue& queue = *queues_[i % num_threads_];
+    std::lock_guard<std::mutex> lock(queue.mtx);
+    queue.tasks.push_back(std::move((*tasks)[i]));
+  }
+  tasks->clear();
+
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    ++batch_;
+    num_busy_workers_ = workers_.size();
+  }
+  start_cv_.notify_all();
+
+  Drain(0);
+
+  // Others may still be running stolen tasks.
+  std::unique_lock<std::mutex> lock(mtx_);
+  done_cv_.wait(lock, [this] { return num_busy_workers_ == 0; });
+  CHECK_EQ(0, num_pending_.load());
+}
+
+void WorkPool::WorkerLoop(int32_t worker_id) {
+  int64_t seen_batch = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mtx_);
+      start_cv_.wait(lock, [this, seen_batch] {
+          return shutdown_ || batch_ != seen_batch; });
+      if (shutdown_) {
+        return;
+      }
+      seen_batch = batch_;
+    }
+    Drain(worker_id);
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      --num_busy_workers_;
+    }
+    done_cv_.notify_one();
+  }
+}
+
+void WorkPool::Drain(int32_t worker_id) {
+  Task task;
+  while (num_pending_ > 0 && PopOrSteal(worker_id, &task)) {
+    task();
+    --num_pending_;
+  }
+}
+
+bool WorkPool::PopOrSteal(int32_t worker_id, Task* task) {
+  {
+    WorkQueue& own = *queues_[worker_id];
+    std::lock_guard<std::mutex> lock(own.mtx);
+    if (!own.tasks.empty()) {
+      *task = std::move(own.tasks.back());
+      own.tasks.pop_back();
+      return true;
+    }
+  }
+  for (int i = 1; i < num_threads_; ++i) {
+    WorkQueue& victim = *queues_[(worker_id + i) % num_threads_];
+    std::lock_guard<std::mutex> lock(victim.mtx);
+    if (!victim.tasks.empty()) {
+      *task = std::move(victim.tasks.front());
+      victim.tasks.pop_front();
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace tree
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+
+namespace tree {
+
+// WorkPool runs a batch of independent tasks on num_threads threads (the
+// calling thread being one of them). Tasks are dealt round robin onto
+// per-thread deques; a thread pops its own deque from the back and, once
+// empty, steals from the front of the others', so a few long tasks (e.g.
+// a big frontier node) do not leave the other threads idle.
+// RunAll() is not reentrant: only the owning thread calls it.
+class WorkPool {
+public:
+  typedef std::function<void()> Task;
+
+  explicit WorkPool(int32_t num_threads);
+
+  ~WorkPool();
+
+  int32_t GetNumThreads() const {
+    return num_threads_;
+  }
+
+  // Run all tasks and return when all are done.
+  void RunAll(std::vector<Task>* tasks);
+
+private:
+  struct WorkQueue {
+    std::mutex mtx;
+    std::deque<Task> tasks;
+  };
+
+  void WorkerLoop(int32_t worker_id);
+
+  // Run tasks from worker_id's queue, then steal, until no task is left.
+  void Drain(int32_t worker_id);
+
+  bool PopOrSteal(int32_t worker_id, Task* task);
+
+  int32_t num_threads_;
+  std::vector<std::unique_ptr<WorkQueue> > queues_;
+  std::vector<std::thread> workers_;
+
+  std::mutex mtx_;
+  std::condition_variable start_cv_;
+  std::condition_variable done_cv_;
+  int64_t batch_;             // id of the current batch, guarded by mtx_
+  int32_t num_busy_workers_;  // guarded by mtx_
+  bool shutdown_;             // guarded by mtx_
+  std::atomic<int64_t> num_pending_;
+};
+
+}  // namespace tree
@@ -18,7 +18,11 @@ ProxGrad::ProxGrad(const ProxGradConfig& config) :
   num_features_(feature_end_ - feature_start_),
   num_reps_(config.num_reps),
   beta_(num_features_),
-  r_(num_samples_) {
+  r_(num_samples_),
+  X_block_ready_(false),
+  residual_(num_samples_),
+  X_delta_(num_samples_),
+  sampled_(num_features_) {
     num_feature_samples_ = std::min(num_features_,
         static_cast<int>(FLAGS_minibatch_ratio * num_features_));
     LOG_IF(INFO, worker_rank_ == 0) << "sample size: " << num_feature_samples_
@@ -85,7 +89,7 @@ void ProxGrad::ProxStep(
   }
   w_table_.Get(0, &row_acc);
   const auto& w_all_row = row_acc.Get<petuum::DenseRow<float>>();
-  std::vector<float> row_vec;
+  std::vector<float>& row_vec = row_vec_;
   w_all_row.CopyToVector(&row_vec);
   CHECK_EQ(num_samples_ + num_workers_, row_vec.size());
 
@@ -114,13 +118,7 @@ void ProxGrad::ProxStep(
   }
   staleness_table_.BatchInc(0, staleness_update);
 
-  std::vector<float> w_only_vec(row_vec.begin(),
-      row_vec.begin() + num_samples_);
-  petuum::ml::DenseFeature<float> w_all(w_only_vec);
-  CHECK_EQ(num_samples_, w_all.GetFeatureDim());
   CHECK_EQ(num_samples_, y.GetFeatureDim());
-  // w -= y
-  FeatureScaleAndAdd(-1, y, &w_all);
 
   //int sample_size = FLAGS_minibatch_ratio * num_samples_;
   std::vector<int> sampled_dim = SampleWithoutReplacement(num_features_,
@@ -128,40 +126,66 @@ void ProxGrad::ProxStep(
   CHECK_EQ(sampled_dim.size(), num_feature_samples_);
   std::sort(sampled_dim.begin(), sampled_dim.end());
 
-  // X_delta = X_k * delta_k^{c+1}
-  petuum::ml::DenseFeature<float> X_delta(num_samples_);
-  for (int rep = 0; rep < num_reps_; ++rep) {
-    // gradient = X_k^T (w_all - y)
-    petuum::ml::DenseFeature<float> grad(num_features_);
-    //LOG(INFO) << "dim w_all " << w_all.GetFeatureDim();
-    for (int j = 0; j < sampled_dim.size(); ++j) {
-      int dim = sampled_dim[j];
-      grad[dim] = SparseDenseFeatureDotProduct(
-          *(X_cols[feature_start_ + dim]), w_all);
+  // +1 as last update entry is this worker's clock.
+  petuum::UpdateBatch<float> update(num_samples_ + 1);
+  if (FLAGS_fused_prox_step) {
+    if (!X_block_ready_) {
+      X_block_.Init(X_cols, feature_start_, feature_end_);
+      X_block_ready_ = true;
+    }
+    // residual = w_all - y
+    for (int i = 0; i < num_samples_; ++i) {
+      residual_[i] = row_vec[i] - y[i];
+    }
+    std::fill(sampled_.begin(), sampled_.end(), 0);
+    for (int dim : sampled_dim) {
+      sampled_[dim] = 1;
+    }
+    FusedProxStep(lr);
+    for (int i = 0; i < num_samples_; ++i) {
+      update.UpdateSet(i, i, X_delta_[i]);
     }
+  } else {
+    std::vector<float> w_only_vec(row_vec.begin(),
+        row_vec.begin() + num_samples_);
+    petuum::ml::DenseFeature<float> w_all(w_only_vec);
+    CHECK_EQ(num_samples_, w_all.GetFeatureDim());
+    // w -= y
+    FeatureScaleAndAdd(-1, y, &w_all);
 
-    petuum::ml::DenseFeature<float> new_beta = beta_;
-    FeatureScaleAndAdd(-lr, grad, &new_beta);
-    SoftThreshold(lr * FLAGS_lambda, &new_beta);
+    // X_delta = X_k * delta_k^{c+1}
+    petuum::ml::DenseFeature<float> X_delta(num_samples_);
+    for (int rep = 0; rep < num_reps_; ++rep) {
+      // gradient = X_k^T (w_all - y)
+      petuum::ml::DenseFeature<float> grad(num_features_);
+      //LOG(INFO) << "dim w_all " << w_all.GetFeatureDim();
+      for (int j = 0; j < sampled_dim.size(); ++j) {
+        int dim = sampled_dim[j];
+        grad[dim] = SparseDenseFeatureDotProduct(
+            *(X_cols[feature_start_ + dim]), w_all);
+      }
 
-    // delta_k^{c+1} = beta_k^{c+1} - beta_k^c
-    petuum::ml::DenseFeature<float> delta = new_beta;
-    FeatureScaleAndAdd(-1, beta_, &delta);
-    if (rep == 0) {
-      beta_ = new_beta;
-    }
+      petuum::ml::DenseFeature<float> new_beta = beta_;
+      FeatureScaleAndAdd(-lr, grad, &new_beta);
+      SoftThreshold(lr * FLAGS_lambda, &new_beta);
+
+      // delta_k^{c+1} = beta_k^{c+1} - beta_k^c
+      petuum::ml::DenseFeature<float> delta = new_beta;
+      FeatureScaleAndAdd(-1, beta_, &delta);
+      if (rep == 0) {
+        beta_ = new_beta;
+      }
 
-    for (int j = 0; j < sampled_dim.size(); ++j) {
-      int dim = sampled_dim[j];
-      FeatureScaleAndAdd(delta[dim],
-          *(X_cols[feature_start_ + dim]), &X_delta);
+      for (int j = 0; j < sampled_dim.size(); ++j) {
+        int dim = sampled_dim[j];
+        FeatureScaleAndAdd(delta[dim],
+            *(X_cols[feature_start_ + dim]), &X_delta);
+      }
     }
-  }
 
-  // +1 as last update entry is this worker's clock.
-  petuum::UpdateBatch<float> update(num_samples_ + 1);
-  for (int i = 0; i < num_samples_; ++i) {
-    update.UpdateSet(i, i, X_delta[i]);
+    for (int i = 0; i < num_samples_; ++i) {
+      update.UpdateSet(i, i, X_delta[i]);
+    }
   }
   // Increment clock by 1.
   update.UpdateSet(num_samples_, worker_rank_ + num_samples_, 1);
@@ -184,6 +208,71 @@ void ProxGrad::ProxStep(
   }
 }
 
+namespace {
+
+float SoftThresholdScalar(float x, float threshold) {
+  if (x > threshold) {
+    return x - threshold;
+  } else if (x < -threshold) {
+    return x + threshold;
+  }
+  return 0.;
+}
+
+}  // anonymous namespace
+
+void ProxGrad::FusedProxStep(float lr) {
+  int num_threads = std::max(1, std::min(FLAGS_num_prox_threads,
+        num_features_));
+  X_delta_parts_.resize(num_threads - 1);
+  float threshold = lr * FLAGS_lambda;
+  float* beta = beta_.GetVector().data();
+  const float* residual = residual_.data();
+
+  // Thread t owns features [begin, end) and accumulates into its own
+  // X_delta; the columns' sample ids overlap across features.
+  auto prox_range = [&](int t) {
+    float* X_delta = X_delta_.data();
+    if (t > 0) {
+      X_delta_parts_[t - 1].assign(num_samples_, 0.);
+      X_delta = X_delta_parts_[t - 1].data();
+    }
+    int begin = static_cast<int64_t>(num_features_) * t / num_threads;
+    int end = static_cast<int64_t>(num_features_) * (t + 1) / num_threads;
+    for (int j = begin; j < end; ++j) {
+      // Unsampled coordinates have zero gradient but are still shrunk.
+      float grad = sampled_[j] ? X_block_.Dot(j, residual) : 0.;
+      float b0 = beta[j];
+      float b1 = SoftThresholdScalar(b0 - lr * grad, threshold);
+      beta[j] = b1;
+      if (!sampled_[j]) {
+        continue;
+      }
+      // Repetitions after the first step from the updated beta but do not
+      // keep it, so they all add the same delta.
+      float delta = b1 - b0;
+      if (num_reps_ > 1) {
+        delta += (num_reps_ - 1) * (SoftThresholdScalar(b1 - lr * grad, threshold)
+            - b1);
+      }
+      if (delta != 0) {
+        X_block_.Axpy(j, delta, X_delta);
+      }
+    }
+  };
+
+  std::fill(X_delta_.begin(), X_delta_.end(), 0.);
+  if (prox_pool_ == nullptr || prox_pool_->get_num_threads() != num_threads) {
+    prox_pool_.reset(new petuum::ml::ForkJoinPool(num_threads));
+  }
+  prox_pool_->Run(prox_range);
+  for (const auto& part : X_delta_parts_) {
+    for (int i = 0; i < num_samples_; ++i) {
+      X_delta_[i] += part[i];
+    }
+  }
+}
+
 // Sum of sqloss for all data.
 float ProxGrad::EvalSqLoss(
     const petuum::ml::DenseFeature<float>& y) {
@@ -44,6 +44,10 @@ PETUUM_LDFLAGS = -Wl,-rpath,$(PETUUM_THIRD_PARTY_LIB) \
 # PETUUM_LDFLAGS += -lnuma
 PETUUM_LDFLAGS += -lsnappy
 
+# uncomment to read/write LZ4 block files (io/block_stream)
+# PETUUM_CXXFLAGS += -DHAS_LZ4
+# PETUUM_LDFLAGS += -llz4
+
 PETUUM_PS_LIB = $(PETUUM_LIB)/libpetuum-ps.a
 PETUUM_PS_SN_LIB = $(PETUUM_LIB)/libpetuum-ps-sn.a
 PETUUM_ML_LIB = $(PETUUM_LIB)/libpetuum-ml.a
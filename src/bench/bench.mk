@@ -0,0 +1,22 @@
+BENCH_DIR = $(SRC)/bench
+BENCH_BIN = $(BIN)/bench
+
+ROW_OPLOG_BENCH = $(BENCH_BIN)/row_oplog_bench
+PS_BENCH = $(BENCH_BIN)/ps_bench
+
+$(BENCH_BIN):
+	mkdir -p $@
+
+$(ROW_OPLOG_BENCH): $(BENCH_DIR)/row_oplog_bench.cpp $(PS_LIB) $(BENCH_BIN)
+	$(CXX) $(CXXFLAGS) $(INCFLAGS) $< $(PS_LIB) $(LDFLAGS) -o $@
+
+row_oplog_bench: $(ROW_OPLOG_BENCH)
+
+$(PS_BENCH): $(BENCH_DIR)/ps_bench.cpp $(PS_LIB) $(BENCH_BIN)
+	$(CXX) $(CXXFLAGS) $(INCFLAGS) $< $(PS_LIB) $(LDFLAGS) -o $@
+
+ps_bench: $(PS_BENCH)
+
+bench: row_oplog_bench ps_bench
+
+.PHONY: row_oplog_bench ps_bench bench
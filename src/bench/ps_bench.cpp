@@ -0,0 +1,375 @@
+// Single-host PS benchmark with a synthetic workload. Each client is a
+// process with num_worker_threads table threads; every thread does
+// ops_per_clock Get()/BatchInc() calls per clock on rows drawn from a Zipf
+// distribution, then Clock()s. With the default --client_id=-1 the bench
+// forks num_clients processes on 127.0.0.1 itself (client 0 also hosts the
+// name node); with --client_id >= 0 and --hostfile it runs one client of a
+// multi-host setup, as the apps do.
+//
+// Each client prints one JSON object on a line (and appends it to
+// --results_path if set), so results can be collected and compared across
+// commits. Oplog bytes per clock come from Stats and need PETUUM_STATS.
+//
+// Example, as one command line:
+//   bin/bench/ps_bench --num_clients=2 --num_worker_threads=4
+//     --consistency_model=SSP --staleness=2 --zipf_s=1.1
+//     --label=$(git rev-parse --short HEAD) --results_path=ps_bench.jsonl
+
+#include <petuum_ps_common/include/petuum_ps.hpp>
+#include <petuum_ps_common/util/high_resolution_timer.hpp>
+#include <petuum_ps_common/util/stats.hpp>
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <sys/resource.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Topology
+DEFINE_int32(num_clients, 1, "Number of clients.");
+DEFINE_int32(client_id, -1, "-1 to fork all num_clients on localhost; "
+    "otherwise run only this client (requires --hostfile).");
+DEFINE_string(hostfile, "", "Host file as used by the apps. Empty to put "
+    "all clients on 127.0.0.1.");
+DEFINE_int32(base_port, 9999, "Port of client 0 when --hostfile is empty. "
+    "Client i uses base_port + 100 * i (and the ports above it).");
+DEFINE_int32(num_worker_threads, 2, "Table threads per client.");
+DEFINE_int32(num_comm_channels_per_client, 1, "Comm channels per client.");
+DEFINE_string(consistency_model, "SSPPush", "SSP/SSPPush/SSPAggr");
+DEFINE_string(stats_path, "", "Stats output prefix (with PETUUM_STATS).");
+
+// Table
+DEFINE_int32(num_rows, 1000, "Rows in the table.");
+DEFINE_int32(row_width, 1000, "Columns per row.");
+DEFINE_bool(sparse_rows, false, "SparseRow<float> instead of "
+    "DenseRow<float>.");
+DEFINE_int32(row_oplog_type, petuum::RowOpLogType::kDenseRowOpLog,
+    "RowOpLogType: 0 dense, 1 sparse, 2 sparse vector, 3 sparse hash.");
+DEFINE_bool(oplog_dense_serialized, false, "Serialize dense row oplogs "
+    "densely.");
+DEFINE_string(oplog_type, "Sparse", "Sparse/Dense table oplog.");
+DEFINE_int32(staleness, 0, "Table staleness.");
+
+// Workload
+DEFINE_int32(num_clocks, 20, "Clocks per worker thread.");
+DEFINE_int32(ops_per_clock, 1000, "Get or Inc calls per worker per clock.");
+DEFINE_double(get_fraction, 0.5, "Fraction of ops that are Get().");
+DEFINE_int32(updates_per_inc, 10, "Columns per BatchInc(); a whole dense "
+    "row uses DenseBatchInc().");
+DEFINE_double(zipf_s, 0., "Zipf exponent of row popularity; 0 is uniform.");
+DEFINE_int32(seed, 1234, "Workload seed; worker w of client c uses "
+    "seed + c * 1000 + w.");
+
+// Output
+DEFINE_string(results_path, "", "Append the JSON results line here.");
+DEFINE_string(label, "", "Free-form tag copied into the results, e.g. a "
+    "commit id.");
+
+namespace {
+
+const int32_t kTableID = 0;
+const int32_t kDenseRowFloatTypeID = 0;
+const int32_t kSparseRowFloatTypeID = 1;
+
+struct WorkerResult {
+  int64_t num_gets;
+  int64_t num_incs;
+  double loop_sec;
+  double cpu_sec;
+  // Merged and sorted in ResultsJson().
+  std::vector<float> get_latency_us;
+};
+
+double ThreadCpuSec() {
+  rusage usage;
+  CHECK_EQ(0, getrusage(RUSAGE_THREAD, &usage));
+  return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec
+      + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+double ProcessCpuSec() {
+  rusage usage;
+  CHECK_EQ(0, getrusage(RUSAGE_SELF, &usage));
+  return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec
+      + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+// Row ids ranked by popularity: P(row r) ~ 1 / (r + 1)^s.
+class ZipfRowSampler {
+public:
+  ZipfRowSampler(int32_t num_rows, double s) : cdf_(num_rows) {
+    double sum = 0.;
+    for (int32_t r = 0; r < num_rows; ++r) {
+      sum += 1. / std::pow(r + 1., s);
+      cdf_[r] = sum;
+    }
+    for (int32_t r = 0; r < num_rows; ++r) {
+      cdf_[r] /= sum;
+    }
+  }
+
+  template<typename RNG>
+  int32_t Sample(RNG &rng) {
+    double u = std::uniform_real_distribution<double>(0., 1.)(rng);
+    int32_t r = std::lower_bound(cdf_.begin(), cdf_.end(), u) - cdf_.begin();
+    return std::min<int32_t>(r, cdf_.size() - 1);
+  }
+
+private:
+  std::vector<double> cdf_;
+};
+
+void Worker(int32_t worker_rank, WorkerResult *result) {
+  petuum::PSTableGroup::RegisterThread();
+  petuum::Table<float> table
+      = petuum::PSTableGroup::GetTableOrDie<float>(kTableID);
+  std::mt19937 rng(FLAGS_seed + FLAGS_client_id * 1000 + worker_rank);
+  ZipfRowSampler row_sampler(FLAGS_num_rows, FLAGS_zipf_s);
+  std::uniform_int_distribution<int32_t> col_dist(0, FLAGS_row_width - 1);
+  std::bernoulli_distribution is_get(FLAGS_get_fraction);
+  bool dense_inc = !FLAGS_sparse_rows
+      && FLAGS_updates_per_inc >= FLAGS_row_width;
+
+  petuum::UpdateBatch<float> update_batch(FLAGS_updates_per_inc);
+  petuum::DenseUpdateBatch<float> dense_update_batch(0, FLAGS_row_width);
+  for (int32_t i = 0; i < FLAGS_row_width; ++i) {
+    dense_update_batch[i] = 1.;
+  }
+  result->num_gets = 0;
+  result->num_incs = 0;
+  result->get_latency_us.reserve(static_cast<size_t>(FLAGS_num_clocks
+      * FLAGS_ops_per_clock * FLAGS_get_fraction * 1.1) + 1);
+
+  double cpu_begin = ThreadCpuSec();
+  petuum::HighResolutionTimer loop_timer;
+  for (int32_t clock = 0; clock < FLAGS_num_clocks; ++clock) {
+    for (int32_t op = 0; op < FLAGS_ops_per_clock; ++op) {
+      int32_t row_id = row_sampler.Sample(rng);
+      if (is_get(rng)) {
+        petuum::HighResolutionTimer get_timer;
+        petuum::RowAccessor row_acc;
+        table.Get(row_id, &row_acc);
+        result->get_latency_us.push_back(get_timer.elapsed() * 1e6);
+        ++result->num_gets;
+      } else if (dense_inc) {
+        table.DenseBatchInc(row_id, dense_update_batch);
+        ++result->num_incs;
+      } else {
+        for (int32_t i = 0; i < FLAGS_updates_per_inc; ++i) {
+          update_batch.UpdateSet(i, col_dist(rng), 1.);
+        }
+        table.BatchInc(row_id, update_batch);
+        ++result->num_incs;
+      }
+    }
+    petuum::PSTableGroup::Clock();
+  }
+  result->loop_sec = loop_timer.elapsed();
+  result->cpu_sec = ThreadCpuSec() - cpu_begin;
+  petuum::PSTableGroup::DeregisterThread();
+}
+
+float Percentile(const std::vector<float> &sorted, double p) {
+  if (sorted.empty()) {
+    return 0.;
+  }
+  size_t idx = std::min(sorted.size() - 1,
+                        static_cast<size_t>(p * sorted.size()));
+  return sorted[idx];
+}
+
+std::string ResultsJson(const std::vector<WorkerResult> &results,
+                        double process_cpu_sec) {
+  int64_t num_gets = 0;
+  int64_t num_incs = 0;
+  double max_loop_sec = 0.;
+  std::vector<float> get_latency_us;
+  for (const WorkerResult &result : results) {
+    num_gets += result.num_gets;
+    num_incs += result.num_incs;
+    max_loop_sec = std::max(max_loop_sec, result.loop_sec);
+    get_latency_us.insert(get_latency_us.end(), result.get_latency_us.begin(),
+                          result.get_latency_us.end());
+  }
+  std::sort(get_latency_us.begin(), get_latency_us.end());
+  double worker_cpu_sec = 0.;
+
+  std::stringstream ss;
+  ss << "{\"bench\": \"ps_bench\""
+     << ", \"label\": \"" << FLAGS_label << "\""
+     << ", \"client_id\": " << FLAGS_client_id
+     << ", \"num_clients\": " << FLAGS_num_clients
+     << ", \"num_worker_threads\": " << FLAGS_num_worker_threads
+     << ", \"num_comm_channels_per_client\": "
+     << FLAGS_num_comm_channels_per_client
+     << ", \"consistency_model\": \"" << FLAGS_consistency_model << "\""
+     << ", \"num_rows\": " << FLAGS_num_rows
+     << ", \"row_width\": " << FLAGS_row_width
+     << ", \"sparse_rows\": " << (FLAGS_sparse_rows ? "true" : "false")
+     << ", \"row_oplog_type\": " << FLAGS_row_oplog_type
+     << ", \"oplog_type\": \"" << FLAGS_oplog_type << "\""
+     << ", \"staleness\": " << FLAGS_staleness
+     << ", \"num_clocks\": " << FLAGS_num_clocks
+     << ", \"ops_per_clock\": " << FLAGS_ops_per_clock
+     << ", \"get_fraction\": " << FLAGS_get_fraction
+     << ", \"updates_per_inc\": " << FLAGS_updates_per_inc
+     << ", \"zipf_s\": " << FLAGS_zipf_s
+     << ", \"num_gets\": " << num_gets
+     << ", \"num_incs\": " << num_incs
+     << ", \"loop_sec\": " << max_loop_sec
+     << ", \"ops_per_sec\": " << (num_gets + num_incs) / max_loop_sec
+     << ", \"get_latency_us\": {\"p50\": " << Percentile(get_latency_us, 0.5)
+     << ", \"p90\": " << Percentile(get_latency_us, 0.9)
+     << ", \"p99\": " << Percentile(get_latency_us, 0.99)
+     << ", \"p999\": " << Percentile(get_latency_us, 0.999)
+     << ", \"max\": "
+     << (get_latency_us.empty() ? 0.f : get_latency_us.back()) << "}"
+     << ", \"worker_cpu_sec\": [";
+  for (size_t w = 0; w < results.size(); ++w) {
+    ss << (w == 0 ? "" : ", ") << results[w].cpu_sec;
+    worker_cpu_sec += results[w].cpu_sec;
+  }
+  // Everything else in the process: bg, server and name node threads.
+  ss << "], \"system_cpu_sec\": " << process_cpu_sec - worker_cpu_sec
+     << ", \"oplog_sent_mb_per_clock\": "
+     << petuum::Stats::GetBgAccumOpLogSentMb() / FLAGS_num_clocks
+     << ", \"server_push_recv_mb_per_clock\": "
+     << petuum::Stats::GetBgAccumServerPushRowRecvMb() / FLAGS_num_clocks
+     << "}";
+  return ss.str();
+}
+
+void RunClient() {
+  petuum::TableGroupConfig table_group_config;
+  table_group_config.stats_path = FLAGS_stats_path;
+  table_group_config.num_comm_channels_per_client
+      = FLAGS_num_comm_channels_per_client;
+  table_group_config.num_total_clients = FLAGS_num_clients;
+  table_group_config.num_tables = 1;
+  // + 1 for main() thread.
+  table_group_config.num_local_app_threads = FLAGS_num_worker_threads + 1;
+  table_group_config.client_id = FLAGS_client_id;
+  if (FLAGS_hostfile.empty()) {
+    for (int32_t i = 0; i < FLAGS_num_clients; ++i) {
+      table_group_config.host_map.insert(std::make_pair(i,
+          petuum::HostInfo(i, "127.0.0.1",
+                           std::to_string(FLAGS_base_port + 100 * i))));
+    }
+  } else {
+    petuum::GetHostInfos(FLAGS_hostfile, &table_group_config.host_map);
+  }
+  if (FLAGS_consistency_model == "SSP") {
+    table_group_config.consistency_model = petuum::SSP;
+  } else if (FLAGS_consistency_model == "SSPPush") {
+    table_group_config.consistency_model = petuum::SSPPush;
+  } else if (FLAGS_consistency_model == "SSPAggr") {
+    table_group_config.consistency_model = petuum::SSPAggr;
+  } else {
+    LOG(FATAL) << "Unsupported consistency model "
+               << FLAGS_consistency_model;
+  }
+
+  petuum::PSTableGroup::RegisterRow<petuum::DenseRow<float> >(
+      kDenseRowFloatTypeID);
+  petuum::PSTableGroup::RegisterRow<petuum::SparseRow<float> >(
+      kSparseRowFloatTypeID);
+
+  petuum::PSTableGroup::Init(table_group_config, false);
+
+  petuum::ClientTableConfig table_config;
+  table_config.table_info.row_type = FLAGS_sparse_rows
+      ? kSparseRowFloatTypeID : kDenseRowFloatTypeID;
+  table_config.table_info.table_staleness = FLAGS_staleness;
+  table_config.table_info.row_capacity = FLAGS_row_width;
+  table_config.table_info.row_oplog_type = FLAGS_row_oplog_type;
+  table_config.table_info.oplog_dense_serialized
+      = FLAGS_oplog_dense_serialized;
+  table_config.table_info.dense_row_oplog_capacity = FLAGS_row_width;
+  table_config.process_cache_capacity = FLAGS_num_rows;
+  table_config.oplog_capacity = FLAGS_num_rows;
+  if (FLAGS_oplog_type == "Sparse") {
+    table_config.oplog_type = petuum::Sparse;
+  } else if (FLAGS_oplog_type == "Dense") {
+    table_config.oplog_type = petuum::Dense;
+  } else {
+    LOG(FATAL) << "Unsupported oplog type " << FLAGS_oplog_type;
+  }
+  CHECK(petuum::PSTableGroup::CreateTable(kTableID, table_config));
+  petuum::PSTableGroup::CreateTableDone();
+
+  std::vector<WorkerResult> results(FLAGS_num_worker_threads);
+  std::vector<std::thread> threads(FLAGS_num_worker_threads);
+  for (int32_t w = 0; w < FLAGS_num_worker_threads; ++w) {
+    threads[w] = std::thread(Worker, w, &results[w]);
+  }
+  for (auto &thr : threads) {
+    thr.join();
+  }
+  petuum::PSTableGroup::ShutDown();
+
+  std::string json = ResultsJson(results, ProcessCpuSec());
+  printf("%s\n", json.c_str());
+  fflush(stdout);
+  if (!FLAGS_results_path.empty()) {
+    std::ofstream out(FLAGS_results_path, std::ios_base::app);
+    out << json << "\n";
+  }
+}
+
+}  // anonymous namespace
+
+int main(int argc, char *argv[]) {
+  google::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+  CHECK_GT(FLAGS_num_clients, 0);
+  CHECK_GT(FLAGS_num_worker_threads, 0);
+  CHECK_GT(FLAGS_num_clocks, 0);
+  CHECK_GT(FLAGS_updates_per_inc, 0);
+  CHECK(FLAGS_get_fraction >= 0. && FLAGS_get_fraction <= 1.);
+
+  if (FLAGS_client_id >= 0) {
+    CHECK(FLAGS_num_clients == 1 || !FLAGS_hostfile.empty())
+        << "Give --hostfile to run a single client of several.";
+    RunClient();
+    return 0;
+  }
+
+  // Fork clients 1..num_clients-1 before any PS thread exists; this
+  // process is client 0.
+  std::vector<pid_t> children;
+  FLAGS_client_id = 0;
+  for (int32_t i = 1; i < FLAGS_num_clients; ++i) {
+    pid_t pid = fork();
+    CHECK_GE(pid, 0) << "fork() failed";
+    if (pid == 0) {
+      // The older siblings are not our children; only client 0 waits.
+      children.clear();
+      FLAGS_client_id = i;
+      break;
+    }
+    children.push_back(pid);
+  }
+  RunClient();
+
+  int exit_code = 0;
+  for (pid_t pid : children) {
+    int status;
+    CHECK_EQ(pid, waitpid(pid, &status, 0));
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+      LOG(ERROR) << "Client process " << pid << " failed, status " << status;
+      exit_code = 1;
+    }
+  }
+  return exit_code;
+}
@@ -0,0 +1,190 @@
+// Micro-benchmark of the row oplog types (RowOpLogType): Inc, BatchInc and
+// sparse (or dense) serialization throughput on DenseRow<float> updates,
+// without the rest of the PS. Each round refills the same row oplogs after
+// Reset(), as the append-only RowOpLogRecycle path does.
+//
+// Example:
+//   bin/bench/row_oplog_bench --num_cols=1000000 --nnz_per_row=1000
+
+#include <petuum_ps/oplog/create_row_oplog.hpp>
+#include <petuum_ps/oplog/oplog_updater.hpp>
+#include <petuum_ps_common/include/configs.hpp>
+#include <petuum_ps_common/storage/dense_row.hpp>
+#include <petuum_ps_common/util/high_resolution_timer.hpp>
+
+#include <gflags/gflags.h>
+#include <glog/logging.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+DEFINE_int32(num_cols, 100000, "Row width.");
+DEFINE_int32(num_rows, 100, "Row oplogs filled per round.");
+DEFINE_int32(nnz_per_row, 1000, "Updates per row oplog per round. Columns "
+    "are drawn uniformly, so some repeat.");
+DEFINE_int32(batch_size, 100, "Columns per BatchInc.");
+DEFINE_int32(num_rounds, 20, "Rounds per row oplog type.");
+DEFINE_bool(typed_updater, true, "BatchInc through OpLogUpdater (typed for "
+    "DenseRow<float>), as the consistency controllers do; false for the "
+    "per-update virtual AddUpdates loop.");
+DEFINE_string(row_oplog_types, "0,1,2,3", "Comma separated RowOpLogType "
+    "values: 0 dense, 1 sparse (std::map), 2 sparse vector, 3 sparse hash.");
+
+namespace {
+
+const char *RowOpLogTypeName(int32_t row_oplog_type) {
+  switch (row_oplog_type) {
+    case petuum::RowOpLogType::kDenseRowOpLog: return "dense";
+    case petuum::RowOpLogType::kSparseRowOpLog: return "sparse";
+    case petuum::RowOpLogType::kSparseVectorRowOpLog: return "sparse_vector";
+    case petuum::RowOpLogType::kSparseHashRowOpLog: return "sparse_hash";
+    default: LOG(FATAL) << "Unknown row oplog type " << row_oplog_type;
+  }
+  return "";
+}
+
+struct BenchResult {
+  double inc_sec;
+  double batch_inc_sec;
+  double serialize_sec;
+  size_t serialized_bytes;
+  float checksum;
+};
+
+// Per-update virtual call, as OpLogUpdater does for rows it has no typed
+// path for.
+void GenericBatchInc(petuum::AbstractRowOpLog *row_oplog,
+    const petuum::AbstractRow *sample_row, const int32_t *column_ids,
+    const float *deltas, int32_t num_updates) {
+  for (int i = 0; i < num_updates; ++i) {
+    void *oplog_delta = row_oplog->FindCreate(column_ids[i]);
+    sample_row->AddUpdates(column_ids[i], oplog_delta, deltas + i);
+  }
+}
+
+BenchResult RunBench(int32_t row_oplog_type,
+    const petuum::AbstractRow *sample_row,
+    const std::vector<std::vector<int32_t> > &row_cols,
+    const std::vector<std::vector<int32_t> > &row_sorted_cols,
+    const std::vector<float> &deltas) {
+  petuum::CreateRowOpLog::CreateRowOpLogFunc CreateRowOpLog
+      = petuum::CreateRowOpLog::GetCreateRowOpLogFunc(row_oplog_type, false);
+  bool dense = row_oplog_type == petuum::RowOpLogType::kDenseRowOpLog;
+  std::unique_ptr<petuum::OpLogUpdater> oplog_updater(
+      petuum::OpLogUpdater::Create(sample_row, row_oplog_type));
+  std::vector<petuum::AbstractRowOpLog*> row_oplogs(FLAGS_num_rows);
+  for (int r = 0; r < FLAGS_num_rows; ++r) {
+    row_oplogs[r] = CreateRowOpLog(sample_row->get_update_size(), sample_row,
+                                   FLAGS_num_cols);
+  }
+  std::vector<uint8_t> mem;
+  BenchResult result = {0., 0., 0., 0, 0.};
+
+  for (int round = 0; round < FLAGS_num_rounds; ++round) {
+    bool batch = round % 2 == 1;
+    petuum::HighResolutionTimer inc_timer;
+    for (int r = 0; r < FLAGS_num_rows; ++r) {
+      petuum::AbstractRowOpLog *row_oplog = row_oplogs[r];
+      if (batch) {
+        const std::vector<int32_t> &cols = row_sorted_cols[r];
+        for (int i = 0; i < cols.size(); i += FLAGS_batch_size) {
+          int32_t num_updates = std::min<int32_t>(FLAGS_batch_size,
+                                                  cols.size() - i);
+          if (FLAGS_typed_updater) {
+            oplog_updater->BatchInc(row_oplog, cols.data() + i,
+                                    deltas.data() + i, num_updates);
+          } else {
+            GenericBatchInc(row_oplog, sample_row, cols.data() + i,
+                            deltas.data() + i, num_updates);
+          }
+        }
+      } else {
+        const std::vector<int32_t> &cols = row_cols[r];
+        for (int i = 0; i < cols.size(); ++i) {
+          void *oplog_delta = row_oplog->FindCreate(cols[i]);
+          sample_row->AddUpdates(cols[i], oplog_delta, &deltas[i]);
+        }
+      }
+    }
+    (batch ? result.batch_inc_sec : result.inc_sec) += inc_timer.elapsed();
+
+    petuum::HighResolutionTimer serialize_timer;
+    for (int r = 0; r < FLAGS_num_rows; ++r) {
+      petuum::AbstractRowOpLog *row_oplog = row_oplogs[r];
+      size_t size;
+      if (dense) {
+        size = row_oplog->GetDenseSerializedSize();
+      } else {
+        row_oplog->ClearZerosAndGetNoneZeroSize();
+        size = row_oplog->GetSparseSerializedSize();
+      }
+      if (mem.size() < size) {
+        mem.resize(size);
+      }
+      if (dense) {
+        row_oplog->SerializeDense(mem.data());
+      } else {
+        row_oplog->SerializeSparse(mem.data());
+      }
+      result.serialized_bytes += size;
+      result.checksum
+          += *reinterpret_cast<const float*>(&mem[size - sizeof(float)]);
+      row_oplog->Reset();
+    }
+    result.serialize_sec += serialize_timer.elapsed();
+  }
+
+  for (int r = 0; r < FLAGS_num_rows; ++r) {
+    delete row_oplogs[r];
+  }
+  return result;
+}
+
+}  // anonymous namespace
+
+int main(int argc, char *argv[]) {
+  google::ParseCommandLineFlags(&argc, &argv, true);
+  google::InitGoogleLogging(argv[0]);
+  CHECK_GT(FLAGS_num_rounds, 1) << "Need rounds for both Inc and BatchInc.";
+
+  petuum::DenseRow<float> sample_row;
+  std::mt19937 gen(12345);
+  std::uniform_int_distribution<int32_t> col_dist(0, FLAGS_num_cols - 1);
+  std::vector<std::vector<int32_t> > row_cols(FLAGS_num_rows);
+  std::vector<std::vector<int32_t> > row_sorted_cols(FLAGS_num_rows);
+  for (int r = 0; r < FLAGS_num_rows; ++r) {
+    row_cols[r].resize(FLAGS_nnz_per_row);
+    for (int i = 0; i < FLAGS_nnz_per_row; ++i) {
+      row_cols[r][i] = col_dist(gen);
+    }
+    row_sorted_cols[r] = row_cols[r];
+    std::sort(row_sorted_cols[r].begin(), row_sorted_cols[r].end());
+  }
+  std::vector<float> deltas(FLAGS_nnz_per_row, 1.);
+
+  std::stringstream ss(FLAGS_row_oplog_types);
+  // Even rounds Inc, odd rounds BatchInc.
+  double updates_per_round = static_cast<double>(FLAGS_num_rows)
+      * FLAGS_nnz_per_row;
+  double inc_updates = updates_per_round * ((FLAGS_num_rounds + 1) / 2);
+  double batch_inc_updates = updates_per_round * (FLAGS_num_rounds / 2);
+  printf("%-14s %14s %14s %14s %14s\n", "row_oplog_type", "inc_Mops",
+         "batch_inc_Mops", "serialize_MBps", "checksum");
+  for (std::string token; std::getline(ss, token, ','); ) {
+    int32_t row_oplog_type = std::stoi(token);
+    BenchResult result = RunBench(row_oplog_type, &sample_row, row_cols,
+                                  row_sorted_cols, deltas);
+    printf("%-14s %14.2f %14.2f %14.2f %14.1f\n",
+           RowOpLogTypeName(row_oplog_type),
+           inc_updates / result.inc_sec / 1e6,
+           batch_inc_updates / result.batch_inc_sec / 1e6,
+           result.serialized_bytes / result.serialize_sec / (1 << 20),
+           result.checksum);
+  }
+  return 0;
+}
@@ -0,0 +1,307 @@
+#include <io/block_stream.hpp>
+#include <glog/logging.h>
+#include <snappy.h>
+#include <algorithm>
+#include <cstring>
+#ifdef HAS_LZ4
+#include <lz4.h>
+#endif
+
+namespace petuum {
+namespace io {
+
+namespace {
+
+void Compress(Codec codec, const std::string& raw, std::string* compressed) {
+  switch (codec) {
+    case kNoCodec:
+      *compressed = raw;
+      break;
+    case kSnappyCodec:
+      snappy::Compress(raw.data(), raw.size(), compressed);
+      break;
+    case kLZ4Codec:
+#ifdef HAS_LZ4
+      {
+        compressed->resize(LZ4_compressBound(raw.size()));
+        int size = LZ4_compress_default(raw.data(), &(*compressed)[0],
+            raw.size(), compressed->size());
+        CHECK_GT(size, 0) << "LZ4 compression of " << raw.size()
+          << " bytes failed";
+        compressed->resize(size);
+      }
+#else
+      LOG(FATAL) << "Built without LZ4. Add -DHAS_LZ4 and -llz4.";
+#endif
+      break;
+    default:
+      LOG(FATAL) << "Unknown codec " << codec;
+  }
+}
+
+void Decompress(Codec codec, const std::string& compressed, size_t raw_size,
+    std::string* raw, const std::string& url) {
+  raw->resize(raw_size);
+  switch (codec) {
+    case kNoCodec:
+      CHECK_EQ(raw_size, compressed.size()) << "Corrupted block in " << url;
+      memcpy(&(*raw)[0], compressed.data(), raw_size);
+      break;
+    case kSnappyCodec:
+      {
+        size_t uncompressed_size = 0;
+        CHECK(snappy::GetUncompressedLength(compressed.data(),
+              compressed.size(), &uncompressed_size)
+            && uncompressed_size == raw_size
+            && snappy::RawUncompress(compressed.data(), compressed.size(),
+              &(*raw)[0]))
+          << "Cannot snappy decompress block of size " << compressed.size()
+          << "; File: " << url;
+      }
+      break;
+    case kLZ4Codec:
+#ifdef HAS_LZ4
+      CHECK_EQ(static_cast<int>(raw_size), LZ4_decompress_safe(
+            compressed.data(), &(*raw)[0], compressed.size(), raw_size))
+        << "Cannot LZ4 decompress block of size " << compressed.size()
+        << "; File: " << url;
+#else
+      LOG(FATAL) << "Built without LZ4, cannot read " << url
+        << ". Add -DHAS_LZ4 and -llz4.";
+#endif
+      break;
+    default:
+      LOG(FATAL) << "Unknown codec " << codec << " in " << url;
+  }
+}
+
+}  // anonymous namespace
+
+// ================== BlockCompressedWriter ==================
+
+BlockCompressedWriter::BlockCompressedWriter(const std::string& url,
+    Codec codec, size_t block_size) :
+  sink_(url, std::ios_base::out | std::ios_base::trunc
+      | std::ios_base::binary),
+  codec_(codec), block_size_(block_size), closed_(false) {
+  CHECK_NE(kAutoCodec, codec_) << "Writer needs a concrete codec.";
+  CHECK_GT(block_size_, 0);
+  CHECK_LE(block_size_, UINT32_MAX);
+  char header[kBlockHeaderSize] = {0};
+  memcpy(header, kBlockMagic, sizeof(kBlockMagic));
+  header[sizeof(kBlockMagic)] = static_cast<char>(codec_);
+  sink_.write(header, kBlockHeaderSize);
+  raw_.reserve(block_size_);
+}
+
+BlockCompressedWriter::~BlockCompressedWriter() {
+  Close();
+}
+
+void BlockCompressedWriter::Write(const char* data, size_t size) {
+  CHECK(!closed_);
+  while (size > 0) {
+    size_t n = std::min(size, block_size_ - raw_.size());
+    raw_.append(data, n);
+    data += n;
+    size -= n;
+    if (raw_.size() == block_size_) {
+      FlushBlock();
+    }
+  }
+}
+
+void BlockCompressedWriter::Close() {
+  if (closed_) {
+    return;
+  }
+  FlushBlock();
+  sink_.close();
+  closed_ = true;
+}
+
+void BlockCompressedWriter::FlushBlock() {
+  if (raw_.empty()) {
+    return;
+  }
+  Compress(codec_, raw_, &compressed_);
+  CHECK_LE(compressed_.size(), UINT32_MAX);
+  uint32_t sizes[2] = {static_cast<uint32_t>(raw_.size()),
+    static_cast<uint32_t>(compressed_.size())};
+  sink_.write(reinterpret_cast<const char*>(sizes), sizeof(sizes));
+  sink_.write(compressed_.data(), compressed_.size());
+  raw_.clear();
+}
+
+// ================== PrefetchReader ==================
+
+PrefetchReader::PrefetchReader(const std::string& url, Codec codec,
+    int num_buffers) :
+  url_(url), codec_(codec), num_buffers_(num_buffers),
+  source_(url, std::ios_base::in | std::ios_base::binary),
+  eof_(false), stop_(false), pos_(0) {
+  CHECK_GT(num_buffers, 0);
+  prefetch_thread_ = std::thread(&PrefetchReader::Prefetch, this);
+}
+
+PrefetchReader::~PrefetchReader() {
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  prefetch_thread_.join();
+  source_.close();
+}
+
+bool PrefetchReader::NextChunk(const char** data, size_t* size) {
+  {
+    std::unique_lock<std::mutex> lock(mtx_);
+    cv_.wait(lock, [this] { return !ready_.empty() || eof_; });
+    if (ready_.empty()) {
+      return false;
+    }
+    // Keep the capacity of the consumed chunk for the prefetch thread.
+    free_.emplace_back();
+    free_.back().swap(current_);
+    current_.swap(ready_.front());
+    ready_.pop_front();
+  }
+  cv_.notify_all();
+  pos_ = 0;
+  *data = current_.data();
+  *size = current_.size();
+  return true;
+}
+
+bool PrefetchReader::GetLine(std::string* line) {
+  line->clear();
+  bool found = false;
+  while (true) {
+    if (pos_ == current_.size()) {
+      const char* data;
+      size_t size;
+      if (!NextChunk(&data, &size)) {
+        return found;
+      }
+    }
+    found = true;
+    const char* begin = current_.data() + pos_;
+    const char* end = current_.data() + current_.size();
+    const char* newline = static_cast<const char*>(
+        memchr(begin, '\n', end - begin));
+    if (newline != NULL) {
+      line->append(begin, newline - begin);
+      pos_ = newline - current_.data() + 1;
+      return true;
+    }
+    line->append(begin, end - begin);
+    pos_ = current_.size();
+  }
+}
+
+size_t PrefetchReader::ReadFully(char* buf, size_t size) {
+  size_t total = 0;
+  while (total < size) {
+    std::streamsize n = source_.read(buf + total, size - total);
+    if (n <= 0) {
+      break;
+    }
+    total += n;
+  }
+  return total;
+}
+
+bool PrefetchReader::Enqueue(std::string* chunk) {
+  {
+    std::unique_lock<std::mutex> lock(mtx_);
+    cv_.wait(lock, [this] { return ready_.size() < num_buffers_ || stop_; });
+    if (stop_) {
+      return false;
+    }
+    ready_.emplace_back();
+    ready_.back().swap(*chunk);
+    if (!free_.empty()) {
+      chunk->swap(free_.back());
+      free_.pop_back();
+    }
+    chunk->clear();
+  }
+  cv_.notify_all();
+  return true;
+}
+
+void PrefetchReader::Prefetch() {
+  std::string chunk;
+  char header[kBlockHeaderSize];
+  size_t header_size = ReadFully(header, kBlockHeaderSize);
+  bool is_block_file = header_size == kBlockHeaderSize
+    && memcmp(header, kBlockMagic, sizeof(kBlockMagic)) == 0;
+  if (is_block_file) {
+    Codec file_codec = static_cast<Codec>(header[sizeof(kBlockMagic)]);
+    CHECK(codec_ == kAutoCodec || codec_ == file_codec)
+      << url_ << " has codec " << file_codec << ", expected " << codec_;
+    std::string compressed;
+    uint32_t sizes[2];
+    while (true) {
+      size_t n = ReadFully(reinterpret_cast<char*>(sizes), sizeof(sizes));
+      if (n == 0) {
+        break;
+      }
+      CHECK_EQ(sizeof(sizes), n) << "Truncated block header in " << url_;
+      compressed.resize(sizes[1]);
+      CHECK_EQ(sizes[1], ReadFully(&compressed[0], sizes[1]))
+        << "Truncated block in " << url_;
+      Decompress(file_codec, compressed, sizes[0], &chunk, url_);
+      if (!chunk.empty() && !Enqueue(&chunk)) {
+        return;
+      }
+    }
+  } else if (codec_ == kSnappyCodec) {
+    // Whole-file snappy stream: nothing can be decoded before the end.
+    std::string compressed(header, header_size);
+    compressed.resize(header_size + BUFFER_SIZE);
+    size_t size = header_size;
+    size_t n;
+    while ((n = ReadFully(&compressed[size], compressed.size() - size)) > 0) {
+      size += n;
+      if (size == compressed.size()) {
+        compressed.resize(size * 2);
+      }
+    }
+    compressed.resize(size);
+    CHECK(snappy::Uncompress(compressed.data(), compressed.size(), &chunk))
+      << "Cannot snappy decompress buffer of size " << compressed.size()
+      << "; File: " << url_;
+    if (!chunk.empty() && !Enqueue(&chunk)) {
+      return;
+    }
+  } else {
+    CHECK_NE(kLZ4Codec, codec_) << url_ << " is not an LZ4 block file.";
+    chunk.assign(header, header_size);
+    while (true) {
+      size_t size = chunk.size();
+      chunk.resize(BUFFER_SIZE);
+      size += ReadFully(&chunk[size], BUFFER_SIZE - size);
+      chunk.resize(size);
+      if (chunk.empty()) {
+        break;
+      }
+      bool full = size == BUFFER_SIZE;
+      if (!Enqueue(&chunk)) {
+        return;
+      }
+      if (!full) {
+        break;
+      }
+    }
+  }
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    eof_ = true;
+  }
+  cv_.notify_all();
+}
+
+}   // namespace io
+}   // namespace petuum
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <io/general_fstream.hpp>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace petuum {
+namespace io {
+
+// Compression of a block stream. kAutoCodec is only valid for readers: a
+// file starting with the block header is decoded per its header, any other
+// file is read raw.
+enum Codec {
+  kAutoCodec = 0,
+  kNoCodec = 1,
+  kSnappyCodec = 2,
+  kLZ4Codec = 3      // Requires building with -DHAS_LZ4 (and -llz4).
+};
+
+// Block file layout:
+//   header: "PBLK" | uint8 codec | 3 bytes zero
+//   blocks: uint32 raw_size | uint32 compressed_size | compressed bytes
+// Blocks are compressed independently, so a reader decodes a block as soon
+// as it arrives instead of after the whole file.
+const char kBlockMagic[4] = {'P', 'B', 'L', 'K'};
+const size_t kBlockHeaderSize = 8;
+const size_t kDefaultBlockSize = 4 * 1024 * 1024;
+
+// Write 'url' (HDFS or local, see general_sink) as a block file. Blocks
+// are cut every block_size raw bytes regardless of record boundaries.
+class BlockCompressedWriter {
+public:
+  BlockCompressedWriter(const std::string& url, Codec codec,
+      size_t block_size = kDefaultBlockSize);
+  ~BlockCompressedWriter();
+
+  void Write(const char* data, size_t size);
+
+  void Write(const std::string& data) {
+    Write(data.data(), data.size());
+  }
+
+  // Flush the last partial block and close the file. Called by the
+  // destructor if not called before.
+  void Close();
+
+private:
+  void FlushBlock();
+
+  general_sink sink_;
+  Codec codec_;
+  size_t block_size_;
+  std::string raw_;
+  std::string compressed_;
+  bool closed_;
+};
+
+// Reads 'url' on a background thread, BUFFER_SIZE bytes (or one block) at a
+// time, and decompresses on that thread as well. At most num_buffers decoded
+// chunks are queued ahead of the caller, so with the default of 2 the next
+// chunk is read while the caller parses the current one.
+//
+// A snappy file without the block header (whole-file snappy::Compress, as
+// ReadDataLabelLibSVM has always accepted) is decoded as a single chunk;
+// only block files stream.
+class PrefetchReader {
+public:
+  PrefetchReader(const std::string& url, Codec codec = kAutoCodec,
+      int num_buffers = 2);
+  ~PrefetchReader();
+
+  // Next decoded chunk, valid until the next call. Return false at the end
+  // of the file.
+  bool NextChunk(const char** data, size_t* size);
+
+  // Next line without the trailing '\n'. Return false at the end of the
+  // file. Lines may span chunks.
+  bool GetLine(std::string* line);
+
+private:
+  void Prefetch();
+  // Read exactly size bytes unless the file ends first. Return the bytes
+  // read.
+  size_t ReadFully(char* buf, size_t size);
+  // Hand a decoded chunk to the caller; block while num_buffers_ are
+  // queued. Return false if the reader is being destroyed.
+  bool Enqueue(std::string* chunk);
+
+  const std::string url_;
+  const Codec codec_;
+  const size_t num_buffers_;
+  general_source source_;
+
+  std::mutex mtx_;
+  std::condition_variable cv_;
+  std::deque<std::string> ready_;
+  std::vector<std::string> free_;
+  bool eof_;
+  bool stop_;
+
+  // Owned by the caller thread.
+  std::string current_;
+  size_t pos_;
+
+  std::thread prefetch_thread_;
+};
+
+}   // namespace io
+}   // namespace petuum
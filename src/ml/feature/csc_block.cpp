@@ -0,0 +1,108 @@
+#include <ml/feature/csc_block.hpp>
+#include <glog/logging.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define PETUUM_ML_X86 1
+#endif
+
+namespace petuum {
+namespace ml {
+
+namespace {
+
+float DotScalar(const int32_t* idx, const float* val, int64_t n,
+    const float* v) {
+  float sum = 0.;
+  for (int64_t k = 0; k < n; ++k) {
+    sum += val[k] * v[idx[k]];
+  }
+  return sum;
+}
+
+void AxpyScalar(const int32_t* idx, const float* val, int64_t n, float a,
+    float* out) {
+  for (int64_t k = 0; k < n; ++k) {
+    out[idx[k]] += a * val[k];
+  }
+}
+
+#ifdef PETUUM_ML_X86
+__attribute__((target("avx2,fma")))
+float DotAvx2(const int32_t* idx, const float* val, int64_t n,
+    const float* v) {
+  __m256 acc = _mm256_setzero_ps();
+  int64_t k = 0;
+  for (; k + 8 <= n; k += 8) {
+    __m256i vi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(idx + k));
+    __m256 gathered = _mm256_i32gather_ps(v, vi, 4);
+    acc = _mm256_fmadd_ps(_mm256_loadu_ps(val + k), gathered, acc);
+  }
+  float lanes[8];
+  _mm256_storeu_ps(lanes, acc);
+  float sum = ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3]))
+    + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+  for (; k < n; ++k) {
+    sum += val[k] * v[idx[k]];
+  }
+  return sum;
+}
+
+// Sample ids within a column are distinct, so a scatter never writes the
+// same element twice.
+__attribute__((target("avx512f")))
+void AxpyAvx512(const int32_t* idx, const float* val, int64_t n, float a,
+    float* out) {
+  __m512 va = _mm512_set1_ps(a);
+  int64_t k = 0;
+  for (; k + 16 <= n; k += 16) {
+    __m512i vi = _mm512_loadu_si512(idx + k);
+    __m512 o = _mm512_i32gather_ps(vi, out, 4);
+    o = _mm512_fmadd_ps(va, _mm512_loadu_ps(val + k), o);
+    _mm512_i32scatter_ps(out, vi, o, 4);
+  }
+  for (; k < n; ++k) {
+    out[idx[k]] += a * val[k];
+  }
+}
+#endif
+
+}  // anonymous namespace
+
+CscBlock::CscBlock() : col_ptr_(1, 0), dot_(DotScalar),
+  axpy_(AxpyScalar) {
+#ifdef PETUUM_ML_X86
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+      dot_ = DotAvx2;
+    }
+    if (__builtin_cpu_supports("avx512f")) {
+      axpy_ = AxpyAvx512;
+    }
+#endif
+  }
+
+void CscBlock::Init(
+    const std::vector<SparseFeature<float>*>& X_cols,
+    int feature_start, int feature_end) {
+  CHECK_LE(feature_start, feature_end);
+  int num_cols = feature_end - feature_start;
+  col_ptr_.resize(num_cols + 1);
+  col_ptr_[0] = 0;
+  for (int j = 0; j < num_cols; ++j) {
+    col_ptr_[j + 1] = col_ptr_[j]
+      + X_cols[feature_start + j]->GetNumEntries();
+  }
+  row_idx_.resize(col_ptr_[num_cols]);
+  vals_.resize(col_ptr_[num_cols]);
+  for (int j = 0; j < num_cols; ++j) {
+    const SparseFeature<float>& col = *X_cols[feature_start + j];
+    int64_t offset = col_ptr_[j];
+    for (int k = 0; k < col.GetNumEntries(); ++k) {
+      row_idx_[offset + k] = col.GetFeatureId(k);
+      vals_[offset + k] = col.GetFeatureVal(k);
+    }
+  }
+}
+
+}  // namespace ml
+}  // namespace petuum
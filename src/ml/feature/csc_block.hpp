@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <ml/feature/sparse_feature.hpp>
+
+namespace petuum {
+namespace ml {
+
+// A worker's block of feature columns in compressed sparse column form:
+// column j's samples are row_idx_[col_ptr_[j] .. col_ptr_[j+1]) with values
+// in vals_. Dot() gathers from and Axpy() scatters into dense sample
+// vectors, with AVX2 gathers / AVX-512 scatters when the CPU has them.
+class CscBlock {
+public:
+  CscBlock();
+
+  // Copy columns [feature_start, feature_end) of X_cols.
+  void Init(const std::vector<SparseFeature<float>*>& X_cols,
+      int feature_start, int feature_end);
+
+  int GetNumCols() const {
+    return static_cast<int>(col_ptr_.size()) - 1;
+  }
+
+  int64_t GetNumNonZeros() const {
+    return col_ptr_.back();
+  }
+
+  // sum_i X(i, j) * v[i]
+  float Dot(int j, const float* v) const {
+    return dot_(row_idx_.data() + col_ptr_[j], vals_.data() + col_ptr_[j],
+        col_ptr_[j + 1] - col_ptr_[j], v);
+  }
+
+  // out[i] += a * X(i, j)
+  void Axpy(int j, float a, float* out) const {
+    axpy_(row_idx_.data() + col_ptr_[j], vals_.data() + col_ptr_[j],
+        col_ptr_[j + 1] - col_ptr_[j], a, out);
+  }
+
+private:
+  typedef float (*DotFunc)(const int32_t* idx, const float* val,
+      int64_t n, const float* v);
+  typedef void (*AxpyFunc)(const int32_t* idx, const float* val,
+      int64_t n, float a, float* out);
+
+  std::vector<int64_t> col_ptr_;
+  std::vector<int32_t> row_idx_;
+  std::vector<float> vals_;
+  DotFunc dot_;
+  AxpyFunc axpy_;
+};
+
+}  // namespace ml
+}  // namespace petuum
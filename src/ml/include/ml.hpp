@@ -1,6 +1,7 @@
 #pragma once
 
 #include <ml/util/workload_manager.hpp>
+#include <ml/util/fork_join_pool.hpp>
 #include <ml/util/data_loading.hpp>
 #include <ml/util/metafile_reader.hpp>
 #include <ml/util/math_util.hpp>
@@ -9,3 +10,4 @@
 #include <ml/feature/sparse_feature.hpp>
 #include <ml/feature/dense_feature.hpp>
 #include <ml/feature/abstract_feature.hpp>
+#include <ml/feature/csc_block.hpp>
@@ -10,7 +10,7 @@
 #include <petuum_ps_common/util/high_resolution_timer.hpp>
 #include <ml/util/data_loading.hpp>
 #include <io/general_fstream.hpp>
-#include <snappy.h>
+#include <io/block_stream.hpp>
 #include <iterator>
 #include <cmath>
 
@@ -118,30 +118,49 @@ float ParseLibSVMLine(const std::string& line, std::vector<int32_t>* feature_ids
   return label;
 }
 
-// Open 'filename' and snappy decompress it to std::string.
-std::string SnappyOpenFileToString(const std::string& filename) {
-  // std::ifstream file(filename, std::ifstream::binary);
-  petuum::io::ifstream file(filename, std::ifstream::binary);
-  CHECK(file) << "Can't open " << filename;
-  std::string buffer((std::istreambuf_iterator<char>(file)),
-      std::istreambuf_iterator<char>());
-  std::string uncompressed;
-  CHECK(snappy::Uncompress(buffer.data(), buffer.size(), &uncompressed))
-    << "Cannot snappy decompress buffer of size " << buffer.size()
-    << "; File: " << filename;
-  return uncompressed;
-}
+}  // anonymous namespace
+
+LibSVMStreamReader::LibSVMStreamReader(const std::string& filename,
+    int32_t feature_dim, bool feature_one_based, bool label_one_based,
+    bool snappy_compressed) :
+  reader_(new io::PrefetchReader(filename,
+        snappy_compressed ? io::kSnappyCodec : io::kAutoCodec)),
+  feature_dim_(feature_dim), feature_one_based_(feature_one_based),
+  label_one_based_(label_one_based), feature_ids_(feature_dim),
+  feature_vals_(feature_dim) { }
 
-std::string OpenFileToString(const std::string& filename) {
-  // std::ifstream file(filename);
-  petuum::io::ifstream file(filename);
-  CHECK(file) << "Can't open " << filename;
-  std::string buffer((std::istreambuf_iterator<char>(file)),
-      std::istreambuf_iterator<char>());
-  return buffer;
+LibSVMStreamReader::~LibSVMStreamReader() { }
+
+int32_t LibSVMStreamReader::NextMinibatch(int32_t minibatch_size,
+    std::vector<AbstractFeature<float>*>* features,
+    std::vector<float>* labels) {
+  int32_t i = 0;
+  for (; i < minibatch_size && reader_->GetLine(&line_); ++i) {
+    float label = ParseLibSVMLine(line_, &feature_ids_, &feature_vals_,
+        feature_one_based_, label_one_based_);
+    labels->push_back(label);
+    features->push_back(new SparseFeature<float>(feature_ids_, feature_vals_,
+          feature_dim_));
+  }
+  return i;
 }
 
-}  // anonymous namespace
+int32_t LibSVMStreamReader::NextMinibatch(int32_t minibatch_size,
+    std::vector<std::vector<float> >* features,
+    std::vector<float>* labels) {
+  int32_t i = 0;
+  for (; i < minibatch_size && reader_->GetLine(&line_); ++i) {
+    float label = ParseLibSVMLine(line_, &feature_ids_, &feature_vals_,
+        feature_one_based_, label_one_based_);
+    labels->push_back(label);
+    features->emplace_back(feature_dim_);
+    std::vector<float>& feature = features->back();
+    for (int j = 0; j < feature_ids_.size(); ++j) {
+      feature[feature_ids_[j]] = feature_vals_[j];
+    }
+  }
+  return i;
+}
 
 void ReadDataLabelLibSVM(const std::string& filename,
     int32_t feature_dim, int32_t num_data,
@@ -174,22 +193,13 @@ void ReadDataLabelLibSVM(const std::string& filename,
     std::vector<AbstractFeature<float>*>* features, std::vector<float>* labels,
     bool feature_one_based, bool label_one_based, bool snappy_compressed) {
   petuum::HighResolutionTimer read_timer;
-  features->resize(num_data);
-  labels->resize(num_data);
-  std::string file_str = snappy_compressed ?
-    SnappyOpenFileToString(filename) : OpenFileToString(filename);
-  std::istringstream data_stream(file_str);
-  int32_t i = 0;
-  std::vector<int32_t> feature_ids(feature_dim);
-  std::vector<float> feature_vals(feature_dim);
-  for (std::string line; std::getline(data_stream, line) && i < num_data;
-      ++i) {
-    float label = ParseLibSVMLine(line, &feature_ids,
-        &feature_vals, feature_one_based, label_one_based);
-    (*labels)[i] = label;
-    (*features)[i] = new SparseFeature<float>(feature_ids, feature_vals,
-        feature_dim);
-  }
+  features->clear();
+  labels->clear();
+  features->reserve(num_data);
+  labels->reserve(num_data);
+  LibSVMStreamReader reader(filename, feature_dim, feature_one_based,
+      label_one_based, snappy_compressed);
+  int32_t i = reader.NextMinibatch(num_data, features, labels);
   CHECK_EQ(num_data, i) << "Request to read " << num_data
     << " data instances but only " << i << " found in " << filename;
   LOG(INFO) << "Read " << i << " instances from " << filename << " in "
@@ -201,24 +211,13 @@ void ReadDataLabelLibSVM(const std::string& filename,
     std::vector<std::vector<float> >* features, std::vector<float>* labels,
     bool feature_one_based, bool label_one_based, bool snappy_compressed) {
   petuum::HighResolutionTimer read_timer;
-  features->resize(num_data);
-  labels->resize(num_data);
-  std::string file_str = snappy_compressed ?
-    SnappyOpenFileToString(filename) : OpenFileToString(filename);
-  std::istringstream data_stream(file_str);
-  std::vector<int32_t> feature_ids(feature_dim);
-  std::vector<float> feature_vals(feature_dim);
-  int i = 0;
-  for (std::string line; std::getline(data_stream, line) && i < num_data;
-      ++i) {
-    float label = ParseLibSVMLine(line, &feature_ids,
-        &feature_vals, feature_one_based, label_one_based);
-    (*labels)[i] = label;
-    (*features)[i].resize(feature_dim);
-    for (int j = 0; j < feature_ids.size(); ++j) {
-      (*features)[i][feature_ids[j]] = feature_vals[j];
-    }
-  }
+  features->clear();
+  labels->clear();
+  features->reserve(num_data);
+  labels->reserve(num_data);
+  LibSVMStreamReader reader(filename, feature_dim, feature_one_based,
+      label_one_based, snappy_compressed);
+  int32_t i = reader.NextMinibatch(num_data, features, labels);
   CHECK_EQ(num_data, i) << "Request to read " << num_data
     << " data instances but only " << i << " found in " << filename;
   LOG(INFO) << "Read " << i << " instances from " << filename << " in "
@@ -6,10 +6,15 @@
 #include <string>
 #include <vector>
 #include <cstdint>
+#include <memory>
 #include <ml/feature/sparse_feature.hpp>
 #include <ml/feature/dense_feature.hpp>
 
 namespace petuum {
+namespace io {
+class PrefetchReader;
+}   // namespace io
+
 namespace ml {
 
 // Read dense binary data and labels from filename and output to 'features'
@@ -26,6 +31,40 @@ void ReadDataLabelBinary(const std::string& filename,
     std::vector<std::vector<float> >* features, std::vector<int32_t>* labels,
     bool feature_one_based = false, bool label_one_based = false);
 
+// Parse a LibSVM file in minibatches while a background thread reads (and
+// decompresses) ahead, so training can start on the first minibatch while
+// the rest of the file is still arriving. Reads plain text, whole-file
+// snappy (snappy_compressed = true), and block files written by
+// io::BlockCompressedWriter (snappy or LZ4; detected from the file).
+class LibSVMStreamReader {
+public:
+  LibSVMStreamReader(const std::string& filename, int32_t feature_dim,
+      bool feature_one_based = false, bool label_one_based = false,
+      bool snappy_compressed = false);
+  ~LibSVMStreamReader();
+
+  // Parse up to minibatch_size instances, appending SparseFeature (owned by
+  // the caller) to features and the labels to labels. Return the number of
+  // instances parsed; 0 once the file is exhausted.
+  int32_t NextMinibatch(int32_t minibatch_size,
+      std::vector<AbstractFeature<float>*>* features,
+      std::vector<float>* labels);
+
+  // Same, but densify each instance into a feature_dim float vector.
+  int32_t NextMinibatch(int32_t minibatch_size,
+      std::vector<std::vector<float> >* features,
+      std::vector<float>* labels);
+
+private:
+  std::unique_ptr<io::PrefetchReader> reader_;
+  const int32_t feature_dim_;
+  const bool feature_one_based_;
+  const bool label_one_based_;
+  std::string line_;
+  std::vector<int32_t> feature_ids_;
+  std::vector<float> feature_vals_;
+};
+
 // Similar to ReadDataLabelBinary, but read LibSVM format: label
 // [feature_id:feature_value] as SparseFeature.
 //
@@ -0,0 +1,65 @@
+#include <ml/util/fork_join_pool.hpp>
+#include <glog/logging.h>
+
+namespace petuum {
+namespace ml {
+
+ForkJoinPool::ForkJoinPool(int num_threads) : num_threads_(num_threads),
+  fn_(NULL), generation_(0), num_pending_(0), stop_(false) {
+  CHECK_GT(num_threads, 0);
+  for (int t = 1; t < num_threads; ++t) {
+    workers_.emplace_back(&ForkJoinPool::WorkerLoop, this, t);
+  }
+}
+
+ForkJoinPool::~ForkJoinPool() {
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    stop_ = true;
+  }
+  start_cv_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+void ForkJoinPool::Run(const std::function<void(int)>& fn) {
+  if (num_threads_ == 1) {
+    fn(0);
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    fn_ = &fn;
+    num_pending_ = num_threads_ - 1;
+    ++generation_;
+  }
+  start_cv_.notify_all();
+  fn(0);
+  std::unique_lock<std::mutex> lock(mtx_);
+  done_cv_.wait(lock, [this] { return num_pending_ == 0; });
+}
+
+void ForkJoinPool::WorkerLoop(int t) {
+  int64_t seen = 0;
+  while (true) {
+    const std::function<void(int)>* fn;
+    {
+      std::unique_lock<std::mutex> lock(mtx_);
+      start_cv_.wait(lock, [&] { return stop_ || generation_ != seen; });
+      if (stop_) {
+        return;
+      }
+      seen = generation_;
+      fn = fn_;
+    }
+    (*fn)(t);
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (--num_pending_ == 0) {
+      done_cv_.notify_one();
+    }
+  }
+}
+
+}  // namespace ml
+}  // namespace petuum
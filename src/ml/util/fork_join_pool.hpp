@@ -0,0 +1,47 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace petuum {
+namespace ml {
+
+// A fixed set of num_threads - 1 worker threads for repeated fork/join
+// steps, so a step does not pay for creating and joining threads.
+class ForkJoinPool {
+public:
+  explicit ForkJoinPool(int num_threads);
+  ~ForkJoinPool();
+
+  ForkJoinPool(const ForkJoinPool&) = delete;
+  ForkJoinPool& operator=(const ForkJoinPool&) = delete;
+
+  int get_num_threads() const {
+    return num_threads_;
+  }
+
+  // Run fn(0) on the calling thread and fn(1) .. fn(num_threads - 1) on the
+  // workers. Return once all of them have returned.
+  void Run(const std::function<void(int)>& fn);
+
+private:
+  void WorkerLoop(int t);
+
+  const int num_threads_;
+  std::mutex mtx_;
+  std::condition_variable start_cv_;
+  std::condition_variable done_cv_;
+  const std::function<void(int)>* fn_;
+  // Bumped by each Run(); workers wait for it to change.
+  int64_t generation_;
+  int num_pending_;
+  bool stop_;
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace ml
+}  // namespace petuum
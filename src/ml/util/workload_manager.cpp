@@ -0,0 +1,74 @@
+// Author: Dai Wei (wdai@cs.cmu.edu)
+// Date: 2014.07.14
+
+#include <ml/util/workload_manager.hpp>
+#include <algorithm>
+
+namespace petuum {
+namespace ml {
+
+const int32_t WorkStealingPool::kNumChunksPerBatch;
+
+WorkStealingPool::WorkStealingPool(const WorkloadManagerConfig& config) :
+  num_threads_(config.num_threads),
+  num_batches_per_epoch_(config.num_batches_per_epoch),
+  ranges_(config.num_threads),
+  slots_(new BatchSlot[config.num_threads * config.num_batches_per_epoch]) {
+  for (int i = 0; i < num_threads_; ++i) {
+    ThreadRange& range = ranges_[i];
+    GetThreadDataRange(config, i, &range.data_idx_begin, &range.data_idx_end);
+    range.batch_size = ComputeBatchSize(range.data_idx_begin,
+        range.data_idx_end, num_batches_per_epoch_);
+    range.chunk_size = std::max(1, range.batch_size / kNumChunksPerBatch);
+  }
+}
+
+void WorkStealingPool::StartBatch(int32_t thread_id, int32_t epoch,
+    int32_t batch, WorkChunk* chunk) {
+  const ThreadRange& range = ranges_[thread_id];
+  BatchSlot& slot = GetSlot(thread_id, batch);
+  std::lock_guard<std::mutex> lock(slot.mtx);
+  CHECK_LT(slot.epoch, epoch);
+  slot.epoch = epoch;
+  slot.front = batch * range.batch_size;
+  slot.back = slot.front + range.batch_size;
+  chunk->owner = thread_id;
+  chunk->begin = slot.front;
+  chunk->end = std::min(slot.front + range.chunk_size, slot.back);
+  slot.front = chunk->end;
+}
+
+bool WorkStealingPool::NextChunk(int32_t thread_id, int32_t epoch,
+    int32_t batch, WorkChunk* chunk) {
+  {
+    BatchSlot& slot = GetSlot(thread_id, batch);
+    std::lock_guard<std::mutex> lock(slot.mtx);
+    if (slot.front < slot.back) {
+      chunk->owner = thread_id;
+      chunk->begin = slot.front;
+      chunk->end = std::min(slot.front + ranges_[thread_id].chunk_size,
+          slot.back);
+      slot.front = chunk->end;
+      return true;
+    }
+  }
+  // Own batch is done; steal from the back of others' so that their owners
+  // can keep taking from the front.
+  for (int i = 1; i < num_threads_; ++i) {
+    int32_t victim = (thread_id + i) % num_threads_;
+    BatchSlot& slot = GetSlot(victim, batch);
+    std::lock_guard<std::mutex> lock(slot.mtx);
+    if (slot.epoch == epoch && slot.front < slot.back) {
+      chunk->owner = victim;
+      chunk->end = slot.back;
+      chunk->begin = std::max(slot.back - ranges_[victim].chunk_size,
+          slot.front);
+      slot.back = chunk->begin;
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace ml
+}  // namespace petuum
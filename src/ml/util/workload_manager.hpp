@@ -6,11 +6,18 @@
 #include <glog/logging.h>
 #include <cstdint>
 #include <cmath>
+#include <mutex>
+#include <vector>
+#include <memory>
 
 namespace petuum {
 namespace ml {
 
+class WorkStealingPool;
+
 struct WorkloadManagerConfig {
+  WorkloadManagerConfig() : work_stealing_pool(nullptr) { }
+
   int32_t thread_id;
   int32_t client_id;
   int32_t num_clients;
@@ -18,50 +25,138 @@ struct WorkloadManagerConfig {
   int32_t num_batches_per_epoch;
   int32_t num_data;
   bool global_data;  // true if dataset is duplicated on other clients.
+  // If set, threads of this client that share the pool take work from each
+  // other within a batch. Not owned.
+  WorkStealingPool *work_stealing_pool;
 };
 
-class WorkloadManager {
-public:
-  WorkloadManager(const WorkloadManagerConfig& config) {
-    int32_t thread_id = config.thread_id;
-    int32_t client_id = config.client_id;
-    int32_t num_clients = config.num_clients;
-    int32_t num_threads = config.num_threads;
-    int32_t num_batches_per_epoch = config.num_batches_per_epoch;
-    bool global_data = config.global_data;
-
-    // Each thread handles data [data_idx_begin_, data_idx_end_).
-    int num_data = config.num_data;
-    int num_data_per_thread;
-    if (global_data) {
-      num_data_per_thread = num_data / (num_clients * num_threads);
-      data_idx_begin_ = num_data_per_thread *
-        (client_id * num_threads + thread_id);
-      // The last thread takes the rest of the data.
-      if (client_id == num_clients - 1 && thread_id == num_threads - 1) {
-        data_idx_end_ = num_data;
-      } else {
-        data_idx_end_ = data_idx_begin_ + num_data_per_thread;
-      }
+// Data [*data_idx_begin, *data_idx_end) of thread_id on config.client_id.
+inline void GetThreadDataRange(const WorkloadManagerConfig& config,
+    int32_t thread_id, int32_t* data_idx_begin, int32_t* data_idx_end) {
+  int32_t client_id = config.client_id;
+  int32_t num_clients = config.num_clients;
+  int32_t num_threads = config.num_threads;
+  int num_data = config.num_data;
+  int num_data_per_thread;
+  if (config.global_data) {
+    num_data_per_thread = num_data / (num_clients * num_threads);
+    *data_idx_begin = num_data_per_thread *
+      (client_id * num_threads + thread_id);
+    // The last thread takes the rest of the data.
+    if (client_id == num_clients - 1 && thread_id == num_threads - 1) {
+      *data_idx_end = num_data;
     } else {
-      num_data_per_thread = num_data / num_threads;
-      data_idx_begin_ = num_data_per_thread * thread_id;
-      // The last thread takes the rest of the data.
-      if (thread_id == num_threads - 1) {
-        data_idx_end_ = num_data;
-      } else {
-        data_idx_end_ = data_idx_begin_ + num_data_per_thread;
-      }
+      *data_idx_end = *data_idx_begin + num_data_per_thread;
+    }
+  } else {
+    num_data_per_thread = num_data / num_threads;
+    *data_idx_begin = num_data_per_thread * thread_id;
+    // The last thread takes the rest of the data.
+    if (thread_id == num_threads - 1) {
+      *data_idx_end = num_data;
+    } else {
+      *data_idx_end = *data_idx_begin + num_data_per_thread;
     }
+  }
+}
+
+// We will allow wrap-around on [data_idx_begin, data_idx_end) when data
+// points aren't divisible.
+inline int32_t ComputeBatchSize(int32_t data_idx_begin, int32_t data_idx_end,
+    int32_t num_batches_per_epoch) {
+  int32_t batch_size = std::ceil(
+      static_cast<float>(data_idx_end - data_idx_begin)
+      / num_batches_per_epoch);
+  CHECK_LT(0, batch_size) << "Batch size cannot be 0. # data this thread: "
+    << (data_idx_end - data_idx_begin) << " num_batches_per_epoch: "
+    << num_batches_per_epoch;
+  return batch_size;
+}
+
+// Part of one thread's epoch: positions [begin, end) of its
+// batch_size * num_batches_per_epoch data.
+struct WorkChunk {
+  int32_t owner;  // thread_id
+  int32_t begin;
+  int32_t end;
+};
+
+// Lets the threads of one client balance each batch among themselves. Each
+// thread still owns the batches of its static partition and clocks once per
+// batch, but hands out its batch in chunks: it takes chunks from the front,
+// and threads done with their own batch take chunks from the back of the
+// batches of threads in the same batch. A straggler thus only processes
+// what the others did not get to before the next clock.
+//
+// Threads only steal from batches their owner has started in the same
+// epoch, so work never moves across clocks.
+class WorkStealingPool {
+public:
+  // config.thread_id and config.work_stealing_pool are ignored.
+  explicit WorkStealingPool(const WorkloadManagerConfig& config);
+
+  // Start thread_id's batch and take its first chunk.
+  void StartBatch(int32_t thread_id, int32_t epoch, int32_t batch,
+      WorkChunk* chunk);
+
+  // Next chunk of thread_id's batch, or a stolen chunk of the same batch of
+  // another thread. Returns false when the batch is done.
+  bool NextChunk(int32_t thread_id, int32_t epoch, int32_t batch,
+      WorkChunk* chunk);
+
+  int32_t GetDataIdx(int32_t owner, int32_t pos) const {
+    const ThreadRange& range = ranges_[owner];
+    int32_t idx = range.data_idx_begin + pos;
+    // Wrap around to be within [data_idx_begin, data_idx_end)
+    return (idx >= range.data_idx_end) ?
+      (idx - range.data_idx_end) % (range.data_idx_end - range.data_idx_begin)
+      + range.data_idx_begin : idx;
+  }
+
+  // Chunks per batch; the unit of stealing.
+  static const int32_t kNumChunksPerBatch = 16;
+
+private:
+  struct ThreadRange {
+    int32_t data_idx_begin;
+    int32_t data_idx_end;
+    int32_t batch_size;
+    int32_t chunk_size;
+  };
+
+  // One batch of one thread.
+  struct BatchSlot {
+    BatchSlot() : epoch(-1), front(0), back(0) { }
+
+    std::mutex mtx;
+    // Epoch the owner last started this batch in.
+    int32_t epoch;
+    // Remaining positions [front, back).
+    int32_t front;
+    int32_t back;
+  };
+
+  BatchSlot& GetSlot(int32_t thread_id, int32_t batch) {
+    return slots_[thread_id * num_batches_per_epoch_ + batch];
+  }
+
+  int32_t num_threads_;
+  int32_t num_batches_per_epoch_;
+  std::vector<ThreadRange> ranges_;
+  std::unique_ptr<BatchSlot[]> slots_;
+};
 
-    // We will allow wrap-around on [data_idx_begin_, data_idx_end_)  when
-    // data points aren't divisible.
-    batch_size_ = std::ceil(static_cast<float>(data_idx_end_ - data_idx_begin_)
-        / num_batches_per_epoch);
-    CHECK_LT(0, batch_size_) << "Batch size cannot be 0. # data this thread: "
-      << (data_idx_end_ - data_idx_begin_) << " num_batches_per_epoch: "
-      << num_batches_per_epoch;
-    num_data_per_epoch_ = batch_size_ * num_batches_per_epoch;
+class WorkloadManager {
+public:
+  WorkloadManager(const WorkloadManagerConfig& config) :
+    work_stealing_pool_(config.work_stealing_pool),
+    thread_id_(config.thread_id), epoch_(0) {
+    // Each thread handles data [data_idx_begin_, data_idx_end_).
+    GetThreadDataRange(config, config.thread_id, &data_idx_begin_,
+        &data_idx_end_);
+    batch_size_ = ComputeBatchSize(data_idx_begin_, data_idx_end_,
+        config.num_batches_per_epoch);
+    num_data_per_epoch_ = batch_size_ * config.num_batches_per_epoch;
     Restart();
   }
 
@@ -76,17 +171,37 @@ public:
 
   void Restart() {
     num_data_this_epoch_ = 0;
+    ++epoch_;
+    batch_ = -1;
+    in_batch_ = false;
   }
 
   // Get a data index and advance.
   int32_t GetDataIdxAndAdvance() {
     CHECK(!IsEnd());
+    if (work_stealing_pool_ != nullptr) {
+      if (!in_batch_) {
+        work_stealing_pool_->StartBatch(thread_id_, epoch_, ++batch_,
+            &chunk_);
+        in_batch_ = true;
+      }
+      int32_t ret_idx = work_stealing_pool_->GetDataIdx(chunk_.owner,
+          chunk_.begin++);
+      ++num_data_this_epoch_;
+      if (chunk_.begin == chunk_.end) {
+        in_batch_ = work_stealing_pool_->NextChunk(thread_id_, epoch_,
+            batch_, &chunk_);
+      }
+      return ret_idx;
+    }
     int32_t ret_idx = num_data_this_epoch_++ + data_idx_begin_;
     return WrapAround(ret_idx);
   }
 
   // Get the next num_data indices without advancing.
   std::vector<int32_t> GetBatchDataIdx(int32_t num_data) const {
+    CHECK(work_stealing_pool_ == nullptr)
+      << "GetBatchDataIdx() is not supported with work stealing";
     std::vector<int32_t> result(num_data);
     for (int i = 0; i < num_data; ++i) {
       result[i] = (num_data_this_epoch_ + data_idx_begin_ + i);
@@ -98,10 +213,17 @@ public:
 
   // Is end of the data set (of this partition).
   bool IsEnd() const {
+    if (work_stealing_pool_ != nullptr) {
+      return !in_batch_ && batch_ == GetNumBatches() - 1;
+    }
     return num_data_this_epoch_ == num_data_per_epoch_;
   }
 
+  // With work stealing a batch can be more or less than GetBatchSize().
   bool IsEndOfBatch() const {
+    if (work_stealing_pool_ != nullptr) {
+      return !in_batch_;
+    }
     return num_data_this_epoch_ % batch_size_ == 0;
   }
 private:
@@ -121,6 +243,15 @@ private:
   int32_t batch_size_;
   int32_t num_data_this_epoch_;
   int32_t num_data_per_epoch_;
+
+  // Work stealing only.
+  WorkStealingPool* work_stealing_pool_;
+  int32_t thread_id_;
+  // Restart() count; the same on all threads sharing the pool.
+  int32_t epoch_;
+  int32_t batch_;
+  bool in_batch_;
+  WorkChunk chunk_;
 };
 
 
@@ -2,6 +2,8 @@
 #include <petuum_ps/client/client_table.hpp>
 #include <petuum_ps_common/util/class_register.hpp>
 #include <petuum_ps_common/util/stats.hpp>
+#include <petuum_ps_common/util/metrics.hpp>
+#include <petuum_ps_common/util/trace.hpp>
 #include <petuum_ps_common/client/client_row.hpp>
 #include <petuum_ps_common/storage/bounded_dense_process_storage.hpp>
 #include <petuum_ps_common/storage/bounded_sparse_process_storage.hpp>
@@ -29,7 +31,8 @@ ClientTable::ClientTable(int32_t table_id, const ClientTableConfig &config):
     sample_row_(ClassRegistry<AbstractRow>::GetRegistry().CreateObject(
         row_type_)),
     oplog_index_(std::ceil(static_cast<float>(config.oplog_capacity)
-                           / GlobalContext::get_num_comm_channels_per_client())),
+                           / GlobalContext::get_num_comm_channels_per_client()),
+                 table_id),
     staleness_(config.table_info.table_staleness),
     oplog_dense_serialized_(config.table_info.oplog_dense_serialized),
     client_table_config_(config),
@@ -39,7 +42,22 @@ ClientTable::ClientTable(int32_t table_id, const ClientTableConfig &config):
     dense_row_oplog_capacity_(config.table_info.dense_row_oplog_capacity),
     append_only_oplog_type_(config.append_only_oplog_type),
     row_capacity_(config.table_info.row_capacity),
-    no_oplog_replay_(config.no_oplog_replay) {
+    no_oplog_replay_(config.no_oplog_replay),
+    col_segment_size_(config.col_segment_size),
+    num_col_segments_(0) {
+  if (col_segment_size_ > 0) {
+    CHECK_EQ(GlobalContext::get_consistency_model(), SSP)
+        << "Column-segmented rows require SSP, table " << table_id_;
+    CHECK(oplog_type_ == Sparse || oplog_type_ == Dense)
+        << "Column-segmented rows require a Sparse or Dense oplog, table "
+        << table_id_;
+    CHECK(!no_oplog_replay_)
+        << "Column-segmented rows require oplog replay, table " << table_id_;
+    CHECK_GT(row_capacity_, 0) << "table " << table_id_;
+    num_col_segments_ = (row_capacity_ + col_segment_size_ - 1)
+                        / col_segment_size_;
+  }
+
   switch (config.process_storage_type) {
     case BoundedDense:
       {
@@ -148,9 +166,15 @@ ClientTable::ClientTable(int32_t table_id, const ClientTableConfig &config):
       LOG(FATAL) << "Not yet support consistency model "
                  << GlobalContext::get_consistency_model();
   }
+  // All consistency controllers above are SSP ones.
+  table_staleness_ = &static_cast<SSPConsistencyController*>(
+      consistency_controller_)->get_table_staleness();
 }
 
 ClientTable::~ClientTable() {
+  // The calling thread's cache may still hold references to rows of
+  // process_storage_ (copy-on-write mode), so release it first.
+  thread_cache_.reset();
   delete consistency_controller_;
   delete sample_row_;
   delete oplog_;
@@ -158,10 +182,16 @@ ClientTable::~ClientTable() {
 }
 
 void ClientTable::RegisterThread() {
-  if (thread_cache_.get() == 0)
+  if (thread_cache_.get() == 0) {
+    // Pinned rows cannot be evicted. Split the process cache among the app
+    // threads and keep one share free for rows the bg thread inserts.
+    size_t max_shared_rows = client_table_config_.process_cache_capacity
+        / (GlobalContext::get_num_app_threads() + 1);
     thread_cache_.reset(new ThreadTable(
         sample_row_, client_table_config_.table_info.row_oplog_type,
-        client_table_config_.table_info.row_capacity));
+        client_table_config_.table_info.row_capacity,
+        client_table_config_.thread_cache_cow, max_shared_rows));
+  }
 
   oplog_->RegisterThread();
 }
@@ -203,20 +233,28 @@ void ClientTable::FlushThreadCache() {
 }
 
 ClientRow *ClientTable::Get(int32_t row_id, RowAccessor *row_accessor) {
+  TraceScope trace_scope(kTraceAppGet, table_id_, row_id);
   return consistency_controller_->Get(row_id, row_accessor);
 }
 
 void ClientTable::Inc(int32_t row_id, int32_t column_id, const void *update) {
   STATS_APP_SAMPLE_INC_BEGIN(table_id_);
+  TraceScope trace_scope(kTraceAppInc, table_id_, row_id);
   consistency_controller_->Inc(row_id, column_id, update);
+  Metrics::Add(kMetricAppInc);
   STATS_APP_SAMPLE_INC_END(table_id_);
 }
 
 void ClientTable::BatchInc(int32_t row_id, const int32_t* column_ids,
   const void* updates, int32_t num_updates) {
   STATS_APP_SAMPLE_BATCH_INC_BEGIN(table_id_);
+  TraceScope trace_scope(kTraceAppBatchInc, table_id_, row_id);
+  if (trace_scope.enabled()) {
+    trace_scope.set_bytes(num_updates * sample_row_->get_update_size());
+  }
   consistency_controller_->BatchInc(row_id, column_ids, updates,
                                     num_updates);
+  Metrics::Add(kMetricAppBatchInc);
   STATS_APP_SAMPLE_BATCH_INC_END(table_id_);
 }
 
@@ -224,8 +262,13 @@ void ClientTable::DenseBatchInc(
     int32_t row_id, const void *updates, int32_t index_st,
     int32_t num_updates) {
   STATS_APP_SAMPLE_BATCH_INC_BEGIN(table_id_);
+  TraceScope trace_scope(kTraceAppBatchInc, table_id_, row_id);
+  if (trace_scope.enabled()) {
+    trace_scope.set_bytes(num_updates * sample_row_->get_update_size());
+  }
   consistency_controller_->DenseBatchInc(row_id, updates, index_st,
                                          num_updates);
+  Metrics::Add(kMetricAppBatchInc);
   STATS_APP_SAMPLE_BATCH_INC_END(table_id_);
 }
 
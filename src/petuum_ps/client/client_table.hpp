@@ -12,6 +12,7 @@
 #include <petuum_ps/oplog/abstract_oplog.hpp>
 #include <petuum_ps/oplog/oplog_index.hpp>
 #include <petuum_ps/client/thread_table.hpp>
+#include <petuum_ps/consistency/table_staleness.hpp>
 
 #include <boost/thread/tss.hpp>
 
@@ -69,6 +70,11 @@ public:
     return staleness_;
   }
 
+  // Current bound; differs from get_staleness() for adaptive tables.
+  TableStaleness &get_table_staleness() {
+    return *table_staleness_;
+  }
+
   bool oplog_dense_serialized() const {
     return oplog_dense_serialized_;
   }
@@ -97,6 +103,19 @@ public:
     return no_oplog_replay_;
   }
 
+  size_t get_row_capacity() const {
+    return row_capacity_;
+  }
+
+  // 0 if rows are not column-segmented.
+  size_t get_col_segment_size() const {
+    return col_segment_size_;
+  }
+
+  int32_t get_num_col_segments() const {
+    return num_col_segments_;
+  }
+
 private:
   const int32_t table_id_;
   const int32_t row_type_;
@@ -104,6 +123,8 @@ private:
   AbstractOpLog *oplog_;
   AbstractProcessStorage *process_storage_;
   AbstractConsistencyController *consistency_controller_;
+  // Owned by consistency_controller_.
+  TableStaleness *table_staleness_;
 
   boost::thread_specific_ptr<ThreadTable> thread_cache_;
   TableOpLogIndex oplog_index_;
@@ -124,6 +145,9 @@ private:
   ClientRow *CreateSSPClientRow(int32_t clock);
 
   const bool no_oplog_replay_;
+
+  const size_t col_segment_size_;
+  int32_t num_col_segments_;
 };
 
 }  // namespace petuum
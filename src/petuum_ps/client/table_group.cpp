@@ -1,9 +1,12 @@
 #include <petuum_ps_common/util/stats.hpp>
+#include <petuum_ps_common/util/metrics.hpp>
+#include <petuum_ps_common/util/trace.hpp>
 #include <petuum_ps/client/table_group.hpp>
 #include <petuum_ps/thread/context.hpp>
 #include <petuum_ps/server/server_threads.hpp>
 #include <petuum_ps/server/name_node.hpp>
 #include <petuum_ps/thread/bg_workers.hpp>
+#include <petuum_ps/oplog/oplog_index.hpp>
 #include <sstream>
 #include <iostream>
 #include <algorithm>
@@ -30,9 +33,15 @@ TableGroup::TableGroup(const TableGroupConfig &table_group_config,
   int32_t local_id_min = GlobalContext::get_thread_id_min(client_id);
   int32_t local_id_max = GlobalContext::get_thread_id_max(client_id);
   num_app_threads_registered_ = 1;  // init thread is the first one
+  // The head bg thread reports every staleness_adapt_interval clocks, with
+  // or without adaptive tables.
+  CHECK_GT(table_group_config.staleness_adapt_interval, 0);
 
   STATS_INIT(table_group_config);
   STATS_REGISTER_THREAD(kAppThread);
+  Trace::Init(table_group_config);
+  Metrics::Init(table_group_config);
+  Trace::RegisterThread("app");
 
   // can be Inited after CommBus but must be before everything else
   GlobalContext::Init(
@@ -58,7 +67,14 @@ TableGroup::TableGroup(const TableGroupConfig &table_group_config,
       table_group_config.thread_oplog_batch_size,
       table_group_config.server_push_row_threshold,
       table_group_config.server_idle_milli,
-      table_group_config.server_row_candidate_factor);
+      table_group_config.server_row_candidate_factor,
+      table_group_config.host_oplog_aggr,
+      table_group_config.staleness_adapt_interval);
+
+  // SSPAggr bg threads pick the oplogs to send by their own policy and read
+  // every table's oplog index.
+  if (consistency_model != SSPAggr)
+    DirtyOpLogTables::Init(num_comm_channels_per_client);
 
   CommBus *comm_bus = new CommBus(local_id_min, local_id_max,
                                   num_total_clients, 1);
@@ -106,14 +122,22 @@ TableGroup::~TableGroup() {
   for(auto iter = tables_.begin(); iter != tables_.end(); iter++){
     delete iter->second;
   }
+  DirtyOpLogTables::ShutDown();
+  Metrics::ShutDown();
   STATS_DEREGISTER_THREAD();
   STATS_PRINT();
+  Trace::Dump();
 }
 
 bool TableGroup::CreateTable(int32_t table_id,
   const ClientTableConfig& table_config) {
+  const TableInfo &table_info = table_config.table_info;
   max_table_staleness_ = std::max(max_table_staleness_,
-      table_config.table_info.table_staleness);
+                                  table_info.table_staleness);
+  if (table_info.adaptive_staleness_max > table_info.adaptive_staleness_min) {
+    max_table_staleness_ = std::max(max_table_staleness_,
+                                    table_info.adaptive_staleness_max);
+  }
 
   bool suc = BgWorkers::CreateTable(table_id, table_config);
   if (suc
@@ -140,6 +164,7 @@ void TableGroup::WaitThreadRegister() {
 
 int32_t TableGroup::RegisterThread() {
   STATS_REGISTER_THREAD(kAppThread);
+  Trace::RegisterThread("app");
   int app_thread_id_offset = num_app_threads_registered_++;
 
   int32_t thread_id = GlobalContext::get_local_id_min()
@@ -177,8 +202,11 @@ void TableGroup::DeregisterThread(){
 
 void TableGroup::Clock() {
   STATS_APP_ACCUM_TG_CLOCK_BEGIN();
+  TraceScope trace_scope(kTraceAppClock);
   ThreadContext::Clock();
   (this->*ClockInternal)();
+  Trace::SetClock(ThreadContext::get_clock());
+  Metrics::Add(kMetricAppClock);
   STATS_APP_ACCUM_TG_CLOCK_END();
 }
 
@@ -188,6 +216,10 @@ void TableGroup::GlobalBarrier() {
   }
 }
 
+void TableGroup::ReportProgress(double progress) {
+  TableStaleness::ReportProgress(progress);
+}
+
 void TableGroup::ClockAggressive() {
   for (auto table_iter = tables_.cbegin(); table_iter != tables_.cend();
     table_iter++) {
@@ -46,6 +46,8 @@ public:
 
   void GlobalBarrier();
 
+  void ReportProgress(double progress);
+
 private:
   typedef void (TableGroup::*ClockFunc) ();
   ClockFunc ClockInternal;
@@ -57,7 +59,7 @@ private:
   pthread_barrier_t register_barrier_;
   std::atomic<int> num_app_threads_registered_;
 
-  // Max staleness among all tables.
+  // Max staleness among all tables, including adaptive bounds.
   int32_t max_table_staleness_;
   VectorClockMT vector_clock_;
 };
@@ -12,24 +12,24 @@ namespace petuum {
 
 ThreadTable::ThreadTable(
     const AbstractRow *sample_row, int32_t row_oplog_type,
-    size_t dense_row_oplog_capacity) :
+    size_t dense_row_oplog_capacity, bool cow, size_t max_shared_rows) :
     oplog_index_(GlobalContext::get_num_comm_channels_per_client()),
     sample_row_(sample_row),
+    cow_(cow),
+    max_shared_rows_(max_shared_rows),
+    dense_batch_(row_oplog_type == RowOpLogType::kDenseRowOpLog
+                 && OpLogUpdater::IsTypedDenseRow(sample_row)),
     update_count_(0),
-    dense_row_oplog_capacity_(dense_row_oplog_capacity) {
+    dense_row_oplog_capacity_(dense_row_oplog_capacity),
+    oplog_updater_(OpLogUpdater::Create(sample_row, row_oplog_type)) {
 
   ApplyThreadOpLog_ = &ThreadTable::ApplyThreadOpLogSSP;
 
   if (GlobalContext::get_consistency_model() == SSPAggr) {
     UpdateOpLogClock_ = UpdateOpLogClockSSPAggr;
 
-    if (row_oplog_type == RowOpLogType::kDenseRowOpLog) {
-      CreateRowOpLog_ = CreateRowOpLog::CreateDenseMetaRowOpLog;
-    } else if (row_oplog_type == RowOpLogType::kSparseRowOpLog) {
-      CreateRowOpLog_ = CreateRowOpLog::CreateSparseMetaRowOpLog;
-    } else {
-      CreateRowOpLog_ = CreateRowOpLog::CreateSparseVectorMetaRowOpLog;
-    }
+    CreateRowOpLog_ = CreateRowOpLog::GetCreateRowOpLogFunc(
+        row_oplog_type, true);
 
     if (GlobalContext::get_update_sort_policy() == RelativeMagnitude
         || GlobalContext::get_update_sort_policy() == FIFO_N_ReMag) {
@@ -37,20 +37,13 @@ ThreadTable::ThreadTable(
     }
   } else {
     UpdateOpLogClock_ = UpdateOpLogClockNoOp;
-    if (row_oplog_type == RowOpLogType::kDenseRowOpLog)
-      CreateRowOpLog_ = CreateRowOpLog::CreateDenseRowOpLog;
-    else if (row_oplog_type == RowOpLogType::kSparseRowOpLog)
-      CreateRowOpLog_ = CreateRowOpLog::CreateSparseRowOpLog;
-    else
-      CreateRowOpLog_ = CreateRowOpLog::CreateSparseVectorRowOpLog;
+    CreateRowOpLog_ = CreateRowOpLog::GetCreateRowOpLogFunc(
+        row_oplog_type, false);
   }
 }
 
 ThreadTable::~ThreadTable() {
-  for (auto iter = row_storage_.begin(); iter != row_storage_.end(); iter++) {
-    if (iter->second != 0)
-      delete iter->second;
-  }
+  ClearRows();
 
   for (auto iter = oplog_map_.begin(); iter != oplog_map_.end(); iter++) {
     if (iter->second != 0)
@@ -98,14 +91,54 @@ void ThreadTable::FlushOpLogIndex(TableOpLogIndex &table_oplog_index) {
 AbstractRow *ThreadTable::GetRow(int32_t row_id) {
   boost::unordered_map<int32_t, AbstractRow* >::iterator row_iter
       = row_storage_.find(row_id);
-  if (row_iter == row_storage_.end()) {
+  if (row_iter != row_storage_.end()) {
+    return row_iter->second;
+  }
+  if (!cow_) {
     return 0;
   }
-  return row_iter->second;
+
+  auto shared_iter = shared_rows_.find(row_id);
+  if (shared_iter == shared_rows_.end()) {
+    return 0;
+  }
+  AbstractRow *shared_row = shared_iter->second->GetRowDataPtr();
+  auto oplog_iter = oplog_map_.find(row_id);
+  if (oplog_iter == oplog_map_.end()) {
+    return shared_row;
+  }
+
+  // Written by this thread; copy so it can see its own updates.
+  AbstractRow *row = shared_row->Clone();
+  ApplyRowOpLogUnsafe(oplog_iter->second, row);
+  row_storage_[row_id] = row;
+  return row;
 }
 
-void ThreadTable::InsertRow(int32_t row_id, const AbstractRow *to_insert) {
-  AbstractRow *row = to_insert->Clone();
+void ThreadTable::InsertRow(int32_t row_id, ClientRow *client_row) {
+  if (cow_) {
+    auto shared_iter = shared_rows_.find(row_id);
+    if (shared_iter != shared_rows_.end()) {
+      client_row->IncRef();
+      shared_iter->second->DecRef();
+      shared_iter->second = client_row;
+      return;
+    }
+    if (shared_rows_.size() < max_shared_rows_) {
+      client_row->IncRef();
+      shared_rows_[row_id] = client_row;
+
+      auto row_iter = row_storage_.find(row_id);
+      if (row_iter != row_storage_.end()) {
+        delete row_iter->second;
+        row_storage_.erase(row_iter);
+      }
+      return;
+    }
+    // Pin limit reached; fall back to a private clone.
+  }
+
+  AbstractRow *row = client_row->GetRowDataPtr()->Clone();
   boost::unordered_map<int32_t, AbstractRow* >::iterator row_iter
       = row_storage_.find(row_id);
   if (row_iter != row_storage_.end()) {
@@ -118,13 +151,50 @@ void ThreadTable::InsertRow(int32_t row_id, const AbstractRow *to_insert) {
   boost::unordered_map<int32_t, AbstractRowOpLog* >::iterator oplog_iter
       = oplog_map_.find(row_id);
   if (oplog_iter != oplog_map_.end()) {
-    int32_t column_id;
-    void *delta = oplog_iter->second->BeginIterate(&column_id);
-    while (delta != 0) {
-      row->ApplyInc(column_id, delta);
-      delta = oplog_iter->second->Next(&column_id);
+    ApplyRowOpLogUnsafe(oplog_iter->second, row);
+  }
+}
+
+int32_t ThreadTable::GatherUpdates(AbstractRowOpLog *row_oplog) {
+  size_t update_size = sample_row_->get_update_size();
+  batch_column_ids_.clear();
+  batch_updates_.clear();
+
+  int32_t column_id;
+  const uint8_t *delta
+      = reinterpret_cast<const uint8_t*>(row_oplog->BeginIterate(&column_id));
+  while (delta != 0) {
+    batch_column_ids_.push_back(column_id);
+    batch_updates_.insert(batch_updates_.end(), delta, delta + update_size);
+    delta = reinterpret_cast<const uint8_t*>(row_oplog->Next(&column_id));
+  }
+  return batch_column_ids_.size();
+}
+
+void ThreadTable::ApplyRowOpLogUnsafe(AbstractRowOpLog *row_oplog,
+                                      AbstractRow *row) {
+  if (dense_batch_) {
+    row->ApplyDenseBatchIncUnsafe(row_oplog->FindCreate(0), 0,
+                                  row_oplog->GetSize());
+    return;
+  }
+  int32_t num_updates = GatherUpdates(row_oplog);
+  row->ApplyBatchIncUnsafe(batch_column_ids_.data(), batch_updates_.data(),
+                           num_updates);
+}
+
+void ThreadTable::ClearRows() {
+  for (auto iter = row_storage_.begin(); iter != row_storage_.end(); iter++) {
+    if (iter->second != 0) {
+      delete iter->second;
     }
   }
+  row_storage_.clear();
+
+  for (auto iter = shared_rows_.begin(); iter != shared_rows_.end(); iter++) {
+    iter->second->DecRef();
+  }
+  shared_rows_.clear();
 }
 
 // The assumption is that thread oplog will be flushed every clock, so we only
@@ -164,13 +234,7 @@ void ThreadTable::BatchInc(int32_t row_id, const int32_t *column_ids,
     row_oplog = oplog_iter->second;
   }
 
-  const uint8_t* deltas_uint8 = reinterpret_cast<const uint8_t*>(deltas);
-
-  for (int i = 0; i < num_updates; ++i) {
-    void *oplog_delta = row_oplog->FindCreate(column_ids[i]);
-    sample_row_->AddUpdates(column_ids[i], oplog_delta, deltas_uint8
-                            + sample_row_->get_update_size()*i);
-  }
+  oplog_updater_->BatchInc(row_oplog, column_ids, deltas, num_updates);
 
   auto row_iter = row_storage_.find(row_id);
   if (row_iter != row_storage_.end()) {
@@ -189,13 +253,7 @@ void ThreadTable::DenseBatchInc(int32_t row_id, const void *updates,
     row_oplog->OverwriteWithDenseUpdate(updates, index_st, num_updates);
   } else {
     row_oplog = oplog_iter->second;
-    const uint8_t* updates_uint8 = reinterpret_cast<const uint8_t*>(updates);
-    for (int i = 0; i < num_updates; ++i) {
-      int32_t col_id = i + index_st;
-      void *oplog_update = row_oplog->FindCreate(col_id);
-      sample_row_->AddUpdates(col_id, oplog_update, updates_uint8
-                              + sample_row_->get_update_size()*i);
-    }
+    oplog_updater_->DenseBatchInc(row_oplog, updates, index_st, num_updates);
   }
 
   auto row_iter = row_storage_.find(row_id);
@@ -208,13 +266,7 @@ void ThreadTable::FlushCache(AbstractProcessStorage &process_storage,
                              AbstractOpLog &table_oplog,
 			     const AbstractRow *sample_row) {
   FlushCacheOpLog(process_storage, table_oplog, sample_row);
-
-  for (auto iter = row_storage_.begin(); iter != row_storage_.end(); iter++) {
-    if (iter->second != 0) {
-      delete iter->second;
-    }
-  }
-  row_storage_.clear();
+  ClearRows();
 }
 
 void ThreadTable::FlushCacheOpLog(AbstractProcessStorage &process_storage,
@@ -244,19 +296,30 @@ void ThreadTable::ApplyThreadOpLogSSP(
 
   int32_t partition_num = GlobalContext::GetPartitionCommChannelIndex(row_id);
 
-  int32_t column_id;
-  void *delta = row_oplog->BeginIterate(&column_id);
-  while (delta != 0) {
-    void *oplog_delta = oplog_accessor->get_row_oplog()->FindCreate(column_id);
-    sample_row_->AddUpdates(column_id, oplog_delta, delta);
-
-    oplog_index_[partition_num].insert(row_id);
+  // One batch per row: the typed updater for the table oplog and a single
+  // row lock for process storage.
+  if (dense_batch_) {
+    const void *updates = row_oplog->FindCreate(0);
+    int32_t num_updates = row_oplog->GetSize();
+    oplog_updater_->DenseBatchInc(oplog_accessor->get_row_oplog(), updates, 0,
+                                  num_updates);
     if (row_found) {
-      row_accessor->GetRowData()->ApplyInc(column_id, delta);
+      row_accessor->GetRowData()->ApplyDenseBatchInc(updates, 0, num_updates);
+    }
+  } else {
+    int32_t num_updates = GatherUpdates(row_oplog);
+    if (num_updates == 0) {
+      return;
+    }
+    oplog_updater_->BatchInc(oplog_accessor->get_row_oplog(),
+                             batch_column_ids_.data(), batch_updates_.data(),
+                             num_updates);
+    if (row_found) {
+      row_accessor->GetRowData()->ApplyBatchInc(
+          batch_column_ids_.data(), batch_updates_.data(), num_updates);
     }
-
-    delta = row_oplog->Next(&column_id);
   }
+  oplog_index_[partition_num].insert(row_id);
 }
 
 void ThreadTable::ApplyThreadOpLogGetImportance(
@@ -1,29 +1,44 @@
 #pragma once
 
+#include <memory>
 #include <unordered_set>
 #include <vector>
 #include <boost/noncopyable.hpp>
 
 #include <petuum_ps_common/include/abstract_row.hpp>
+#include <petuum_ps_common/client/client_row.hpp>
 #include <petuum_ps_common/storage/abstract_process_storage.hpp>
 #include <petuum_ps_common/include/configs.hpp>
 
 #include <petuum_ps/oplog/oplog_index.hpp>
 #include <petuum_ps/oplog/abstract_oplog.hpp>
 #include <petuum_ps/oplog/create_row_oplog.hpp>
+#include <petuum_ps/oplog/oplog_updater.hpp>
 
 namespace petuum {
 
+// Per-thread row cache and oplog for ThreadGet()/ThreadInc(), flushed on
+// Clock().
+//
+// By default each row a thread reads is cloned into the cache and the
+// thread's updates are applied to both the clone and the thread oplog. With
+// cow set the cache instead pins the shared process storage row and hands
+// it out as is; only when a thread reads a row it has updated in this clock
+// is the row cloned and the thread oplog merged into the clone. Like Get(),
+// a shared row may reflect server updates that arrive during the clock.
+// At most max_shared_rows rows are pinned per clock; rows read past that are
+// cloned, so pinned rows never fill a bounded process storage.
 class ThreadTable : boost::noncopyable {
 public:
   explicit ThreadTable(const AbstractRow *sample_row, int32_t row_oplog_type,
-                       size_t dense_row_oplog_capacity);
+                       size_t dense_row_oplog_capacity, bool cow = false,
+                       size_t max_shared_rows = 0);
   ~ThreadTable();
   void IndexUpdate(int32_t row_id);
   void FlushOpLogIndex(TableOpLogIndex &oplog_index);
 
   AbstractRow *GetRow(int32_t row_id);
-  void InsertRow(int32_t row_id, const AbstractRow *to_insert);
+  void InsertRow(int32_t row_id, ClientRow *client_row);
   void Inc(int32_t row_id, int32_t column_id, const void *delta);
   void BatchInc(int32_t row_id, const int32_t *column_ids,
                 const void *deltas, int32_t num_updates);
@@ -49,7 +64,14 @@ private:
   std::vector<std::unordered_set<int32_t> > oplog_index_;
   boost::unordered_map<int32_t, AbstractRow* > row_storage_;
   boost::unordered_map<int32_t, AbstractRowOpLog* > oplog_map_;
+  // cow only; each holds a reference.
+  boost::unordered_map<int32_t, ClientRow* > shared_rows_;
   const AbstractRow *sample_row_;
+  const bool cow_;
+  const size_t max_shared_rows_;
+  // Thread oplogs are DenseRowOpLogs of a DenseRow, so they are applied as
+  // one dense batch over the oplog buffer.
+  const bool dense_batch_;
 
   size_t update_count_;
 
@@ -62,6 +84,18 @@ private:
   UpdateOpLogClockFunc UpdateOpLogClock_;
 
   CreateRowOpLog::CreateRowOpLogFunc CreateRowOpLog_;
+  std::unique_ptr<OpLogUpdater> oplog_updater_;
+
+  // Scratch space for GatherUpdates().
+  std::vector<int32_t> batch_column_ids_;
+  std::vector<uint8_t> batch_updates_;
+
+  // Copies the updates of row_oplog into batch_column_ids_ and
+  // batch_updates_; returns the number of updates.
+  int32_t GatherUpdates(AbstractRowOpLog *row_oplog);
+  // Applies row_oplog to a row private to this thread.
+  void ApplyRowOpLogUnsafe(AbstractRowOpLog *row_oplog, AbstractRow *row);
+  void ClearRows();
 
   void ApplyThreadOpLogSSP(
       OpLogAccessor *oplog_accessor, RowAccessor *row_accessor, bool row_found,
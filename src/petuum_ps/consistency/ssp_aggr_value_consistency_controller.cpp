@@ -57,14 +57,8 @@ void SSPAggrValueConsistencyController::BatchInc(int32_t row_id,
   OpLogAccessor oplog_accessor;
   oplog_.FindInsertOpLog(row_id, &oplog_accessor);
 
-  const uint8_t* deltas_uint8 = reinterpret_cast<const uint8_t*>(updates);
-
-  for (int i = 0; i < num_updates; ++i) {
-    void *oplog_delta
-        = oplog_accessor.get_row_oplog()->FindCreate(column_ids[i]);
-    sample_row_->AddUpdates(column_ids[i], oplog_delta, deltas_uint8
-			    + sample_row_->get_update_size()*i);
-  }
+  oplog_updater_->BatchInc(oplog_accessor.get_row_oplog(), column_ids,
+                           updates, num_updates);
   MetaRowOpLog *meta_row_oplog
       = dynamic_cast<MetaRowOpLog*>(oplog_accessor.get_row_oplog());
   meta_row_oplog->GetMeta().set_clock(ThreadContext::get_clock());
@@ -97,14 +91,9 @@ void SSPAggrValueConsistencyController::DenseBatchInc(
     oplog_accessor.get_row_oplog()->OverwriteWithDenseUpdate(
         updates, index_st, num_updates);
   } else {
-      const uint8_t* deltas_uint8 = reinterpret_cast<const uint8_t*>(updates);
-      for (int i = 0; i < num_updates; ++i) {
-        int32_t col_id = i + index_st;
-        void *oplog_delta = oplog_accessor.get_row_oplog()->FindCreate(col_id);
-        sample_row_->AddUpdates(col_id, oplog_delta, deltas_uint8
-                                + sample_row_->get_update_size()*i);
-      }
-    }
+    oplog_updater_->DenseBatchInc(oplog_accessor.get_row_oplog(), updates,
+                                  index_st, num_updates);
+  }
   MetaRowOpLog *meta_row_oplog
       = dynamic_cast<MetaRowOpLog*>(oplog_accessor.get_row_oplog());
   meta_row_oplog->GetMeta().set_clock(ThreadContext::get_clock());
@@ -3,6 +3,8 @@
 #include <petuum_ps/thread/context.hpp>
 #include <petuum_ps/thread/bg_workers.hpp>
 #include <petuum_ps_common/util/stats.hpp>
+#include <petuum_ps_common/util/metrics.hpp>
+#include <petuum_ps_common/util/trace.hpp>
 #include <glog/logging.h>
 #include <algorithm>
 
@@ -19,25 +21,18 @@ SSPConsistencyController::SSPConsistencyController(
     int32_t row_oplog_type) :
   AbstractConsistencyController(table_id, process_storage,
     sample_row),
-  staleness_(info.table_staleness),
+  staleness_(info),
   thread_cache_(thread_cache),
   oplog_index_(oplog_index),
-  oplog_(oplog) {
-  AddUpdates_ = std::bind(&AbstractRow::AddUpdates,
-                          sample_row_, std::placeholders::_1,
-                          std::placeholders::_2, std::placeholders::_3);
-  if (row_oplog_type == RowOpLogType::kDenseRowOpLog) {
-    DenseBatchIncOpLog_ = &SSPConsistencyController::DenseBatchIncDenseOpLog;
-  } else {
-    DenseBatchIncOpLog_ = &SSPConsistencyController::DenseBatchIncNonDenseOpLog;
-  }
-}
+  oplog_(oplog),
+  oplog_updater_(OpLogUpdater::Create(sample_row, row_oplog_type)) { }
 
 ClientRow *SSPConsistencyController::Get(int32_t row_id, RowAccessor* row_accessor) {
   STATS_APP_SAMPLE_SSP_GET_BEGIN(table_id_);
 
   // Look for row_id in process_storage_.
-  int32_t stalest_clock = std::max(0, ThreadContext::get_clock() - staleness_);
+  int32_t stalest_clock = std::max(0, ThreadContext::get_clock()
+      - staleness_.Get(ThreadContext::get_clock()));
 
   ClientRow *client_row = process_storage_.Find(row_id, row_accessor);
 
@@ -45,6 +40,9 @@ ClientRow *SSPConsistencyController::Get(int32_t row_id, RowAccessor* row_access
     // Found it! Check staleness.
     int32_t clock = client_row->GetClock();
     if (clock >= stalest_clock) {
+      STATS_APP_ACCUM_GET_STALENESS(table_id_,
+                                    ThreadContext::get_clock() - clock, true);
+      Metrics::Add(kMetricAppGet);
       STATS_APP_SAMPLE_SSP_GET_END(table_id_, true);
       return client_row;
     }
@@ -52,10 +50,14 @@ ClientRow *SSPConsistencyController::Get(int32_t row_id, RowAccessor* row_access
 
   // Didn't find row_id that's fresh enough in process_storage_.
   // Fetch from server.
+  BlockedGetTimer blocked_get_timer(staleness_);
   int32_t num_fetches = 0;
   do {
     STATS_APP_ACCUM_SSP_GET_SERVER_FETCH_BEGIN(table_id_);
-    BgWorkers::RequestRow(table_id_, row_id, stalest_clock);
+    {
+      TraceScope trace_scope(kTraceAppGetServerFetch, table_id_, row_id);
+      BgWorkers::RequestRow(table_id_, row_id, stalest_clock);
+    }
     STATS_APP_ACCUM_SSP_GET_SERVER_FETCH_END(table_id_);
 
     // fetch again
@@ -69,6 +71,10 @@ ClientRow *SSPConsistencyController::Get(int32_t row_id, RowAccessor* row_access
   }while(client_row == 0);
 
   CHECK_GE(client_row->GetClock(), stalest_clock);
+  STATS_APP_ACCUM_GET_STALENESS(table_id_,
+      ThreadContext::get_clock() - client_row->GetClock(), false);
+  Metrics::Add(kMetricAppGet);
+  Metrics::Add(kMetricAppGetMiss);
   STATS_APP_SAMPLE_SSP_GET_END(table_id_, false);
 
   return client_row;
@@ -100,14 +106,8 @@ void SSPConsistencyController::BatchInc(int32_t row_id,
   OpLogAccessor oplog_accessor;
   oplog_.FindInsertOpLog(row_id, &oplog_accessor);
 
-  const uint8_t* deltas_uint8 = reinterpret_cast<const uint8_t*>(updates);
-
-  for (int i = 0; i < num_updates; ++i) {
-    void *oplog_delta
-        = oplog_accessor.get_row_oplog()->FindCreate(column_ids[i]);
-    sample_row_->AddUpdates(column_ids[i], oplog_delta, deltas_uint8
-			    + sample_row_->get_update_size()*i);
-  }
+  oplog_updater_->BatchInc(oplog_accessor.get_row_oplog(), column_ids,
+                           updates, num_updates);
   STATS_APP_SAMPLE_BATCH_INC_OPLOG_END();
 
   STATS_APP_SAMPLE_BATCH_INC_PROCESS_STORAGE_BEGIN();
@@ -133,9 +133,8 @@ void SSPConsistencyController::DenseBatchInc(
     oplog_accessor.get_row_oplog()->OverwriteWithDenseUpdate(
         updates, index_st, num_updates);
   } else {
-    const uint8_t* deltas_uint8 = reinterpret_cast<const uint8_t*>(updates);
-    (this->*DenseBatchIncOpLog_)(&oplog_accessor, deltas_uint8,
-                                 index_st, num_updates);
+    oplog_updater_->DenseBatchInc(oplog_accessor.get_row_oplog(), updates,
+                                  index_st, num_updates);
   }
   STATS_APP_SAMPLE_BATCH_INC_OPLOG_END();
 
@@ -149,31 +148,6 @@ void SSPConsistencyController::DenseBatchInc(
   STATS_APP_SAMPLE_BATCH_INC_PROCESS_STORAGE_END();
 }
 
-void SSPConsistencyController::DenseBatchIncDenseOpLog(
-    OpLogAccessor *oplog_accessor, const uint8_t *updates,
-    int32_t index_st, int32_t num_updates) {
-  size_t update_size = sample_row_->get_update_size();
-  uint8_t *oplog_delta = reinterpret_cast<uint8_t*>(
-      oplog_accessor->get_row_oplog()->FindCreate(index_st));
-  for (int i = 0; i < num_updates; ++i) {
-    int32_t col_id = i + index_st;
-    AddUpdates_(col_id, oplog_delta, updates + update_size*i);
-    oplog_delta += update_size;
-  }
-}
-
-void SSPConsistencyController::DenseBatchIncNonDenseOpLog(
-    OpLogAccessor *oplog_accessor, const uint8_t *updates,
-    int32_t index_st, int32_t num_updates) {
-  size_t update_size = sample_row_->get_update_size();
-  for (int i = 0; i < num_updates; ++i) {
-    int32_t col_id = i + index_st;
-    void *oplog_delta
-        = oplog_accessor->get_row_oplog()->FindCreate(col_id);
-    sample_row_->AddUpdates(col_id, oplog_delta, updates + update_size*i);
-  }
-}
-
 void SSPConsistencyController::ThreadGet(int32_t row_id,
   ThreadRowAccessor* row_accessor) {
   STATS_APP_SAMPLE_THREAD_GET_BEGIN(table_id_);
@@ -186,16 +160,19 @@ void SSPConsistencyController::ThreadGet(int32_t row_id,
   RowAccessor process_row_accessor;
   ClientRow *client_row = process_storage_.Find(row_id, &process_row_accessor);
 
-  int32_t stalest_clock = std::max(0, ThreadContext::get_clock() - staleness_);
+  int32_t stalest_clock = std::max(0, ThreadContext::get_clock()
+      - staleness_.Get(ThreadContext::get_clock()));
   if (client_row != 0) {
     // Found it! Check staleness.
     int32_t clock = client_row->GetClock();
     if (clock >= stalest_clock) {
-      AbstractRow *tmp_row_data = process_row_accessor.GetRowData();
-      thread_cache_->InsertRow(row_id, tmp_row_data);
+      STATS_APP_ACCUM_GET_STALENESS(table_id_,
+                                    ThreadContext::get_clock() - clock, true);
+      thread_cache_->InsertRow(row_id, client_row);
       row_data = thread_cache_->GetRow(row_id);
       CHECK(row_data != 0);
       row_accessor->row_data_ptr_ = row_data;
+      Metrics::Add(kMetricAppThreadGet);
       STATS_APP_SAMPLE_THREAD_GET_END(table_id_);
       return;
     }
@@ -203,6 +180,7 @@ void SSPConsistencyController::ThreadGet(int32_t row_id,
 
   // Didn't find row_id that's fresh enough in process_storage_.
   // Fetch from server.
+  BlockedGetTimer blocked_get_timer(staleness_);
   int32_t num_fetches = 0;
   do {
     BgWorkers::RequestRow(table_id_, row_id, stalest_clock);
@@ -218,12 +196,14 @@ void SSPConsistencyController::ThreadGet(int32_t row_id,
   } while(client_row == 0);
 
   CHECK_GE(client_row->GetClock(), stalest_clock);
+  STATS_APP_ACCUM_GET_STALENESS(table_id_,
+      ThreadContext::get_clock() - client_row->GetClock(), false);
 
-  AbstractRow *tmp_row_data = client_row->GetRowDataPtr();
-  thread_cache_->InsertRow(row_id, tmp_row_data);
+  thread_cache_->InsertRow(row_id, client_row);
   row_data = thread_cache_->GetRow(row_id);
   CHECK(row_data != 0);
   row_accessor->row_data_ptr_ = row_data;
+  Metrics::Add(kMetricAppThreadGet);
   STATS_APP_SAMPLE_THREAD_GET_END(table_id_);
 }
 
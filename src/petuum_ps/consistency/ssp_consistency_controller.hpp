@@ -3,14 +3,15 @@
 
 #include <petuum_ps_common/consistency/abstract_consistency_controller.hpp>
 #include <petuum_ps/oplog/abstract_oplog.hpp>
+#include <petuum_ps/oplog/oplog_updater.hpp>
 #include <petuum_ps_common/util/vector_clock_mt.hpp>
 #include <petuum_ps/client/thread_table.hpp>
+#include <petuum_ps/consistency/table_staleness.hpp>
 #include <utility>
 #include <vector>
 #include <cstdint>
 #include <atomic>
-
-#include <functional>
+#include <memory>
 
 namespace petuum {
 
@@ -61,17 +62,13 @@ public:
   virtual void FlushThreadCache();
   virtual void Clock();
 
-protected:
-  void DenseBatchIncDenseOpLog(OpLogAccessor *oplog_accessor, const uint8_t *updates,
-                               int32_t index_st, int32_t num_updates);
-  void DenseBatchIncNonDenseOpLog(OpLogAccessor *oplog_accessor, const uint8_t *updates,
-                                  int32_t index_st, int32_t num_updates);
-  typedef void (SSPConsistencyController::*DenseBatchIncOpLogFunc)(
-      OpLogAccessor *oplog_accessor, const uint8_t *updates,
-      int32_t index_st, int32_t num_updates);
+  TableStaleness &get_table_staleness() {
+    return staleness_;
+  }
 
+protected:
   // SSP staleness parameter.
-  int32_t staleness_;
+  TableStaleness staleness_;
 
   boost::thread_specific_ptr<ThreadTable> &thread_cache_;
   TableOpLogIndex &oplog_index_;
@@ -80,9 +77,8 @@ protected:
   // all local updates are reflected in the row values.
   AbstractOpLog& oplog_;
 
-  typedef std::function<void(int32_t, void*, const void*)> AddUpdatesFunc;
-  AddUpdatesFunc AddUpdates_;
-  DenseBatchIncOpLogFunc DenseBatchIncOpLog_;
+  // Typed for DenseRow tables; used by BatchInc and DenseBatchInc.
+  std::unique_ptr<OpLogUpdater> oplog_updater_;
 };
 
 }  // namespace petuum
@@ -2,6 +2,8 @@
 #include <petuum_ps/thread/context.hpp>
 #include <petuum_ps/thread/bg_workers.hpp>
 #include <petuum_ps_common/util/stats.hpp>
+#include <petuum_ps_common/util/metrics.hpp>
+#include <petuum_ps_common/util/trace.hpp>
 #include <glog/logging.h>
 
 namespace petuum {
@@ -72,13 +74,18 @@ ClientRow *SSPPushConsistencyController::Get(int32_t row_id,
   STATS_APP_SAMPLE_SSP_GET_BEGIN(table_id_);
 
   // Look for row_id in process_storage_.
-  int32_t stalest_clock = std::max(0, ThreadContext::get_clock() - staleness_);
+  int32_t stalest_clock = std::max(0, ThreadContext::get_clock()
+      - staleness_.Get(ThreadContext::get_clock()));
 
   if (ThreadContext::GetCachedSystemClock() < stalest_clock) {
     int32_t system_clock = BgWorkers::GetSystemClock();
     if(system_clock < stalest_clock) {
       STATS_APP_ACCUM_SSPPUSH_GET_COMM_BLOCK_BEGIN(table_id_);
-      BgWorkers::WaitSystemClock(stalest_clock);
+      {
+        TraceScope trace_scope(kTraceAppGetCommBlock, table_id_, row_id);
+        BlockedGetTimer blocked_get_timer(staleness_);
+        BgWorkers::WaitSystemClock(stalest_clock);
+      }
       STATS_APP_ACCUM_SSPPUSH_GET_COMM_BLOCK_END(table_id_);
       system_clock = BgWorkers::GetSystemClock();
     }
@@ -88,16 +95,23 @@ ClientRow *SSPPushConsistencyController::Get(int32_t row_id,
   ClientRow *client_row = process_storage_.Find(row_id, row_accessor);
 
   if (client_row != 0) {
+    STATS_APP_ACCUM_GET_STALENESS(table_id_,
+        ThreadContext::get_clock() - client_row->GetClock(), true);
+    Metrics::Add(kMetricAppGet);
     STATS_APP_SAMPLE_SSP_GET_END(table_id_, true);
     return client_row;
   }
 
   // Didn't find row_id that's fresh enough in process_storage_.
   // Fetch from server.
-   int32_t num_fetches = 0;
+  BlockedGetTimer blocked_get_timer(staleness_);
+  int32_t num_fetches = 0;
   do {
     STATS_APP_ACCUM_SSP_GET_SERVER_FETCH_BEGIN(table_id_);
-    BgWorkers::RequestRow(table_id_, row_id, stalest_clock);
+    {
+      TraceScope trace_scope(kTraceAppGetServerFetch, table_id_, row_id);
+      BgWorkers::RequestRow(table_id_, row_id, stalest_clock);
+    }
     STATS_APP_ACCUM_SSP_GET_SERVER_FETCH_END(table_id_);
 
     // fetch again
@@ -110,6 +124,10 @@ ClientRow *SSPPushConsistencyController::Get(int32_t row_id,
     CHECK_LE(num_fetches, 3); // to prevent infinite loop
   }while(client_row == 0);
 
+  STATS_APP_ACCUM_GET_STALENESS(table_id_,
+      ThreadContext::get_clock() - client_row->GetClock(), false);
+  Metrics::Add(kMetricAppGet);
+  Metrics::Add(kMetricAppGetMiss);
   STATS_APP_SAMPLE_SSP_GET_END(table_id_, false);
   return client_row;
 }
@@ -119,13 +137,18 @@ void SSPPushConsistencyController::ThreadGet(int32_t row_id,
   STATS_APP_SAMPLE_THREAD_GET_BEGIN(table_id_);
 
   // Look for row_id in process_storage_.
-  int32_t stalest_clock = std::max(0, ThreadContext::get_clock() - staleness_);
+  int32_t stalest_clock = std::max(0, ThreadContext::get_clock()
+      - staleness_.Get(ThreadContext::get_clock()));
 
   if (ThreadContext::GetCachedSystemClock() < stalest_clock) {
     int32_t system_clock = BgWorkers::GetSystemClock();
     if(system_clock < stalest_clock) {
       STATS_APP_ACCUM_SSPPUSH_GET_COMM_BLOCK_BEGIN(table_id_);
-      BgWorkers::WaitSystemClock(stalest_clock);
+      {
+        TraceScope trace_scope(kTraceAppGetCommBlock, table_id_, row_id);
+        BlockedGetTimer blocked_get_timer(staleness_);
+        BgWorkers::WaitSystemClock(stalest_clock);
+      }
       STATS_APP_ACCUM_SSPPUSH_GET_COMM_BLOCK_END(table_id_);
       system_clock = BgWorkers::GetSystemClock();
     }
@@ -135,15 +158,18 @@ void SSPPushConsistencyController::ThreadGet(int32_t row_id,
   AbstractRow *row_data = thread_cache_->GetRow(row_id);
   if (row_data != 0) {
     row_accessor->row_data_ptr_ = row_data;
+    Metrics::Add(kMetricAppThreadGet);
     STATS_APP_SAMPLE_THREAD_GET_END(table_id_);
     return;
   }
 
   RowAccessor process_row_accessor;
   ClientRow *client_row = process_storage_.Find(row_id, &process_row_accessor);
+  bool hit = (client_row != 0);
   if (client_row == 0) {
     // Didn't find row_id that's fresh enough in process_storage_.
     // Fetch from server.
+    BlockedGetTimer blocked_get_timer(staleness_);
     int32_t num_fetches = 0;
     do {
       BgWorkers::RequestRow(table_id_, row_id, stalest_clock);
@@ -157,11 +183,13 @@ void SSPPushConsistencyController::ThreadGet(int32_t row_id,
       CHECK_LE(num_fetches, 3); // to prevent infinite loop
     }while(client_row == 0);
   }
-  AbstractRow *tmp_row_data = client_row->GetRowDataPtr();
-  thread_cache_->InsertRow(row_id, tmp_row_data);
+  STATS_APP_ACCUM_GET_STALENESS(table_id_,
+      ThreadContext::get_clock() - client_row->GetClock(), hit);
+  thread_cache_->InsertRow(row_id, client_row);
   row_data = thread_cache_->GetRow(row_id);
   CHECK(row_data != 0);
   row_accessor->row_data_ptr_ = row_data;
+  Metrics::Add(kMetricAppThreadGet);
   STATS_APP_SAMPLE_THREAD_GET_END(table_id_);
 }
 
@@ -0,0 +1,126 @@
+#include <petuum_ps/consistency/table_staleness.hpp>
+#include <glog/logging.h>
+#include <algorithm>
+
+namespace petuum {
+
+std::mutex TableStaleness::progress_mtx_;
+double TableStaleness::progress_ = 0;
+bool TableStaleness::has_progress_ = false;
+
+TableStaleness::TableStaleness(const TableInfo &info):
+    adaptive_(info.adaptive_staleness_max > info.adaptive_staleness_min),
+    min_(adaptive_ ? info.adaptive_staleness_min : info.table_staleness),
+    max_(adaptive_ ? info.adaptive_staleness_max : info.table_staleness),
+    schedule_(Pack(0, info.table_staleness, info.table_staleness)),
+    blocked_ns_(0) {
+  if (adaptive_) {
+    CHECK_GE(min_, 0);
+    CHECK_LE(max_, 0xffff);
+    CHECK(info.table_staleness >= min_ && info.table_staleness <= max_)
+        << "table_staleness " << info.table_staleness
+        << " out of adaptive bounds [" << min_ << ", " << max_ << "]";
+  }
+}
+
+void TableStaleness::Schedule(int32_t staleness, int32_t effective_clock) {
+  CHECK(adaptive_);
+  CHECK(staleness >= min_ && staleness <= max_) << staleness;
+  // By the time the name node decides the next bound every client has
+  // reached the previous effective clock, so the previous bound is the one
+  // in force.
+  uint64_t schedule = schedule_.load(std::memory_order_relaxed);
+  int32_t prev_staleness = (schedule >> 16) & 0xffff;
+  schedule_.store(Pack(effective_clock, staleness, prev_staleness),
+                  std::memory_order_release);
+}
+
+void TableStaleness::ReportProgress(double progress) {
+  std::lock_guard<std::mutex> lock(progress_mtx_);
+  progress_ = progress;
+  has_progress_ = true;
+}
+
+bool TableStaleness::TakeProgress(double *progress) {
+  std::lock_guard<std::mutex> lock(progress_mtx_);
+  if (!has_progress_) {
+    return false;
+  }
+  *progress = progress_;
+  has_progress_ = false;
+  return true;
+}
+
+constexpr double StalenessPolicy::kRaiseBlockedFrac;
+constexpr double StalenessPolicy::kLowerBlockedFrac;
+
+StalenessPolicy::StalenessPolicy(int32_t staleness, int32_t min, int32_t max):
+    staleness_(staleness),
+    min_(min),
+    max_(max),
+    has_prev_progress_(false),
+    prev_progress_(0),
+    prev_report_clock_(-1),
+    prev_first_arrival_ns_(0) { }
+
+int32_t StalenessPolicy::Step(
+    int32_t report_clock,
+    const std::vector<StalenessObservation> &observations) {
+  CHECK(!observations.empty());
+  double sum_blocked_frac = 0;
+  double sum_progress = 0;
+  int32_t num_progress = 0;
+  int64_t first_arrival_ns = observations[0].arrival_ns;
+  int64_t last_arrival_ns = observations[0].arrival_ns;
+  for (const auto &observation : observations) {
+    sum_blocked_frac += observation.blocked_frac;
+    if (observation.has_progress) {
+      sum_progress += observation.progress;
+      ++num_progress;
+    }
+    first_arrival_ns = std::min(first_arrival_ns, observation.arrival_ns);
+    last_arrival_ns = std::max(last_arrival_ns, observation.arrival_ns);
+  }
+  double blocked_frac = sum_blocked_frac / observations.size();
+
+  // Skew in clocks; unknown (0) until the clock period is.
+  double skew = 0;
+  if (prev_report_clock_ >= 0 && report_clock > prev_report_clock_
+      && first_arrival_ns > prev_first_arrival_ns_) {
+    double clock_ns = double(first_arrival_ns - prev_first_arrival_ns_)
+        / (report_clock - prev_report_clock_);
+    skew = (last_arrival_ns - first_arrival_ns) / clock_ns;
+  }
+  prev_report_clock_ = report_clock;
+  prev_first_arrival_ns_ = first_arrival_ns;
+
+  bool progress_fell = false;
+  // Only compare rounds where every client reported progress.
+  if (num_progress == (int32_t) observations.size()) {
+    double progress = sum_progress / num_progress;
+    progress_fell = has_prev_progress_ && progress < prev_progress_;
+    has_prev_progress_ = true;
+    prev_progress_ = progress;
+  }
+
+  int32_t prev_staleness = staleness_;
+  if (progress_fell) {
+    --staleness_;
+  } else if (blocked_frac > kRaiseBlockedFrac) {
+    ++staleness_;
+  } else if (blocked_frac < kLowerBlockedFrac && skew + 1 < staleness_) {
+    --staleness_;
+  }
+  staleness_ = std::max(min_, std::min(max_, staleness_));
+
+  // Only changes of the bound are logged by default.
+  VLOG(staleness_ != prev_staleness ? 0 : 1)
+      << "report_clock = " << report_clock
+      << " blocked_frac = " << blocked_frac
+      << " skew = " << skew
+      << " progress_fell = " << progress_fell
+      << " staleness = " << staleness_;
+  return staleness_;
+}
+
+}   // namespace petuum
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <petuum_ps_common/include/configs.hpp>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <vector>
+#include <stdint.h>
+
+namespace petuum {
+
+// The staleness bound of one table on a client.
+//
+// Fixed at table_staleness unless the table has adaptive bounds. Then each
+// head bg reports its observations to the name node every
+// staleness_adapt_interval clocks; once all clients have reported a clock,
+// the name node runs StalenessPolicy and broadcasts the new bound together
+// with the clock it takes effect (the next report clock). Readers ask for
+// the bound in force at their own clock, so all threads of all clients
+// switch at the same clock, provided the update arrives before they get
+// there. A client that is already past the effective clock switches at
+// once.
+class TableStaleness {
+public:
+  explicit TableStaleness(const TableInfo &info);
+
+  bool adaptive() const {
+    return adaptive_;
+  }
+
+  int32_t get_min() const {
+    return min_;
+  }
+
+  int32_t get_max() const {
+    return max_;
+  }
+
+  // Bound in force at clock. Lock-free, called on every Get.
+  int32_t Get(int32_t clock) const {
+    if (!adaptive_) {
+      return min_;
+    }
+    uint64_t schedule = schedule_.load(std::memory_order_acquire);
+    return (clock >= static_cast<int32_t>(schedule >> 32))
+        ? static_cast<int32_t>((schedule >> 16) & 0xffff)
+        : static_cast<int32_t>(schedule & 0xffff);
+  }
+
+  // Head bg only. The previous bound stays in force before effective_clock.
+  void Schedule(int32_t staleness, int32_t effective_clock);
+
+  // App threads, once per Get that had to wait for the server.
+  void RecordBlockedGet(int64_t blocked_ns) {
+    blocked_ns_.fetch_add(blocked_ns, std::memory_order_relaxed);
+  }
+
+  // Head bg: nanoseconds app threads spent blocked since the last call.
+  int64_t TakeBlockedNs() {
+    return blocked_ns_.exchange(0, std::memory_order_relaxed);
+  }
+
+  static int64_t NowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  // Latest application progress metric, higher is better (e.g. negated
+  // training loss). Process-wide; see PSTableGroup::ReportProgress().
+  static void ReportProgress(double progress);
+
+  // Returns false if nothing was reported since the last call.
+  static bool TakeProgress(double *progress);
+
+private:
+  static uint64_t Pack(int32_t effective_clock, int32_t staleness,
+                       int32_t prev_staleness) {
+    return (static_cast<uint64_t>(effective_clock) << 32)
+        | (static_cast<uint64_t>(staleness) << 16)
+        | static_cast<uint64_t>(prev_staleness);
+  }
+
+  const bool adaptive_;
+  // min_ is the fixed staleness if !adaptive_.
+  const int32_t min_;
+  const int32_t max_;
+
+  // effective clock (32 bits) | staleness (16) | previous staleness (16)
+  std::atomic<uint64_t> schedule_;
+  std::atomic<int64_t> blocked_ns_;
+
+  static std::mutex progress_mtx_;
+  static double progress_;
+  static bool has_progress_;
+};
+
+// Charges the enclosing scope to table_staleness as blocked Get time.
+class BlockedGetTimer {
+public:
+  explicit BlockedGetTimer(TableStaleness &table_staleness):
+      table_staleness_(table_staleness),
+      begin_ns_(table_staleness.adaptive() ? TableStaleness::NowNs() : -1) { }
+
+  ~BlockedGetTimer() {
+    if (begin_ns_ >= 0) {
+      table_staleness_.RecordBlockedGet(TableStaleness::NowNs() - begin_ns_);
+    }
+  }
+
+private:
+  TableStaleness &table_staleness_;
+  const int64_t begin_ns_;
+};
+
+// One client's observations of one report clock.
+struct StalenessObservation {
+  // Fraction of app thread time spent in Gets blocked on the server.
+  double blocked_frac;
+  bool has_progress;
+  double progress;
+  // Arrival of the report at the name node.
+  int64_t arrival_ns;
+};
+
+// Name node side decision for one table. Each step:
+//  - if the mean progress fell since the last step, the bound is hurting
+//    convergence: staleness - 1;
+//  - else if app threads spend more than kRaiseBlockedFrac of their time
+//    blocked: staleness + 1;
+//  - else if they spend less than kLowerBlockedFrac and the clients are
+//    closer together than the bound (skew + 1 < staleness), the slack is
+//    unused: staleness - 1.
+// Clock skew across clients is estimated from how far apart the reports
+// of one clock arrive, in units of the clock period.
+class StalenessPolicy {
+public:
+  StalenessPolicy(int32_t staleness, int32_t min, int32_t max);
+
+  // Returns the staleness for the next interval.
+  int32_t Step(int32_t report_clock,
+               const std::vector<StalenessObservation> &observations);
+
+  int32_t get_staleness() const {
+    return staleness_;
+  }
+
+  static constexpr double kRaiseBlockedFrac = 0.05;
+  static constexpr double kLowerBlockedFrac = 0.005;
+
+private:
+  int32_t staleness_;
+  const int32_t min_;
+  const int32_t max_;
+
+  bool has_prev_progress_;
+  double prev_progress_;
+
+  // First arrival of the previous step, to estimate the clock period.
+  int32_t prev_report_clock_;
+  int64_t prev_first_arrival_ns_;
+};
+
+}   // namespace petuum
@@ -1,4 +1,5 @@
 #include <petuum_ps/oplog/create_row_oplog.hpp>
+#include <petuum_ps_common/include/configs.hpp>
 namespace petuum {
 
 AbstractRowOpLog *CreateRowOpLog::CreateDenseRowOpLog(
@@ -37,6 +38,19 @@ AbstractRowOpLog *CreateRowOpLog::CreateSparseVectorRowOpLog(
       update_size);
 }
 
+AbstractRowOpLog *CreateRowOpLog::CreateSparseHashRowOpLog(
+    size_t update_size, const AbstractRow *sample_row,
+    size_t row_capacity __attribute__((unused))) {
+  return new SparseHashRowOpLog(
+      kSparseHashRowOpLogInitCapacity,
+      std::bind(&AbstractRow::InitUpdate,
+                sample_row, std::placeholders::_1,
+                std::placeholders::_2),
+      std::bind(&AbstractRow::CheckZeroUpdate,
+                sample_row, std::placeholders::_1),
+      update_size);
+}
+
 AbstractRowOpLog *CreateRowOpLog::CreateDenseMetaRowOpLog(
     size_t update_size, const AbstractRow *sample_row, size_t row_capacity) {
   return new DenseMetaRowOpLog(
@@ -71,4 +85,28 @@ AbstractRowOpLog *CreateRowOpLog::CreateSparseVectorMetaRowOpLog(
                 sample_row, std::placeholders::_1),
       update_size);
 }
+
+AbstractRowOpLog *CreateRowOpLog::CreateSparseHashMetaRowOpLog(
+    size_t update_size, const AbstractRow *sample_row,
+    size_t row_capacity __attribute__((unused))) {
+  return new SparseHashMetaRowOpLog(
+      std::bind(&AbstractRow::InitUpdate,
+                sample_row, std::placeholders::_1,
+                std::placeholders::_2),
+      std::bind(&AbstractRow::CheckZeroUpdate,
+                sample_row, std::placeholders::_1),
+      update_size);
+}
+
+CreateRowOpLog::CreateRowOpLogFunc CreateRowOpLog::GetCreateRowOpLogFunc(
+    int32_t row_oplog_type, bool meta) {
+  if (row_oplog_type == RowOpLogType::kDenseRowOpLog)
+    return meta ? CreateDenseMetaRowOpLog : CreateDenseRowOpLog;
+  else if (row_oplog_type == RowOpLogType::kSparseRowOpLog)
+    return meta ? CreateSparseMetaRowOpLog : CreateSparseRowOpLog;
+  else if (row_oplog_type == RowOpLogType::kSparseHashRowOpLog)
+    return meta ? CreateSparseHashMetaRowOpLog : CreateSparseHashRowOpLog;
+  else
+    return meta ? CreateSparseVectorMetaRowOpLog : CreateSparseVectorRowOpLog;
+}
 }
@@ -5,6 +5,7 @@
 #include <petuum_ps_common/oplog/dense_row_oplog.hpp>
 #include <petuum_ps_common/oplog/sparse_row_oplog.hpp>
 #include <petuum_ps_common/oplog/sparse_vector_row_oplog.hpp>
+#include <petuum_ps_common/oplog/sparse_hash_row_oplog.hpp>
 #include <petuum_ps/oplog/meta_row_oplog.hpp>
 
 namespace petuum {
@@ -27,6 +28,10 @@ class CreateRowOpLog {
       size_t update_size, const AbstractRow *sample_row,
       size_t row_oplog_capacity);
 
+  static AbstractRowOpLog *CreateSparseHashRowOpLog(
+      size_t update_size, const AbstractRow *sample_row,
+      size_t row_oplog_capacity);
+
   static AbstractRowOpLog *CreateDenseMetaRowOpLog(
       size_t update_size, const AbstractRow *sample_row,
       size_t row_oplog_capacity);
@@ -39,5 +44,13 @@ class CreateRowOpLog {
       size_t update_size, const AbstractRow *sample_row,
       size_t row_oplog_capacity);
 
+  static AbstractRowOpLog *CreateSparseHashMetaRowOpLog(
+      size_t update_size, const AbstractRow *sample_row,
+      size_t row_oplog_capacity);
+
+  // Plain and Meta (SSPAggr) creators for a RowOpLogType.
+  static CreateRowOpLogFunc GetCreateRowOpLogFunc(int32_t row_oplog_type,
+                                                  bool meta);
+
 };
 }
@@ -4,6 +4,7 @@
 #include <petuum_ps_common/oplog/dense_row_oplog.hpp>
 #include <petuum_ps_common/oplog/sparse_row_oplog.hpp>
 #include <petuum_ps_common/oplog/sparse_vector_row_oplog.hpp>
+#include <petuum_ps_common/oplog/sparse_hash_row_oplog.hpp>
 #include <glog/logging.h>
 
 namespace petuum {
@@ -73,4 +74,17 @@ public:
           InitUpdate, CheckZeroUpdate, update_size) { }
 };
 
+class SparseHashMetaRowOpLog : public MetaRowOpLog,
+                               public SparseHashRowOpLog {
+public:
+  SparseHashMetaRowOpLog(
+      InitUpdateFunc InitUpdate,
+      CheckZeroUpdateFunc CheckZeroUpdate,
+      size_t update_size):
+      AbstractRowOpLog(update_size),
+      SparseHashRowOpLog(
+          kSparseHashRowOpLogInitCapacity,
+          InitUpdate, CheckZeroUpdate, update_size) { }
+};
+
 }
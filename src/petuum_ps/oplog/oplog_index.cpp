@@ -6,11 +6,42 @@
 
 namespace petuum {
 
-PartitionOpLogIndex::PartitionOpLogIndex(size_t capacity):
+std::unique_ptr<DirtyOpLogTables::Partition[]> DirtyOpLogTables::partitions_;
+
+void DirtyOpLogTables::Init(int32_t num_partitions) {
+  partitions_.reset(new Partition[num_partitions]);
+}
+
+void DirtyOpLogTables::ShutDown() {
+  partitions_.reset();
+}
+
+void DirtyOpLogTables::Add(int32_t partition_num, int32_t table_id) {
+  if (!enabled())
+    return;
+  Partition &partition = partitions_[partition_num];
+  std::lock_guard<std::mutex> lock(partition.mtx);
+  partition.table_ids.push_back(table_id);
+}
+
+void DirtyOpLogTables::Take(int32_t partition_num,
+                            std::vector<int32_t> *table_ids) {
+  CHECK(enabled());
+  table_ids->clear();
+  Partition &partition = partitions_[partition_num];
+  std::lock_guard<std::mutex> lock(partition.mtx);
+  table_ids->swap(partition.table_ids);
+}
+
+PartitionOpLogIndex::PartitionOpLogIndex(size_t capacity, int32_t table_id,
+                                         int32_t partition_num):
     capacity_(capacity),
+    table_id_(table_id),
+    partition_num_(partition_num),
     locks_(GlobalContext::GetLockPoolSize()),
     shared_oplog_index_(new cuckoohash_map<int32_t, bool>
-                        (capacity*kCuckooExpansionFactor)){
+                        (capacity*kCuckooExpansionFactor)),
+    dirty_(false) {
 }
 
 PartitionOpLogIndex::~PartitionOpLogIndex() {
@@ -21,19 +52,28 @@ PartitionOpLogIndex::~PartitionOpLogIndex() {
 
 PartitionOpLogIndex::PartitionOpLogIndex(PartitionOpLogIndex && other):
   capacity_(other.capacity_),
-  shared_oplog_index_(other.shared_oplog_index_) {
+  table_id_(other.table_id_),
+  partition_num_(other.partition_num_),
+  shared_oplog_index_(other.shared_oplog_index_),
+  dirty_(other.dirty_.load()) {
   other.shared_oplog_index_ = 0;
 }
 
 void PartitionOpLogIndex::AddIndex(const std::unordered_set<int32_t>
                                    &oplog_index) {
+  if (oplog_index.empty())
+    return;
   smtx_.lock_shared();
   for (auto iter = oplog_index.cbegin(); iter != oplog_index.cend(); iter++) {
     locks_.Lock(*iter);
     shared_oplog_index_->insert(*iter, true);
     locks_.Unlock(*iter);
   }
+  bool was_dirty = dirty_.exchange(true);
   smtx_.unlock_shared();
+  // Listed before the app thread's clock message reaches the bg thread.
+  if (!was_dirty)
+    DirtyOpLogTables::Add(partition_num_, table_id_);
 }
 
 cuckoohash_map<int32_t, bool> *PartitionOpLogIndex::Reset() {
@@ -41,6 +81,7 @@ cuckoohash_map<int32_t, bool> *PartitionOpLogIndex::Reset() {
   cuckoohash_map<int32_t, bool> *old_index = shared_oplog_index_;
   shared_oplog_index_ = new cuckoohash_map<int32_t, bool>
                     (capacity_*kCuckooExpansionFactor);
+  dirty_ = false;
   smtx_.unlock();
   return old_index;
 }
@@ -52,10 +93,10 @@ size_t PartitionOpLogIndex::GetNumRowOpLogs() {
   return num_row_oplogs;
 }
 
-TableOpLogIndex::TableOpLogIndex(size_t capacity) {
+TableOpLogIndex::TableOpLogIndex(size_t capacity, int32_t table_id) {
   for (int32_t i = 0; i < GlobalContext::get_num_comm_channels_per_client();
        ++i) {
-    partition_oplog_index_.emplace_back(capacity);
+    partition_oplog_index_.emplace_back(capacity, table_id, i);
   }
 }
 
@@ -4,6 +4,9 @@
 #include <libcuckoo/cuckoohash_map.hh>
 #include <unordered_set>
 #include <stdint.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include <boost/noncopyable.hpp>
 
 #include <petuum_ps_common/util/lock.hpp>
@@ -11,9 +14,41 @@
 #include <petuum_ps/thread/context.hpp>
 
 namespace petuum {
+
+// Per partition (comm channel), the tables whose oplog index has gone from
+// empty to non-empty since the bg thread last took them, so that a clock
+// only visits tables that were updated. Each table is listed at most once
+// until its index is reset. Disabled unless Init() is called.
+class DirtyOpLogTables {
+public:
+  static void Init(int32_t num_partitions);
+
+  // Drops the lists and disables tracking, so a later table group does
+  // not see table ids of this one.
+  static void ShutDown();
+
+  static bool enabled() {
+    return partitions_ != nullptr;
+  }
+
+  static void Add(int32_t partition_num, int32_t table_id);
+
+  // Replaces *table_ids with the listed tables and clears the list.
+  static void Take(int32_t partition_num, std::vector<int32_t> *table_ids);
+
+private:
+  struct Partition {
+    std::mutex mtx;
+    std::vector<int32_t> table_ids;
+  };
+
+  static std::unique_ptr<Partition[]> partitions_;
+};
+
 class PartitionOpLogIndex : boost::noncopyable {
 public:
-  explicit PartitionOpLogIndex(size_t capacity);
+  PartitionOpLogIndex(size_t capacity, int32_t table_id,
+                      int32_t partition_num);
   PartitionOpLogIndex(PartitionOpLogIndex && other);
   PartitionOpLogIndex & operator = (PartitionOpLogIndex && other) = delete;
 
@@ -23,14 +58,18 @@ public:
   size_t GetNumRowOpLogs();
 private:
   size_t capacity_;
+  const int32_t table_id_;
+  const int32_t partition_num_;
   SharedMutex smtx_;
   StripedLock<int32_t> locks_;
   cuckoohash_map<int32_t, bool> *shared_oplog_index_;
+  // shared_oplog_index_ is non-empty; only changed under smtx_.
+  std::atomic<bool> dirty_;
 };
 
 class TableOpLogIndex : boost::noncopyable{
 public:
-  explicit TableOpLogIndex(size_t capacity);
+  TableOpLogIndex(size_t capacity, int32_t table_id);
   void AddIndex(int32_t partition_num,
                 const std::unordered_set<int32_t> &oplog_index);
   cuckoohash_map<int32_t, bool> *ResetPartition(int32_t partition_num);
@@ -0,0 +1,114 @@
+#include <petuum_ps/oplog/oplog_updater.hpp>
+#include <petuum_ps_common/include/configs.hpp>
+#include <petuum_ps_common/storage/dense_row.hpp>
+
+#include <typeinfo>
+
+namespace petuum {
+
+namespace {
+
+class GenericOpLogUpdater : public OpLogUpdater {
+public:
+  explicit GenericOpLogUpdater(const AbstractRow *sample_row):
+      sample_row_(sample_row),
+      update_size_(sample_row->get_update_size()) { }
+
+  void BatchInc(AbstractRowOpLog *row_oplog, const int32_t *column_ids,
+                const void *updates, int32_t num_updates) const {
+    const uint8_t *updates_uint8 = reinterpret_cast<const uint8_t*>(updates);
+    for (int i = 0; i < num_updates; ++i) {
+      void *oplog_delta = row_oplog->FindCreate(column_ids[i]);
+      sample_row_->AddUpdates(column_ids[i], oplog_delta,
+                              updates_uint8 + update_size_*i);
+    }
+  }
+
+  void DenseBatchInc(AbstractRowOpLog *row_oplog, const void *updates,
+                     int32_t index_st, int32_t num_updates) const {
+    const uint8_t *updates_uint8 = reinterpret_cast<const uint8_t*>(updates);
+    for (int i = 0; i < num_updates; ++i) {
+      int32_t col_id = i + index_st;
+      void *oplog_delta = row_oplog->FindCreate(col_id);
+      sample_row_->AddUpdates(col_id, oplog_delta,
+                              updates_uint8 + update_size_*i);
+    }
+  }
+
+private:
+  const AbstractRow *sample_row_;
+  const size_t update_size_;
+};
+
+// DenseRow<V>::AddUpdates is a plain +=, so do it inline on V. With a dense
+// row oplog the updates of column c live at base[c], and DenseBatchInc is a
+// contiguous loop the compiler can vectorize.
+template<typename V, bool dense_oplog>
+class TypedOpLogUpdater : public OpLogUpdater {
+public:
+  void BatchInc(AbstractRowOpLog *row_oplog, const int32_t *column_ids,
+                const void *updates, int32_t num_updates) const {
+    const V *typed_updates = reinterpret_cast<const V*>(updates);
+    if (dense_oplog) {
+      V *base = reinterpret_cast<V*>(row_oplog->FindCreate(0));
+      for (int i = 0; i < num_updates; ++i) {
+        base[column_ids[i]] += typed_updates[i];
+      }
+    } else {
+      for (int i = 0; i < num_updates; ++i) {
+        *reinterpret_cast<V*>(row_oplog->FindCreate(column_ids[i]))
+            += typed_updates[i];
+      }
+    }
+  }
+
+  void DenseBatchInc(AbstractRowOpLog *row_oplog, const void *updates,
+                     int32_t index_st, int32_t num_updates) const {
+    const V * __restrict__ typed_updates
+        = reinterpret_cast<const V*>(updates);
+    if (dense_oplog) {
+      V * __restrict__ oplog_updates
+          = reinterpret_cast<V*>(row_oplog->FindCreate(index_st));
+      for (int i = 0; i < num_updates; ++i) {
+        oplog_updates[i] += typed_updates[i];
+      }
+    } else {
+      for (int i = 0; i < num_updates; ++i) {
+        *reinterpret_cast<V*>(row_oplog->FindCreate(i + index_st))
+            += typed_updates[i];
+      }
+    }
+  }
+};
+
+template<typename V>
+OpLogUpdater *CreateTypedOpLogUpdater(int32_t row_oplog_type) {
+  if (row_oplog_type == RowOpLogType::kDenseRowOpLog) {
+    return new TypedOpLogUpdater<V, true>;
+  }
+  return new TypedOpLogUpdater<V, false>;
+}
+
+}  // anonymous namespace
+
+OpLogUpdater *OpLogUpdater::Create(const AbstractRow *sample_row,
+                                   int32_t row_oplog_type) {
+  const std::type_info &row_type = typeid(*sample_row);
+  if (row_type == typeid(DenseRow<float>)) {
+    return CreateTypedOpLogUpdater<float>(row_oplog_type);
+  } else if (row_type == typeid(DenseRow<double>)) {
+    return CreateTypedOpLogUpdater<double>(row_oplog_type);
+  } else if (row_type == typeid(DenseRow<int32_t>)) {
+    return CreateTypedOpLogUpdater<int32_t>(row_oplog_type);
+  }
+  return new GenericOpLogUpdater(sample_row);
+}
+
+bool OpLogUpdater::IsTypedDenseRow(const AbstractRow *sample_row) {
+  const std::type_info &row_type = typeid(*sample_row);
+  return row_type == typeid(DenseRow<float>)
+      || row_type == typeid(DenseRow<double>)
+      || row_type == typeid(DenseRow<int32_t>);
+}
+
+}   // namespace petuum
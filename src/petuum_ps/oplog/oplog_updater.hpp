@@ -0,0 +1,35 @@
+#pragma once
+
+#include <stdint.h>
+#include <boost/noncopyable.hpp>
+
+#include <petuum_ps_common/include/abstract_row.hpp>
+#include <petuum_ps_common/oplog/abstract_row_oplog.hpp>
+
+namespace petuum {
+
+// Accumulates a batch of updates into a row oplog. Which implementation is
+// used is decided once per table from the sample row and row oplog type:
+// DenseRow<float/double/int32_t> tables add typed values directly (into the
+// contiguous buffer for dense row oplogs), any other row type goes through
+// FindCreate() + AbstractRow::AddUpdates() per update.
+class OpLogUpdater : boost::noncopyable {
+public:
+  virtual ~OpLogUpdater() { }
+
+  virtual void BatchInc(AbstractRowOpLog *row_oplog, const int32_t *column_ids,
+                        const void *updates, int32_t num_updates) const = 0;
+
+  virtual void DenseBatchInc(AbstractRowOpLog *row_oplog, const void *updates,
+                             int32_t index_st, int32_t num_updates) const = 0;
+
+  // sample_row must outlive the returned updater.
+  static OpLogUpdater *Create(const AbstractRow *sample_row,
+                              int32_t row_oplog_type);
+
+  // Whether sample_row is a DenseRow<float/double/int32_t>, i.e. a row a
+  // dense row oplog can be applied to as one dense batch.
+  static bool IsTypedDenseRow(const AbstractRow *sample_row);
+};
+
+}   // namespace petuum
@@ -7,6 +7,7 @@
 #include <pthread.h>
 #include <utility>
 #include <iostream>
+#include <algorithm>
 
 namespace petuum {
 
@@ -81,18 +82,6 @@ void NameNodeThread::InitNameNode() {
   SendToAllBgThreads(reinterpret_cast<MsgBase*>(&client_start_msg));
 }
 
-bool NameNodeThread::HaveCreatedAllTables() {
-  if((int32_t) create_table_map_.size() < GlobalContext::get_num_tables())
-    return false;
-
-  for (const auto &create_table_pair : create_table_map_) {
-    if (!create_table_pair.second.RepliedToAllClients()) {
-      return false;
-    }
-  }
-  return true;
-}
-
 void NameNodeThread::SendCreatedAllTablesMsg() {
   CreatedAllTablesMsg created_all_tables_msg;
   int32_t num_clients = GlobalContext::get_num_clients();
@@ -126,58 +115,113 @@ bool NameNodeThread::HandleShutDownMsg() {
   return false;
 }
 
-void NameNodeThread::HandleCreateTable (int32_t sender_id,
-  CreateTableMsg &create_table_msg) {
-  int32_t table_id = create_table_msg.get_table_id();
-  if (create_table_map_.count(table_id) == 0) {
-    TableInfo table_info;
-    table_info.table_staleness = create_table_msg.get_staleness();
-    table_info.row_type = create_table_msg.get_row_type();
-    table_info.row_capacity = create_table_msg.get_row_capacity();
-    table_info.oplog_dense_serialized = create_table_msg.get_oplog_dense_serialized();
-    table_info.row_oplog_type = create_table_msg.get_row_oplog_type();
-    table_info.dense_row_oplog_capacity = create_table_msg.get_dense_row_oplog_capacity();
-    server_obj_.CreateTable(table_id, table_info);
-
-    create_table_map_.insert(std::make_pair(table_id, CreateTableInfo())); // access it to call default constructor
-    SendToAllServers(reinterpret_cast<MsgBase*>(&create_table_msg));
+void NameNodeThread::ReplyCreateTables(int32_t bg_id) {
+  CreateTablesReplyMsg create_tables_reply_msg;
+  create_tables_reply_msg.get_num_tables() = create_tables_info_.num_tables_;
+  size_t sent_size = (comm_bus_->*(comm_bus_->SendAny_))(
+      bg_id, create_tables_reply_msg.get_mem(),
+      create_tables_reply_msg.get_size());
+  CHECK_EQ(sent_size, create_tables_reply_msg.get_size());
+  ++create_tables_info_.num_clients_replied_;
+  if (create_tables_info_.RepliedToAllClients())
+    SendCreatedAllTablesMsg();
+}
+
+void NameNodeThread::HandleCreateTables(int32_t sender_id,
+  CreateTablesMsg &create_tables_msg) {
+  int32_t num_tables = create_tables_msg.get_num_tables();
+  CHECK_EQ(num_tables, GlobalContext::get_num_tables());
+  if (!create_tables_info_.created_) {
+    CreateTableRecord *records = create_tables_msg.get_records();
+    for (int32_t i = 0; i < num_tables; ++i) {
+      server_obj_.CreateTable(records[i].table_id, records[i].table_info);
+      const TableInfo &table_info = records[i].table_info;
+      if (table_info.adaptive_staleness_max
+          > table_info.adaptive_staleness_min) {
+        staleness_policies_.emplace(records[i].table_id,
+            StalenessPolicy(table_info.table_staleness,
+                            table_info.adaptive_staleness_min,
+                            table_info.adaptive_staleness_max));
+      }
+    }
+    create_tables_info_.created_ = true;
+    create_tables_info_.num_tables_ = num_tables;
+    SendToAllServers(reinterpret_cast<MsgBase*>(&create_tables_msg));
   }
-  if (create_table_map_[table_id].ReceivedFromAllServers()) {
-    CreateTableReplyMsg create_table_reply_msg;
-    create_table_reply_msg.get_table_id() = create_table_msg.get_table_id();
-    size_t sent_size = (comm_bus_->*(comm_bus_->SendAny_))(
-        sender_id, create_table_reply_msg.get_mem(),
-        create_table_reply_msg.get_size());
-    CHECK_EQ(sent_size, create_table_reply_msg.get_size());
-    ++create_table_map_[table_id].num_clients_replied_;
-    if (HaveCreatedAllTables())
-      SendCreatedAllTablesMsg();
+  if (create_tables_info_.ReceivedFromAllServers()) {
+    ReplyCreateTables(sender_id);
   } else {
     // to be sent later
-    create_table_map_[table_id].bgs_to_reply_.push(sender_id);
+    create_tables_info_.bgs_to_reply_.push(sender_id);
   }
 }
 
-void NameNodeThread::HandleCreateTableReply(
-  CreateTableReplyMsg &create_table_reply_msg){
+void NameNodeThread::HandleCreateTablesReply(
+  CreateTablesReplyMsg &create_tables_reply_msg) {
+  CHECK_EQ(create_tables_reply_msg.get_num_tables(),
+           create_tables_info_.num_tables_);
+  ++create_tables_info_.num_servers_replied_;
 
-  int32_t table_id = create_table_reply_msg.get_table_id();
-  ++create_table_map_[table_id].num_servers_replied_;
-
-  if (create_table_map_[table_id].ReceivedFromAllServers()) {
-    std::queue<int32_t> &bgs_to_reply
-        = create_table_map_[table_id].bgs_to_reply_;
+  if (create_tables_info_.ReceivedFromAllServers()) {
+    std::queue<int32_t> &bgs_to_reply = create_tables_info_.bgs_to_reply_;
     while (!bgs_to_reply.empty()) {
       int32_t bg_id = bgs_to_reply.front();
       bgs_to_reply.pop();
-      size_t sent_size = (comm_bus_->*(comm_bus_->SendAny_))(
-          bg_id, create_table_reply_msg.get_mem(),
-          create_table_reply_msg.get_size());
-      CHECK_EQ(sent_size, create_table_reply_msg.get_size());
-      ++create_table_map_[table_id].num_clients_replied_;
+      ReplyCreateTables(bg_id);
     }
-    if (HaveCreatedAllTables())
-      SendCreatedAllTablesMsg();
+  }
+}
+
+// Reports of one clock complete in clock order since each client sends them
+// in order, so each policy steps through the clocks in order.
+void NameNodeThread::HandleStalenessReport(
+  StalenessReportMsg &staleness_report_msg) {
+  int64_t arrival_ns = TableStaleness::NowNs();
+  int32_t report_clock = staleness_report_msg.get_report_clock();
+  StalenessReports &reports = staleness_reports_[report_clock];
+  StalenessReportRecord *records = staleness_report_msg.get_records();
+  for (int32_t i = 0; i < staleness_report_msg.get_num_tables(); ++i) {
+    StalenessObservation observation;
+    observation.blocked_frac = records[i].blocked_frac;
+    observation.has_progress = staleness_report_msg.get_has_progress();
+    observation.progress = staleness_report_msg.get_progress();
+    observation.arrival_ns = arrival_ns;
+    reports.observations_[records[i].table_id].push_back(observation);
+  }
+  if (++reports.num_clients_reported_ < GlobalContext::get_num_clients())
+    return;
+
+  std::vector<StalenessUpdateRecord> updates;
+  for (const auto &observations_pair : reports.observations_) {
+    auto policy_iter = staleness_policies_.find(observations_pair.first);
+    CHECK(policy_iter != staleness_policies_.end())
+        << "table " << observations_pair.first << " is not adaptive";
+    StalenessPolicy &policy = policy_iter->second;
+    int32_t prev_staleness = policy.get_staleness();
+    int32_t staleness = policy.Step(report_clock, observations_pair.second);
+    if (staleness != prev_staleness) {
+      StalenessUpdateRecord update;
+      update.table_id = observations_pair.first;
+      update.staleness = staleness;
+      updates.push_back(update);
+    }
+  }
+  staleness_reports_.erase(report_clock);
+  if (updates.empty())
+    return;
+
+  StalenessUpdateMsg staleness_update_msg(updates.size());
+  staleness_update_msg.get_effective_clock()
+      = report_clock + GlobalContext::get_staleness_adapt_interval();
+  std::copy(updates.begin(), updates.end(),
+            staleness_update_msg.get_records());
+  for (int32_t client_idx = 0; client_idx < GlobalContext::get_num_clients();
+       ++client_idx) {
+    int32_t head_bg_id = GlobalContext::get_head_bg_id(client_idx);
+    size_t sent_size = (comm_bus_->*(comm_bus_->SendAny_))(
+        head_bg_id, staleness_update_msg.get_mem(),
+        staleness_update_msg.get_size());
+    CHECK_EQ(sent_size, staleness_update_msg.get_size());
   }
 }
 
@@ -222,16 +266,22 @@ void *NameNodeThread::operator() () {
 	}
 	break;
       }
-    case kCreateTable:
+    case kCreateTables:
+      {
+	CreateTablesMsg create_tables_msg(zmq_msg.data());
+	HandleCreateTables(sender_id, create_tables_msg);
+	break;
+      }
+    case kCreateTablesReply:
       {
-	CreateTableMsg create_table_msg(zmq_msg.data());
-	HandleCreateTable(sender_id, create_table_msg);
+	CreateTablesReplyMsg create_tables_reply_msg(zmq_msg.data());
+	HandleCreateTablesReply(create_tables_reply_msg);
 	break;
       }
-    case kCreateTableReply:
+    case kStalenessReport:
       {
-	CreateTableReplyMsg create_table_reply_msg(zmq_msg.data());
-	HandleCreateTableReply(create_table_reply_msg);
+	StalenessReportMsg staleness_report_msg(zmq_msg.data());
+	HandleStalenessReport(staleness_report_msg);
 	break;
       }
     default:
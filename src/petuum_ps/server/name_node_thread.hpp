@@ -6,10 +6,12 @@
 #include <vector>
 #include <pthread.h>
 #include <queue>
+#include <map>
 
 #include <petuum_ps_common/util/thread.hpp>
 #include <petuum_ps/server/server.hpp>
 #include <petuum_ps/thread/ps_msgs.hpp>
+#include <petuum_ps/consistency/table_staleness.hpp>
 #include <petuum_ps_common/comm_bus/comm_bus.hpp>
 
 namespace petuum {
@@ -26,24 +28,22 @@ public:
   }
 
 private:
-  struct CreateTableInfo {
+  // All clients create the same tables, each with one CreateTablesMsg from
+  // its head bg. The first one is forwarded to the servers; head bgs are
+  // replied to once every server has acknowledged it.
+  struct CreateTablesInfo {
+    bool created_;
+    int32_t num_tables_;
     int32_t num_clients_replied_;
     int32_t num_servers_replied_;
     std::queue<int32_t> bgs_to_reply_;
-    CreateTableInfo():
+    CreateTablesInfo():
+      created_(false),
+      num_tables_(0),
       num_clients_replied_(0),
       num_servers_replied_(0),
       bgs_to_reply_(){}
 
-    ~CreateTableInfo(){}
-
-    CreateTableInfo & operator= (const CreateTableInfo& info_obj){
-      num_clients_replied_ = info_obj.num_clients_replied_;
-      num_servers_replied_ = info_obj.num_servers_replied_;
-      bgs_to_reply_ = info_obj.bgs_to_reply_;
-      return *this;
-    }
-
     bool ReceivedFromAllServers() const {
       return (num_servers_replied_ == GlobalContext::get_num_total_servers());
     }
@@ -53,6 +53,15 @@ private:
     }
   };
 
+  // Reports of one clock, per adaptive table, until all clients have sent
+  // theirs.
+  struct StalenessReports {
+    int32_t num_clients_reported_;
+    std::map<int32_t, std::vector<StalenessObservation> > observations_;
+    StalenessReports():
+      num_clients_reported_(0) { }
+  };
+
   // communication function
   int32_t GetConnection(bool *is_client, int32_t *client_id);
   void SendToAllServers(MsgBase *msg);
@@ -62,12 +71,15 @@ private:
   void SetUpCommBus();
   void InitNameNode();
 
-  bool HaveCreatedAllTables();
+  void ReplyCreateTables(int32_t bg_id);
   void SendCreatedAllTablesMsg();
 
   bool HandleShutDownMsg(); // returns true if the server may shut down
-  void HandleCreateTable(int32_t sender_id, CreateTableMsg &create_table_msg);
-  void HandleCreateTableReply(CreateTableReplyMsg &create_table_reply_msg);
+  void HandleCreateTables(int32_t sender_id,
+                          CreateTablesMsg &create_tables_msg);
+  void HandleCreateTablesReply(
+      CreateTablesReplyMsg &create_tables_reply_msg);
+  void HandleStalenessReport(StalenessReportMsg &staleness_report_msg);
 
   int32_t my_id_;
   pthread_barrier_t *init_barrier_;
@@ -75,7 +87,11 @@ private:
 
   std::vector<int32_t> bg_worker_ids_;
   // one bg per client is refered to as head bg
-  std::map<int32_t, CreateTableInfo> create_table_map_;
+  CreateTablesInfo create_tables_info_;
+  // The staleness of adaptive tables is decided here for all clients.
+  std::map<int32_t, StalenessPolicy> staleness_policies_;
+  // report clock -> reports
+  std::map<int32_t, StalenessReports> staleness_reports_;
   Server server_obj_;
   int32_t num_shutdown_bgs_;
 };
@@ -0,0 +1,283 @@
+#include <petuum_ps/server/oplog_aggregator.hpp>
+#include <petuum_ps/server/serialized_oplog_reader.hpp>
+#include <petuum_ps/oplog/create_row_oplog.hpp>
+#include <petuum_ps/thread/context.hpp>
+#include <petuum_ps_common/thread/mem_transfer.hpp>
+
+#include <utility>
+#include <string.h>
+
+namespace petuum {
+
+OpLogAggregator::OpLogAggregator(
+    int32_t my_id, CommBus *comm_bus,
+    const boost::unordered_map<int32_t, ServerTable> &tables):
+    my_id_(my_id),
+    comm_bus_(comm_bus),
+    tables_(tables),
+    num_remote_servers_(0),
+    num_shutdown_servers_(0) {
+  int32_t comm_channel_idx = GlobalContext::GetCommChannelIndexServer(my_id_);
+  std::vector<int32_t> host_client_ids;
+  GlobalContext::GetHostClientIDs(GlobalContext::get_client_id(),
+                                  &host_client_ids);
+  for (const auto &client_id : host_client_ids) {
+    local_bg_ids_.push_back(
+        GlobalContext::get_bg_thread_id(client_id, comm_channel_idx));
+  }
+}
+
+OpLogAggregator::~OpLogAggregator() {
+  for (auto &dst_pair : dst_oplogs_) {
+    for (auto &table_pair : dst_pair.second.table_oplogs) {
+      for (auto &row_pair : table_pair.second) {
+        delete row_pair.second;
+      }
+    }
+  }
+}
+
+void OpLogAggregator::Init() {
+  int32_t comm_channel_idx = GlobalContext::GetCommChannelIndexServer(my_id_);
+  std::vector<int32_t> server_ids;
+  GlobalContext::GetServerThreadIDs(comm_channel_idx, &server_ids);
+
+  ServerConnectMsg server_connect_msg;
+  void *msg = server_connect_msg.get_mem();
+  int32_t msg_size = server_connect_msg.get_size();
+
+  std::vector<int32_t> remote_server_ids;
+  std::vector<std::string> remote_server_addrs;
+  for (const auto &server_id : server_ids) {
+    if (GlobalContext::IsSameHost(
+            GlobalContext::thread_id_to_client_id(server_id),
+            GlobalContext::get_client_id()))
+      continue;
+    HostInfo server_info = GlobalContext::get_server_info(server_id);
+    remote_server_ids.push_back(server_id);
+    remote_server_addrs.push_back(server_info.ip + ":" + server_info.port);
+    GetDstOpLog(server_id);
+    ++num_remote_servers_;
+  }
+  if (!remote_server_ids.empty()) {
+    comm_bus_->ConnectTo(remote_server_ids, remote_server_addrs, msg,
+                         msg_size);
+  }
+}
+
+OpLogAggregator::DstOpLog &OpLogAggregator::GetDstOpLog(
+    int32_t dst_server_id) {
+  auto iter = dst_oplogs_.find(dst_server_id);
+  if (iter != dst_oplogs_.end())
+    return iter->second;
+
+  DstOpLog &dst_oplog = dst_oplogs_[dst_server_id];
+  for (const auto &bg_id : local_bg_ids_) {
+    dst_oplog.bg_clock.AddClock(bg_id, 0);
+  }
+  dst_oplog.num_shutdown_bgs = 0;
+  return dst_oplog;
+}
+
+AbstractRowOpLog *OpLogAggregator::NewRowOpLog(
+    const ServerTable &server_table) {
+  const AbstractRow *sample_row = server_table.get_sample_row();
+  size_t update_size = sample_row->get_update_size();
+  if (server_table.oplog_dense_serialized())
+    return CreateRowOpLog::CreateDenseRowOpLog(
+        update_size, sample_row,
+        server_table.get_table_info().dense_row_oplog_capacity);
+  return CreateRowOpLog::CreateSparseRowOpLog(update_size, sample_row, 0);
+}
+
+void OpLogAggregator::MergeOpLog(const void *oplog, DstOpLog *dst_oplog) {
+  SerializedOpLogReader oplog_reader(oplog, tables_);
+  bool to_read = oplog_reader.Restart();
+  if (!to_read)
+    return;
+
+  int32_t table_id;
+  int32_t row_id;
+  const int32_t *column_ids = 0;
+  int32_t num_updates;
+  bool started_new_table;
+  const void *updates = oplog_reader.Next(&table_id, &row_id, &column_ids,
+                                          &num_updates, &started_new_table);
+  while (updates != 0) {
+    auto table_iter = tables_.find(table_id);
+    CHECK(table_iter != tables_.end()) << "Not found table_id = " << table_id;
+    const ServerTable &server_table = table_iter->second;
+    const AbstractRow *sample_row = server_table.get_sample_row();
+    size_t update_size = sample_row->get_update_size();
+    bool dense = server_table.oplog_dense_serialized();
+
+    RowOpLogMap &row_oplogs = dst_oplog->table_oplogs[table_id];
+    auto row_iter = row_oplogs.find(row_id);
+    if (row_iter == row_oplogs.end()) {
+      row_iter = row_oplogs.insert(
+          std::make_pair(row_id, NewRowOpLog(server_table))).first;
+    }
+    AbstractRowOpLog *row_oplog = row_iter->second;
+
+    const uint8_t *update_ptr = reinterpret_cast<const uint8_t*>(updates);
+    for (int32_t i = 0; i < num_updates; ++i) {
+      int32_t col_id = dense ? i : column_ids[i];
+      sample_row->AddUpdates(col_id, row_oplog->FindCreate(col_id),
+                             update_ptr + i*update_size);
+    }
+
+    updates = oplog_reader.Next(&table_id, &row_id, &column_ids,
+                                &num_updates, &started_new_table);
+  }
+}
+
+void OpLogAggregator::HandleOpLogMsg(
+    int32_t bg_id, ClientSendOpLogMsg &client_send_oplog_msg) {
+  HandleBgOpLog(bg_id, client_send_oplog_msg.get_dst_server_id(),
+                client_send_oplog_msg.get_version(),
+                client_send_oplog_msg.get_is_clock(),
+                client_send_oplog_msg.get_bg_clock(),
+                (client_send_oplog_msg.get_avai_size() > 0)
+                ? client_send_oplog_msg.get_data() : 0);
+}
+
+void OpLogAggregator::HandleClockMsg(
+    int32_t bg_id, ClientClockMsg &client_clock_msg) {
+  int32_t num_dst_servers = client_clock_msg.get_num_dst_servers();
+  const int32_t *dst_server_ids = client_clock_msg.get_dst_server_ids();
+  for (int32_t i = 0; i < num_dst_servers; ++i) {
+    HandleBgOpLog(bg_id, dst_server_ids[i], client_clock_msg.get_version(),
+                  client_clock_msg.get_is_clock(),
+                  client_clock_msg.get_bg_clock(), 0);
+  }
+}
+
+void OpLogAggregator::HandleBgOpLog(
+    int32_t bg_id, int32_t dst_server_id, uint32_t version,
+    bool is_clock, int32_t bg_clock, const void *oplog) {
+  DstOpLog &dst_oplog = GetDstOpLog(dst_server_id);
+
+  auto info_iter = dst_oplog.bg_infos.find(bg_id);
+  if (info_iter == dst_oplog.bg_infos.end()) {
+    AggrOpLogBgInfo bg_info;
+    bg_info.bg_id = bg_id;
+    bg_info.first_version = version;
+    bg_info.is_clock = false;
+    bg_info.bg_clock = 0;
+    info_iter = dst_oplog.bg_infos.insert(std::make_pair(bg_id, bg_info)).first;
+  }
+  info_iter->second.last_version = version;
+
+  if (oplog != 0)
+    MergeOpLog(oplog, &dst_oplog);
+
+  if (!is_clock)
+    return;
+
+  info_iter->second.is_clock = true;
+  info_iter->second.bg_clock = bg_clock;
+  int32_t new_host_clock = dst_oplog.bg_clock.TickUntil(bg_id, bg_clock);
+  if (new_host_clock)
+    SendAggrOpLog(dst_server_id, &dst_oplog);
+}
+
+void OpLogAggregator::SendAggrOpLog(int32_t dst_server_id,
+                                    DstOpLog *dst_oplog) {
+  if (dst_oplog->bg_infos.empty())
+    return;
+
+  // 1) count
+  size_t oplog_size = 0;
+  int32_t num_tables = 0;
+  for (auto &table_pair : dst_oplog->table_oplogs) {
+    if (table_pair.second.empty())
+      continue;
+    const ServerTable &server_table = tables_.find(table_pair.first)->second;
+    bool dense = server_table.oplog_dense_serialized();
+    ++num_tables;
+    oplog_size += sizeof(int32_t) + sizeof(size_t) + sizeof(int32_t);
+    for (auto &row_pair : table_pair.second) {
+      AbstractRowOpLog *row_oplog = row_pair.second;
+      if (dense) {
+        oplog_size += sizeof(int32_t) + row_oplog->GetDenseSerializedSize();
+      } else {
+        row_oplog->ClearZerosAndGetNoneZeroSize();
+        oplog_size += sizeof(int32_t) + row_oplog->GetSparseSerializedSize();
+      }
+    }
+  }
+  if (num_tables > 0)
+    oplog_size += sizeof(int32_t);
+
+  // 2) serialize
+  int32_t num_bgs = dst_oplog->bg_infos.size();
+  AggrSendOpLogMsg aggr_oplog_msg(num_bgs*sizeof(AggrOpLogBgInfo)
+                                  + oplog_size);
+  aggr_oplog_msg.get_num_bgs() = num_bgs;
+  AggrOpLogBgInfo *bg_infos = aggr_oplog_msg.get_bg_infos();
+  for (const auto &info_pair : dst_oplog->bg_infos) {
+    *bg_infos = info_pair.second;
+    ++bg_infos;
+  }
+
+  uint8_t *mem = reinterpret_cast<uint8_t*>(aggr_oplog_msg.get_oplog());
+  if (num_tables > 0) {
+    *(reinterpret_cast<int32_t*>(mem)) = num_tables;
+    mem += sizeof(int32_t);
+  }
+  for (auto &table_pair : dst_oplog->table_oplogs) {
+    if (table_pair.second.empty())
+      continue;
+    const ServerTable &server_table = tables_.find(table_pair.first)->second;
+    bool dense = server_table.oplog_dense_serialized();
+
+    *(reinterpret_cast<int32_t*>(mem)) = table_pair.first;
+    mem += sizeof(int32_t);
+    *(reinterpret_cast<size_t*>(mem))
+        = server_table.get_sample_row()->get_update_size();
+    mem += sizeof(size_t);
+    *(reinterpret_cast<int32_t*>(mem)) = table_pair.second.size();
+    mem += sizeof(int32_t);
+
+    for (auto &row_pair : table_pair.second) {
+      *(reinterpret_cast<int32_t*>(mem)) = row_pair.first;
+      mem += sizeof(int32_t);
+      AbstractRowOpLog *row_oplog = row_pair.second;
+      if (dense)
+        mem += row_oplog->SerializeDense(mem);
+      else
+        mem += row_oplog->SerializeSparse(mem);
+      delete row_oplog;
+    }
+    table_pair.second.clear();
+  }
+
+  MemTransfer::TransferMem(comm_bus_, dst_server_id, &aggr_oplog_msg);
+  dst_oplog->bg_infos.clear();
+}
+
+void OpLogAggregator::HandleShutDownMsg(
+    ClientShutDownMsg &client_shut_down_msg) {
+  int32_t dst_server_id = client_shut_down_msg.get_dst_server_id();
+  DstOpLog &dst_oplog = GetDstOpLog(dst_server_id);
+  ++dst_oplog.num_shutdown_bgs;
+  if (dst_oplog.num_shutdown_bgs < (int32_t) local_bg_ids_.size())
+    return;
+
+  SendAggrOpLog(dst_server_id, &dst_oplog);
+
+  ClientShutDownMsg msg;
+  msg.get_dst_server_id() = dst_server_id;
+  for (size_t i = 0; i < local_bg_ids_.size(); ++i) {
+    size_t sent_size = (comm_bus_->*(comm_bus_->SendAny_))(
+        dst_server_id, msg.get_mem(), msg.get_size());
+    CHECK_EQ(sent_size, msg.get_size());
+  }
+  ++num_shutdown_servers_;
+}
+
+bool OpLogAggregator::AllShutDown() const {
+  return num_shutdown_servers_ == num_remote_servers_;
+}
+
+}  // namespace petuum
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <map>
+#include <vector>
+#include <stdint.h>
+#include <boost/noncopyable.hpp>
+#include <boost/unordered_map.hpp>
+
+#include <petuum_ps/server/server_table.hpp>
+#include <petuum_ps/thread/ps_msgs.hpp>
+#include <petuum_ps_common/oplog/abstract_row_oplog.hpp>
+#include <petuum_ps_common/util/vector_clock.hpp>
+#include <petuum_ps_common/comm_bus/comm_bus.hpp>
+
+namespace petuum {
+
+// Merges the oplogs that bg threads on this host send to servers on other
+// hosts. Lives in the host leader's server thread of each comm channel.
+// Updates to the same row from different bg threads are summed up, and one
+// AggrSendOpLogMsg per destination server leaves the host whenever the
+// minimum clock of the host's bg threads advances.
+// Single threaded: only the owning server thread calls it.
+class OpLogAggregator : boost::noncopyable {
+public:
+  // tables are the owning server's tables, used to parse and merge oplogs.
+  OpLogAggregator(int32_t my_id, CommBus *comm_bus,
+                  const boost::unordered_map<int32_t, ServerTable> &tables);
+  ~OpLogAggregator();
+
+  // Connect to the servers of my comm channel on other hosts.
+  void Init();
+
+  void HandleOpLogMsg(int32_t bg_id, ClientSendOpLogMsg &client_send_oplog_msg);
+
+  // Same as an empty ClientSendOpLogMsg to each of the destinations.
+  void HandleClockMsg(int32_t bg_id, ClientClockMsg &client_clock_msg);
+
+  // Relays the shutdown of all local bg threads once each of them has
+  // asked, after the last merged oplog.
+  void HandleShutDownMsg(ClientShutDownMsg &client_shut_down_msg);
+
+  bool AllShutDown() const;
+
+private:
+  typedef boost::unordered_map<int32_t, AbstractRowOpLog*> RowOpLogMap;
+
+  struct DstOpLog {
+    // bg id -> merged versions and clock of that bg
+    std::map<int32_t, AggrOpLogBgInfo> bg_infos;
+    // table id -> row id -> merged row oplog
+    std::map<int32_t, RowOpLogMap> table_oplogs;
+    VectorClock bg_clock;
+    int32_t num_shutdown_bgs;
+  };
+
+  DstOpLog &GetDstOpLog(int32_t dst_server_id);
+  // oplog may be 0 if there is none.
+  void HandleBgOpLog(int32_t bg_id, int32_t dst_server_id, uint32_t version,
+                     bool is_clock, int32_t bg_clock, const void *oplog);
+  void MergeOpLog(const void *oplog, DstOpLog *dst_oplog);
+  AbstractRowOpLog *NewRowOpLog(const ServerTable &server_table);
+  void SendAggrOpLog(int32_t dst_server_id, DstOpLog *dst_oplog);
+
+  const int32_t my_id_;
+  CommBus* const comm_bus_;
+  const boost::unordered_map<int32_t, ServerTable> &tables_;
+
+  // bg threads of my comm channel on this host
+  std::vector<int32_t> local_bg_ids_;
+  std::map<int32_t, DstOpLog> dst_oplogs_;
+  int32_t num_remote_servers_;
+  int32_t num_shutdown_servers_;
+};
+
+}  // namespace petuum
@@ -97,28 +97,37 @@ void Server::Init(int32_t server_id,
  void Server::GetFulfilledRowRequests(std::vector<ServerRowRequest> *requests) {
    int32_t clock = bg_clock_.get_min_clock();
    requests->clear();
-   auto iter = clock_bg_row_requests_.find(clock);
 
-   if(iter == clock_bg_row_requests_.end())
-     return;
-   boost::unordered_map<int32_t,
-     std::vector<ServerRowRequest> > &bg_row_requests = iter->second;
-
-   for (auto bg_iter = bg_row_requests.begin(); bg_iter != bg_row_requests.end();
-     bg_iter++) {
-     requests->insert(requests->end(), bg_iter->second.begin(),
-       bg_iter->second.end());
+   // The min clock may advance by more than one at a time when oplogs
+   // arrive merged by a host oplog aggregator.
+   auto iter = clock_bg_row_requests_.begin();
+   while (iter != clock_bg_row_requests_.end() && iter->first <= clock) {
+     boost::unordered_map<int32_t,
+       std::vector<ServerRowRequest> > &bg_row_requests = iter->second;
+
+     for (auto bg_iter = bg_row_requests.begin();
+          bg_iter != bg_row_requests.end(); bg_iter++) {
+       requests->insert(requests->end(), bg_iter->second.begin(),
+         bg_iter->second.end());
+     }
+     iter = clock_bg_row_requests_.erase(iter);
    }
-
-   clock_bg_row_requests_.erase(clock);
  }
 
  void Server::ApplyOpLogUpdateVersion(
      const void *oplog, size_t oplog_size, int32_t bg_thread_id,
      uint32_t version) {
-   CHECK_EQ(bg_version_map_[bg_thread_id] + 1, version);
-   bg_version_map_[bg_thread_id] = version;
+   UpdateBgVersion(bg_thread_id, version, version);
+   ApplyOpLog(oplog, oplog_size);
+ }
+
+ void Server::UpdateBgVersion(int32_t bg_thread_id, uint32_t first_version,
+                              uint32_t last_version) {
+   CHECK_EQ(bg_version_map_[bg_thread_id] + 1, first_version);
+   bg_version_map_[bg_thread_id] = last_version;
+ }
 
+ void Server::ApplyOpLog(const void *oplog, size_t oplog_size) {
    if (oplog_size == 0)
      return;
 
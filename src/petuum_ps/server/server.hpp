@@ -44,6 +44,11 @@ public:
   void ApplyOpLogUpdateVersion(
       const void *oplog, size_t oplog_size, int32_t bg_thread_id,
       uint32_t version);
+  // A bg thread's oplogs of version first_version ~ last_version arrive
+  // merged into one oplog via the host oplog aggregator.
+  void UpdateBgVersion(int32_t bg_thread_id, uint32_t first_version,
+                       uint32_t last_version);
+  void ApplyOpLog(const void *oplog, size_t oplog_size);
   int32_t GetMinClock();
   int32_t GetBgVersion(int32_t bg_thread_id);
 
@@ -58,6 +63,10 @@ public:
 
   bool AccumedOpLogSinceLastPush();
 
+  const boost::unordered_map<int32_t, ServerTable> &get_tables() const {
+    return tables_;
+  }
+
 private:
   VectorClock bg_clock_;
 
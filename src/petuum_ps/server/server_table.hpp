@@ -129,6 +129,14 @@ public:
     return table_info_.oplog_dense_serialized;
   }
 
+  const AbstractRow *get_sample_row() const {
+    return sample_row_;
+  }
+
+  const TableInfo &get_table_info() const {
+    return table_info_;
+  }
+
   bool AppendTableToBuffs(
       int32_t client_id_st,
       boost::unordered_map<int32_t, RecordBuff> *buffs,
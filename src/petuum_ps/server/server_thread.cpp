@@ -3,6 +3,8 @@
 #include <petuum_ps/thread/context.hpp>
 #include <petuum_ps/thread/ps_msgs.hpp>
 #include <petuum_ps_common/util/stats.hpp>
+#include <petuum_ps_common/util/metrics.hpp>
+#include <petuum_ps_common/util/trace.hpp>
 #include <petuum_ps_common/thread/mem_transfer.hpp>
 
 namespace petuum {
@@ -102,6 +104,7 @@ void ServerThread::SendToAllBgThreads(MsgBase *msg) {
 }
 
 void ServerThread::InitServer() {
+  STATS_SERVER_INIT_BEGIN();
   ConnectToNameNode();
 
   int32_t num_bgs;
@@ -110,13 +113,25 @@ void ServerThread::InitServer() {
     int32_t client_id;
     bool is_client;
     int32_t bg_id = GetConnection(&is_client, &client_id);
-    CHECK(is_client);
+    if (!is_client) {
+      // host oplog aggregator of another host
+      CHECK(GlobalContext::get_host_oplog_aggr());
+      --num_bgs;
+      continue;
+    }
     bg_worker_ids_[num_bgs] = bg_id;
   }
 
   server_obj_.Init(my_id_, bg_worker_ids_);
   ClientStartMsg client_start_msg;
   SendToAllBgThreads(reinterpret_cast<MsgBase*>(&client_start_msg));
+
+  if (GlobalContext::am_i_oplog_aggr()) {
+    oplog_aggr_ = new OpLogAggregator(my_id_, comm_bus_,
+                                      server_obj_.get_tables());
+    oplog_aggr_->Init();
+  }
+  STATS_SERVER_INIT_END();
 }
 
 bool ServerThread::HandleShutDownMsg() {
@@ -138,28 +153,21 @@ bool ServerThread::HandleShutDownMsg() {
   return false;
 }
 
-void ServerThread::HandleCreateTable(int32_t sender_id,
-                                     CreateTableMsg &create_table_msg) {
-  int32_t table_id = create_table_msg.get_table_id();
+void ServerThread::HandleCreateTables(int32_t sender_id,
+                                      CreateTablesMsg &create_tables_msg) {
+  int32_t num_tables = create_tables_msg.get_num_tables();
 
   // I'm not name node
-  CreateTableReplyMsg create_table_reply_msg;
-  create_table_reply_msg.get_table_id() = create_table_msg.get_table_id();
+  CreateTablesReplyMsg create_tables_reply_msg;
+  create_tables_reply_msg.get_num_tables() = num_tables;
   size_t sent_size = (comm_bus_->*(comm_bus_->SendAny_))(sender_id,
-    create_table_reply_msg.get_mem(), create_table_reply_msg.get_size());
-  CHECK_EQ(sent_size, create_table_reply_msg.get_size());
-
-  TableInfo table_info;
-  table_info.table_staleness = create_table_msg.get_staleness();
-  table_info.row_type = create_table_msg.get_row_type();
-  table_info.row_capacity = create_table_msg.get_row_capacity();
-  table_info.oplog_dense_serialized
-      = create_table_msg.get_oplog_dense_serialized();
-  table_info.row_oplog_type
-      = create_table_msg.get_row_oplog_type();
-  table_info.dense_row_oplog_capacity
-      = create_table_msg.get_dense_row_oplog_capacity();
-  server_obj_.CreateTable(table_id, table_info);
+    create_tables_reply_msg.get_mem(), create_tables_reply_msg.get_size());
+  CHECK_EQ(sent_size, create_tables_reply_msg.get_size());
+
+  CreateTableRecord *records = create_tables_msg.get_records();
+  for (int32_t i = 0; i < num_tables; ++i) {
+    server_obj_.CreateTable(records[i].table_id, records[i].table_info);
+  }
 }
 
 void ServerThread::HandleRowRequest(int32_t sender_id,
@@ -186,6 +194,8 @@ void ServerThread::ReplyRowRequest(int32_t bg_id, ServerRow *server_row,
                                    int32_t table_id, int32_t row_id,
                                    int32_t server_clock, uint32_t version) {
   size_t row_size = server_row->SerializedSize();
+  TraceScope trace_scope(kTraceServerReplyRowRequest, table_id, row_id,
+                         row_size);
 
   ServerRowRequestReplyMsg server_row_request_reply_msg(row_size);
   server_row_request_reply_msg.get_table_id() = table_id;
@@ -207,33 +217,26 @@ void ServerThread::HandleOpLogMsg(int32_t sender_id,
   uint32_t version = client_send_oplog_msg.get_version();
   int32_t bg_clock = client_send_oplog_msg.get_bg_clock();
 
+  Metrics::Add(kMetricServerOpLogRecvBytes, client_send_oplog_msg.get_size());
   STATS_SERVER_ADD_PER_CLOCK_OPLOG_SIZE(client_send_oplog_msg.get_size());
 
   STATS_SERVER_ACCUM_APPLY_OPLOG_BEGIN();
-  server_obj_.ApplyOpLogUpdateVersion(
-      client_send_oplog_msg.get_data(), client_send_oplog_msg.get_avai_size(),
-      sender_id, version);
+  {
+    TraceScope trace_scope(kTraceServerApplyOpLog, -1, -1,
+                           client_send_oplog_msg.get_size());
+    server_obj_.ApplyOpLogUpdateVersion(
+        client_send_oplog_msg.get_data(),
+        client_send_oplog_msg.get_avai_size(), sender_id, version);
+  }
   STATS_SERVER_ACCUM_APPLY_OPLOG_END();
 
   bool clock_changed = false;
   if (is_clock) {
     clock_changed = server_obj_.ClockUntil(sender_id, bg_clock);
     if (clock_changed) {
-      std::vector<ServerRowRequest> requests;
-      server_obj_.GetFulfilledRowRequests(&requests);
-      for (auto request_iter = requests.begin();
-	   request_iter != requests.end(); request_iter++) {
-	int32_t table_id = request_iter->table_id;
-	int32_t row_id = request_iter->row_id;
-	int32_t bg_id = request_iter->bg_id;
-	uint32_t version = server_obj_.GetBgVersion(bg_id);
-	ServerRow *server_row = server_obj_.FindCreateRow(table_id, row_id);
-        RowSubscribe(server_row,
-                     GlobalContext::thread_id_to_client_id(bg_id));
-	int32_t server_clock = server_obj_.GetMinClock();
-	ReplyRowRequest(bg_id, server_row, table_id, row_id, server_clock,
-                        version);
-      }
+      Trace::SetClock(server_obj_.GetMinClock());
+      ReplyFulfilledRowRequests();
+      Metrics::Add(kMetricServerClock);
       STATS_SERVER_CLOCK();
     }
   }
@@ -245,6 +248,66 @@ void ServerThread::HandleOpLogMsg(int32_t sender_id,
   }
 }
 
+void ServerThread::HandleAggrOpLogMsg(int32_t sender_id,
+                                      AggrSendOpLogMsg &aggr_send_oplog_msg) {
+  int32_t num_bgs = aggr_send_oplog_msg.get_num_bgs();
+  AggrOpLogBgInfo *bg_infos = aggr_send_oplog_msg.get_bg_infos();
+
+  Metrics::Add(kMetricServerOpLogRecvBytes, aggr_send_oplog_msg.get_size());
+  STATS_SERVER_ADD_PER_CLOCK_OPLOG_SIZE(aggr_send_oplog_msg.get_size());
+
+  STATS_SERVER_ACCUM_APPLY_OPLOG_BEGIN();
+  {
+    TraceScope trace_scope(kTraceServerApplyOpLog, -1, -1,
+                           aggr_send_oplog_msg.get_size());
+    for (int32_t i = 0; i < num_bgs; ++i) {
+      server_obj_.UpdateBgVersion(bg_infos[i].bg_id,
+                                  bg_infos[i].first_version,
+                                  bg_infos[i].last_version);
+    }
+    server_obj_.ApplyOpLog(aggr_send_oplog_msg.get_oplog(),
+                           aggr_send_oplog_msg.get_oplog_size());
+  }
+  STATS_SERVER_ACCUM_APPLY_OPLOG_END();
+
+  bool clock_changed = false;
+  for (int32_t i = 0; i < num_bgs; ++i) {
+    if (bg_infos[i].is_clock
+        && server_obj_.ClockUntil(bg_infos[i].bg_id, bg_infos[i].bg_clock))
+      clock_changed = true;
+  }
+  if (clock_changed) {
+    Trace::SetClock(server_obj_.GetMinClock());
+    ReplyFulfilledRowRequests();
+    Metrics::Add(kMetricServerClock);
+    STATS_SERVER_CLOCK();
+    ServerPushRow(clock_changed);
+  } else {
+    for (int32_t i = 0; i < num_bgs; ++i) {
+      SendOpLogAckMsg(bg_infos[i].bg_id,
+                      server_obj_.GetBgVersion(bg_infos[i].bg_id));
+    }
+  }
+}
+
+void ServerThread::ReplyFulfilledRowRequests() {
+  std::vector<ServerRowRequest> requests;
+  server_obj_.GetFulfilledRowRequests(&requests);
+  for (auto request_iter = requests.begin();
+       request_iter != requests.end(); request_iter++) {
+    int32_t table_id = request_iter->table_id;
+    int32_t row_id = request_iter->row_id;
+    int32_t bg_id = request_iter->bg_id;
+    uint32_t version = server_obj_.GetBgVersion(bg_id);
+    ServerRow *server_row = server_obj_.FindCreateRow(table_id, row_id);
+    RowSubscribe(server_row,
+                 GlobalContext::thread_id_to_client_id(bg_id));
+    int32_t server_clock = server_obj_.GetMinClock();
+    ReplyRowRequest(bg_id, server_row, table_id, row_id, server_clock,
+                    version);
+  }
+}
+
 long ServerThread::ServerIdleWork() {
   return 0;
 }
@@ -260,6 +323,7 @@ void *ServerThread::operator() () {
   ThreadContext::RegisterThread(my_id_);
 
   STATS_REGISTER_THREAD(kServerThread);
+  Trace::RegisterThread("server");
 
   SetUpCommBus();
 
@@ -272,6 +336,7 @@ void *ServerThread::operator() () {
   MsgType msg_type;
   void *msg_mem;
   bool destroy_mem = false;
+  bool all_bgs_shut_down = false;
   long timeout_milli = GlobalContext::get_server_idle_milli();
   while(1) {
     bool received = WaitMsg_(&sender_id, &zmq_msg, timeout_milli);
@@ -297,18 +362,28 @@ void *ServerThread::operator() () {
     switch (msg_type) {
     case kClientShutDown:
       {
-	bool shutdown = HandleShutDownMsg();
-	if (shutdown) {
+        ClientShutDownMsg client_shut_down_msg(msg_mem);
+        if (client_shut_down_msg.get_dst_server_id() != my_id_) {
+          CHECK(oplog_aggr_ != 0);
+          oplog_aggr_->HandleShutDownMsg(client_shut_down_msg);
+        } else {
+          all_bgs_shut_down = HandleShutDownMsg();
+        }
+	if (all_bgs_shut_down
+            && (oplog_aggr_ == 0 || oplog_aggr_->AllShutDown())) {
 	  comm_bus_->ThreadDeregister();
 	  STATS_DEREGISTER_THREAD();
 	  return 0;
 	}
 	break;
       }
-    case kCreateTable:
+    case kServerConnect:
+      // host oplog aggregator of another host connecting late
+      break;
+    case kCreateTables:
       {
-	CreateTableMsg create_table_msg(msg_mem);
-	HandleCreateTable(sender_id, create_table_msg);
+	CreateTablesMsg create_tables_msg(msg_mem);
+	HandleCreateTables(sender_id, create_tables_msg);
 	break;
       }
     case kRowRequest:
@@ -321,7 +396,28 @@ void *ServerThread::operator() () {
       {
 	ClientSendOpLogMsg client_send_oplog_msg(msg_mem);
 
-	HandleOpLogMsg(sender_id, client_send_oplog_msg);
+        if (client_send_oplog_msg.get_dst_server_id() != my_id_) {
+          CHECK(oplog_aggr_ != 0);
+          oplog_aggr_->HandleOpLogMsg(sender_id, client_send_oplog_msg);
+        } else {
+          HandleOpLogMsg(sender_id, client_send_oplog_msg);
+          Metrics::Add(kMetricServerOpLogMsgRecv);
+          STATS_SERVER_OPLOG_MSG_RECV_INC_ONE();
+        }
+      }
+      break;
+    case kClientClock:
+      {
+        ClientClockMsg client_clock_msg(msg_mem);
+        CHECK(oplog_aggr_ != 0);
+        oplog_aggr_->HandleClockMsg(sender_id, client_clock_msg);
+      }
+      break;
+    case kAggrSendOpLog:
+      {
+        AggrSendOpLogMsg aggr_send_oplog_msg(msg_mem);
+        HandleAggrOpLogMsg(sender_id, aggr_send_oplog_msg);
+        Metrics::Add(kMetricServerOpLogMsgRecv);
         STATS_SERVER_OPLOG_MSG_RECV_INC_ONE();
       }
       break;
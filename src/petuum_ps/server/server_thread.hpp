@@ -6,6 +6,7 @@
 #include <pthread.h>
 
 #include <petuum_ps/server/server.hpp>
+#include <petuum_ps/server/oplog_aggregator.hpp>
 #include <petuum_ps_common/util/thread.hpp>
 #include <petuum_ps/thread/context.hpp>
 
@@ -17,9 +18,13 @@ public:
       bg_worker_ids_(GlobalContext::get_num_clients()),
       num_shutdown_bgs_(0),
       comm_bus_(GlobalContext::comm_bus),
-      init_barrier_(init_barrier) { }
+      init_barrier_(init_barrier),
+      oplog_aggr_(0) { }
 
-  virtual ~ServerThread() { }
+  virtual ~ServerThread() {
+    if (oplog_aggr_ != 0)
+      delete oplog_aggr_;
+  }
 
   void ShutDown() {
     Join();
@@ -48,13 +53,17 @@ protected:
 
   void SendToAllBgThreads(MsgBase *msg);
   bool HandleShutDownMsg();
-  void HandleCreateTable(int32_t sender_id, CreateTableMsg &create_table_msg);
+  void HandleCreateTables(int32_t sender_id,
+                          CreateTablesMsg &create_tables_msg);
   void HandleRowRequest(int32_t sender_id, RowRequestMsg &row_request_msg);
   void ReplyRowRequest(int32_t bg_id, ServerRow *server_row,
                        int32_t table_id, int32_t row_id, int32_t server_clock,
                        uint32_t version);
   void HandleOpLogMsg(int32_t sender_id,
                       ClientSendOpLogMsg &client_send_oplog_msg);
+  void HandleAggrOpLogMsg(int32_t sender_id,
+                          AggrSendOpLogMsg &aggr_send_oplog_msg);
+  void ReplyFulfilledRowRequests();
 
   virtual long ServerIdleWork();
   virtual long ResetServerIdleMilli();
@@ -70,6 +79,9 @@ protected:
   CommBus* const comm_bus_;
 
   pthread_barrier_t *init_barrier_;
+
+  // merges oplogs of co-located clients, only in the host leader
+  OpLogAggregator *oplog_aggr_;
 };
 
 }
@@ -2,6 +2,7 @@
 #include <petuum_ps/thread/trans_time_estimate.hpp>
 #include <petuum_ps/thread/context.hpp>
 #include <petuum_ps_common/util/stats.hpp>
+#include <petuum_ps_common/util/trace.hpp>
 
 namespace petuum {
 void SSPAggrServerThread::SetWaitMsg() {
@@ -16,8 +17,10 @@ long SSPAggrServerThread::ServerIdleWork() {
   }
 
   if (server_obj_.AccumedOpLogSinceLastPush()) {
+    TraceScope trace_scope(kTraceServerPushRow);
     size_t sent_bytes
         = server_obj_.CreateSendServerPushRowMsgsPartial(SendServerPushRowMsg);
+    trace_scope.set_bytes(sent_bytes);
     row_send_milli_sec_ = TransTimeEstimate::EstimateTransMillisec(sent_bytes);
 
     msg_send_timer_.restart();
@@ -34,8 +37,12 @@ long SSPAggrServerThread::ResetServerIdleMilli() {
 
 void SSPAggrServerThread::ServerPushRow(bool clock_changed) {
   STATS_SERVER_ACCUM_PUSH_ROW_BEGIN();
-  size_t sent_bytes
-      = server_obj_.CreateSendServerPushRowMsgs(SendServerPushRowMsg);
+  size_t sent_bytes;
+  {
+    TraceScope trace_scope(kTraceServerPushRow);
+    sent_bytes = server_obj_.CreateSendServerPushRowMsgs(SendServerPushRowMsg);
+    trace_scope.set_bytes(sent_bytes);
+  }
   STATS_SERVER_ACCUM_PUSH_ROW_END();
 
   row_send_milli_sec_ = TransTimeEstimate::EstimateTransMillisec(sent_bytes);
@@ -2,6 +2,8 @@
 #include <petuum_ps/thread/context.hpp>
 #include <petuum_ps_common/thread/mem_transfer.hpp>
 #include <petuum_ps_common/util/stats.hpp>
+#include <petuum_ps_common/util/metrics.hpp>
+#include <petuum_ps_common/util/trace.hpp>
 
 namespace petuum {
 
@@ -9,7 +11,9 @@ void SSPPushServerThread::SendServerPushRowMsg(
     int32_t bg_id, ServerPushRowMsg *msg, bool last_msg,
     int32_t version, int32_t server_min_clock) {
   msg->get_version() = version;
+  Metrics::Add(kMetricServerPushRowBytes, msg->get_size());
   STATS_SERVER_ADD_PER_CLOCK_PUSH_ROW_SIZE(msg->get_size());
+  Metrics::Add(kMetricServerPushRowMsgSend);
   STATS_SERVER_PUSH_ROW_MSG_SEND_INC_ONE();
 
   if (last_msg) {
@@ -27,7 +31,9 @@ void SSPPushServerThread::SendServerPushRowMsg(
 
 void SSPPushServerThread::ServerPushRow(bool clock_changed) {
   STATS_SERVER_ACCUM_PUSH_ROW_BEGIN();
-  server_obj_.CreateSendServerPushRowMsgs(SendServerPushRowMsg);
+  TraceScope trace_scope(kTraceServerPushRow);
+  trace_scope.set_bytes(
+      server_obj_.CreateSendServerPushRowMsgs(SendServerPushRowMsg));
   STATS_SERVER_ACCUM_PUSH_ROW_END();
 }
 
@@ -5,9 +5,12 @@
 #include <petuum_ps/client/oplog_serializer.hpp>
 #include <petuum_ps/client/ssp_client_row.hpp>
 #include <petuum_ps_common/util/stats.hpp>
+#include <petuum_ps_common/util/metrics.hpp>
+#include <petuum_ps_common/util/trace.hpp>
 #include <petuum_ps_common/comm_bus/comm_bus.hpp>
 #include <petuum_ps_common/thread/mem_transfer.hpp>
 #include <petuum_ps/thread/context.hpp>
+#include <petuum_ps/oplog/create_row_oplog.hpp>
 #include <glog/logging.h>
 #include <utility>
 #include <limits.h>
@@ -26,6 +29,7 @@ AbstractBgWorker::AbstractBgWorker(int32_t id,
     version_(0),
     client_clock_(0),
     clock_has_pushed_(-1),
+    staleness_report_ns_(0),
     comm_bus_(GlobalContext::comm_bus),
     init_barrier_(init_barrier),
     create_table_barrier_(create_table_barrier) {
@@ -98,6 +102,14 @@ bool AbstractBgWorker::CreateTable(int32_t table_id,
         = table_config.process_storage_type;
     bg_create_table_msg.get_no_oplog_replay()
         = table_config.no_oplog_replay;
+    bg_create_table_msg.get_col_segment_size()
+        = table_config.col_segment_size;
+    bg_create_table_msg.get_thread_cache_cow()
+        = table_config.thread_cache_cow;
+    bg_create_table_msg.get_adaptive_staleness_min()
+        = table_info.adaptive_staleness_min;
+    bg_create_table_msg.get_adaptive_staleness_max()
+        = table_info.adaptive_staleness_max;
 
     size_t sent_size = SendMsg(
         reinterpret_cast<MsgBase*>(&bg_create_table_msg));
@@ -236,6 +248,7 @@ void AbstractBgWorker::InitCommBus() {
 }
 
 void AbstractBgWorker::BgServerHandshake() {
+  STATS_BG_HANDSHAKE_BEGIN();
   {
     // connect to name node
     int32_t name_node_id = GlobalContext::get_name_node_id();
@@ -254,10 +267,25 @@ void AbstractBgWorker::BgServerHandshake() {
     CHECK_EQ(msg_type, kConnectServer) << "sender_id = " << sender_id;
   }
 
-  // connect to servers
+  // connect to servers, remote ones all at once
   {
+    std::vector<int32_t> remote_server_ids;
+    std::vector<std::string> remote_server_addrs;
     for (const auto &server_id : server_ids_) {
-      ConnectToNameNodeOrServer(server_id);
+      if (comm_bus_->IsLocalEntity(server_id)) {
+        ConnectToNameNodeOrServer(server_id);
+      } else {
+        HostInfo server_info = GlobalContext::get_server_info(server_id);
+        remote_server_ids.push_back(server_id);
+        remote_server_addrs.push_back(server_info.ip + ":" + server_info.port);
+      }
+    }
+    if (!remote_server_ids.empty()) {
+      ClientConnectMsg client_connect_msg;
+      client_connect_msg.get_client_id() = GlobalContext::get_client_id();
+      comm_bus_->ConnectTo(remote_server_ids, remote_server_addrs,
+                           client_connect_msg.get_mem(),
+                           client_connect_msg.get_size());
     }
   }
 
@@ -276,9 +304,12 @@ void AbstractBgWorker::BgServerHandshake() {
       CHECK_EQ(msg_type, kClientStart);
     }
   }
+  STATS_BG_HANDSHAKE_END();
 }
 
 void AbstractBgWorker::HandleCreateTables() {
+  STATS_BG_CREATE_TABLES_BEGIN();
+  std::vector<CreateTableRecord> records;
   for (int32_t num_created_tables = 0;
        num_created_tables < GlobalContext::get_num_tables();
        ++num_created_tables) {
@@ -327,40 +358,43 @@ void AbstractBgWorker::HandleCreateTables() {
           = bg_create_table_msg.get_process_storage_type();
       client_table_config.no_oplog_replay
           = bg_create_table_msg.get_no_oplog_replay();
+      client_table_config.col_segment_size
+          = bg_create_table_msg.get_col_segment_size();
+      client_table_config.thread_cache_cow
+          = bg_create_table_msg.get_thread_cache_cow();
+      client_table_config.table_info.adaptive_staleness_min
+          = bg_create_table_msg.get_adaptive_staleness_min();
+      client_table_config.table_info.adaptive_staleness_max
+          = bg_create_table_msg.get_adaptive_staleness_max();
+
+      table_id = bg_create_table_msg.get_table_id();
+
+      // A new bound takes effect staleness_adapt_interval clocks after the
+      // report; no client may get there before the update arrives.
+      const TableInfo &table_info = client_table_config.table_info;
+      if (table_info.adaptive_staleness_max
+          > table_info.adaptive_staleness_min) {
+        CHECK_GT(GlobalContext::get_staleness_adapt_interval(),
+                 table_info.adaptive_staleness_max + 1)
+            << "table " << table_id;
+      }
 
-      CreateTableMsg create_table_msg;
-      create_table_msg.get_table_id() = bg_create_table_msg.get_table_id();
-      create_table_msg.get_staleness() = bg_create_table_msg.get_staleness();
-      create_table_msg.get_row_type() = bg_create_table_msg.get_row_type();
-      create_table_msg.get_row_capacity()
-	= bg_create_table_msg.get_row_capacity();
-      create_table_msg.get_oplog_dense_serialized()
-          = bg_create_table_msg.get_oplog_dense_serialized();
-      create_table_msg.get_row_oplog_type()
-          = bg_create_table_msg.get_row_oplog_type();
-      create_table_msg.get_dense_row_oplog_capacity()
-          = bg_create_table_msg.get_dense_row_oplog_capacity();
-
-      table_id = create_table_msg.get_table_id();
-
-      // send msg to name node
-      int32_t name_node_id = GlobalContext::get_name_node_id();
-      size_t sent_size = (comm_bus_->*(comm_bus_->SendAny_))(name_node_id,
-	create_table_msg.get_mem(), create_table_msg.get_size());
-      CHECK_EQ(sent_size, create_table_msg.get_size());
+      CreateTableRecord record;
+      record.table_id = table_id;
+      record.table_info = client_table_config.table_info;
+      // Servers only ever see the segments of column-segmented rows.
+      if (client_table_config.col_segment_size > 0) {
+        record.table_info.row_capacity = client_table_config.col_segment_size;
+        record.table_info.dense_row_oplog_capacity
+            = client_table_config.col_segment_size;
+      }
+      records.push_back(record);
     }
 
-    // wait for response from name node
+    // The client table is usable locally right away. App threads cannot
+    // reach the servers before create_table_barrier_, which the head bg
+    // passes only once the servers have all tables.
     {
-      zmq::message_t zmq_msg;
-      int32_t name_node_id;
-      (comm_bus_->*(comm_bus_->RecvAny_))(&name_node_id, &zmq_msg);
-      MsgType msg_type = MsgBase::get_msg_type(zmq_msg.data());
-
-      CHECK_EQ(msg_type, kCreateTableReply);
-      CreateTableReplyMsg create_table_reply_msg(zmq_msg.data());
-      CHECK_EQ(create_table_reply_msg.get_table_id(), table_id);
-
       ClientTable *client_table;
       try {
 	client_table  = new ClientTable(table_id, client_table_config);
@@ -370,12 +404,36 @@ void AbstractBgWorker::HandleCreateTables() {
       // not thread-safe
       (*tables_)[table_id] = client_table;
 
-      size_t sent_size = comm_bus_->SendInProc(sender_id, zmq_msg.data(),
-        zmq_msg.size());
-      CHECK_EQ(sent_size, zmq_msg.size());
+      CreateTableReplyMsg create_table_reply_msg;
+      create_table_reply_msg.get_table_id() = table_id;
+      size_t sent_size = comm_bus_->SendInProc(sender_id,
+        create_table_reply_msg.get_mem(), create_table_reply_msg.get_size());
+      CHECK_EQ(sent_size, create_table_reply_msg.get_size());
     }
   }
 
+  // One round trip to the name node for all tables.
+  {
+    CreateTablesMsg create_tables_msg(records.size());
+    std::copy(records.begin(), records.end(),
+              create_tables_msg.get_records());
+    int32_t name_node_id = GlobalContext::get_name_node_id();
+    size_t sent_size = (comm_bus_->*(comm_bus_->SendAny_))(name_node_id,
+      create_tables_msg.get_mem(), create_tables_msg.get_size());
+    CHECK_EQ(sent_size, create_tables_msg.get_size());
+  }
+
+  {
+    zmq::message_t zmq_msg;
+    int32_t name_node_id;
+    (comm_bus_->*(comm_bus_->RecvAny_))(&name_node_id, &zmq_msg);
+    MsgType msg_type = MsgBase::get_msg_type(zmq_msg.data());
+    CHECK_EQ(msg_type, kCreateTablesReply);
+    CreateTablesReplyMsg create_tables_reply_msg(zmq_msg.data());
+    CHECK_EQ(create_tables_reply_msg.get_num_tables(),
+             (int32_t) records.size());
+  }
+
   {
     zmq::message_t zmq_msg;
     int32_t sender_id;
@@ -383,18 +441,72 @@ void AbstractBgWorker::HandleCreateTables() {
     MsgType msg_type = MsgBase::get_msg_type(zmq_msg.data());
     CHECK_EQ(msg_type, kCreatedAllTables);
   }
+  staleness_report_ns_ = TableStaleness::NowNs();
+  STATS_BG_CREATE_TABLES_END();
+}
+
+void AbstractBgWorker::SendStalenessReport() {
+  int64_t now_ns = TableStaleness::NowNs();
+  // Total app thread time since the last report.
+  double thread_ns = std::max(1., double(now_ns - staleness_report_ns_)
+                              * GlobalContext::get_num_table_threads());
+  staleness_report_ns_ = now_ns;
+
+  std::vector<StalenessReportRecord> records;
+  for (const auto &table_pair : (*tables_)) {
+    TableStaleness &table_staleness = table_pair.second->get_table_staleness();
+    if (!table_staleness.adaptive())
+      continue;
+    StalenessReportRecord record;
+    record.table_id = table_pair.first;
+    record.blocked_frac = table_staleness.TakeBlockedNs() / thread_ns;
+    records.push_back(record);
+  }
+  if (records.empty())
+    return;
+
+  StalenessReportMsg staleness_report_msg(records.size());
+  staleness_report_msg.get_client_id() = GlobalContext::get_client_id();
+  staleness_report_msg.get_report_clock() = client_clock_;
+  staleness_report_msg.get_progress() = 0;
+  staleness_report_msg.get_has_progress()
+      = TableStaleness::TakeProgress(&staleness_report_msg.get_progress());
+  std::copy(records.begin(), records.end(),
+            staleness_report_msg.get_records());
+  int32_t name_node_id = GlobalContext::get_name_node_id();
+  size_t sent_size = (comm_bus_->*(comm_bus_->SendAny_))(name_node_id,
+    staleness_report_msg.get_mem(), staleness_report_msg.get_size());
+  CHECK_EQ(sent_size, staleness_report_msg.get_size());
+}
+
+void AbstractBgWorker::HandleStalenessUpdate(
+    StalenessUpdateMsg &staleness_update_msg) {
+  int32_t effective_clock = staleness_update_msg.get_effective_clock();
+  StalenessUpdateRecord *records = staleness_update_msg.get_records();
+  for (int32_t i = 0; i < staleness_update_msg.get_num_tables(); ++i) {
+    auto table_iter = tables_->find(records[i].table_id);
+    CHECK(table_iter != tables_->end()) << records[i].table_id;
+    table_iter->second->get_table_staleness().Schedule(
+        records[i].staleness, effective_clock);
+  }
 }
 
 long AbstractBgWorker::HandleClockMsg(bool clock_advanced) {
   STATS_BG_ACCUM_CLOCK_END_OPLOG_SERIALIZE_BEGIN();
-  BgOpLog *bg_oplog = PrepareOpLogsToSend();
-
-  CreateOpLogMsgs(bg_oplog);
+  BgOpLog *bg_oplog;
+  {
+    TraceScope trace_scope(kTraceBgCreateOpLogMsgs);
+    bg_oplog = PrepareOpLogsToSend();
+    CreateOpLogMsgs(bg_oplog);
+  }
   STATS_BG_ACCUM_CLOCK_END_OPLOG_SERIALIZE_END();
 
   clock_has_pushed_ = client_clock_;
 
-  SendOpLogMsgs(clock_advanced);
+  {
+    TraceScope trace_scope(kTraceBgSendOpLogMsgs);
+    trace_scope.set_bytes(SendOpLogMsgs(clock_advanced));
+  }
   TrackBgOpLog(bg_oplog);
   return 0;
 }
@@ -567,22 +679,24 @@ void AbstractBgWorker::CreateOpLogMsgs(const BgOpLog *bg_oplog) {
 
     oplog_serializer.AssignMem(server_oplog_msg_map_[server_id]->get_data());
 
-    for (const auto &table_pair : (*tables_)) {
-      int32_t table_id = table_pair.first;
+    // Only tables with oplogs for this server.
+    for (const auto &table_size_pair : server_iter->second) {
+      int32_t table_id = table_size_pair.first;
       uint8_t *table_ptr
 	= reinterpret_cast<uint8_t*>(oplog_serializer.GetTablePtr(table_id));
 
-      if (table_ptr == 0) {
-        table_server_mem_map[table_id].erase(server_id);
+      if (table_ptr == 0)
         continue;
-      }
+      auto table_iter = tables_->find(table_id);
+      CHECK(table_iter != tables_->end()) << "Cannot find table " << table_id;
+      ClientTable *table = table_iter->second;
 
       // table id
       *(reinterpret_cast<int32_t*>(table_ptr)) = table_id;
 
       // table update size
       *(reinterpret_cast<size_t*>(table_ptr + sizeof(int32_t)))
-	= table_pair.second->get_sample_row()->get_update_size();
+	= table->get_sample_row()->get_update_size();
 
       // offset for table rows
       table_server_mem_map[table_id][server_id]
@@ -590,26 +704,45 @@ void AbstractBgWorker::CreateOpLogMsgs(const BgOpLog *bg_oplog) {
     }
   }
 
-  for (const auto &table_pair : (*tables_)) {
+  for (auto &table_pair : table_server_mem_map) {
     int32_t table_id = table_pair.first;
-    ClientTable *table = table_pair.second;
+    auto table_iter = tables_->find(table_id);
+    CHECK(table_iter != tables_->end()) << "Cannot find table " << table_id;
+    ClientTable *table = table_iter->second;
     if (table->get_no_oplog_replay()) {
       auto serializer_iter = row_oplog_serializer_map_.find(table_id);
       CHECK(serializer_iter != row_oplog_serializer_map_.end());
 
       RowOpLogSerializer *row_oplog_serializer = serializer_iter->second;
-      row_oplog_serializer->SerializeByServer(&(table_server_mem_map[table_id]));
+      row_oplog_serializer->SerializeByServer(&(table_pair.second));
     } else {
       BgOpLogPartition *oplog_partition = bg_oplog->Get(table_id);
+      CHECK(oplog_partition != 0) << "table_id = " << table_id;
       oplog_partition->SerializeByServer(
-          &(table_server_mem_map[table_id]),
-          table_pair.second->oplog_dense_serialized());
+          &(table_pair.second), table->oplog_dense_serialized());
     }
   }
 }
 
+size_t AbstractBgWorker::SendClockOpLogMsg(int32_t recv_id,
+                                           int32_t dst_server_id,
+                                           bool clock_advanced) {
+  ClientSendOpLogMsg clock_oplog_msg(0);
+  clock_oplog_msg.get_is_clock() = clock_advanced;
+  clock_oplog_msg.get_client_id() = GlobalContext::get_client_id();
+  clock_oplog_msg.get_version() = version_;
+  clock_oplog_msg.get_bg_clock() = clock_has_pushed_ + 1;
+  clock_oplog_msg.get_dst_server_id() = dst_server_id;
+
+  size_t sent_size = clock_oplog_msg.get_size();
+  MemTransfer::TransferMem(comm_bus_, recv_id, &clock_oplog_msg);
+  return sent_size;
+}
+
 size_t AbstractBgWorker::SendOpLogMsgs(bool clock_advanced) {
   size_t accum_size = 0;
+  // aggregator server id -> relayed servers that only get the clock
+  std::map<int32_t, std::vector<int32_t> > relayed_clock_server_ids;
   for (const auto &server_id : server_ids_) {
     auto oplog_msg_iter = server_oplog_msg_map_.find(server_id);
     if (oplog_msg_iter != server_oplog_msg_map_.end()) {
@@ -617,24 +750,47 @@ size_t AbstractBgWorker::SendOpLogMsgs(bool clock_advanced) {
       oplog_msg_iter->second->get_client_id() = GlobalContext::get_client_id();
       oplog_msg_iter->second->get_version() = version_;
       oplog_msg_iter->second->get_bg_clock() = clock_has_pushed_ + 1;
+      oplog_msg_iter->second->get_dst_server_id() = server_id;
 
       accum_size += oplog_msg_iter->second->get_size();
-      MemTransfer::TransferMem(comm_bus_, server_id, oplog_msg_iter->second);
+      MemTransfer::TransferMem(comm_bus_,
+                               GlobalContext::GetOpLogAggrServerID(server_id),
+                               oplog_msg_iter->second);
       // delete message after send
       delete oplog_msg_iter->second;
       oplog_msg_iter->second = 0;
     } else {
-      ClientSendOpLogMsg clock_oplog_msg(0);
-      clock_oplog_msg.get_is_clock() = clock_advanced;
-      clock_oplog_msg.get_client_id() = GlobalContext::get_client_id();
-      clock_oplog_msg.get_version() = version_;
-      clock_oplog_msg.get_bg_clock() = clock_has_pushed_ + 1;
-
-      accum_size += clock_oplog_msg.get_size();
-      MemTransfer::TransferMem(comm_bus_, server_id, &clock_oplog_msg);
+      int32_t aggr_server_id = GlobalContext::GetOpLogAggrServerID(server_id);
+      if (aggr_server_id != server_id) {
+        relayed_clock_server_ids[aggr_server_id].push_back(server_id);
+        continue;
+      }
+      accum_size += SendClockOpLogMsg(server_id, server_id, clock_advanced);
+    }
+  }
+
+  // Servers without oplog that are relayed through the same host oplog
+  // aggregator share one message.
+  for (const auto &aggr_pair : relayed_clock_server_ids) {
+    const std::vector<int32_t> &dst_server_ids = aggr_pair.second;
+    if (dst_server_ids.size() == 1) {
+      accum_size += SendClockOpLogMsg(aggr_pair.first, dst_server_ids[0],
+                                      clock_advanced);
+      continue;
     }
+    ClientClockMsg clock_msg(dst_server_ids.size()*sizeof(int32_t));
+    clock_msg.get_is_clock() = clock_advanced;
+    clock_msg.get_client_id() = GlobalContext::get_client_id();
+    clock_msg.get_version() = version_;
+    clock_msg.get_bg_clock() = clock_has_pushed_ + 1;
+    std::copy(dst_server_ids.begin(), dst_server_ids.end(),
+              clock_msg.get_dst_server_ids());
+
+    accum_size += clock_msg.get_size();
+    MemTransfer::TransferMem(comm_bus_, aggr_pair.first, &clock_msg);
   }
 
+  Metrics::Add(kMetricBgOpLogSentBytes, accum_size);
   STATS_BG_ADD_PER_CLOCK_OPLOG_SIZE(accum_size);
 
   return accum_size;
@@ -658,6 +814,48 @@ size_t AbstractBgWorker::CountRowOpLogToSend(
   return serialized_size;
 }
 
+size_t AbstractBgWorker::CountColSegmentedRowOpLogToSend(
+    int32_t row_id, AbstractRowOpLog *row_oplog, ClientTable *table,
+    std::map<int32_t, size_t> *table_num_bytes_by_server,
+    BgOpLogPartition *bg_table_oplog,
+    GetSerializedRowOpLogSizeFunc GetSerializedRowOpLogSize) {
+  const AbstractRow *sample_row = table->get_sample_row();
+  size_t update_size = sample_row->get_update_size();
+  int32_t segment_size = table->get_col_segment_size();
+  int32_t num_segments = table->get_num_col_segments();
+  CreateRowOpLog::CreateRowOpLogFunc CreateSegmentRowOpLog
+      = table->oplog_dense_serialized() ? CreateRowOpLog::CreateDenseRowOpLog
+      : CreateRowOpLog::CreateSparseRowOpLog;
+
+  std::vector<AbstractRowOpLog*> segment_oplogs(num_segments, 0);
+  int32_t column_id;
+  const void *update = row_oplog->BeginIterateConst(&column_id);
+  while (update != 0) {
+    int32_t segment_id = column_id / segment_size;
+    AbstractRowOpLog *&segment_oplog = segment_oplogs[segment_id];
+    if (segment_oplog == 0)
+      segment_oplog = CreateSegmentRowOpLog(update_size, sample_row,
+                                            segment_size);
+    int32_t segment_column_id = column_id - segment_id * segment_size;
+    sample_row->AddUpdates(segment_column_id,
+                           segment_oplog->FindCreate(segment_column_id),
+                           update);
+    update = row_oplog->NextConst(&column_id);
+  }
+  delete row_oplog;
+
+  size_t serialized_size = 0;
+  for (int32_t i = 0; i < num_segments; ++i) {
+    if (segment_oplogs[i] == 0)
+      continue;
+    serialized_size += CountRowOpLogToSend(
+        GlobalContext::GetColSegmentRowID(row_id, i, num_segments),
+        segment_oplogs[i], table_num_bytes_by_server, bg_table_oplog,
+        GetSerializedRowOpLogSize);
+  }
+  return serialized_size;
+}
+
 void AbstractBgWorker::RecvAppInitThreadConnection(int32_t *num_connected_app_threads) {
   zmq::message_t zmq_msg;
   int32_t sender_id;
@@ -676,13 +874,14 @@ void AbstractBgWorker::CheckForwardRowRequestToServer(
   int32_t clock = row_request_msg.get_clock();
   bool forced = row_request_msg.get_forced_request();
 
+  auto table_iter = tables_->find(table_id);
+  CHECK(table_iter != tables_->end());
+  ClientTable *table = table_iter->second;
+
   if (!forced) {
     // Check if the row exists in process cache
-    auto table_iter = tables_->find(table_id);
-    CHECK(table_iter != tables_->end());
     {
       // check if it is in process storage
-      ClientTable *table = table_iter->second;
       AbstractProcessStorage &table_storage = table->get_process_storage();
       RowAccessor row_accessor;
       ClientRow *client_row = table_storage.Find(row_id, &row_accessor);
@@ -715,13 +914,89 @@ void AbstractBgWorker::CheckForwardRowRequestToServer(
     = row_request_oplog_mgr_->AddRowRequest(row_request, table_id, row_id);
 
   if (should_be_sent) {
-    int32_t server_id
-        = GlobalContext::GetPartitionServerID(row_id, my_comm_channel_idx_);
+    SendRowRequestToServers(table, row_request_msg);
+  }
+}
+
+void AbstractBgWorker::SendRowRequestToServers(
+    ClientTable *client_table, RowRequestMsg &row_request_msg) {
+  int32_t row_id = row_request_msg.get_row_id();
+  int32_t num_segments = client_table->get_num_col_segments();
+  int32_t num_requests = (num_segments > 0) ? num_segments : 1;
+
+  for (int32_t i = 0; i < num_requests; ++i) {
+    if (num_segments > 0) {
+      row_request_msg.get_row_id()
+          = GlobalContext::GetColSegmentRowID(row_id, i, num_segments);
+    }
+    int32_t server_id = GlobalContext::GetPartitionServerID(
+        row_request_msg.get_row_id(), my_comm_channel_idx_);
 
     size_t sent_size = (comm_bus_->*(comm_bus_->SendAny_))(server_id,
       row_request_msg.get_mem(), row_request_msg.get_size());
     CHECK_EQ(sent_size, row_request_msg.get_size());
   }
+  row_request_msg.get_row_id() = row_id;
+}
+
+bool AbstractBgWorker::AddColSegmentReply(
+    int32_t table_id, ClientTable *client_table, uint32_t version,
+    const void *data, size_t data_size, int32_t *row_id, int32_t *clock,
+    std::vector<uint8_t> *row_data, size_t *row_size) {
+  int32_t num_segments = client_table->get_num_col_segments();
+  size_t segment_size = client_table->get_col_segment_size();
+  int32_t segment_row_id = *row_id;
+  int32_t segment_id;
+  *row_id = GlobalContext::GetColSegmentedRowID(segment_row_id, num_segments,
+                                                &segment_id);
+
+  std::pair<int32_t, int32_t> request_key(table_id, *row_id);
+  ColSegmentedRowReply &reply = col_segmented_row_replies_[request_key];
+  if (reply.segments.empty()) {
+    reply.segments.resize(num_segments);
+    reply.num_received = 0;
+    reply.clock = *clock;
+  }
+  ColSegmentReply &segment = reply.segments[segment_id];
+  const uint8_t *segment_mem = reinterpret_cast<const uint8_t*>(data);
+  segment.data.assign(segment_mem, segment_mem + data_size);
+  segment.version = version;
+
+  reply.clock = std::min(reply.clock, *clock);
+  if (++reply.num_received < num_segments)
+    return false;
+
+  // Old oplogs were sent per segment, so replay them on each segment against
+  // the version of the server that holds it. This is done now rather than on
+  // arrival so the oplogs sent since the first segment arrived are included.
+  size_t segment_bytes = 0;
+  for (int32_t i = 0; i < num_segments; ++i) {
+    AbstractRow *segment_data
+        = ClassRegistry<AbstractRow>::GetRegistry().CreateObject(
+            client_table->get_row_type());
+    segment_data->Deserialize(reply.segments[i].data.data(),
+                              reply.segments[i].data.size());
+    if (!client_table->get_no_oplog_replay())
+      CheckAndApplyOldOpLogsToRowData(
+          table_id, GlobalContext::GetColSegmentRowID(*row_id, i, num_segments),
+          reply.segments[i].version, segment_data);
+
+    if (i == 0) {
+      segment_bytes = segment_data->SerializedSize();
+      CHECK_EQ(segment_bytes % segment_size, 0) << "table " << table_id
+          << " does not have a dense row type";
+      row_data->resize(segment_bytes * num_segments);
+    }
+    CHECK_EQ(segment_data->SerializedSize(), segment_bytes);
+    segment_data->Serialize(row_data->data() + segment_bytes * i);
+    delete segment_data;
+  }
+
+  *clock = reply.clock;
+  // Drop the padding of the last segment.
+  *row_size = segment_bytes / segment_size * client_table->get_row_capacity();
+  col_segmented_row_replies_.erase(request_key);
+  return true;
 }
 
 void AbstractBgWorker::UpdateExistingRow(
@@ -844,6 +1119,8 @@ void AbstractBgWorker::HandleServerRowRequestReply(
   int32_t row_id = server_row_request_reply_msg.get_row_id();
   int32_t clock = server_row_request_reply_msg.get_clock();
   uint32_t version = server_row_request_reply_msg.get_version();
+  TraceScope trace_scope(kTraceBgRecvRowReply, table_id, row_id,
+                         server_row_request_reply_msg.get_row_size());
 
   auto table_iter = tables_->find(table_id);
   CHECK(table_iter != tables_->end()) << "Cannot find table " << table_id;
@@ -851,13 +1128,23 @@ void AbstractBgWorker::HandleServerRowRequestReply(
 
   row_request_oplog_mgr_->ServerAcknowledgeVersion(server_id, version);
 
+  const void *data = server_row_request_reply_msg.get_row_data();
+  size_t row_size = server_row_request_reply_msg.get_row_size();
+
+  std::vector<uint8_t> segmented_row_data;
+  if (client_table->get_num_col_segments() > 0) {
+    if (!AddColSegmentReply(table_id, client_table, version, data, row_size,
+                            &row_id, &clock, &segmented_row_data, &row_size))
+      return;
+    data = segmented_row_data.data();
+    // Old oplogs up to the current version were replayed per segment.
+    version = version_ - 1;
+  }
+
   RowAccessor row_accessor;
   ClientRow *client_row = client_table->get_process_storage().Find(
       row_id, &row_accessor);
 
-  const void *data = server_row_request_reply_msg.get_row_data();
-  size_t row_size = server_row_request_reply_msg.get_row_size();
-
   if (client_row != 0) {
     UpdateExistingRow(table_id, row_id, client_row, client_table, data,
                       row_size, version);
@@ -877,12 +1164,7 @@ void AbstractBgWorker::HandleServerRowRequestReply(
     row_request_msg.get_row_id() = row_id;
     row_request_msg.get_clock() = clock_to_request;
 
-    int32_t server_id = GlobalContext::GetPartitionServerID(
-        row_id, my_comm_channel_idx_);
-
-    size_t sent_size = (comm_bus_->*(comm_bus_->SendAny_))(server_id,
-      row_request_msg.get_mem(), row_request_msg.get_size());
-    CHECK_EQ(sent_size, row_request_msg.get_size());
+    SendRowRequestToServers(client_table, row_request_msg);
   }
 
   std::pair<int32_t, int32_t> request_key(table_id, row_id);
@@ -928,6 +1210,7 @@ void AbstractBgWorker::ConnectToNameNodeOrServer(int32_t server_id) {
 
 void *AbstractBgWorker::operator() () {
   STATS_REGISTER_THREAD(kBgThread);
+  Trace::RegisterThread("bg");
 
   ThreadContext::RegisterThread(my_id_);
 
@@ -999,12 +1282,17 @@ void *AbstractBgWorker::operator() () {
               == GlobalContext::get_num_app_threads()) {
             ClientShutDownMsg msg;
             int32_t name_node_id = GlobalContext::get_name_node_id();
+            msg.get_dst_server_id() = name_node_id;
             (comm_bus_->*(comm_bus_->SendAny_))(name_node_id, msg.get_mem(),
               msg.get_size());
 
+            // follows the same route as oplogs so that a server shuts
+            // down only after it has received all of them
             for (const auto &server_id : server_ids_) {
-              (comm_bus_->*(comm_bus_->SendAny_))(server_id, msg.get_mem(),
-                                           msg.get_size());
+              msg.get_dst_server_id() = server_id;
+              (comm_bus_->*(comm_bus_->SendAny_))(
+                  GlobalContext::GetOpLogAggrServerID(server_id),
+                  msg.get_mem(), msg.get_size());
             }
           }
         }
@@ -1036,7 +1324,14 @@ void *AbstractBgWorker::operator() () {
         {
           timeout_milli = HandleClockMsg(true);
           ++client_clock_;
+          Metrics::Add(kMetricBgClock);
           STATS_BG_CLOCK();
+          Trace::SetClock(client_clock_);
+          if (my_comm_channel_idx_ == 0
+              && client_clock_
+              % GlobalContext::get_staleness_adapt_interval() == 0) {
+            SendStalenessReport();
+          }
         }
         break;
       case kBgSendOpLog:
@@ -1062,6 +1357,12 @@ void *AbstractBgWorker::operator() () {
           HandleAppendOpLogMsg(handle_append_oplog_msg.get_table_id());
         }
         break;
+      case kStalenessUpdate:
+        {
+          StalenessUpdateMsg staleness_update_msg(msg_mem);
+          HandleStalenessUpdate(staleness_update_msg);
+        }
+        break;
       default:
         LOG(FATAL) << "Unrecognized type " << msg_type;
     }
@@ -3,6 +3,7 @@
 #pragma once
 
 #include <stdint.h>
+#include <limits.h>
 #include <map>
 #include <vector>
 #include <condition_variable>
@@ -82,6 +83,10 @@ protected:
 
   /* Functions Called From Main Loop -- END */
 
+  // Head bg only, for tables with adaptive staleness.
+  void SendStalenessReport();
+  void HandleStalenessUpdate(StalenessUpdateMsg &staleness_update_msg);
+
   virtual void HandleAppendOpLogMsg(int32_t table_id);
 
   void HandleAppendOpLogAndApply(
@@ -98,6 +103,9 @@ protected:
   virtual BgOpLog *PrepareOpLogsToSend() = 0;
   void CreateOpLogMsgs(const BgOpLog *bg_oplog);
   size_t SendOpLogMsgs(bool clock_advanced) ;
+  // Header-only ClientSendOpLogMsg for dst_server_id, sent to recv_id.
+  size_t SendClockOpLogMsg(int32_t recv_id, int32_t dst_server_id,
+                           bool clock_advanced);
 
   size_t CountRowOpLogToSend(
       int32_t row_id, AbstractRowOpLog *row_oplog,
@@ -105,6 +113,15 @@ protected:
       BgOpLogPartition *bg_table_oplog,
       GetSerializedRowOpLogSizeFunc GetSerializedRowOpLogSize);
 
+  // Splits row_oplog of a column-segmented table into one row oplog per
+  // segment touched, counted under the segments' row ids. Takes ownership
+  // of row_oplog.
+  size_t CountColSegmentedRowOpLogToSend(
+      int32_t row_id, AbstractRowOpLog *row_oplog, ClientTable *table,
+      std::map<int32_t, size_t> *table_num_bytes_by_server,
+      BgOpLogPartition *bg_table_oplog,
+      GetSerializedRowOpLogSizeFunc GetSerializedRowOpLogSize);
+
   virtual void TrackBgOpLog(BgOpLog *bg_oplog) = 0;
 
   void FinalizeOpLogMsgStats(
@@ -121,6 +138,20 @@ protected:
       int32_t server_id,
       ServerRowRequestReplyMsg &server_row_request_reply_msg);
 
+  // Sends row_request_msg to the server of its row or, for a
+  // column-segmented table, one copy to the server of each segment.
+  void SendRowRequestToServers(ClientTable *client_table,
+                               RowRequestMsg &row_request_msg);
+
+  // Adds the reply for one segment, whose row id is *row_id. Returns true
+  // once all segments of the row have arrived, with *row_id, *clock,
+  // *row_data and *row_size set to the reassembled row. Old oplogs up to
+  // the current version have been replayed on the reassembled row.
+  bool AddColSegmentReply(int32_t table_id, ClientTable *client_table,
+                          uint32_t version, const void *data,
+                          size_t data_size, int32_t *row_id, int32_t *clock,
+                          std::vector<uint8_t> *row_data, size_t *row_size);
+
   virtual void CheckAndApplyOldOpLogsToRowData(int32_t table_id,
                                                int32_t row_id, uint32_t row_version,
                                                AbstractRow *row_data) = 0;
@@ -152,6 +183,8 @@ protected:
   uint32_t version_;
   int32_t client_clock_;
   int32_t clock_has_pushed_;
+  // Head bg: when the last staleness report was sent.
+  int64_t staleness_report_ns_;
   RowRequestOpLogMgr *row_request_oplog_mgr_;
   CommBus* const comm_bus_;
 
@@ -170,6 +203,26 @@ protected:
   std::unordered_map<int32_t, int32_t> append_only_buff_proc_count_;
 
   std::unordered_map<int32_t, RowOpLogSerializer*> row_oplog_serializer_map_;
+
+  // Serialized segment as the server sent it, with that server's version.
+  struct ColSegmentReply {
+    std::vector<uint8_t> data;
+    uint32_t version;
+  };
+
+  // Segments received so far of a column-segmented row. Old oplogs are
+  // replayed only once all segments are in, so that oplogs sent while the
+  // row was being assembled are applied to every segment.
+  struct ColSegmentedRowReply {
+    std::vector<ColSegmentReply> segments;
+    int32_t num_received;
+    // the min clock over the segments
+    int32_t clock;
+  };
+
+  // (table_id, row_id) => segments received
+  std::map<std::pair<int32_t, int32_t>, ColSegmentedRowReply>
+  col_segmented_row_replies_;
 };
 
 }
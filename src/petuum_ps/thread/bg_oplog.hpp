@@ -25,8 +25,10 @@ public:
     table_oplog_map_[table_id] = bg_oplog_partition_ptr;
   }
 
+  // 0 if the table had no oplog in this clock.
   BgOpLogPartition* Get(int32_t table_id) const {
-    return table_oplog_map_.at(table_id);
+    auto iter = table_oplog_map_.find(table_id);
+    return (iter == table_oplog_map_.end()) ? 0 : iter->second;
   }
 private:
   std::map<int32_t, BgOpLogPartition*> table_oplog_map_;
@@ -62,4 +62,7 @@ long GlobalContext::server_idle_milli_;
 
 int32_t GlobalContext::server_row_candidate_factor_;
 
+bool GlobalContext::host_oplog_aggr_;
+int32_t GlobalContext::staleness_adapt_interval_;
+
 }   // namespace petuum
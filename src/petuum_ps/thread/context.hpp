@@ -153,7 +153,9 @@ public:
       size_t thread_oplog_batch_size,
       size_t server_push_row_threshold,
       long server_idle_milli,
-      int32_t server_row_candidate_factor) {
+      int32_t server_row_candidate_factor,
+      bool host_oplog_aggr,
+      int32_t staleness_adapt_interval) {
 
     num_comm_channels_per_client_
         = num_comm_channels_per_client;
@@ -191,6 +193,10 @@ public:
 
     server_row_candidate_factor_ = server_row_candidate_factor;
 
+    host_oplog_aggr_ = host_oplog_aggr;
+
+    staleness_adapt_interval_ = staleness_adapt_interval;
+
     for (auto host_iter = host_map.begin();
          host_iter != host_map.end(); ++host_iter) {
       HostInfo host_info = host_iter->second;
@@ -293,12 +299,95 @@ public:
     return get_server_thread_id(client_id, comm_channel_idx);
   }
 
+  // Segment segment_id of a column-segmented row row_id is stored on the
+  // servers as a row of its own. Its id keeps row_id's comm channel, while
+  // the segments of a row go to consecutive partitions, so that they spread
+  // over the clients' servers.
+  static int32_t GetColSegmentRowID(int32_t row_id, int32_t segment_id,
+                                    int32_t num_segments) {
+    int64_t segment_row_id
+        = ((int64_t) (row_id / num_comm_channels_per_client_) * num_segments
+           + segment_id) * num_comm_channels_per_client_
+        + row_id % num_comm_channels_per_client_;
+    CHECK_LE(segment_row_id, INT32_MAX) << "row_id = " << row_id
+                                        << " is too large to be segmented";
+    return (int32_t) segment_row_id;
+  }
+
+  // Inverse of GetColSegmentRowID().
+  static int32_t GetColSegmentedRowID(int32_t segment_row_id,
+                                      int32_t num_segments,
+                                      int32_t *segment_id) {
+    int32_t partition = segment_row_id / num_comm_channels_per_client_;
+    *segment_id = partition % num_segments;
+    return partition / num_segments * num_comm_channels_per_client_
+        + segment_row_id % num_comm_channels_per_client_;
+  }
+
   static int32_t GetCommChannelIndexServer(int32_t server_id) {
     int32_t index = server_id % kMaxNumThreadsPerClient
                     - kServerThreadIDStartOffset;
     return index;
   }
 
+  static bool get_host_oplog_aggr() {
+    return host_oplog_aggr_;
+  }
+
+  static int32_t get_staleness_adapt_interval() {
+    return staleness_adapt_interval_;
+  }
+
+  // Clients whose host_map entries share an ip run on the same host.
+  // The one with the smallest id leads the host.
+  static bool IsSameHost(int32_t client_id_a, int32_t client_id_b) {
+    return host_map_[client_id_a].ip == host_map_[client_id_b].ip;
+  }
+
+  static int32_t GetHostLeaderClientID(int32_t client_id) {
+    for (const auto &host_pair : host_map_) {
+      if (IsSameHost(host_pair.first, client_id))
+        return host_pair.first;
+    }
+    return client_id;
+  }
+
+  static void GetHostClientIDs(int32_t client_id,
+                               std::vector<int32_t> *client_ids) {
+    client_ids->clear();
+    for (const auto &host_pair : host_map_) {
+      if (IsSameHost(host_pair.first, client_id))
+        client_ids->push_back(host_pair.first);
+    }
+  }
+
+  // Server thread that bg threads of this client hand their oplogs for
+  // server_id to. It is server_id itself unless host oplog aggregation is
+  // on, server_id lives on another host and this host runs more than one
+  // client. In that case it is the host leader's server thread of the same
+  // comm channel.
+  static int32_t GetOpLogAggrServerID(int32_t server_id) {
+    if (!host_oplog_aggr_
+        || IsSameHost(thread_id_to_client_id(server_id), client_id_))
+      return server_id;
+    std::vector<int32_t> host_client_ids;
+    GetHostClientIDs(client_id_, &host_client_ids);
+    if (host_client_ids.size() == 1)
+      return server_id;
+    return get_server_thread_id(GetHostLeaderClientID(client_id_),
+                                GetCommChannelIndexServer(server_id));
+  }
+
+  // Whether my server threads merge oplogs on behalf of the host
+  static bool am_i_oplog_aggr() {
+    if (!host_oplog_aggr_
+        || GetHostLeaderClientID(client_id_) != client_id_)
+      return false;
+    std::vector<int32_t> host_client_ids;
+    GetHostClientIDs(client_id_, &host_client_ids);
+    return host_client_ids.size() > 1;
+  }
+
   static int32_t get_server_ring_size(){
     return server_ring_size_;
   }
@@ -432,6 +521,10 @@ private:
   static long server_idle_milli_;
 
   static int32_t server_row_candidate_factor_;
+
+  static bool host_oplog_aggr_;
+
+  static int32_t staleness_adapt_interval_;
 };
 
 }   // namespace petuum
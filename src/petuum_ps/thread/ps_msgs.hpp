@@ -116,7 +116,8 @@ public:
         + sizeof(size_t) + sizeof(bool) + sizeof(int32_t)
         + sizeof(size_t)  + sizeof(OpLogType) +sizeof(AppendOnlyOpLogType)
         + sizeof(size_t) + sizeof(size_t) + sizeof(int32_t)
-        + sizeof(ProcessStorageType) + sizeof(bool);
+        + sizeof(ProcessStorageType) + sizeof(bool) + sizeof(size_t)
+        + sizeof(bool) + sizeof(int32_t) + sizeof(int32_t);
   }
 
   int32_t &get_table_id() {
@@ -250,6 +251,52 @@ public:
         + sizeof(ProcessStorageType) ));
   }
 
+  size_t &get_col_segment_size() {
+    return *(reinterpret_cast<size_t*>(
+        mem_.get_mem()
+        + NumberedMsg::get_size() + sizeof(int32_t) + sizeof(int32_t)
+        + sizeof(int32_t) + sizeof(size_t) + sizeof(size_t)
+        + sizeof(size_t) + sizeof(size_t) + sizeof(bool) + sizeof(int32_t)
+        + sizeof(size_t) + sizeof(OpLogType) +sizeof(AppendOnlyOpLogType)
+        + sizeof(size_t) + sizeof(size_t) + sizeof(int32_t)
+        + sizeof(ProcessStorageType) + sizeof(bool) ));
+  }
+
+  bool &get_thread_cache_cow() {
+    return *(reinterpret_cast<bool*>(
+        mem_.get_mem()
+        + NumberedMsg::get_size() + sizeof(int32_t) + sizeof(int32_t)
+        + sizeof(int32_t) + sizeof(size_t) + sizeof(size_t)
+        + sizeof(size_t) + sizeof(size_t) + sizeof(bool) + sizeof(int32_t)
+        + sizeof(size_t) + sizeof(OpLogType) +sizeof(AppendOnlyOpLogType)
+        + sizeof(size_t) + sizeof(size_t) + sizeof(int32_t)
+        + sizeof(ProcessStorageType) + sizeof(bool) + sizeof(size_t) ));
+  }
+
+  int32_t &get_adaptive_staleness_min() {
+    return *(reinterpret_cast<int32_t*>(
+        mem_.get_mem()
+        + NumberedMsg::get_size() + sizeof(int32_t) + sizeof(int32_t)
+        + sizeof(int32_t) + sizeof(size_t) + sizeof(size_t)
+        + sizeof(size_t) + sizeof(size_t) + sizeof(bool) + sizeof(int32_t)
+        + sizeof(size_t) + sizeof(OpLogType) +sizeof(AppendOnlyOpLogType)
+        + sizeof(size_t) + sizeof(size_t) + sizeof(int32_t)
+        + sizeof(ProcessStorageType) + sizeof(bool) + sizeof(size_t)
+        + sizeof(bool) ));
+  }
+
+  int32_t &get_adaptive_staleness_max() {
+    return *(reinterpret_cast<int32_t*>(
+        mem_.get_mem()
+        + NumberedMsg::get_size() + sizeof(int32_t) + sizeof(int32_t)
+        + sizeof(int32_t) + sizeof(size_t) + sizeof(size_t)
+        + sizeof(size_t) + sizeof(size_t) + sizeof(bool) + sizeof(int32_t)
+        + sizeof(size_t) + sizeof(OpLogType) +sizeof(AppendOnlyOpLogType)
+        + sizeof(size_t) + sizeof(size_t) + sizeof(int32_t)
+        + sizeof(ProcessStorageType) + sizeof(bool) + sizeof(size_t)
+        + sizeof(bool) + sizeof(int32_t) ));
+  }
+
 protected:
   void InitMsg() {
     NumberedMsg::InitMsg();
@@ -257,75 +304,82 @@ protected:
   }
 };
 
-struct CreateTableMsg : public NumberedMsg {
+struct CreateTableRecord {
+  int32_t table_id;
+  TableInfo table_info;
+};
+
+// All tables of a client, sent by its head bg to the name node in one
+// message and forwarded by the name node to all servers.
+// Data layout: CreateTableRecord[num_tables]
+struct CreateTablesMsg : public ArbitrarySizedMsg {
 public:
-  CreateTableMsg() {
-    if (get_size() > PETUUM_MSG_STACK_BUFF_SIZE) {
-      own_mem_ = true;
-      use_stack_buff_ = false;
-      mem_.Alloc(get_size());
-    } else {
-      own_mem_ = false;
-      use_stack_buff_ = true;
-      mem_.Reset(stack_buff_);
-     }
-     InitMsg();
+  explicit CreateTablesMsg(int32_t num_tables) {
+    own_mem_ = true;
+    mem_.Alloc(get_header_size() + num_tables*sizeof(CreateTableRecord));
+    InitMsg(num_tables*sizeof(CreateTableRecord));
   }
 
-  explicit CreateTableMsg(void *msg):
-    NumberedMsg(msg) {}
+  explicit CreateTablesMsg(void *msg):
+    ArbitrarySizedMsg(msg) {}
 
-  size_t get_size() {
-    return NumberedMsg::get_size() + sizeof(int32_t) + sizeof(int32_t)
-        + sizeof(int32_t) + sizeof(size_t)
-        + sizeof(bool) + sizeof(int32_t) + sizeof(size_t);
+  size_t get_header_size() {
+    return ArbitrarySizedMsg::get_header_size();
   }
 
-  int32_t &get_table_id() {
-    return *(reinterpret_cast<int32_t*>(mem_.get_mem()
-      + NumberedMsg::get_size()));
+  int32_t get_num_tables() {
+    return get_avai_size() / sizeof(CreateTableRecord);
   }
 
-  int32_t &get_staleness() {
-    return *(reinterpret_cast<int32_t*>(mem_.get_mem()
-      + NumberedMsg::get_size() + sizeof(int32_t)));
+  CreateTableRecord *get_records() {
+    return reinterpret_cast<CreateTableRecord*>(
+        mem_.get_mem() + get_header_size());
   }
 
-  int32_t &get_row_type() {
-    return *(reinterpret_cast<int32_t*>(mem_.get_mem() + NumberedMsg::get_size()
-      + sizeof(int32_t) + sizeof(int32_t)));
+  size_t get_size() {
+    return get_header_size() + get_avai_size();
   }
 
-  size_t &get_row_capacity() {
-    return *(reinterpret_cast<size_t*>(mem_.get_mem() + NumberedMsg::get_size()
-      + sizeof(int32_t) + sizeof(int32_t) + sizeof(int32_t)));
+protected:
+  virtual void InitMsg(int32_t avai_size) {
+    ArbitrarySizedMsg::InitMsg(avai_size);
+    get_msg_type() = kCreateTables;
   }
+};
 
-  bool &get_oplog_dense_serialized() {
-    return *(reinterpret_cast<bool*>(
-        mem_.get_mem() + NumberedMsg::get_size()
-        + sizeof(int32_t) + sizeof(int32_t) + sizeof(int32_t)
-        + sizeof(size_t)));
+// Acknowledges a CreateTablesMsg: server to name node and name node to
+// head bg.
+struct CreateTablesReplyMsg : public NumberedMsg {
+public:
+  CreateTablesReplyMsg() {
+    if (get_size() > PETUUM_MSG_STACK_BUFF_SIZE) {
+      own_mem_ = true;
+      use_stack_buff_ = false;
+      mem_.Alloc(get_size());
+     } else {
+      own_mem_ = false;
+      use_stack_buff_ = true;
+      mem_.Reset(stack_buff_);
+    }
+    InitMsg();
   }
 
-  int32_t &get_row_oplog_type() {
-    return *(reinterpret_cast<int32_t*>(
-        mem_.get_mem() + NumberedMsg::get_size()
-        + sizeof(int32_t) + sizeof(int32_t) + sizeof(int32_t)
-        + sizeof(size_t) + sizeof(bool)));
+  explicit CreateTablesReplyMsg(void *msg):
+    NumberedMsg(msg) {}
+
+  size_t get_size() {
+    return NumberedMsg::get_size() + sizeof(int32_t);
   }
 
-  size_t &get_dense_row_oplog_capacity() {
-    return *(reinterpret_cast<size_t*>(
-        mem_.get_mem() + NumberedMsg::get_size()
-        + sizeof(int32_t) + sizeof(int32_t) + sizeof(int32_t)
-        + sizeof(size_t) + sizeof(bool) + sizeof(int32_t)));
+  int32_t &get_num_tables() {
+    return *(reinterpret_cast<int32_t*>(mem_.get_mem()
+      + NumberedMsg::get_size()));
   }
 
 protected:
-  void InitMsg() {
+  void InitMsg(){
     NumberedMsg::InitMsg();
-    get_msg_type() = kCreateTable;
+    get_msg_type() = kCreateTablesReply;
   }
 };
 
@@ -363,6 +417,119 @@ protected:
   }
 };
 
+struct StalenessReportRecord {
+  int32_t table_id;
+  double blocked_frac;
+};
+
+// Head bg to name node every staleness_adapt_interval clocks, one record
+// per adaptive table.
+// Data layout: StalenessReportRecord[num_tables]
+struct StalenessReportMsg : public ArbitrarySizedMsg {
+public:
+  explicit StalenessReportMsg(int32_t num_tables) {
+    own_mem_ = true;
+    mem_.Alloc(get_header_size() + num_tables*sizeof(StalenessReportRecord));
+    InitMsg(num_tables*sizeof(StalenessReportRecord));
+  }
+
+  explicit StalenessReportMsg(void *msg):
+    ArbitrarySizedMsg(msg) {}
+
+  size_t get_header_size() {
+    return ArbitrarySizedMsg::get_header_size() + sizeof(int32_t)
+        + sizeof(int32_t) + sizeof(bool) + sizeof(double);
+  }
+
+  int32_t &get_client_id() {
+    return *(reinterpret_cast<int32_t*>(mem_.get_mem()
+      + ArbitrarySizedMsg::get_header_size()));
+  }
+
+  int32_t &get_report_clock() {
+    return *(reinterpret_cast<int32_t*>(mem_.get_mem()
+      + ArbitrarySizedMsg::get_header_size() + sizeof(int32_t)));
+  }
+
+  bool &get_has_progress() {
+    return *(reinterpret_cast<bool*>(mem_.get_mem()
+      + ArbitrarySizedMsg::get_header_size() + sizeof(int32_t)
+      + sizeof(int32_t)));
+  }
+
+  double &get_progress() {
+    return *(reinterpret_cast<double*>(mem_.get_mem()
+      + ArbitrarySizedMsg::get_header_size() + sizeof(int32_t)
+      + sizeof(int32_t) + sizeof(bool)));
+  }
+
+  int32_t get_num_tables() {
+    return get_avai_size() / sizeof(StalenessReportRecord);
+  }
+
+  StalenessReportRecord *get_records() {
+    return reinterpret_cast<StalenessReportRecord*>(
+        mem_.get_mem() + get_header_size());
+  }
+
+  size_t get_size() {
+    return get_header_size() + get_avai_size();
+  }
+
+protected:
+  virtual void InitMsg(int32_t avai_size) {
+    ArbitrarySizedMsg::InitMsg(avai_size);
+    get_msg_type() = kStalenessReport;
+  }
+};
+
+struct StalenessUpdateRecord {
+  int32_t table_id;
+  int32_t staleness;
+};
+
+// Name node to head bgs: new bounds, in force from effective_clock on.
+// Data layout: StalenessUpdateRecord[num_tables]
+struct StalenessUpdateMsg : public ArbitrarySizedMsg {
+public:
+  explicit StalenessUpdateMsg(int32_t num_tables) {
+    own_mem_ = true;
+    mem_.Alloc(get_header_size() + num_tables*sizeof(StalenessUpdateRecord));
+    InitMsg(num_tables*sizeof(StalenessUpdateRecord));
+  }
+
+  explicit StalenessUpdateMsg(void *msg):
+    ArbitrarySizedMsg(msg) {}
+
+  size_t get_header_size() {
+    return ArbitrarySizedMsg::get_header_size() + sizeof(int32_t);
+  }
+
+  int32_t &get_effective_clock() {
+    return *(reinterpret_cast<int32_t*>(mem_.get_mem()
+      + ArbitrarySizedMsg::get_header_size()));
+  }
+
+  int32_t get_num_tables() {
+    return get_avai_size() / sizeof(StalenessUpdateRecord);
+  }
+
+  StalenessUpdateRecord *get_records() {
+    return reinterpret_cast<StalenessUpdateRecord*>(
+        mem_.get_mem() + get_header_size());
+  }
+
+  size_t get_size() {
+    return get_header_size() + get_avai_size();
+  }
+
+protected:
+  virtual void InitMsg(int32_t avai_size) {
+    ArbitrarySizedMsg::InitMsg(avai_size);
+    get_msg_type() = kStalenessUpdate;
+  }
+};
+
 struct RowRequestMsg : public NumberedMsg {
 public:
   RowRequestMsg() {
@@ -561,6 +728,17 @@ public:
   explicit ClientShutDownMsg(void *msg):
     NumberedMsg(msg) {}
 
+  size_t get_size() {
+    return NumberedMsg::get_size() + sizeof(int32_t);
+  }
+
+  // server the shutdown is meant for; differs from the receiver when it
+  // is relayed through the host oplog aggregator
+  int32_t &get_dst_server_id() {
+    return *(reinterpret_cast<int32_t*>(
+        mem_.get_mem() + NumberedMsg::get_size()));
+  }
+
 protected:
   void InitMsg() {
     NumberedMsg::InitMsg();
@@ -783,7 +961,8 @@ public:
 
   size_t get_header_size() {
     return ArbitrarySizedMsg::get_header_size() + sizeof(bool)
-        + sizeof(int32_t) + sizeof(uint32_t) + sizeof(int32_t);
+        + sizeof(int32_t) + sizeof(uint32_t) + sizeof(int32_t)
+        + sizeof(int32_t);
   }
 
   bool &get_is_clock() {
@@ -808,6 +987,14 @@ public:
       + sizeof(int32_t) + sizeof(uint32_t)));
   }
 
+  // server the oplog is meant for; differs from the receiver when it is
+  // relayed through the host oplog aggregator
+  int32_t &get_dst_server_id() {
+    return *(reinterpret_cast<int32_t*>(mem_.get_mem()
+      + ArbitrarySizedMsg::get_header_size() + sizeof(bool)
+      + sizeof(int32_t) + sizeof(uint32_t) + sizeof(int32_t)));
+  }
+
   // data is to be accessed via SerializedOpLogAccessor
   void *get_data() {
     return mem_.get_mem() + get_header_size();
@@ -824,6 +1011,127 @@ protected:
   }
 };
 
+// Clock of one bg thread for several servers that it has no oplog for, sent
+// in place of one empty ClientSendOpLogMsg per server when they are all
+// relayed through the same host oplog aggregator.
+// Data layout: int32_t dst_server_ids[get_num_dst_servers()]
+struct ClientClockMsg : public ArbitrarySizedMsg {
+public:
+  explicit ClientClockMsg(int32_t avai_size) {
+    own_mem_ = true;
+    mem_.Alloc(get_header_size() + avai_size);
+    InitMsg(avai_size);
+  }
+
+  explicit ClientClockMsg(void *msg):
+    ArbitrarySizedMsg(msg) {}
+
+  size_t get_header_size() {
+    return ArbitrarySizedMsg::get_header_size() + sizeof(bool)
+        + sizeof(int32_t) + sizeof(uint32_t) + sizeof(int32_t);
+  }
+
+  bool &get_is_clock() {
+    return *(reinterpret_cast<bool*>(mem_.get_mem()
+      + ArbitrarySizedMsg::get_header_size()));
+  }
+
+  int32_t &get_client_id() {
+    return *(reinterpret_cast<int32_t*>(mem_.get_mem()
+      + ArbitrarySizedMsg::get_header_size() + sizeof(bool)));
+  }
+
+  uint32_t &get_version() {
+    return *(reinterpret_cast<uint32_t*>(mem_.get_mem()
+      + ArbitrarySizedMsg::get_header_size() + sizeof(bool)
+      + sizeof(int32_t)));
+  }
+
+  int32_t &get_bg_clock() {
+    return *(reinterpret_cast<int32_t*>(mem_.get_mem()
+      + ArbitrarySizedMsg::get_header_size() + sizeof(bool)
+      + sizeof(int32_t) + sizeof(uint32_t)));
+  }
+
+  int32_t get_num_dst_servers() {
+    return get_avai_size() / sizeof(int32_t);
+  }
+
+  int32_t *get_dst_server_ids() {
+    return reinterpret_cast<int32_t*>(mem_.get_mem() + get_header_size());
+  }
+
+  size_t get_size() {
+    return get_header_size() + get_avai_size();
+  }
+
+protected:
+  virtual void InitMsg(int32_t avai_size) {
+    ArbitrarySizedMsg::InitMsg(avai_size);
+    get_msg_type() = kClientClock;
+  }
+};
+
+// Per bg thread record of an AggrSendOpLogMsg. The bg's oplog versions
+// first_version ~ last_version are all merged into the message.
+struct AggrOpLogBgInfo {
+  int32_t bg_id;
+  uint32_t first_version;
+  uint32_t last_version;
+  int32_t bg_clock; // latest clock sent by the bg, valid if is_clock
+  bool is_clock;
+};
+
+// Oplogs of all bg threads on one host merged by the host oplog
+// aggregator for one destination server.
+// Data layout:
+// 1. AggrOpLogBgInfo[num_bgs]
+// 2. serialized oplog, same as ClientSendOpLogMsg
+struct AggrSendOpLogMsg : public ArbitrarySizedMsg {
+public:
+  explicit AggrSendOpLogMsg(int32_t avai_size) {
+    own_mem_ = true;
+    mem_.Alloc(get_header_size() + avai_size);
+    InitMsg(avai_size);
+  }
+
+  explicit AggrSendOpLogMsg(void *msg):
+    ArbitrarySizedMsg(msg) {}
+
+  size_t get_header_size() {
+    return ArbitrarySizedMsg::get_header_size() + sizeof(int32_t);
+  }
+
+  int32_t &get_num_bgs() {
+    return *(reinterpret_cast<int32_t*>(mem_.get_mem()
+      + ArbitrarySizedMsg::get_header_size()));
+  }
+
+  AggrOpLogBgInfo *get_bg_infos() {
+    return reinterpret_cast<AggrOpLogBgInfo*>(
+        mem_.get_mem() + get_header_size());
+  }
+
+  void *get_oplog() {
+    return mem_.get_mem() + get_header_size()
+        + get_num_bgs()*sizeof(AggrOpLogBgInfo);
+  }
+
+  size_t get_oplog_size() {
+    return get_avai_size() - get_num_bgs()*sizeof(AggrOpLogBgInfo);
+  }
+
+  size_t get_size() {
+    return get_header_size() + get_avai_size();
+  }
+
+protected:
+  virtual void InitMsg(int32_t avai_size) {
+    ArbitrarySizedMsg::InitMsg(avai_size);
+    get_msg_type() = kAggrSendOpLog;
+  }
+};
+
 struct ServerPushRowMsg : public ArbitrarySizedMsg {
 public:
   explicit ServerPushRowMsg(int32_t avai_size) {
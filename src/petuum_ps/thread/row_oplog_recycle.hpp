@@ -20,21 +20,8 @@ public:
       sample_row_(sample_row),
       update_size_(update_size),
       dense_row_oplog_capacity_(dense_row_oplog_capacity) {
-    if (GlobalContext::get_consistency_model() == SSPAggr) {
-      if (row_oplog_type == RowOpLogType::kDenseRowOpLog)
-        CreateRowOpLog_ = CreateRowOpLog::CreateDenseMetaRowOpLog;
-      else if (row_oplog_type == RowOpLogType::kSparseRowOpLog)
-        CreateRowOpLog_ = CreateRowOpLog::CreateSparseMetaRowOpLog;
-      else
-        CreateRowOpLog_ = CreateRowOpLog::CreateSparseVectorMetaRowOpLog;
-    } else {
-      if (row_oplog_type == RowOpLogType::kDenseRowOpLog)
-        CreateRowOpLog_ = CreateRowOpLog::CreateDenseRowOpLog;
-      else if (row_oplog_type == RowOpLogType::kSparseRowOpLog)
-        CreateRowOpLog_ = CreateRowOpLog::CreateSparseRowOpLog;
-      else
-        CreateRowOpLog_ = CreateRowOpLog::CreateSparseVectorRowOpLog;
-    }
+    CreateRowOpLog_ = CreateRowOpLog::GetCreateRowOpLogFunc(
+        row_oplog_type, GlobalContext::get_consistency_model() == SSPAggr);
   }
 
   ~RowOpLogRecycle() {
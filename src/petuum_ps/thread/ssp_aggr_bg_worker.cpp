@@ -16,7 +16,7 @@ void SSPAggrBgWorker::FinalizeTableStats() {
   for (const auto &table_pair : (*tables_)) {
     min_table_staleness_
         = std::min(min_table_staleness_,
-                   table_pair.second->get_staleness());
+                   table_pair.second->get_table_staleness().get_min());
   }
 }
 
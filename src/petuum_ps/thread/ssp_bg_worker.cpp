@@ -8,6 +8,7 @@
 #include <petuum_ps_common/comm_bus/comm_bus.hpp>
 #include <petuum_ps_common/thread/mem_transfer.hpp>
 #include <petuum_ps/thread/context.hpp>
+#include <petuum_ps/oplog/oplog_index.hpp>
 #include <glog/logging.h>
 #include <utility>
 #include <limits.h>
@@ -56,35 +57,61 @@ ClientRow *SSPBgWorker::CreateClientRow(int32_t clock, AbstractRow *row_data) {
 BgOpLog *SSPBgWorker::PrepareOpLogsToSend() {
   BgOpLog *bg_oplog = new BgOpLog;
 
-  for (const auto &table_pair : (*tables_)) {
-    int32_t table_id = table_pair.first;
-
-    if (table_pair.second->get_no_oplog_replay()) {
-      if (table_pair.second->get_oplog_type() == Sparse ||
-          table_pair.second->get_oplog_type() == Dense)
-        PrepareOpLogsNormalNoReplay(table_id, table_pair.second);
-      else if (table_pair.second->get_oplog_type() == AppendOnly)
-        PrepareOpLogsAppendOnlyNoReplay(table_id, table_pair.second);
-      else
-        LOG(FATAL) << "Unknown oplog type = " << table_pair.second->get_oplog_type();
-    } else {
-      BgOpLogPartition *bg_table_oplog = 0;
-      if (table_pair.second->get_oplog_type() == Sparse ||
-          table_pair.second->get_oplog_type() == Dense)
-        bg_table_oplog = PrepareOpLogsNormal(table_id, table_pair.second);
-      else if (table_pair.second->get_oplog_type() == AppendOnly)
-        bg_table_oplog = PrepareOpLogsAppendOnly(table_id, table_pair.second);
-      else
-        LOG(FATAL) << "Unknown oplog type = " << table_pair.second->get_oplog_type();
-      bg_oplog->Add(table_id, bg_table_oplog);
+  if (!DirtyOpLogTables::enabled()) {
+    for (const auto &table_pair : (*tables_)) {
+      PrepareTableOpLogsToSend(table_pair.first, table_pair.second, bg_oplog);
     }
+    return bg_oplog;
+  }
 
-    FinalizeOpLogMsgStats(table_id, &table_num_bytes_by_server_,
-                          &server_table_oplog_size_map_);
+  // Only tables updated since the last clock have oplogs to send. Sizes
+  // left from the last clock would be sent again for the others.
+  for (auto &server_pair : server_table_oplog_size_map_) {
+    server_pair.second.clear();
+  }
+  DirtyOpLogTables::Take(my_comm_channel_idx_, &dirty_table_ids_);
+  for (int32_t table_id : dirty_table_ids_) {
+    auto table_iter = tables_->find(table_id);
+    CHECK(table_iter != tables_->end()) << "Cannot find table " << table_id;
+    ClientTable *table = table_iter->second;
+    if (table->get_oplog_type() != AppendOnly)
+      PrepareTableOpLogsToSend(table_id, table, bg_oplog);
+  }
+  // Append-only buffers are flushed to the bg thread without going through
+  // the oplog index.
+  for (const auto &table_pair : (*tables_)) {
+    if (table_pair.second->get_oplog_type() == AppendOnly)
+      PrepareTableOpLogsToSend(table_pair.first, table_pair.second, bg_oplog);
   }
   return bg_oplog;
 }
 
+void SSPBgWorker::PrepareTableOpLogsToSend(int32_t table_id, ClientTable *table,
+                                           BgOpLog *bg_oplog) {
+  if (table->get_no_oplog_replay()) {
+    if (table->get_oplog_type() == Sparse ||
+        table->get_oplog_type() == Dense)
+      PrepareOpLogsNormalNoReplay(table_id, table);
+    else if (table->get_oplog_type() == AppendOnly)
+      PrepareOpLogsAppendOnlyNoReplay(table_id, table);
+    else
+      LOG(FATAL) << "Unknown oplog type = " << table->get_oplog_type();
+  } else {
+    BgOpLogPartition *bg_table_oplog = 0;
+    if (table->get_oplog_type() == Sparse ||
+        table->get_oplog_type() == Dense)
+      bg_table_oplog = PrepareOpLogsNormal(table_id, table);
+    else if (table->get_oplog_type() == AppendOnly)
+      bg_table_oplog = PrepareOpLogsAppendOnly(table_id, table);
+    else
+      LOG(FATAL) << "Unknown oplog type = " << table->get_oplog_type();
+    bg_oplog->Add(table_id, bg_table_oplog);
+  }
+
+  FinalizeOpLogMsgStats(table_id, &table_num_bytes_by_server_,
+                        &server_table_oplog_size_map_);
+}
+
 BgOpLogPartition *SSPBgWorker::PrepareOpLogsNormal(
     int32_t table_id, ClientTable *table) {
   AbstractOpLog &table_oplog = table->get_oplog();
@@ -119,8 +146,14 @@ BgOpLogPartition *SSPBgWorker::PrepareOpLogsNormal(
 
     if (found && (row_oplog == 0)) continue;
 
-    CountRowOpLogToSend(row_id, row_oplog, &table_num_bytes_by_server_,
-                        bg_table_oplog, GetSerializedRowOpLogSize);
+    if (table->get_col_segment_size() > 0) {
+      CountColSegmentedRowOpLogToSend(
+          row_id, row_oplog, table, &table_num_bytes_by_server_,
+          bg_table_oplog, GetSerializedRowOpLogSize);
+    } else {
+      CountRowOpLogToSend(row_id, row_oplog, &table_num_bytes_by_server_,
+                          bg_table_oplog, GetSerializedRowOpLogSize);
+    }
   }
   delete new_table_oplog_index_ptr;
   return bg_table_oplog;
@@ -276,6 +309,11 @@ void SSPBgWorker::ApplyOldOpLogsToRowData(
 
   while (bg_oplog != NULL) {
     BgOpLogPartition *bg_oplog_partition = bg_oplog->Get(table_id);
+    // Tables without updates in that clock have no partition.
+    if (bg_oplog_partition == 0) {
+      bg_oplog = row_request_oplog_mgr_->OpLogIterNext(&oplog_version);
+      continue;
+    }
     // OpLogs that are after (exclusively) version should be applied
     const AbstractRowOpLog *row_oplog = bg_oplog_partition->FindOpLog(row_id);
     if (row_oplog != 0) {
@@ -44,6 +44,8 @@ protected:
 
   /* Handles Sending OpLogs -- BEGIN */
   virtual BgOpLog *PrepareOpLogsToSend();
+  void PrepareTableOpLogsToSend(int32_t table_id, ClientTable *table,
+                                BgOpLog *bg_oplog);
 
   virtual BgOpLogPartition *PrepareOpLogsNormal(int32_t table_id, ClientTable *table);
   virtual BgOpLogPartition *PrepareOpLogsAppendOnly(int32_t table_id, ClientTable *table);
@@ -64,6 +66,9 @@ protected:
                                uint32_t version_end,
                                AbstractRow *row_data);
   /* Handles Row Requests -- END */
+
+  // Reused by PrepareOpLogsToSend().
+  std::vector<int32_t> dirty_table_ids_;
 };
 
 }
@@ -1,5 +1,7 @@
 #include <petuum_ps/thread/ssp_push_bg_worker.hpp>
 #include <petuum_ps_common/util/stats.hpp>
+#include <petuum_ps_common/util/metrics.hpp>
+#include <petuum_ps_common/util/trace.hpp>
 #include <petuum_ps/client/serialized_row_reader.hpp>
 #include <petuum_ps/thread/ssp_push_row_request_oplog_mgr.hpp>
 
@@ -11,6 +13,8 @@ void SSPPushBgWorker::CreateRowRequestOpLogMgr() {
 
 void SSPPushBgWorker::HandleServerPushRow(int32_t sender_id, void *msg_mem) {
   ServerPushRowMsg server_push_row_msg(msg_mem);
+  TraceScope trace_scope(kTraceBgApplyServerPushRow, -1, -1,
+                         server_push_row_msg.get_size());
   uint32_t version = server_push_row_msg.get_version();
   row_request_oplog_mgr_->ServerAcknowledgeVersion(sender_id, version);
 
@@ -20,6 +24,8 @@ void SSPPushBgWorker::HandleServerPushRow(int32_t sender_id, void *msg_mem) {
   ApplyServerPushedRow(version, server_push_row_msg.get_data(),
                        server_push_row_msg.get_avai_size());
 
+  Metrics::Add(kMetricBgServerPushRowRecvBytes,
+               server_push_row_msg.get_size());
   STATS_BG_ADD_PER_CLOCK_SERVER_PUSH_ROW_SIZE(
       server_push_row_msg.get_size());
   STATS_BG_ACCUM_PUSH_ROW_MSG_RECEIVED_INC_ONE();
@@ -41,6 +41,9 @@ public:
   virtual void Clock() = 0;
 
   virtual void GlobalBarrier() = 0;
+
+  // Ignored unless some table has adaptive staleness.
+  virtual void ReportProgress(double progress) { }
 };
 
 }   // namespace petuum
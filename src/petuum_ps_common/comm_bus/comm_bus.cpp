@@ -169,6 +169,31 @@ void CommBus::ConnectTo(int32_t entity_id, const std::string &network_addr,
     void *connect_msg, size_t size) {
   CHECK(!IsLocalEntity(entity_id)) << "Local entity " << entity_id;
 
+  zmq::socket_t *sock = GetCreateInterProcSock();
+  std::string connect_addr;
+  MakeInterProcAddr(network_addr, &connect_addr);
+  int32_t zmq_id = ZMQUtil::EntityID2ZmqID(entity_id);
+  ZMQUtil::ZMQConnectSend(sock, connect_addr, zmq_id, connect_msg, size);
+}
+
+void CommBus::ConnectTo(const std::vector<int32_t> &entity_ids,
+    const std::vector<std::string> &network_addrs, void *connect_msg,
+    size_t size) {
+  CHECK_EQ(entity_ids.size(), network_addrs.size());
+  zmq::socket_t *sock = GetCreateInterProcSock();
+  for (size_t i = 0; i < entity_ids.size(); ++i) {
+    CHECK(!IsLocalEntity(entity_ids[i])) << "Local entity " << entity_ids[i];
+    std::string connect_addr;
+    MakeInterProcAddr(network_addrs[i], &connect_addr);
+    ZMQUtil::ZMQConnect(sock, connect_addr);
+  }
+  for (const auto &entity_id : entity_ids) {
+    ZMQUtil::ZMQSendConnectMsg(sock, ZMQUtil::EntityID2ZmqID(entity_id),
+                               connect_msg, size);
+  }
+}
+
+zmq::socket_t *CommBus::GetCreateInterProcSock() {
   zmq::socket_t *sock = thr_info_->interproc_sock_.get();
   if (sock == NULL) {
     try {
@@ -183,11 +208,7 @@ void CommBus::ConnectTo(int32_t entity_id, const std::string &network_addr,
         thr_info_->num_bytes_interproc_send_buff_,
         thr_info_->num_bytes_interproc_recv_buff_);
   }
-
-  std::string connect_addr;
-  MakeInterProcAddr(network_addr, &connect_addr);
-  int32_t zmq_id = ZMQUtil::EntityID2ZmqID(entity_id);
-  ZMQUtil::ZMQConnectSend(sock, connect_addr, zmq_id, connect_msg, size);
+  return sock;
 }
 
 size_t CommBus::Send(int32_t entity_id, const void *data, size_t len) {
@@ -6,6 +6,7 @@
 #include <zmq.hpp>
 #include <string>
 #include <utility>
+#include <vector>
 #include <boost/thread/tss.hpp>
 #include <boost/scoped_ptr.hpp>
 #include <boost/scoped_array.hpp>
@@ -113,6 +114,12 @@ public:
   // Connect to a remote thread.
   void ConnectTo(int32_t entity_id, const std::string& network_addr, void
       *connect_msg, size_t size);
+  // Connect to several remote threads, sending each the same connect_msg.
+  // All connections are initiated before the first message is sent, so
+  // the TCP handshakes overlap rather than costing a round trip each.
+  void ConnectTo(const std::vector<int32_t> &entity_ids,
+      const std::vector<std::string> &network_addrs, void *connect_msg,
+      size_t size);
 
   size_t Send(int32_t entity_id, const void *data, size_t len);
   size_t SendInProc(int32_t entity_id, const void *data, size_t len);
@@ -162,6 +169,7 @@ private:
 
   static void SetUpRouterSocket(zmq::socket_t *sock, int32_t id,
     int num_bytes_send_buff, int num_bytes_recv_buff);
+  zmq::socket_t *GetCreateInterProcSock();
   static const std::string kInProcPrefix;
   static const std::string kInterProcPrefix;
   zmq::context_t *zmq_ctx_;
@@ -55,6 +55,12 @@ void ZMQUtil::ZMQBind(zmq::socket_t *sock, const std::string &connect_addr){
 
 void ZMQUtil::ZMQConnectSend(zmq::socket_t *sock,
   const std::string &connect_addr, int32_t zmq_id, void *msg, size_t size){
+  ZMQConnect(sock, connect_addr);
+  ZMQSendConnectMsg(sock, zmq_id, msg, size);
+}
+
+void ZMQUtil::ZMQConnect(zmq::socket_t *sock,
+  const std::string &connect_addr) {
   try{
     sock->connect(connect_addr.c_str());
   }catch(zmq::error_t &e){
@@ -71,7 +77,10 @@ void ZMQUtil::ZMQConnectSend(zmq::socket_t *sock,
       LOG(FATAL) << e.what();
     }
   }
+}
 
+void ZMQUtil::ZMQSendConnectMsg(zmq::socket_t *sock, int32_t zmq_id,
+  void *msg, size_t size) {
   timespec sleep_time, rem_time;
   sleep_time.tv_sec = 0;
   sleep_time.tv_nsec = 500; // sleep 500 nanoseconds
@@ -21,6 +21,14 @@ public:
   static void ZMQConnectSend(zmq::socket_t *sock, const std::string &connect_addr, 
     int32_t zmq_id, void *msg, size_t size);
 
+  // The two halves of ZMQConnectSend. ZMQConnect returns immediately; the
+  // connection is established in the background.
+  static void ZMQConnect(zmq::socket_t *sock, const std::string &connect_addr);
+
+  // Retry until the peer is connected (ROUTER_MANDATORY) and msg is sent.
+  static void ZMQSendConnectMsg(zmq::socket_t *sock, int32_t zmq_id,
+    void *msg, size_t size);
+
   // True for received, false for not
   static bool ZMQRecvAsync(zmq::socket_t *sock, zmq::message_t *msg);
 
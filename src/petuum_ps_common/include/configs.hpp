@@ -31,10 +31,17 @@ enum UpdateSortPolicy {
   FIFO_N_ReMag = 3
 };
 
+enum MetricsFormat {
+  JsonLines = 0,
+  Prometheus = 1
+};
+
 struct RowOpLogType {
   static const int32_t kDenseRowOpLog = 0;
   static const int32_t kSparseRowOpLog = 1;
   static const int32_t kSparseVectorRowOpLog = 2;
+  // Open-addressing table with inline updates; see SparseHashRowOpLog.
+  static const int32_t kSparseHashRowOpLog = 3;
 };
 
 enum OpLogType {
@@ -72,7 +79,14 @@ struct TableGroupConfig {
       oplog_push_upper_bound_kb(100),
       oplog_push_staleness_tolerance(2),
       thread_oplog_batch_size(100*1000*1000),
-      server_row_candidate_factor(5) { }
+      server_row_candidate_factor(5),
+      host_oplog_aggr(false),
+      metrics_path(""),
+      metrics_format(JsonLines),
+      metrics_interval_sec(10),
+      trace_path(""),
+      trace_buffer_size(64*1024),
+      staleness_adapt_interval(10) { }
 
   std::string stats_path;
 
@@ -146,6 +160,29 @@ struct TableGroupConfig {
   long server_idle_milli;
 
   long server_row_candidate_factor;
+
+  // If set to true, oplogs that co-located clients send to servers on
+  // other hosts are first merged by one server thread on this host, which
+  // forwards a single message per destination server per host clock.
+  bool host_oplog_aggr;
+
+  // If not empty, metrics (see util/metrics.hpp) are written to
+  // <metrics_path>.<client_id> every metrics_interval_sec while running.
+  // Latency histograms are only filled with PETUUM_STATS.
+  std::string metrics_path;
+  MetricsFormat metrics_format;
+  int32_t metrics_interval_sec;
+
+  // If not empty, PS thread activity (see util/trace.hpp) is recorded and
+  // dumped as Chrome trace-event JSON to <trace_path>.<client_id>.json at
+  // shutdown. Each thread keeps its last trace_buffer_size events.
+  std::string trace_path;
+  size_t trace_buffer_size;
+
+  // Clocks between staleness adjustments of tables with adaptive staleness.
+  // Must be positive, and exceed their adaptive_staleness_max + 1 so that
+  // all clients switch at the same clock.
+  int32_t staleness_adapt_interval;
 };
 
 // TableInfo is shared between client and server.
@@ -156,7 +193,9 @@ struct TableInfo {
       row_capacity(0),
       oplog_dense_serialized(false),
       row_oplog_type(1),
-      dense_row_oplog_capacity(0) { }
+      dense_row_oplog_capacity(0),
+      adaptive_staleness_min(0),
+      adaptive_staleness_max(0) { }
 
   // table_staleness is used for SSP and ClockVAP.
   int32_t table_staleness;
@@ -175,6 +214,12 @@ struct TableInfo {
   int32_t row_oplog_type;
 
   size_t dense_row_oplog_capacity;
+
+  // If adaptive_staleness_max > adaptive_staleness_min, the staleness starts
+  // at table_staleness and is tuned within [min, max] at run time (see
+  // consistency/table_staleness.hpp). SSP and SSPPush only.
+  int32_t adaptive_staleness_min;
+  int32_t adaptive_staleness_max;
 };
 
 // ClientTableConfig is used by client only.
@@ -189,7 +234,9 @@ struct ClientTableConfig {
       per_thread_append_only_buff_pool_size(3),
       bg_apply_append_oplog_freq(1),
       process_storage_type(BoundedSparse),
-      no_oplog_replay(false) { }
+      no_oplog_replay(false),
+      col_segment_size(0),
+      thread_cache_cow(false) { }
 
   TableInfo table_info;
 
@@ -216,6 +263,23 @@ struct ClientTableConfig {
   ProcessStorageType process_storage_type;
 
   bool no_oplog_replay;
+
+  // If > 0, the column space of each row is split into segments of this
+  // many columns, which servers store and serve as independent rows; the
+  // client fetches the segments of a row in parallel and reassembles it.
+  // Meant for tables with a few very wide rows. Requires SSP, a Dense or
+  // Sparse oplog with replay, and a dense row type (one whose serialized
+  // form is its packed column values).
+  size_t col_segment_size;
+
+  // If true, ThreadGet() hands out the shared process storage row instead
+  // of a per-thread clone; a thread only copies a row it reads again after
+  // writing to it in the same clock (to see its own updates).
+  // A shared row stays pinned until the thread's next Clock() and cannot be
+  // evicted, so each thread pins at most
+  // process_cache_capacity / (num_app_threads + 1) rows per clock and
+  // clones the rest.
+  bool thread_cache_cow;
 };
 
 }  // namespace petuum
@@ -125,6 +125,14 @@ public:
     return abstract_table_group_->GlobalBarrier();
   }
 
+  // Report the application's convergence metric, higher is better (e.g.
+  // negated training loss). Tables with adaptive staleness lower their bound
+  // when it gets worse. Any thread may call it; the latest value is sent
+  // with the next staleness report.
+  static void ReportProgress(double progress) {
+    return abstract_table_group_->ReportProgress(progress);
+  }
+
 private:
   static AbstractTableGroup *abstract_table_group_;
 };
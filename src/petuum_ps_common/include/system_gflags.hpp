@@ -7,6 +7,11 @@
 #include <petuum_ps_common/util/utils.hpp>
 
 DEFINE_string(stats_path, "", "stats file path prefix");
+DEFINE_string(metrics_path, "", "live metrics file path prefix");
+DEFINE_string(metrics_format, "JsonLines", "JsonLines/Prometheus");
+DEFINE_int32(metrics_interval_sec, 10, "live metrics report interval");
+DEFINE_string(trace_path, "", "Chrome trace file path prefix");
+DEFINE_uint64(trace_buffer_size, 64*1024, "trace events kept per thread");
 
 // Topology Configs
 DEFINE_int32(num_clients, 1, "total number of clients");
@@ -35,6 +40,13 @@ DEFINE_int32(server_push_row_threshold, 100, "Server push row threshold");
 DEFINE_int32(server_idle_milli, 10, "server idle time out in millisec");
 DEFINE_string(update_sort_policy, "Random", "Update sort policy");
 
+// Aggregate oplogs of clients on the same host before they leave the host
+DEFINE_bool(host_oplog_aggr, false, "merge co-located clients' oplogs per host");
+
+// Adaptive staleness
+DEFINE_int32(staleness_adapt_interval, 10,
+             "clocks between adaptive staleness adjustments");
+
 // Snapshot Configs
 DEFINE_int32(snapshot_clock, -1, "snapshot clock");
 DEFINE_int32(resume_clock, -1, "resume clock");
@@ -45,6 +57,17 @@ namespace petuum {
 void InitTableGroupConfig(TableGroupConfig *config, int32_t *client_id,
                           int32_t num_tables) {
   config->stats_path = FLAGS_stats_path;
+  config->metrics_path = FLAGS_metrics_path;
+  if (FLAGS_metrics_format == "JsonLines") {
+    config->metrics_format = petuum::JsonLines;
+  } else if (FLAGS_metrics_format == "Prometheus") {
+    config->metrics_format = petuum::Prometheus;
+  } else {
+    LOG(FATAL) << "Unknown metrics format " << FLAGS_metrics_format;
+  }
+  config->metrics_interval_sec = FLAGS_metrics_interval_sec;
+  config->trace_path = FLAGS_trace_path;
+  config->trace_buffer_size = FLAGS_trace_buffer_size;
   config->num_comm_channels_per_client = FLAGS_num_comm_channels_per_client;
   config->num_tables = num_tables;
   config->num_total_clients = FLAGS_num_clients;
@@ -92,6 +115,8 @@ void InitTableGroupConfig(TableGroupConfig *config, int32_t *client_id,
   config->server_push_row_threshold = FLAGS_server_push_row_threshold;
   config->server_idle_milli = FLAGS_server_idle_milli;
   config->server_row_candidate_factor = FLAGS_server_row_candidate_factor;
+  config->host_oplog_aggr = FLAGS_host_oplog_aggr;
+  config->staleness_adapt_interval = FLAGS_staleness_adapt_interval;
 
   *client_id = FLAGS_client_id;
 }
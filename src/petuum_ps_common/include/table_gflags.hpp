@@ -18,6 +18,10 @@ DEFINE_uint64(append_only_buffer_capacity, 1024*1024, "buffer capacity in bytes"
 DEFINE_uint64(append_only_buffer_pool_size, 3, "append_ only buffer pool size");
 DEFINE_int32(bg_apply_append_oplog_freq, 4, "bg apply append oplog freq");
 DEFINE_string(process_storage_type, "BoundedSparse", "proess storage type");
+DEFINE_bool(thread_cache_cow, false, "share process rows with thread caches");
+DEFINE_int32(adaptive_staleness_min, 0, "adaptive staleness lower bound");
+DEFINE_int32(adaptive_staleness_max, 0,
+             "adaptive staleness upper bound; adaptive if > min");
 
 namespace petuum {
 
@@ -30,6 +34,8 @@ namespace petuum {
 
 void InitTableConfig(ClientTableConfig *config) {
   config->table_info.table_staleness = FLAGS_table_staleness;
+  config->table_info.adaptive_staleness_min = FLAGS_adaptive_staleness_min;
+  config->table_info.adaptive_staleness_max = FLAGS_adaptive_staleness_max;
   config->table_info.row_type = FLAGS_row_type;
 
   config->table_info.oplog_dense_serialized = FLAGS_oplog_dense_serialized;
@@ -65,6 +71,8 @@ void InitTableConfig(ClientTableConfig *config) {
   } else {
     LOG(FATAL) << "Unknown process storage type " << FLAGS_process_storage_type;
   }
+
+  config->thread_cache_cow = FLAGS_thread_cache_cow;
 }
 
 }
@@ -0,0 +1,255 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+#include <glog/logging.h>
+
+#include <petuum_ps_common/oplog/abstract_row_oplog.hpp>
+
+namespace petuum {
+const size_t kSparseHashRowOpLogInitCapacity = 16;
+const int32_t kSparseHashEmptyColId = -1;
+
+// Sparse row oplog that keeps (column id, update) pairs inline in one
+// open-addressing table (linear probing) instead of a std::map node plus a
+// separate update allocation per column. Reset() keeps the table, so a
+// recycled row oplog does not allocate at all.
+//
+// As with SparseVectorRowOpLog, FindCreate() may move the updates: a
+// pointer it returns is valid until the next FindCreate() or
+// OverwriteWithDenseUpdate().
+class SparseHashRowOpLog : public virtual AbstractRowOpLog {
+public:
+  SparseHashRowOpLog(
+      size_t init_capacity,
+      InitUpdateFunc InitUpdate,
+      CheckZeroUpdateFunc CheckZeroUpdate,
+      size_t update_size):
+      AbstractRowOpLog(update_size),
+      size_(0),
+      iter_order_valid_(true),
+      iter_idx_(0),
+      InitUpdate_(InitUpdate),
+      CheckZeroUpdate_(CheckZeroUpdate) {
+    size_t capacity = 1;
+    while (capacity < init_capacity) capacity <<= 1;
+    col_ids_.assign(capacity, kSparseHashEmptyColId);
+    updates_.resize(capacity*update_size);
+    mask_ = capacity - 1;
+  }
+
+  virtual ~SparseHashRowOpLog() { }
+
+  void Reset() {
+    std::fill(col_ids_.begin(), col_ids_.end(), kSparseHashEmptyColId);
+    size_ = 0;
+    iter_order_.clear();
+    iter_order_valid_ = true;
+  }
+
+  void* Find(int32_t col_id) {
+    size_t slot = FindSlot(col_id);
+    if (col_ids_[slot] == kSparseHashEmptyColId) {
+      return 0;
+    }
+    return &updates_[slot*update_size_];
+  }
+
+  const void* FindConst(int32_t col_id) const {
+    size_t slot = FindSlot(col_id);
+    if (col_ids_[slot] == kSparseHashEmptyColId) {
+      return 0;
+    }
+    return &updates_[slot*update_size_];
+  }
+
+  void* FindCreate(int32_t col_id) {
+    size_t slot = FindSlot(col_id);
+    if (col_ids_[slot] != kSparseHashEmptyColId) {
+      return &updates_[slot*update_size_];
+    }
+    // Keep the load factor at or below 3/4.
+    if ((size_ + 1)*4 > col_ids_.size()*3) {
+      Rehash(col_ids_.size()*2, false);
+      slot = FindSlot(col_id);
+    }
+    col_ids_[slot] = col_id;
+    ++size_;
+    iter_order_valid_ = false;
+    uint8_t *update = &updates_[slot*update_size_];
+    InitUpdate_(col_id, update);
+    return update;
+  }
+
+  // Guaranteed ordered traversal
+  void* BeginIterate(int32_t *column_id) {
+    SortIterOrder();
+    iter_idx_ = 0;
+    return Next(column_id);
+  }
+
+  void* Next(int32_t *column_id) {
+    if (iter_idx_ == iter_order_.size()) {
+      return 0;
+    }
+    size_t slot = static_cast<uint32_t>(iter_order_[iter_idx_++]);
+    *column_id = col_ids_[slot];
+    return &updates_[slot*update_size_];
+  }
+
+  // Guaranteed ordered traversal, in ascending order of column_id
+  const void* BeginIterateConst(int32_t *column_id) const {
+    SortIterOrder();
+    iter_idx_ = 0;
+    return NextConst(column_id);
+  }
+
+  const void* NextConst(int32_t *column_id) const {
+    if (iter_idx_ == iter_order_.size()) {
+      return 0;
+    }
+    size_t slot = static_cast<uint32_t>(iter_order_[iter_idx_++]);
+    *column_id = col_ids_[slot];
+    return &updates_[slot*update_size_];
+  }
+
+  size_t GetSize() const {
+    return size_;
+  }
+
+  size_t ClearZerosAndGetNoneZeroSize() {
+    for (size_t slot = 0; slot < col_ids_.size(); ++slot) {
+      if (col_ids_[slot] != kSparseHashEmptyColId
+          && CheckZeroUpdate_(&updates_[slot*update_size_])) {
+        // Linear probing cannot simply punch holes; rebuild without zeros.
+        Rehash(col_ids_.size(), true);
+        break;
+      }
+    }
+    return size_;
+  }
+
+  size_t GetSparseSerializedSize() {
+    return sizeof(int32_t) + sizeof(int32_t)*size_ + update_size_*size_;
+  }
+
+  size_t GetDenseSerializedSize() {
+    LOG(FATAL) << "Sparse OpLog does not support dense serialize";
+    return 0;
+  }
+
+  // Serization format:
+  // 1) number of updates in that row
+  // 2) total size for column ids
+  // 3) total size for update array
+  // Updates are written in table order, not column order; receivers apply
+  // them one column at a time, so this skips the sort.
+  size_t SerializeSparse(void *mem) {
+    int32_t *mem_num_updates = reinterpret_cast<int32_t*>(mem);
+    *mem_num_updates = size_;
+
+    int32_t *mem_index = mem_num_updates + 1;
+    uint8_t *mem_oplogs = reinterpret_cast<uint8_t*>(mem_index + size_);
+
+    for (size_t slot = 0; slot < col_ids_.size(); ++slot) {
+      if (col_ids_[slot] == kSparseHashEmptyColId) {
+        continue;
+      }
+      *mem_index++ = col_ids_[slot];
+      memcpy(mem_oplogs, &updates_[slot*update_size_], update_size_);
+      mem_oplogs += update_size_;
+    }
+    return GetSparseSerializedSize();
+  }
+
+  size_t SerializeDense(void *mem) {
+    LOG(FATAL) << "Sparse OpLog does not support dense serialize";
+    return GetSparseSerializedSize();
+  }
+
+  const void *ParseDenseSerializedOpLog(
+      const void *mem, int32_t *num_updates,
+      size_t *serialized_size) const {
+    LOG(FATAL) << "Sparse OpLog does not support dense serialize";
+    return mem;
+  }
+
+  void OverwriteWithDenseUpdate(const void *updates, int32_t index_st,
+                                int32_t num_updates) {
+    const uint8_t *updates_uint8 = reinterpret_cast<const uint8_t*>(updates);
+    for (int i = 0; i < num_updates; ++i) {
+      void *update = FindCreate(i + index_st);
+      memcpy(update, updates_uint8 + i*update_size_, update_size_);
+    }
+  }
+
+private:
+  size_t Hash(int32_t col_id) const {
+    // Fibonacci hashing; consecutive columns spread over the table.
+    return (static_cast<uint32_t>(col_id)*2654435761U) & mask_;
+  }
+
+  // Slot holding col_id, or the empty slot where it would be inserted.
+  size_t FindSlot(int32_t col_id) const {
+    size_t slot = Hash(col_id);
+    while (col_ids_[slot] != kSparseHashEmptyColId
+           && col_ids_[slot] != col_id) {
+      slot = (slot + 1) & mask_;
+    }
+    return slot;
+  }
+
+  void Rehash(size_t capacity, bool drop_zeros) {
+    std::vector<int32_t> old_col_ids(capacity, kSparseHashEmptyColId);
+    std::vector<uint8_t> old_updates(capacity*update_size_);
+    old_col_ids.swap(col_ids_);
+    old_updates.swap(updates_);
+    mask_ = capacity - 1;
+    size_ = 0;
+    for (size_t old_slot = 0; old_slot < old_col_ids.size(); ++old_slot) {
+      int32_t col_id = old_col_ids[old_slot];
+      const uint8_t *update = &old_updates[old_slot*update_size_];
+      if (col_id == kSparseHashEmptyColId
+          || (drop_zeros && CheckZeroUpdate_(update))) {
+        continue;
+      }
+      size_t slot = FindSlot(col_id);
+      col_ids_[slot] = col_id;
+      memcpy(&updates_[slot*update_size_], update, update_size_);
+      ++size_;
+    }
+    iter_order_valid_ = false;
+  }
+
+  // (column id << 32 | slot), sorted, so iteration walks ascending column
+  // ids. SerializeSparse does not use it.
+  void SortIterOrder() const {
+    if (iter_order_valid_) {
+      return;
+    }
+    iter_order_.clear();
+    for (size_t slot = 0; slot < col_ids_.size(); ++slot) {
+      if (col_ids_[slot] != kSparseHashEmptyColId) {
+        iter_order_.push_back(
+            (static_cast<uint64_t>(col_ids_[slot]) << 32) | slot);
+      }
+    }
+    std::sort(iter_order_.begin(), iter_order_.end());
+    iter_order_valid_ = true;
+  }
+
+  std::vector<int32_t> col_ids_;
+  std::vector<uint8_t> updates_;
+  size_t mask_;
+  size_t size_;
+  mutable std::vector<uint64_t> iter_order_;
+  mutable bool iter_order_valid_;
+  mutable size_t iter_idx_;
+  const InitUpdateFunc InitUpdate_;
+  const CheckZeroUpdateFunc CheckZeroUpdate_;
+};
+
+}
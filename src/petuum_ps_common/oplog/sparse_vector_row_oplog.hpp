@@ -24,6 +24,7 @@ public:
       size_t update_size):
       AbstractRowOpLog(update_size),
       oplogs_(init_capacity, update_size),
+      num_nonzeros_(0),
       InitUpdate_(InitUpdate),
       CheckZeroUpdate_(CheckZeroUpdate) {
     CHECK(init_capacity > 0);
@@ -35,6 +36,7 @@ public:
 
   void Reset() {
     oplogs_.ResetSizeAndShrink();
+    num_nonzeros_ = 0;
     memset(oplogs_.get_data_ptr(), 0,
            (update_size_ + sizeof(int32_t))*oplogs_.get_capacity());
   }
@@ -119,7 +121,7 @@ public:
 
     for (int32_t idx = 0; idx < oplogs_.get_size(); ++idx) {
       uint8_t *update = oplogs_.GetByIdx(idx, &col_id);
-      if (!CheckZeroUpdate_(update))
+      if (CheckZeroUpdate_(update))
         continue;
 
       *(reinterpret_cast<int32_t*>(mem_index)) = col_id;
@@ -16,7 +16,7 @@ enum MsgType {
   kServerConnect = 1,
   kAppConnect = 2,
   kBgCreateTable = 3,
-  kCreateTable = 4,
+  kCreateTables = 4,
   kCreateTableReply = 5,
   kCreatedAllTables = 6,
   kRowRequest = 7,
@@ -33,6 +33,11 @@ enum MsgType {
   kServerPushRow = 18,
   kServerOpLogAck = 19,
   kBgHandleAppendOpLog = 20,
+  kAggrSendOpLog = 21,
+  kCreateTablesReply = 22,
+  kStalenessReport = 23,
+  kStalenessUpdate = 24,
+  kClientClock = 25,
   kMemTransfer = 50
 };
 
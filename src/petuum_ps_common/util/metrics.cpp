@@ -0,0 +1,245 @@
+#include <petuum_ps_common/util/metrics.hpp>
+#include <glog/logging.h>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace petuum {
+
+namespace {
+
+const char *kMetricCounterNames[kNumMetricCounters] = {
+  "app_get",
+  "app_get_miss",
+  "app_thread_get",
+  "app_inc",
+  "app_batch_inc",
+  "app_clock",
+  "bg_clock",
+  "bg_oplog_sent_bytes",
+  "bg_server_push_row_recv_bytes",
+  "server_clock",
+  "server_oplog_recv_bytes",
+  "server_push_row_bytes",
+  "server_oplog_msg_recv",
+  "server_push_row_msg_send"
+};
+
+const char *kMetricHistogramNames[kNumMetricHistograms] = {
+  "get",
+  "ssp_get_server_fetch",
+  "ssppush_get_comm_block",
+  "table_clock"
+};
+
+const double kQuantiles[] = {0.5, 0.9, 0.99, 0.999};
+
+double WallTimeSec() {
+  return std::chrono::duration<double>(
+      std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+uint64_t HistCount(const std::vector<uint64_t> &hist) {
+  uint64_t count = 0;
+  for (uint64_t bucket : hist) {
+    count += bucket;
+  }
+  return count;
+}
+
+// Upper bound (us) of the bucket holding quantile q; 0 if empty.
+uint64_t HistQuantile(const std::vector<uint64_t> &hist, double q) {
+  uint64_t count = HistCount(hist);
+  if (count == 0) {
+    return 0;
+  }
+  uint64_t rank = static_cast<uint64_t>(q * (count - 1)) + 1;
+  uint64_t seen = 0;
+  for (size_t b = 0; b < hist.size(); ++b) {
+    seen += hist[b];
+    if (seen >= rank) {
+      return MetricBuckets::GetUpperBound(b);
+    }
+  }
+  return MetricBuckets::GetUpperBound(hist.size() - 1);
+}
+
+}  // anonymous namespace
+
+__thread ThreadMetrics *Metrics::thread_metrics_ = 0;
+std::mutex Metrics::mtx_;
+std::vector<std::unique_ptr<ThreadMetrics> > Metrics::all_thread_metrics_;
+std::string Metrics::path_;
+MetricsFormat Metrics::format_ = JsonLines;
+int32_t Metrics::interval_sec_ = 10;
+int32_t Metrics::client_id_ = 0;
+std::thread Metrics::reporter_;
+std::condition_variable Metrics::reporter_cv_;
+bool Metrics::stop_ = false;
+
+void Metrics::Init(const TableGroupConfig &table_group_config) {
+  if (table_group_config.metrics_path.empty()) {
+    return;
+  }
+  CHECK_GT(table_group_config.metrics_interval_sec, 0);
+  std::stringstream path_ss;
+  path_ss << table_group_config.metrics_path << "."
+          << table_group_config.client_id;
+  path_ = path_ss.str();
+  format_ = table_group_config.metrics_format;
+  interval_sec_ = table_group_config.metrics_interval_sec;
+  client_id_ = table_group_config.client_id;
+  stop_ = false;
+  reporter_ = std::thread(&Metrics::ReporterLoop);
+}
+
+void Metrics::ShutDown() {
+  if (!reporter_.joinable()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    stop_ = true;
+  }
+  reporter_cv_.notify_all();
+  reporter_.join();
+}
+
+ThreadMetrics *Metrics::RegisterThread() {
+  ThreadMetrics *thread_metrics = new ThreadMetrics;
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    all_thread_metrics_.emplace_back(thread_metrics);
+  }
+  return thread_metrics;
+}
+
+void Metrics::TakeSnapshot(Snapshot *snapshot) {
+  snapshot->time_sec = WallTimeSec();
+  snapshot->counters.assign(kNumMetricCounters, 0);
+  snapshot->hists.assign(kNumMetricHistograms,
+      std::vector<uint64_t>(MetricBuckets::kNumBuckets, 0));
+  std::lock_guard<std::mutex> lock(mtx_);
+  for (const auto &thread_metrics : all_thread_metrics_) {
+    for (int c = 0; c < kNumMetricCounters; ++c) {
+      snapshot->counters[c]
+          += thread_metrics->counters[c].load(std::memory_order_relaxed);
+    }
+    for (int h = 0; h < kNumMetricHistograms; ++h) {
+      for (int b = 0; b < MetricBuckets::kNumBuckets; ++b) {
+        snapshot->hists[h][b]
+            += thread_metrics->hists[h][b].load(std::memory_order_relaxed);
+      }
+    }
+  }
+}
+
+std::string Metrics::JsonLine(const Snapshot &prev, const Snapshot &curr) {
+  double interval_sec = curr.time_sec - prev.time_sec;
+  std::stringstream ss;
+  ss << "{\"time_sec\": " << std::fixed << curr.time_sec;
+  ss.unsetf(std::ios_base::floatfield);
+  ss << ", \"client_id\": " << client_id_
+     << ", \"interval_sec\": " << interval_sec
+     << ", \"counters\": {";
+  for (int c = 0; c < kNumMetricCounters; ++c) {
+    ss << (c == 0 ? "" : ", ") << "\"" << kMetricCounterNames[c] << "\": "
+       << curr.counters[c];
+  }
+  ss << "}, \"per_sec\": {";
+  for (int c = 0; c < kNumMetricCounters; ++c) {
+    ss << (c == 0 ? "" : ", ") << "\"" << kMetricCounterNames[c] << "\": "
+       << (curr.counters[c] - prev.counters[c]) / interval_sec;
+  }
+  uint64_t interval_get = curr.counters[kMetricAppGet]
+      - prev.counters[kMetricAppGet];
+  uint64_t interval_get_miss = curr.counters[kMetricAppGetMiss]
+      - prev.counters[kMetricAppGetMiss];
+  ss << "}, \"get_miss_rate\": "
+     << (interval_get == 0 ? 0. : double(interval_get_miss) / interval_get);
+  // Histograms over this interval only.
+  ss << ", \"latency_us\": {";
+  for (int h = 0; h < kNumMetricHistograms; ++h) {
+    std::vector<uint64_t> hist(curr.hists[h]);
+    for (size_t b = 0; b < hist.size(); ++b) {
+      hist[b] -= prev.hists[h][b];
+    }
+    ss << (h == 0 ? "" : ", ") << "\"" << kMetricHistogramNames[h]
+       << "\": {\"count\": " << HistCount(hist);
+    for (double q : kQuantiles) {
+      ss << ", \"p" << q * 100 << "\": " << HistQuantile(hist, q);
+    }
+    ss << ", \"max\": " << HistQuantile(hist, 1.) << "}";
+  }
+  ss << "}}";
+  return ss.str();
+}
+
+std::string Metrics::PrometheusText(const Snapshot &curr) {
+  std::stringstream ss;
+  std::stringstream label_ss;
+  label_ss << "client_id=\"" << client_id_ << "\"";
+  const std::string label = label_ss.str();
+  for (int c = 0; c < kNumMetricCounters; ++c) {
+    ss << "# TYPE petuum_" << kMetricCounterNames[c] << "_total counter\n"
+       << "petuum_" << kMetricCounterNames[c] << "_total{" << label << "} "
+       << curr.counters[c] << "\n";
+  }
+  for (int h = 0; h < kNumMetricHistograms; ++h) {
+    const std::string name = std::string("petuum_")
+        + kMetricHistogramNames[h] + "_seconds";
+    ss << "# TYPE " << name << " summary\n";
+    for (double q : kQuantiles) {
+      ss << name << "{" << label << ",quantile=\"" << q << "\"} "
+         << HistQuantile(curr.hists[h], q) / 1e6 << "\n";
+    }
+    ss << name << "_count{" << label << "} " << HistCount(curr.hists[h])
+       << "\n";
+  }
+  return ss.str();
+}
+
+void Metrics::Report(const Snapshot &prev, const Snapshot &curr) {
+  if (format_ == Prometheus) {
+    // Scrapers must never see a partial file.
+    std::string tmp_path = path_ + ".tmp";
+    {
+      std::ofstream out(tmp_path, std::ios_base::out | std::ios_base::trunc);
+      out << PrometheusText(curr);
+    }
+    // A metrics failure should not take the job down.
+    LOG_IF(WARNING, rename(tmp_path.c_str(), path_.c_str()) != 0)
+        << "Cannot rename " << tmp_path << " to " << path_;
+    return;
+  }
+  std::ofstream out(path_, std::ios_base::out | std::ios_base::app);
+  out << JsonLine(prev, curr) << "\n";
+  if (static_cast<size_t>(out.tellp()) > kMaxFileBytes) {
+    out.close();
+    std::string rotated_path = path_ + ".1";
+    LOG_IF(WARNING, rename(path_.c_str(), rotated_path.c_str()) != 0)
+        << "Cannot rename " << path_ << " to " << rotated_path;
+  }
+}
+
+void Metrics::ReporterLoop() {
+  Snapshot prev;
+  TakeSnapshot(&prev);
+  bool stop = false;
+  while (!stop) {
+    {
+      std::unique_lock<std::mutex> lock(mtx_);
+      stop = reporter_cv_.wait_for(lock, std::chrono::seconds(interval_sec_),
+                                   [] { return stop_; });
+    }
+    Snapshot curr;
+    TakeSnapshot(&curr);
+    Report(prev, curr);
+    prev.time_sec = curr.time_sec;
+    prev.counters.swap(curr.counters);
+    prev.hists.swap(curr.hists);
+  }
+}
+
+}   // namespace petuum
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <petuum_ps_common/include/configs.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdint.h>
+
+namespace petuum {
+
+// Monotonic counters, summed over all threads of the process.
+enum MetricCounter {
+  kMetricAppGet = 0,
+  kMetricAppGetMiss,
+  kMetricAppThreadGet,
+  kMetricAppInc,
+  kMetricAppBatchInc,
+  kMetricAppClock,
+  kMetricBgClock,
+  kMetricBgOpLogSentBytes,
+  kMetricBgServerPushRowRecvBytes,
+  kMetricServerClock,
+  kMetricServerOpLogRecvBytes,
+  kMetricServerPushRowBytes,
+  kMetricServerOpLogMsgRecv,
+  kMetricServerPushRowMsgSend,
+  kNumMetricCounters
+};
+
+// Latency histograms, in microseconds.
+enum MetricHistogram {
+  kMetricGetSec = 0,              // sampled SSP Get(), hit or miss
+  kMetricSSPGetServerFetchSec,
+  kMetricSSPPushGetCommBlockSec,
+  kMetricTableClockSec,
+  kNumMetricHistograms
+};
+
+// Log-linear buckets as in HDR histograms: values below 16 have their own
+// bucket, above that each power of two is split into 8 buckets (at most
+// 12.5% relative error). Values of 2^40 us or more share the last bucket.
+class MetricBuckets {
+public:
+  static const int32_t kNumBuckets = 16 + (40 - 4) * 8;
+
+  static int32_t GetIndex(uint64_t value) {
+    if (value < 16) {
+      return value;
+    }
+    int32_t exp = 63 - __builtin_clzll(value);
+    if (exp >= 40) {
+      return kNumBuckets - 1;
+    }
+    return 16 + (exp - 4) * 8 + ((value >> (exp - 3)) & 7);
+  }
+
+  // Largest value that falls in bucket idx.
+  static uint64_t GetUpperBound(int32_t idx) {
+    if (idx < 16) {
+      return idx;
+    }
+    int32_t exp = (idx - 16) / 8 + 4;
+    uint64_t sub_bucket = (idx - 16) % 8;
+    return ((8 + sub_bucket + 1) << (exp - 3)) - 1;
+  }
+};
+
+// Each thread writes only its own slot, with plain (relaxed) loads and
+// stores, so recording is a few instructions and never locks. The reporter
+// thread reads all slots. Slots outlive their threads so totals never go
+// backwards.
+struct ThreadMetrics {
+  std::atomic<uint64_t> counters[kNumMetricCounters];
+  std::atomic<uint64_t> hists[kNumMetricHistograms][MetricBuckets::kNumBuckets];
+
+  ThreadMetrics() {
+    for (auto &counter : counters) {
+      counter.store(0, std::memory_order_relaxed);
+    }
+    for (auto &hist : hists) {
+      for (auto &bucket : hist) {
+        bucket.store(0, std::memory_order_relaxed);
+      }
+    }
+  }
+};
+
+// Process-wide metrics registry with a background reporter. Counters are
+// bumped directly by the PS threads and work in every build. Latency
+// histograms reuse the sampled Stats timers, so they are only filled in
+// PETUUM_STATS builds. Functions are thread-safe.
+class Metrics {
+public:
+  // Start the reporter if table_group_config.metrics_path is set. It writes
+  // every metrics_interval_sec to <metrics_path>.<client_id>:
+  //  - JsonLines: one JSON object per interval, appended; the file is
+  //    rotated to <file>.1 when it exceeds kMaxFileBytes.
+  //  - Prometheus: text exposition format, rewritten in place (via rename)
+  //    each interval, for a textfile collector.
+  static void Init(const TableGroupConfig &table_group_config);
+
+  // Write a last snapshot and stop the reporter. No-op if not started.
+  static void ShutDown();
+
+  static void Add(MetricCounter counter, uint64_t delta = 1) {
+    std::atomic<uint64_t> &c = GetThreadMetrics()->counters[counter];
+    c.store(c.load(std::memory_order_relaxed) + delta,
+            std::memory_order_relaxed);
+  }
+
+  static void Record(MetricHistogram hist, double sec) {
+    std::atomic<uint64_t> &bucket = GetThreadMetrics()->hists[hist][
+        MetricBuckets::GetIndex(static_cast<uint64_t>(sec * 1e6))];
+    bucket.store(bucket.load(std::memory_order_relaxed) + 1,
+                 std::memory_order_relaxed);
+  }
+
+private:
+  struct Snapshot {
+    double time_sec;
+    std::vector<uint64_t> counters;
+    std::vector<std::vector<uint64_t> > hists;
+  };
+
+  static const size_t kMaxFileBytes = 64 * 1024 * 1024;
+
+  static ThreadMetrics *GetThreadMetrics() {
+    if (thread_metrics_ == 0) {
+      thread_metrics_ = RegisterThread();
+    }
+    return thread_metrics_;
+  }
+
+  static ThreadMetrics *RegisterThread();
+
+  static void TakeSnapshot(Snapshot *snapshot);
+  static void Report(const Snapshot &prev, const Snapshot &curr);
+  static std::string JsonLine(const Snapshot &prev, const Snapshot &curr);
+  static std::string PrometheusText(const Snapshot &curr);
+  static void ReporterLoop();
+
+  // Owned by all_thread_metrics_. __thread rather than thread_specific_ptr
+  // since this is read on every Get/Inc.
+  static __thread ThreadMetrics *thread_metrics_;
+
+  static std::mutex mtx_;
+  static std::vector<std::unique_ptr<ThreadMetrics> > all_thread_metrics_;
+
+  static std::string path_;
+  static MetricsFormat format_;
+  static int32_t interval_sec_;
+  static int32_t client_id_;
+  static std::thread reporter_;
+  static std::condition_variable reporter_cv_;
+  static bool stop_;
+};
+
+}   // namespace petuum
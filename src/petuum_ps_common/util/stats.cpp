@@ -1,14 +1,17 @@
 //Author: Jinliang Wei
 
 #include <petuum_ps_common/util/stats.hpp>
+#include <petuum_ps_common/util/metrics.hpp>
 #include <petuum_ps_common/include/constants.hpp>
 #include <glog/logging.h>
 #include <sstream>
 #include <fstream>
+#include <algorithm>
 
 namespace petuum {
 TableGroupConfig Stats::table_group_config_;
 std::string Stats::stats_path_;
+HighResolutionTimer Stats::startup_timer_;
 boost::thread_specific_ptr<ThreadType> Stats::thread_type_;
 boost::thread_specific_ptr<AppThreadStats> Stats::app_thread_stats_;
 boost::thread_specific_ptr<BgThreadStats> Stats::bg_thread_stats_;
@@ -48,14 +51,19 @@ double Stats::app_accum_tg_clock_sec_ = 0;
 std::vector<double> Stats::app_accum_append_only_flush_oplog_sec_;
 std::vector<size_t> Stats::app_append_only_flush_oplog_count_;
 
+double Stats::app_time_to_first_clock_sec_ = 0;
+double Stats::bg_handshake_sec_ = 0;
+double Stats::bg_create_tables_sec_ = 0;
+double Stats::server_init_sec_ = 0;
+
 double Stats::bg_accum_clock_end_oplog_serialize_sec_ = 0;
 double Stats::bg_accum_total_oplog_serialize_sec_ = 0;
 double Stats::bg_accum_server_push_row_apply_sec_ = 0;
 double Stats::bg_accum_oplog_sent_mb_ = 0;
 double Stats::bg_accum_server_push_row_recv_mb_ = 0;
 
-std::vector<double> Stats::bg_per_clock_oplog_sent_mb_;
-std::vector<double> Stats::bg_per_clock_server_push_row_recv_mb_;
+PerClockSeries Stats::bg_per_clock_oplog_sent_mb_;
+PerClockSeries Stats::bg_per_clock_server_push_row_recv_mb_;
 
 std::vector<size_t> Stats::bg_accum_server_push_oplog_row_applied_;
 std::vector<size_t> Stats::bg_accum_server_push_update_applied_;
@@ -87,12 +95,47 @@ double Stats::server_accum_push_row_sec_ = 0.0;
 double Stats::server_accum_oplog_recv_mb_ = 0.0;
 double Stats::server_accum_push_row_mb_ = 0.0;
 
-std::vector<double> Stats::server_per_clock_oplog_recv_mb_;
-std::vector<double> Stats::server_per_clock_push_row_mb_;
+PerClockSeries Stats::server_per_clock_oplog_recv_mb_;
+PerClockSeries Stats::server_per_clock_push_row_mb_;
 
 std::vector<size_t> Stats::server_accum_num_oplog_msg_recv_;
 std::vector<size_t> Stats::server_accum_num_push_row_msg_send_;
 
+void PerClockSeries::Clock() {
+  ++clock_;
+  if (clock_ % clocks_per_entry_ != 0)
+    return;
+  values_.push_back(0.0);
+  if (values_.size() > kMaxEntries)
+    Coarsen();
+}
+
+void PerClockSeries::Coarsen() {
+  size_t num_entries = (values_.size() + 1) / 2;
+  for (size_t i = 0; i < num_entries; ++i) {
+    values_[i] = values_[2 * i];
+    if (2 * i + 1 < values_.size())
+      values_[i] += values_[2 * i + 1];
+  }
+  values_.resize(num_entries);
+  clocks_per_entry_ *= 2;
+}
+
+void PerClockSeries::Merge(const PerClockSeries &other, double scale) {
+  PerClockSeries coarse_other(other);
+  while (coarse_other.clocks_per_entry_ < clocks_per_entry_)
+    coarse_other.Coarsen();
+  while (clocks_per_entry_ < coarse_other.clocks_per_entry_)
+    Coarsen();
+
+  if (values_.size() < coarse_other.values_.size())
+    values_.resize(coarse_other.values_.size(), 0.0);
+  for (size_t i = 0; i < coarse_other.values_.size(); ++i) {
+    values_[i] += coarse_other.values_[i] * scale;
+  }
+  clock_ = std::max(clock_, coarse_other.clock_);
+}
+
 void Stats::Init(const TableGroupConfig &table_group_config) {
   table_group_config_ = table_group_config;
 
@@ -101,6 +144,7 @@ void Stats::Init(const TableGroupConfig &table_group_config) {
   stats_path_ss << "." << table_group_config.client_id;
 
   stats_path_ = stats_path_ss.str();
+  startup_timer_.restart();
 }
 
 void Stats::RegisterThread(ThreadType thread_type) {
@@ -184,6 +228,8 @@ void Stats::DeregisterAppThread() {
       * app_thread_stats_->accum_sample_batch_inc_process_storage_sec;
   }
 
+  MergeAppThreadStalenessHist();
+
   double my_accum_comm_block_sec = 0.0;
 
   for (auto table_stats_iter = app_thread_stats_->table_stats.begin();
@@ -323,27 +369,10 @@ void Stats::DeregisterBgThread() {
   bg_num_server_push_deserialize_sampled_.push_back(
       stats.num_server_push_deserialize_sampled);
 
-  size_t vec_size = stats.per_clock_oplog_sent_kb.size();
-
-  if (bg_per_clock_oplog_sent_mb_.size() < vec_size) {
-    bg_per_clock_oplog_sent_mb_.resize(vec_size, 0.0);
-  }
-
-  for (int i = 0; i < vec_size; ++i) {
-    bg_per_clock_oplog_sent_mb_[i]
-      += stats.per_clock_oplog_sent_kb[i] / double(k1_Ki);
-  }
-
-  vec_size = stats.per_clock_server_push_row_recv_kb.size();
-
-  if (bg_per_clock_server_push_row_recv_mb_.size() < vec_size) {
-    bg_per_clock_server_push_row_recv_mb_.resize(vec_size, 0.0);
-  }
-
-  for (int i = 0; i < vec_size; ++i) {
-    bg_per_clock_server_push_row_recv_mb_[i]
-      += stats.per_clock_server_push_row_recv_kb[i] / double(k1_Ki);
-  }
+  bg_per_clock_oplog_sent_mb_.Merge(stats.per_clock_oplog_sent_kb,
+                                    1. / double(k1_Ki));
+  bg_per_clock_server_push_row_recv_mb_.Merge(
+      stats.per_clock_server_push_row_recv_kb, 1. / double(k1_Ki));
 
   bg_accum_num_idle_invoke_.push_back(stats.accum_num_idle_invoke);
   bg_accum_num_idle_send_.push_back(stats.accum_num_idle_send);
@@ -373,27 +402,10 @@ void Stats::DeregisterServerThread() {
   server_accum_push_row_mb_
     += stats.accum_push_row_kb / double(k1_Ki);
 
-  size_t vec_size = stats.per_clock_oplog_recv_kb.size();
-
-  if (server_per_clock_oplog_recv_mb_.size() < vec_size) {
-    server_per_clock_oplog_recv_mb_.resize(vec_size, 0.0);
-  }
-
-  for (int i = 0; i < vec_size; ++i) {
-    server_per_clock_oplog_recv_mb_[i]
-      += stats.per_clock_oplog_recv_kb[i] / double(k1_Ki);
-  }
-
-  vec_size = stats.per_clock_push_row_kb.size();
-
-  if (server_per_clock_push_row_mb_.size() < vec_size) {
-    server_per_clock_push_row_mb_.resize(vec_size, 0.0);
-  }
-
-  for (int i = 0; i < vec_size; ++i) {
-    server_per_clock_push_row_mb_[i]
-      += stats.per_clock_push_row_kb[i] / double(k1_Ki);
-  }
+  server_per_clock_oplog_recv_mb_.Merge(stats.per_clock_oplog_recv_kb,
+                                        1. / double(k1_Ki));
+  server_per_clock_push_row_mb_.Merge(stats.per_clock_push_row_kb,
+                                      1. / double(k1_Ki));
 
   server_accum_num_oplog_msg_recv_.push_back(stats.accum_num_oplog_msg_recv);
   server_accum_num_push_row_msg_send_.push_back(
@@ -451,6 +463,12 @@ void Stats::AppAccumTgClockBegin() {
 void Stats::AppAccumTgClockEnd() {
   AppThreadStats &stats = *app_thread_stats_;
   stats.accum_tg_clock_sec += stats.tg_clock_timer.elapsed();
+
+  std::lock_guard<std::mutex> lock(stats_mtx_);
+  MergeAppThreadStalenessHist();
+  if (app_time_to_first_clock_sec_ == 0) {
+    app_time_to_first_clock_sec_ = startup_timer_.elapsed();
+  }
 }
 
 void Stats::AppSampleSSPGetBegin(int32_t table_id) {
@@ -478,6 +496,8 @@ void Stats::AppSampleSSPGetEnd(int32_t table_id, bool hit) {
       || ((org_num_get - 1) % kGetSampleFreq)) {
     return;
   }
+  Metrics::Record(kMetricGetSec,
+                  stats.table_stats[table_id].get_timer.elapsed());
 
   if (hit) {
     stats.table_stats[table_id].accum_sample_ssp_get_hit_sec
@@ -490,14 +510,62 @@ void Stats::AppSampleSSPGetEnd(int32_t table_id, bool hit) {
   }
 }
 
+void Stats::AppAccumGetStaleness(int32_t table_id, int32_t staleness,
+                                 bool hit) {
+  AppThreadPerTableStats &table_stats
+      = app_thread_stats_->table_stats[table_id];
+  std::vector<uint64_t> &hist = hit ? table_stats.get_staleness_hit_hist
+                                    : table_stats.get_staleness_miss_hist;
+  if (hist.empty())
+    hist.resize(kMaxStalenessBucket + 1, 0);
+
+  if (staleness < 0)
+    staleness = 0;
+  else if (staleness > kMaxStalenessBucket)
+    staleness = kMaxStalenessBucket;
+  ++hist[staleness];
+}
+
+void Stats::MergeAppThreadStalenessHist() {
+  for (auto table_stats_iter = app_thread_stats_->table_stats.begin();
+      table_stats_iter != app_thread_stats_->table_stats.end();
+      table_stats_iter++) {
+    AppThreadPerTableStats &thread_table_stats = table_stats_iter->second;
+    AppThreadPerTableStats &merged_table_stats
+        = table_stats_[table_stats_iter->first];
+
+    std::vector<uint64_t> *thread_hists[2] = {
+      &thread_table_stats.get_staleness_hit_hist,
+      &thread_table_stats.get_staleness_miss_hist };
+    std::vector<uint64_t> *merged_hists[2] = {
+      &merged_table_stats.get_staleness_hit_hist,
+      &merged_table_stats.get_staleness_miss_hist };
+
+    for (int i = 0; i < 2; ++i) {
+      std::vector<uint64_t> &thread_hist = *thread_hists[i];
+      if (thread_hist.empty())
+        continue;
+      std::vector<uint64_t> &merged_hist = *merged_hists[i];
+      if (merged_hist.empty())
+        merged_hist.resize(thread_hist.size(), 0);
+      for (size_t b = 0; b < thread_hist.size(); ++b) {
+        merged_hist[b] += thread_hist[b];
+        thread_hist[b] = 0;
+      }
+    }
+  }
+}
+
 void Stats::AppAccumSSPPushGetCommBlockBegin(int32_t table_id) {
   app_thread_stats_->table_stats[table_id].ssppush_get_comm_block_timer.restart();
 }
 
 void Stats::AppAccumSSPPushGetCommBlockEnd(int32_t table_id) {
   AppThreadStats &stats = *app_thread_stats_;
-  stats.table_stats[table_id].accum_ssppush_get_comm_block_sec
-    += stats.table_stats[table_id].ssppush_get_comm_block_timer.elapsed();
+  double elapsed
+    = stats.table_stats[table_id].ssppush_get_comm_block_timer.elapsed();
+  stats.table_stats[table_id].accum_ssppush_get_comm_block_sec += elapsed;
+  Metrics::Record(kMetricSSPPushGetCommBlockSec, elapsed);
 
   ++(stats.table_stats[table_id].num_ssppush_get_comm_block);
 }
@@ -508,8 +576,10 @@ void Stats::AppAccumSSPGetServerFetchBegin(int32_t table_id) {
 
 void Stats::AppAccumSSPGetServerFetchEnd(int32_t table_id) {
   AppThreadStats &stats = *app_thread_stats_;
-  stats.table_stats[table_id].accum_ssp_get_server_fetch_sec
-    += stats.table_stats[table_id].ssp_get_server_fetch_timer.elapsed();
+  double elapsed
+    = stats.table_stats[table_id].ssp_get_server_fetch_timer.elapsed();
+  stats.table_stats[table_id].accum_ssp_get_server_fetch_sec += elapsed;
+  Metrics::Record(kMetricSSPGetServerFetchSec, elapsed);
 }
 
 void Stats::AppSampleIncBegin(int32_t table_id) {
@@ -621,8 +691,9 @@ void Stats::AppSampleTableClockEnd(int32_t table_id) {
   if (org_num_clock % kClockSampleFreq)
     return;
 
-  stats.table_stats[table_id].accum_sample_clock_sec
-    += stats.table_stats[table_id].clock_timer.elapsed();
+  double elapsed = stats.table_stats[table_id].clock_timer.elapsed();
+  stats.table_stats[table_id].accum_sample_clock_sec += elapsed;
+  Metrics::Record(kMetricTableClockSec, elapsed);
   ++stats.table_stats[table_id].num_clock_sampled;
 }
 
@@ -713,6 +784,26 @@ void Stats::BgAccumClockEndOpLogSerializeEnd() {
   stats.accum_clock_end_oplog_serialize_sec += elapsed;
 }
 
+void Stats::BgHandshakeBegin() {
+  bg_thread_stats_->startup_timer.restart();
+}
+
+void Stats::BgHandshakeEnd() {
+  double elapsed = bg_thread_stats_->startup_timer.elapsed();
+  std::lock_guard<std::mutex> lock(stats_mtx_);
+  bg_handshake_sec_ = std::max(bg_handshake_sec_, elapsed);
+}
+
+void Stats::BgCreateTablesBegin() {
+  bg_thread_stats_->startup_timer.restart();
+}
+
+void Stats::BgCreateTablesEnd() {
+  double elapsed = bg_thread_stats_->startup_timer.elapsed();
+  std::lock_guard<std::mutex> lock(stats_mtx_);
+  bg_create_tables_sec_ = elapsed;
+}
+
 void Stats::BgAccumServerPushRowApplyBegin() {
   bg_thread_stats_->server_push_row_apply_timer.restart();
 }
@@ -772,8 +863,8 @@ void Stats::BgSampleServerPushDeserializeEnd() {
 
 void Stats::BgClock() {
   ++(bg_thread_stats_->clock_num);
-  bg_thread_stats_->per_clock_oplog_sent_kb.push_back(0.0);
-  bg_thread_stats_->per_clock_server_push_row_recv_kb.push_back(0.0);
+  bg_thread_stats_->per_clock_oplog_sent_kb.Clock();
+  bg_thread_stats_->per_clock_server_push_row_recv_kb.Clock();
 }
 
 void Stats::BgAddPerClockOpLogSize(size_t oplog_size) {
@@ -782,8 +873,7 @@ void Stats::BgAddPerClockOpLogSize(size_t oplog_size) {
 
   BgThreadStats &stats = *bg_thread_stats_;
 
-  stats.per_clock_oplog_sent_kb[stats.clock_num]
-    += oplog_size_kb;
+  stats.per_clock_oplog_sent_kb.Add(oplog_size_kb);
   stats.accum_oplog_sent_kb += oplog_size_kb;
 }
 
@@ -793,8 +883,7 @@ void Stats::BgAddPerClockServerPushRowSize(size_t server_push_row_size) {
 
   BgThreadStats &stats = *bg_thread_stats_;
 
-  stats.per_clock_server_push_row_recv_kb[stats.clock_num]
-    += server_push_row_size_kb;
+  stats.per_clock_server_push_row_recv_kb.Add(server_push_row_size_kb);
   stats.accum_server_push_row_recv_kb += server_push_row_size_kb;
 }
 
@@ -865,6 +954,16 @@ void Stats::ServerAccumApplyOpLogEnd() {
     += stats.apply_oplog_timer.elapsed();
 }
 
+void Stats::ServerInitBegin() {
+  server_thread_stats_->startup_timer.restart();
+}
+
+void Stats::ServerInitEnd() {
+  double elapsed = server_thread_stats_->startup_timer.elapsed();
+  std::lock_guard<std::mutex> lock(stats_mtx_);
+  server_init_sec_ = std::max(server_init_sec_, elapsed);
+}
+
 void Stats::ServerAccumPushRowBegin() {
   server_thread_stats_->push_row_timer.restart();
 }
@@ -878,8 +977,8 @@ void Stats::ServerAccumPushRowEnd() {
 
 void Stats::ServerClock() {
   ++server_thread_stats_->clock_num;
-  server_thread_stats_->per_clock_oplog_recv_kb.push_back(0.0);
-  server_thread_stats_->per_clock_push_row_kb.push_back(0.0);
+  server_thread_stats_->per_clock_oplog_recv_kb.Clock();
+  server_thread_stats_->per_clock_push_row_kb.Clock();
 }
 
 void Stats::ServerAddPerClockOpLogSize(size_t oplog_size) {
@@ -888,8 +987,7 @@ void Stats::ServerAddPerClockOpLogSize(size_t oplog_size) {
 
   ServerThreadStats &stats = *server_thread_stats_;
 
-  stats.per_clock_oplog_recv_kb[stats.clock_num]
-    += oplog_size_kb;
+  stats.per_clock_oplog_recv_kb.Add(oplog_size_kb);
   stats.accum_oplog_recv_kb += oplog_size_kb;
 }
 
@@ -899,8 +997,7 @@ void Stats::ServerAddPerClockPushRowSize(size_t push_row_size) {
 
   ServerThreadStats &stats = *server_thread_stats_;
 
-  stats.per_clock_push_row_kb[stats.clock_num]
-    += push_row_size_kb;
+  stats.per_clock_push_row_kb.Add(push_row_size_kb);
   stats.accum_push_row_kb += push_row_size_kb;
 }
 
@@ -1146,9 +1243,29 @@ void Stats::PrintStats() {
       << YAML::Value << table_stats_iter->second.num_thread_get
       << YAML::Key << "accum_sample_thread_get_sec"
       << YAML::Value << table_stats_iter->second.accum_sample_thread_get_sec
-      << YAML::EndMap;
+      << YAML::Key << "get_staleness_hit_hist"
+      << YAML::Value;
+    YamlPrintSequence(&yaml_out,
+                      table_stats_iter->second.get_staleness_hit_hist);
+    yaml_out << YAML::Key << "get_staleness_miss_hist"
+      << YAML::Value;
+    YamlPrintSequence(&yaml_out,
+                      table_stats_iter->second.get_staleness_miss_hist);
+    yaml_out << YAML::EndMap;
   }
 
+  yaml_out << YAML::BeginMap
+    << YAML::Comment("Startup")
+    << YAML::Key << "bg_handshake_sec"
+    << YAML::Value << bg_handshake_sec_
+    << YAML::Key << "bg_create_tables_sec"
+    << YAML::Value << bg_create_tables_sec_
+    << YAML::Key << "server_init_sec"
+    << YAML::Value << server_init_sec_
+    << YAML::Key << "app_time_to_first_clock_sec"
+    << YAML::Value << app_time_to_first_clock_sec_
+    << YAML::EndMap;
+
   yaml_out << YAML::BeginMap
     << YAML::Comment("BgThread Stats")
     << YAML::Key << "bg_accum_clock_end_oplog_serialize_sec"
@@ -1164,11 +1281,15 @@ void Stats::PrintStats() {
 
   yaml_out << YAML::Key << "bg_per_clock_oplog_sent_mb"
     << YAML::Value;
-  YamlPrintSequence(&yaml_out, bg_per_clock_oplog_sent_mb_);
+  YamlPrintSequence(&yaml_out, bg_per_clock_oplog_sent_mb_.get_values());
 
   yaml_out << YAML::Key << "bg_per_clock_server_push_row_recv_mb"
     << YAML::Value;
-  YamlPrintSequence(&yaml_out, bg_per_clock_server_push_row_recv_mb_);
+  YamlPrintSequence(&yaml_out,
+                    bg_per_clock_server_push_row_recv_mb_.get_values());
+
+  yaml_out << YAML::Key << "bg_per_clock_clocks_per_entry"
+    << YAML::Value << bg_per_clock_oplog_sent_mb_.get_clocks_per_entry();
 
   yaml_out << YAML::Key << "bg_accum_server_push_oplog_row_applied"
     << YAML::Value;
@@ -1256,11 +1377,14 @@ void Stats::PrintStats() {
 
   yaml_out << YAML::Key << "server_per_clock_oplog_recv_mb"
     << YAML::Value;
-  YamlPrintSequence(&yaml_out, server_per_clock_oplog_recv_mb_);
+  YamlPrintSequence(&yaml_out, server_per_clock_oplog_recv_mb_.get_values());
 
   yaml_out << YAML::Key << "server_per_clock_push_row_mb"
     << YAML::Value;
-  YamlPrintSequence(&yaml_out, server_per_clock_push_row_mb_);
+  YamlPrintSequence(&yaml_out, server_per_clock_push_row_mb_.get_values());
+
+  yaml_out << YAML::Key << "server_per_clock_clocks_per_entry"
+    << YAML::Value << server_per_clock_oplog_recv_mb_.get_clocks_per_entry();
 
   yaml_out << YAML::Key << "server_accum_num_oplog_msg_recv"
     << YAML::Value;
@@ -1295,4 +1419,14 @@ void Stats::PrintStats() {
   app_defined_vec_of.close();
 }
 
+double Stats::GetBgAccumOpLogSentMb() {
+  std::lock_guard<std::mutex> lock(stats_mtx_);
+  return bg_accum_oplog_sent_mb_;
+}
+
+double Stats::GetBgAccumServerPushRowRecvMb() {
+  std::lock_guard<std::mutex> lock(stats_mtx_);
+  return bg_accum_server_push_row_recv_mb_;
+}
+
 }
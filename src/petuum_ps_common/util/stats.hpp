@@ -65,6 +65,9 @@
 #define STATS_APP_SAMPLE_SSP_GET_END(table_id, hit) \
   Stats::AppSampleSSPGetEnd(table_id, hit)
 
+#define STATS_APP_ACCUM_GET_STALENESS(table_id, staleness, hit) \
+  Stats::AppAccumGetStaleness(table_id, staleness, hit)
+
 #define STATS_APP_ACCUM_SSPPUSH_GET_COMM_BLOCK_BEGIN(table_id) \
   Stats::AppAccumSSPPushGetCommBlockBegin(table_id)
 
@@ -164,6 +167,18 @@
 #define STATS_BG_ACCUM_CLOCK_END_OPLOG_SERIALIZE_END() \
   Stats::BgAccumClockEndOpLogSerializeEnd()
 
+#define STATS_BG_HANDSHAKE_BEGIN() \
+  Stats::BgHandshakeBegin()
+
+#define STATS_BG_HANDSHAKE_END() \
+  Stats::BgHandshakeEnd()
+
+#define STATS_BG_CREATE_TABLES_BEGIN() \
+  Stats::BgCreateTablesBegin()
+
+#define STATS_BG_CREATE_TABLES_END() \
+  Stats::BgCreateTablesEnd()
+
 #define STATS_BG_ACCUM_SERVER_PUSH_ROW_APPLY_BEGIN() \
   Stats::BgAccumServerPushRowApplyBegin()
 
@@ -230,6 +245,12 @@
 #define STATS_BG_APPEND_ONLY_RECYCLE_ROW_OPLOG_INC() \
   Stats::BgAppendOnlyRecycleRowOpLogInc()
 
+#define STATS_SERVER_INIT_BEGIN() \
+  Stats::ServerInitBegin()
+
+#define STATS_SERVER_INIT_END() \
+  Stats::ServerInitEnd()
+
 #define STATS_SERVER_ACCUM_PUSH_ROW_BEGIN() \
   Stats::ServerAccumPushRowBegin()
 
@@ -278,6 +299,7 @@
 #define STATS_APP_ACCUM_TG_CLOCK_END() ((void) 0)
 #define STATS_APP_SAMPLE_SSP_GET_BEGIN(table_id) ((void) 0)
 #define STATS_APP_SAMPLE_SSP_GET_END(table_id, hit) ((void) 0)
+#define STATS_APP_ACCUM_GET_STALENESS(table_id, staleness, hit) ((void) 0)
 
 #define STATS_APP_ACCUM_SSPPUSH_GET_COMM_BLOCK_BEGIN(table_id) \
   ((void) 0)
@@ -321,6 +343,10 @@
 #define STATS_BG_ACCUM_OPLOG_SERIALIZE_END() ((void) 0)
 #define STATS_BG_ACCUM_CLOCK_END_OPLOG_SERIALIZE_BEGIN() ((void) 0)
 #define STATS_BG_ACCUM_CLOCK_END_OPLOG_SERIALIZE_END() ((void) 0)
+#define STATS_BG_HANDSHAKE_BEGIN() ((void) 0)
+#define STATS_BG_HANDSHAKE_END() ((void) 0)
+#define STATS_BG_CREATE_TABLES_BEGIN() ((void) 0)
+#define STATS_BG_CREATE_TABLES_END() ((void) 0)
 #define STATS_BG_ACCUM_SERVER_PUSH_ROW_APPLY_BEGIN() ((void) 0)
 #define STATS_BG_ACCUM_SERVER_PUSH_ROW_APPLY_END() ((void) 0)
 #define STATS_BG_CLOCK() ((void) 0)
@@ -355,6 +381,8 @@
 #define STATS_BG_APPEND_ONLY_CREATE_ROW_OPLOG_INC() ((void) 0)
 #define STATS_BG_APPEND_ONLY_RECYCLE_ROW_OPLOG_INC() ((void) 0)
 
+#define STATS_SERVER_INIT_BEGIN() ((void) 0)
+#define STATS_SERVER_INIT_END() ((void) 0)
 #define STATS_SERVER_ACCUM_PUSH_ROW_BEGIN() ((void) 0)
 #define STATS_SERVER_ACCUM_PUSH_ROW_END() ((void) 0)
 #define STATS_SERVER_ACCUM_APPLY_OPLOG_BEGIN() ((void) 0)
@@ -427,6 +455,14 @@ struct AppThreadPerTableStats {
   uint64_t num_clock_sampled;
   double accum_sample_clock_sec;
 
+  // Histograms of the staleness (thread clock - row clock) of the rows
+  // returned by Get and ThreadGet, indexed by staleness; reads of rows
+  // fresher than the thread count as 0 and the last bucket collects
+  // everything beyond. Split by whether the row was found fresh enough
+  // in process storage.
+  std::vector<uint64_t> get_staleness_hit_hist;
+  std::vector<uint64_t> get_staleness_miss_hist;
+
   AppThreadPerTableStats() :
       num_get(0),
       num_ssp_get_hit(0),
@@ -514,7 +550,51 @@ struct AppThreadStats {
       append_only_flush_oplog_count(0) { }
 };
 
+// Per-clock values in bounded memory. Entry i covers clocks
+// [i * clocks_per_entry, (i + 1) * clocks_per_entry). When a clock would
+// take more than kMaxEntries entries, adjacent entries are merged and
+// clocks_per_entry doubles, so long runs keep their whole history at a
+// coarser resolution.
+class PerClockSeries {
+public:
+  static const size_t kMaxEntries = 4096;
+
+  PerClockSeries():
+      values_(1, 0.0),
+      clocks_per_entry_(1),
+      clock_(0) { }
+
+  void Clock();
+
+  // Adds to the entry of the current clock.
+  void Add(double value) {
+    values_.back() += value;
+  }
+
+  // Adds other * scale entry by entry, first bringing both series to the
+  // coarser resolution of the two.
+  void Merge(const PerClockSeries &other, double scale);
+
+  const std::vector<double> &get_values() const {
+    return values_;
+  }
+
+  uint32_t get_clocks_per_entry() const {
+    return clocks_per_entry_;
+  }
+
+private:
+  // Merges adjacent entries and doubles clocks_per_entry_.
+  void Coarsen();
+
+  std::vector<double> values_;
+  uint32_t clocks_per_entry_;
+  uint32_t clock_;
+};
+
 struct BgThreadStats {
+  HighResolutionTimer startup_timer;
+
   HighResolutionTimer oplog_serialize_timer;
 
   double accum_clock_end_oplog_serialize_sec;
@@ -541,8 +621,8 @@ struct BgThreadStats {
   size_t num_server_push_deserialize;
   size_t num_server_push_deserialize_sampled;
 
-  std::vector<double> per_clock_oplog_sent_kb;
-  std::vector<double> per_clock_server_push_row_recv_kb;
+  PerClockSeries per_clock_oplog_sent_kb;
+  PerClockSeries per_clock_server_push_row_recv_kb;
 
   uint32_t clock_num;
 
@@ -577,8 +657,6 @@ struct BgThreadStats {
     sample_server_push_deserialize_sec(0.0),
     num_server_push_deserialize(0),
     num_server_push_deserialize_sampled(0),
-    per_clock_oplog_sent_kb(1, 0.0),
-    per_clock_server_push_row_recv_kb(1, 0.0),
     clock_num(0),
     accum_num_idle_invoke(0),
     accum_num_idle_send(0),
@@ -591,6 +669,8 @@ struct BgThreadStats {
 };
 
 struct ServerThreadStats {
+  HighResolutionTimer startup_timer;
+
   HighResolutionTimer apply_oplog_timer;
   HighResolutionTimer push_row_timer;
 
@@ -600,8 +680,8 @@ struct ServerThreadStats {
   double accum_oplog_recv_kb;
   double accum_push_row_kb;
 
-  std::vector<double> per_clock_oplog_recv_kb;
-  std::vector<double> per_clock_push_row_kb;
+  PerClockSeries per_clock_oplog_recv_kb;
+  PerClockSeries per_clock_push_row_kb;
 
   uint32_t clock_num;
 
@@ -613,8 +693,6 @@ struct ServerThreadStats {
     accum_push_row_sec(0.0),
     accum_oplog_recv_kb(0.0),
     accum_push_row_kb(0.0),
-    per_clock_oplog_recv_kb(1, 0.0),
-    per_clock_push_row_kb(1, 0.0),
     clock_num(0),
     accum_num_oplog_msg_recv(0),
     accum_num_push_row_msg_send(0) { }
@@ -653,6 +731,9 @@ public:
   static void AppSampleSSPGetBegin(int32_t table_id);
   static void AppSampleSSPGetEnd(int32_t table_id, bool hit);
 
+  static void AppAccumGetStaleness(int32_t table_id, int32_t staleness,
+                                   bool hit);
+
   static void AppAccumSSPPushGetCommBlockBegin(int32_t table_id);
   static void AppAccumSSPPushGetCommBlockEnd(int32_t table_id);
 
@@ -704,6 +785,12 @@ public:
   static void BgAccumClockEndOpLogSerializeBegin();
   static void BgAccumClockEndOpLogSerializeEnd();
 
+  static void BgHandshakeBegin();
+  static void BgHandshakeEnd();
+
+  static void BgCreateTablesBegin();
+  static void BgCreateTablesEnd();
+
   static void BgAccumServerPushRowApplyBegin();
   static void BgAccumServerPushRowApplyEnd();
 
@@ -734,6 +821,9 @@ public:
   static void BgAppendOnlyCreateRowOpLogInc();
   static void BgAppendOnlyRecycleRowOpLogInc();
 
+  static void ServerInitBegin();
+  static void ServerInitEnd();
+
   static void ServerAccumPushRowBegin();
   static void ServerAccumPushRowEnd();
 
@@ -749,12 +839,21 @@ public:
 
   static void PrintStats();
 
+  // Totals over the bg threads that have deregistered, i.e. complete after
+  // PSTableGroup::ShutDown(). Zero unless built with PETUUM_STATS.
+  static double GetBgAccumOpLogSentMb();
+  static double GetBgAccumServerPushRowRecvMb();
+
 private:
 
   static void DeregisterAppThread();
   static void DeregisterBgThread();
   static void DeregisterServerThread();
 
+  // Adds the calling app thread's staleness histograms to table_stats_ and
+  // clears them. Caller must hold stats_mtx_.
+  static void MergeAppThreadStalenessHist();
+
   template<typename T>
   static void YamlPrintSequence(YAML::Emitter *yaml_out,
                                 const std::vector<T> &sequence);
@@ -777,8 +876,13 @@ private:
   // of Get()s.
   static const int32_t kFirstNGetToSkip = 10;
 
+  // Staleness histograms have kMaxStalenessBucket + 1 buckets.
+  static const int32_t kMaxStalenessBucket = 32;
+
   static TableGroupConfig table_group_config_;
   static std::string stats_path_;
+  // Started by Init().
+  static HighResolutionTimer startup_timer_;
   static boost::thread_specific_ptr<ThreadType> thread_type_;
   static boost::thread_specific_ptr<AppThreadStats> app_thread_stats_;
   static boost::thread_specific_ptr<BgThreadStats> bg_thread_stats_;
@@ -824,6 +928,13 @@ private:
   static std::vector<double> app_accum_append_only_flush_oplog_sec_;
   static std::vector<size_t> app_append_only_flush_oplog_count_;
 
+  // Startup phases, wall clock. Handshake and server init are the slowest
+  // thread's; create tables is the head bg's.
+  static double app_time_to_first_clock_sec_;
+  static double bg_handshake_sec_;
+  static double bg_create_tables_sec_;
+  static double server_init_sec_;
+
   // Bg thread stats
   static double bg_accum_clock_end_oplog_serialize_sec_;
   static double bg_accum_total_oplog_serialize_sec_;
@@ -833,8 +944,8 @@ private:
   static double bg_accum_oplog_sent_mb_;
   static double bg_accum_server_push_row_recv_mb_;
 
-  static std::vector<double> bg_per_clock_oplog_sent_mb_;
-  static std::vector<double> bg_per_clock_server_push_row_recv_mb_;
+  static PerClockSeries bg_per_clock_oplog_sent_mb_;
+  static PerClockSeries bg_per_clock_server_push_row_recv_mb_;
 
   static std::vector<size_t> bg_accum_server_push_oplog_row_applied_;
   static std::vector<size_t> bg_accum_server_push_update_applied_;
@@ -868,8 +979,8 @@ private:
   static double server_accum_oplog_recv_mb_;
   static double server_accum_push_row_mb_;
 
-  static std::vector<double> server_per_clock_oplog_recv_mb_;
-  static std::vector<double> server_per_clock_push_row_mb_;
+  static PerClockSeries server_per_clock_oplog_recv_mb_;
+  static PerClockSeries server_per_clock_push_row_mb_;
 
   static std::vector<size_t> server_accum_num_oplog_msg_recv_;
   static std::vector<size_t> server_accum_num_push_row_msg_send_;
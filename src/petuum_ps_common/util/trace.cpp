@@ -0,0 +1,136 @@
+#include <petuum_ps_common/util/trace.hpp>
+#include <glog/logging.h>
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace petuum {
+
+namespace {
+
+const char *kTraceEventNames[kNumTraceEvents] = {
+  "app_get",
+  "app_get_server_fetch",
+  "app_get_comm_block",
+  "app_inc",
+  "app_batch_inc",
+  "app_clock",
+  "bg_create_oplog_msgs",
+  "bg_send_oplog_msgs",
+  "bg_recv_row_reply",
+  "bg_apply_server_push_row",
+  "server_apply_oplog",
+  "server_push_row",
+  "server_reply_row_request"
+};
+
+const char *GetTraceEventCategory(int32_t event) {
+  if (event < kTraceBgCreateOpLogMsgs) {
+    return "app";
+  } else if (event < kTraceServerApplyOpLog) {
+    return "bg";
+  }
+  return "server";
+}
+
+// Microseconds with ns digits. Going through double would lose the ns of
+// wall clock timestamps.
+std::string NsToUs(int64_t ns) {
+  char buf[32];
+  snprintf(buf, sizeof(buf), "%lld.%03lld",
+           static_cast<long long>(ns / 1000),
+           static_cast<long long>(ns % 1000));
+  return buf;
+}
+
+}  // anonymous namespace
+
+bool Trace::enabled_ = false;
+std::string Trace::path_;
+size_t Trace::buffer_size_ = 0;
+int32_t Trace::client_id_ = 0;
+int64_t Trace::wall_offset_ns_ = 0;
+boost::thread_specific_ptr<ThreadTrace> Trace::thread_trace_(
+    &Trace::NoCleanup);
+std::mutex Trace::mtx_;
+std::vector<std::unique_ptr<ThreadTrace> > Trace::all_thread_traces_;
+
+void Trace::Init(const TableGroupConfig &table_group_config) {
+  if (table_group_config.trace_path.empty()) {
+    return;
+  }
+  CHECK_GT(table_group_config.trace_buffer_size, 0);
+  std::stringstream path_ss;
+  path_ss << table_group_config.trace_path << "."
+          << table_group_config.client_id << ".json";
+  path_ = path_ss.str();
+  buffer_size_ = table_group_config.trace_buffer_size;
+  client_id_ = table_group_config.client_id;
+  wall_offset_ns_ = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::system_clock::now().time_since_epoch()).count() - NowNs();
+  enabled_ = true;
+}
+
+ThreadTrace *Trace::CreateThreadTrace(const char *name) {
+  ThreadTrace *thread_trace = new ThreadTrace(name, buffer_size_);
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    all_thread_traces_.emplace_back(thread_trace);
+  }
+  thread_trace_.reset(thread_trace);
+  return thread_trace;
+}
+
+void Trace::Dump() {
+  if (!enabled_) {
+    return;
+  }
+  enabled_ = false;
+
+  std::lock_guard<std::mutex> lock(mtx_);
+  std::ofstream out(path_, std::ios_base::out | std::ios_base::trunc);
+  CHECK(out) << "Cannot open " << path_;
+  out << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n";
+  out << "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": " << client_id_
+      << ", \"args\": {\"name\": \"client " << client_id_ << "\"}}";
+  uint64_t num_dropped = 0;
+  for (size_t tid = 0; tid < all_thread_traces_.size(); ++tid) {
+    const ThreadTrace &thread_trace = *all_thread_traces_[tid];
+    out << ",\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": "
+        << client_id_ << ", \"tid\": " << tid << ", \"args\": {\"name\": \""
+        << thread_trace.name << " " << tid << "\"}}";
+
+    // Oldest surviving record first.
+    size_t capacity = thread_trace.records.size();
+    uint64_t num_kept = std::min<uint64_t>(thread_trace.num_recorded,
+                                           capacity);
+    num_dropped += thread_trace.num_recorded - num_kept;
+    for (uint64_t i = thread_trace.num_recorded - num_kept;
+         i < thread_trace.num_recorded; ++i) {
+      const TraceRecord &record = thread_trace.records[i % capacity];
+      out << ",\n{\"name\": \"" << kTraceEventNames[record.event]
+          << "\", \"cat\": \"" << GetTraceEventCategory(record.event)
+          << "\", \"ph\": \"X\", \"pid\": " << client_id_
+          << ", \"tid\": " << tid
+          << ", \"ts\": " << NsToUs(record.begin_ns + wall_offset_ns_)
+          << ", \"dur\": " << NsToUs(record.dur_ns)
+          << ", \"args\": {\"clock\": " << record.clock;
+      if (record.table_id >= 0) {
+        out << ", \"table\": " << record.table_id;
+      }
+      if (record.row_id >= 0) {
+        out << ", \"row\": " << record.row_id;
+      }
+      if (record.bytes > 0) {
+        out << ", \"bytes\": " << record.bytes;
+      }
+      out << "}}";
+    }
+  }
+  out << "\n]}\n";
+  LOG(INFO) << "Trace written to " << path_ << ", " << num_dropped
+            << " events overwritten";
+}
+
+}   // namespace petuum
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <petuum_ps_common/include/configs.hpp>
+#include <boost/thread/tss.hpp>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace petuum {
+
+enum TraceEvent {
+  // app threads
+  kTraceAppGet = 0,
+  kTraceAppGetServerFetch,
+  kTraceAppGetCommBlock,
+  kTraceAppInc,
+  kTraceAppBatchInc,
+  kTraceAppClock,
+  // bg threads
+  kTraceBgCreateOpLogMsgs,
+  kTraceBgSendOpLogMsgs,
+  kTraceBgRecvRowReply,
+  kTraceBgApplyServerPushRow,
+  // server threads
+  kTraceServerApplyOpLog,
+  kTraceServerPushRow,
+  kTraceServerReplyRowRequest,
+  kNumTraceEvents
+};
+
+struct TraceRecord {
+  int64_t begin_ns;
+  int64_t dur_ns;
+  int32_t event;
+  int32_t clock;
+  int32_t table_id;
+  int32_t row_id;
+  uint64_t bytes;
+};
+
+// Ring buffer of one thread's last events. Only the owning thread writes.
+struct ThreadTrace {
+  ThreadTrace(const std::string &name, size_t capacity):
+      name(name),
+      records(capacity),
+      num_recorded(0),
+      clock(0) { }
+
+  std::string name;
+  std::vector<TraceRecord> records;
+  uint64_t num_recorded;
+  int32_t clock;
+};
+
+// Optional timeline of PS thread activity. When disabled (trace_path empty)
+// each instrumentation point costs one predictable branch. When enabled an
+// event is two clock reads and a store into the thread's ring buffer, no
+// locking or allocation.
+//
+// Dump() must be called after all traced threads have stopped; TableGroup
+// does so on destruction. The output loads in chrome://tracing or Perfetto,
+// with pid = client id and one track per thread.
+class Trace {
+public:
+  static void Init(const TableGroupConfig &table_group_config);
+
+  // Write <trace_path>.<client_id>.json and disable tracing.
+  static void Dump();
+
+  static bool enabled() {
+    return enabled_;
+  }
+
+  static int64_t NowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  // Names the calling thread's track ("app", "bg", "server"). Threads that
+  // record without registering get a track named "thread".
+  static void RegisterThread(const char *name) {
+    if (enabled_ && thread_trace_.get() == 0) {
+      CreateThreadTrace(name);
+    }
+  }
+
+  // Clock attached to the calling thread's subsequent events.
+  static void SetClock(int32_t clock) {
+    if (enabled_) {
+      GetThreadTrace()->clock = clock;
+    }
+  }
+
+  static void Record(TraceEvent event, int64_t begin_ns, int64_t end_ns,
+                     int32_t table_id, int32_t row_id, uint64_t bytes) {
+    ThreadTrace *thread_trace = GetThreadTrace();
+    TraceRecord &record = thread_trace->records[
+        thread_trace->num_recorded++ % thread_trace->records.size()];
+    record.begin_ns = begin_ns;
+    record.dur_ns = end_ns - begin_ns;
+    record.event = event;
+    record.clock = thread_trace->clock;
+    record.table_id = table_id;
+    record.row_id = row_id;
+    record.bytes = bytes;
+  }
+
+private:
+  static ThreadTrace *GetThreadTrace() {
+    ThreadTrace *thread_trace = thread_trace_.get();
+    if (thread_trace == 0) {
+      thread_trace = CreateThreadTrace("thread");
+    }
+    return thread_trace;
+  }
+
+  static ThreadTrace *CreateThreadTrace(const char *name);
+  static void NoCleanup(ThreadTrace *thread_trace) { }
+
+  static bool enabled_;
+  static std::string path_;
+  static size_t buffer_size_;
+  static int32_t client_id_;
+  // Added to steady clock ns to get wall clock ns, so traces of different
+  // clients line up.
+  static int64_t wall_offset_ns_;
+
+  static boost::thread_specific_ptr<ThreadTrace> thread_trace_;
+  static std::mutex mtx_;
+  static std::vector<std::unique_ptr<ThreadTrace> > all_thread_traces_;
+};
+
+// Records the enclosing scope as one event.
+class TraceScope {
+public:
+  TraceScope(TraceEvent event, int32_t table_id = -1, int32_t row_id = -1,
+             uint64_t bytes = 0):
+      begin_ns_(Trace::enabled() ? Trace::NowNs() : -1),
+      event_(event),
+      table_id_(table_id),
+      row_id_(row_id),
+      bytes_(bytes) { }
+
+  ~TraceScope() {
+    if (begin_ns_ >= 0) {
+      Trace::Record(event_, begin_ns_, Trace::NowNs(), table_id_, row_id_,
+                    bytes_);
+    }
+  }
+
+  bool enabled() const {
+    return begin_ns_ >= 0;
+  }
+
+  // For sizes only known later, or not worth computing when disabled.
+  void set_bytes(uint64_t bytes) {
+    bytes_ = bytes;
+  }
+
+private:
+  const int64_t begin_ns_;
+  const TraceEvent event_;
+  const int32_t table_id_;
+  const int32_t row_id_;
+  uint64_t bytes_;
+};
+
+}   // namespace petuum
@@ -3,6 +3,7 @@
 #include <petuum_ps_sn/client/client_table.hpp>
 #include <petuum_ps_common/util/class_register.hpp>
 #include <petuum_ps_common/util/stats.hpp>
+#include <petuum_ps_common/util/metrics.hpp>
 #include <petuum_ps_sn/consistency/local_consistency_controller.hpp>
 #include <petuum_ps_sn/consistency/local_ooc_consistency_controller.hpp>
 #include <petuum_ps_sn/thread/context.hpp>
@@ -74,6 +75,7 @@ void ClientTableSN::Get(int32_t row_id, RowAccessor *row_accessor) {
 void ClientTableSN::Inc(int32_t row_id, int32_t column_id, const void *update) {
   STATS_APP_SAMPLE_INC_BEGIN(table_id_);
   consistency_controller_->Inc(row_id, column_id, update);
+  Metrics::Add(kMetricAppInc);
   STATS_APP_SAMPLE_INC_END(table_id_);
 }
 
@@ -82,6 +84,7 @@ void ClientTableSN::BatchInc(int32_t row_id, const int32_t* column_ids,
   STATS_APP_SAMPLE_BATCH_INC_BEGIN(table_id_);
   consistency_controller_->BatchInc(row_id, column_ids, updates,
                                     num_updates);
+  Metrics::Add(kMetricAppBatchInc);
   STATS_APP_SAMPLE_BATCH_INC_END(table_id_);
 }
 
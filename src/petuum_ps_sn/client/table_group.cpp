@@ -1,6 +1,7 @@
 #include <petuum_ps_sn/client/table_group.hpp>
 #include <petuum_ps_sn/thread/context.hpp>
 #include <petuum_ps_common/util/stats.hpp>
+#include <petuum_ps_common/util/metrics.hpp>
 
 #include <petuum_ps_sn/client/client_table.hpp>
 #include <sstream>
@@ -21,6 +22,7 @@ TableGroupSN::TableGroupSN(const TableGroupConfig &table_group_config,
   num_app_threads_registered_ = 1;  // init thread is the first one
 
   STATS_INIT(table_group_config);
+  Metrics::Init(table_group_config);
   VLOG(0) << "Calling STATS_REGISTER_THREAD";
   STATS_REGISTER_THREAD(kAppThread);
 
@@ -56,6 +58,7 @@ TableGroupSN::~TableGroupSN() {
   for(auto iter = tables_.begin(); iter != tables_.end(); iter++){
     delete iter->second;
   }
+  Metrics::ShutDown();
   STATS_DEREGISTER_THREAD();
   STATS_PRINT();
 }
@@ -124,6 +127,7 @@ void TableGroupSN::Clock() {
     GlobalContextSN::clock_cond_var_.notify_all();
   }
 
+  Metrics::Add(kMetricAppClock);
   STATS_APP_ACCUM_TG_CLOCK_END();
 }
 
@@ -3,6 +3,7 @@
 #include <petuum_ps_common/storage/process_storage.hpp>
 #include <petuum_ps_sn/thread/context.hpp>
 #include <petuum_ps_common/util/stats.hpp>
+#include <petuum_ps_common/util/metrics.hpp>
 #include <petuum_ps_common/util/class_register.hpp>
 #include <glog/logging.h>
 #include <algorithm>
@@ -80,11 +81,14 @@ void LocalConsistencyController::Get(int32_t row_id, RowAccessor* row_accessor)
 
   bool found = process_storage_.Find(row_id, row_accessor);
   if (found) {
+    Metrics::Add(kMetricAppGet);
     STATS_APP_SAMPLE_SSP_GET_END(table_id_, true);
     return;
   }
 
   CreateInsertRow(row_id, row_accessor);
+  Metrics::Add(kMetricAppGet);
+  Metrics::Add(kMetricAppGetMiss);
   STATS_APP_SAMPLE_SSP_GET_END(table_id_, false);
 }
 
@@ -118,6 +122,7 @@ void LocalConsistencyController::ThreadGet(int32_t row_id,
   AbstractRow *row_data = thread_cache_->GetRow(row_id);
   if (row_data != 0) {
     row_accessor->row_data_ptr_ = row_data;
+    Metrics::Add(kMetricAppThreadGet);
     STATS_APP_SAMPLE_THREAD_GET_END(table_id_);
     return;
   }
@@ -132,6 +137,7 @@ void LocalConsistencyController::ThreadGet(int32_t row_id,
   AbstractRow *tmp_row_data = process_row_accessor.GetRowData();
   thread_cache_->InsertRow(row_id, tmp_row_data);
   row_accessor->row_data_ptr_ = tmp_row_data;
+  Metrics::Add(kMetricAppThreadGet);
   STATS_APP_SAMPLE_THREAD_GET_END(table_id_);
 }
 
@@ -26,6 +26,9 @@ DEFINE_string(logfile, "", "log file to write ll value per iteration");
 DEFINE_double(lambda, 0.0, "lambda for regularization");
 DEFINE_string(wfile_pre, "", "w matrix save file prefix ");
 DEFINE_string(hfile_pre, "", "h matrix save file prefix");
+DEFINE_double(sched_fraction, 0.0, "Fraction of my rows/cols sampled by priority per W/H update. 0 keeps static bucketing");
+DEFINE_double(sched_eta, 1e-6, "Minimum priority of a parameter in the dependency aware scheduler");
+DEFINE_int64(sched_maxoverlap, -1, "Max features two co-scheduled parameters may share. -1 disables the dependency check");
 
 int main(int argc, char **argv){
 
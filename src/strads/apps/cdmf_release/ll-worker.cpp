@@ -28,6 +28,9 @@ DECLARE_string(logfile);
 DECLARE_double(lambda);
 DECLARE_string(wfile_pre);
 DECLARE_string(hfile_pre);
+DECLARE_double(sched_fraction);
+DECLARE_double(sched_eta);
+DECLARE_int64(sched_maxoverlap);
 
 void collect_partmatrix_ring(sharedctx *ctx, vector<vector<double>>&partialMat, const map<int,bool>&mybucket, int maxcnt, int rank);
 void circulate_pmatrix_ring(sharedctx *ctx, vector<vector<double>>&partialMat, const map<int,bool>&mybucket, int maxrow, int rank, vector<vector<double>>&recvfullmat, int whmatflag);
@@ -179,36 +182,30 @@ void *worker_mach(void *arg){
 	     ctx->rank, rowmap.size(), colmap.size()); 
 
   string alias("NA");
-  dshardctx *pshard = new dshardctx(FLAGS_data_file, alias, rm_map, rowcnt, colcnt);  
-  udshard<rowmajor_map> *rowA = new udshard<rowmajor_map>(pshard); 
+  dshardctx *pshard = new dshardctx(FLAGS_data_file, alias, rm_vec, rowcnt, colcnt);  
+  udshard<cdmf_rowmat> *rowA = new udshard<cdmf_rowmat>(pshard); 
   rowA->matrix.resize(rowcnt, colcnt);
-  rowA->matrix.setvector(rowcnt); // row major vector of map : memory consumption is high 
+  rowA->matrix.setvector(rowcnt); // CSR : nonzeros are staged and compressed at the end of the load 
 
   delete pshard;
-  pshard = new dshardctx(FLAGS_data_file, alias, cm_map, rowcnt, colcnt);  
-  udshard<colmajor_map> *colA = new udshard<colmajor_map>(pshard); 
+  pshard = new dshardctx(FLAGS_data_file, alias, cm_vec, rowcnt, colcnt);  
+  udshard<cdmf_colmat> *colA = new udshard<cdmf_colmat>(pshard); 
   colA->matrix.resize(rowcnt, colcnt); 
-  colA->matrix.setvector(colcnt); // col major vector of map : memory consumption is high  
+  colA->matrix.setvector(colcnt); // CSC 
   delete pshard;
 
   LOG(INFO) << "[worker " << ctx->rank << "] Load input file " << endl;
 
-  mmio_partial_read<rowmajor_map>(ctx->rank, rowA->matrix, rowmap, FLAGS_data_file); // matrix market format partial read  
+  mmio_partial_read<cdmf_rowmat>(ctx->rank, rowA->matrix, rowmap, FLAGS_data_file); // matrix market format partial read  
   strads_msg(ERR, "[worker %d] @@ Create Res RowMajorA  allocated Entry: %ld \n", ctx->rank, rowA->matrix.allocatedentry());
-  mmio_partial_read<colmajor_map>(ctx->rank, colA->matrix, colmap, FLAGS_data_file); // matrix market format partial read
+  mmio_partial_read<cdmf_colmat>(ctx->rank, colA->matrix, colmap, FLAGS_data_file); // matrix market format partial read
   strads_msg(ERR, "[worker %d] @@ Create Res ColMajorA  allocated Entry: %ld \n", ctx->rank, colA->matrix.allocatedentry());
 
-  // make distributed data structures correspond to row majro A and col major A  
-  pshard = new dshardctx(FLAGS_data_file, alias, rm_map, rowcnt, colcnt);  
-  udshard<rowmajor_map> *rowRes = new udshard<rowmajor_map>(pshard); 
-  rowRes->matrix.resize(rowcnt, colcnt);
-  rowRes->matrix.setvector(rowcnt); // row major vector of map : memory consumption is high, no memory allocation yet   
-  delete pshard;
-  pshard = new dshardctx(FLAGS_data_file, alias, cm_map, rowcnt, colcnt);  
-  udshard<colmajor_map> *colRes = new udshard<colmajor_map>(pshard); 
-  colRes->matrix.resize(rowcnt, colcnt); 
-  colRes->matrix.setvector(colcnt); // col major vector of map : memory consumption is high, no memory allocation yet
-  delete pshard;
+  // residual has exactly the nonzero pattern of A : keep it next to A in the same shard 
+  rowA->matrix.alloc_residual();
+  colA->matrix.alloc_residual();
+  udshard<cdmf_rowmat> *rowRes = rowA;
+  udshard<cdmf_colmat> *colRes = colA;
 
   vector<vector<double>>partialW;
   init_partialmatrix(partialW, rowmap, rowcnt, FLAGS_num_rank); // assign memory space to hold partial H -- one H partition  
@@ -227,6 +224,17 @@ void *worker_mach(void *arg){
                                 // don't rely on the fact that all workers receive N packets. 
                                 // ending point should be the point that all workers exit the ring of initial H circulation.
 
+  depscheduler *wsched = NULL; // W row i depends on others through the columns of row i of A 
+  depscheduler *hsched = NULL; // H row j depends on others through the rows of column j of A
+  if(FLAGS_sched_fraction > 0){
+    wsched = new depscheduler(rowcnt, colcnt, FLAGS_sched_eta, FLAGS_sched_maxoverlap, ctx->rank);
+    wsched->load_features(*rowA);
+    hsched = new depscheduler(colcnt, rowcnt, FLAGS_sched_eta, FLAGS_sched_maxoverlap, ctx->rank);
+    hsched->load_features(*colA);
+    strads_msg(ERR, "[worker %d] dependency aware scheduler on, fraction(%lf) maxoverlap(%ld)\n", 
+	       ctx->rank, FLAGS_sched_fraction, (long)FLAGS_sched_maxoverlap);
+  }
+
   vector<vector<double>>fulltmpH; // no memory allocation yet
   vector<vector<double>>fulltmpW; // no memory allocation yet 
 
@@ -238,7 +246,7 @@ void *worker_mach(void *arg){
     long wnend = timenow();
     // update My partial W with Full-H
     long wcstart = timenow();
-    double wobj = update_w(ctx, *rowA, *rowRes, fulltmpH, partialW,rowmap, rowcnt, FLAGS_num_rank, colmap, colcnt, childs);
+    double wobj = update_w(ctx, *rowA, *rowRes, fulltmpH, partialW,rowmap, rowcnt, FLAGS_num_rank, colmap, colcnt, childs, wsched);
     long wcend = timenow();
     drop_tmpfullmat(fulltmpH, colcnt, FLAGS_num_rank); // drop memory of full H
     strads_msg(ERR, "[worker %d] iter[%d] FINISH W UPDATE taking %lf sec  %lf sec Partial objective: %lf \n",
@@ -249,7 +257,7 @@ void *worker_mach(void *arg){
     circulate_pmatrix_ring(ctx, partialW, rowmap, rowcnt, FLAGS_num_rank, fulltmpW, WMAT);// send partial H and recv temp Full W
     long hnend = timenow();
     long hcstart = timenow();
-    double hobj = update_h(ctx, *colA, *colRes, fulltmpW, partialH, colmap, colcnt, FLAGS_num_rank, rowmap, rowcnt, childs); 
+    double hobj = update_h(ctx, *colA, *colRes, fulltmpW, partialH, colmap, colcnt, FLAGS_num_rank, rowmap, rowcnt, childs, hsched); 
     // update My partial H with Full-W
     long hcend = timenow();
     drop_tmpfullmat(fulltmpW, rowcnt, FLAGS_num_rank); // drop memory of full W
@@ -261,6 +269,8 @@ void *worker_mach(void *arg){
   save_h(partialH, colmap, mycols, FLAGS_hfile_pre, ctx->rank); 
   strads_msg(ERR, "[worker %d] leave the ring: myrowcnt: %ld  mycolcnt: %ld  \n", 
 	     ctx->rank, myrows, mycols);
+  delete wsched;
+  delete hsched;
   LOG(INFO) << "[worker " << ctx->rank << "] finish" << endl;
   return NULL;
 }
@@ -9,6 +9,7 @@
 #include <gflags/gflags.h>
 #include <mpi.h>
 #include <assert.h>
+#include <math.h>
 #include "ccdmf.pb.hpp"
 #include "lccdmf.hpp"
 #include <mutex>
@@ -16,6 +17,8 @@
 #include <strads/ds/dshard.hpp>
 #include <strads/ds/spmat.hpp>
 #include <strads/ds/iohandler.hpp>
+#include <strads/include/dep-scheduler.hpp>
+#include "train.hpp"
 
 using namespace std;
 using namespace strads_sysmsg;
@@ -26,12 +29,13 @@ DECLARE_int32(num_rank);
 DECLARE_int32(threads);  // different meaning from multi thread one 
 DECLARE_string(logfile);
 DECLARE_double(lambda);
+DECLARE_double(sched_fraction);
 
 typedef struct{ 
-  udshard<rowmajor_map> *rowA;
-  udshard<rowmajor_map> *rowRes;
-  udshard<colmajor_map> *colA;
-  udshard<colmajor_map> *colRes;
+  udshard<cdmf_rowmat> *rowA;
+  udshard<cdmf_rowmat> *rowRes;
+  udshard<cdmf_colmat> *colA;
+  udshard<cdmf_colmat> *colRes;
   vector<vector<double>>*fulltmpH;
   vector<vector<double>>*partialW; 
   vector<int>*mybucket;
@@ -40,29 +44,31 @@ typedef struct{
   int type;
   int t; // current rank of matrix 0 ~ K-1 
   double sum;
+  vector<double>*change; // if not NULL, sum of |new - old| per row for the scheduler 
 
 }ucommand;
 
-double get_object_h(sharedctx *ctx, udshard<colmajor_map> &rowA, vector<vector<double>>&partialM,
+double get_object_h(sharedctx *ctx, udshard<cdmf_colmat> &rowA, vector<vector<double>>&partialM,
 		  map<int, bool>&fullmattaskmap, int maxcnt, double lambda, 
 		    vector<vector<double>>&fullM, map<int, bool>&fullmattakmap, int colcnt, int rank, child_thread **childs);
 
-double update_1param_h(int rowidx, int t, udshard<colmajor_map> &rowA, 
+double update_1param_h(int rowidx, int t, udshard<cdmf_colmat> &rowA, 
 		     double Wit, vector<vector<double>>&H, 
-		       udshard<colmajor_map> &rowRes, double lambda, double old_wvalue);
+		       udshard<cdmf_colmat> &rowRes, double lambda, double old_wvalue);
 
-void update_parameters_h_mt(sharedctx *ctx, udshard<colmajor_map> &rowA, udshard<colmajor_map> &rowRes, 
+void update_parameters_h_mt(sharedctx *ctx, udshard<cdmf_colmat> &rowA, udshard<cdmf_colmat> &rowRes, 
 			    vector<vector<double>>&fulltmpH, vector<vector<double>>&partialW, 
-			    map<int, bool>&mybucket, int maxcnt, int rank, child_thread **childs);
+			    map<int, bool>&mybucket, int maxcnt, int rank, child_thread **childs, depscheduler *sched);
 
-void set_arg_w(ucommand *tmp, udshard<rowmajor_map> &rowA, udshard<rowmajor_map> &rowRes, 
+void set_arg_w(ucommand *tmp, udshard<cdmf_rowmat> &rowA, udshard<cdmf_rowmat> &rowRes, 
 	     vector<vector<double>>&fulltmpH, vector<vector<double>>&partialW, 
 	       vector<int>&mybucket, int rank, int calctype);
 
-void balanced_wupdate(int mid, udshard<rowmajor_map> &rowA, map<int, bool>&mybucket, vector<vector<int>>&thbuckets);
+void balanced_wupdate(int mid, udshard<cdmf_rowmat> &rowA, map<int, bool>&mybucket, vector<vector<int>>&thbuckets);
 void plainassign_wupdate(map<int, bool>&mybucket, vector<vector<int>>&thbuckets);
+long scheduled_update(depscheduler *sched, map<int, bool>&mybucket, vector<vector<int>>&thbuckets);
 
-void restore_residual_h_mt(sharedctx *ctx, udshard<colmajor_map> &rowA, udshard<colmajor_map> &rowRes, 
+void restore_residual_h_mt(sharedctx *ctx, udshard<cdmf_colmat> &rowA, udshard<cdmf_colmat> &rowRes, 
 			vector<vector<double>>&fulltmpH, vector<vector<double>>&partialW, 
 			   map<int, bool>&mybucket, int maxcnt, int rank, child_thread **childs);
 
@@ -122,7 +128,7 @@ double get_frobenius(vector<vector<double>>&partialW, int rank, map<int, bool>&t
 }
 
 // w update method 
-double get_object_w(sharedctx *ctx, udshard<rowmajor_map> &rowA, vector<vector<double>>&partialM,
+double get_object_w(sharedctx *ctx, udshard<cdmf_rowmat> &rowA, vector<vector<double>>&partialM,
 		    map<int, bool>&partmattaskmap, int maxcnt, double lambda, 
 		    vector<vector<double>>&fullM, map<int, bool>&fullmattakmap, int colcnt, int rank, child_thread **childs){
 
@@ -174,27 +180,28 @@ double get_object_w(sharedctx *ctx, udshard<rowmajor_map> &rowA, vector<vector<d
 }
 
 // w update method: TODO : Multi threading by rows of W, restore residual matrix from A and current W and H matrix  
-void restore_residual_w_st(sharedctx *ctx, udshard<rowmajor_map> &rowA, udshard<rowmajor_map> &rowRes, 
+void restore_residual_w_st(sharedctx *ctx, udshard<cdmf_rowmat> &rowA, udshard<cdmf_rowmat> &rowRes, 
 			vector<vector<double>>&fulltmpH, vector<vector<double>>&partialW, 
 			map<int, bool>&mybucket, int maxcnt, int rank){
   double newtmp=0;
   uint64_t tmpj;
   for(auto p = mybucket.begin(); p != mybucket.end(); p ++){
     int rowidx = p->first;
-    for(auto  p : rowA.matrix.row(rowidx)){
-      tmpj = p.first;  // tmpj : N range                                                             
+    double *res = rowRes.matrix.res_array();
+    for(uint64_t k = rowA.matrix.nnz_begin(rowidx); k < rowA.matrix.nnz_end(rowidx); k++){
+      tmpj = rowA.matrix.minor(k);  // tmpj : N range                                                             
       newtmp = 0;
       for(long t=0; t < rank; t++){
         newtmp += (partialW[rowidx][t]*fulltmpH[tmpj][t]); // Tr(H)                                                                 
       }
-      rowRes.matrix(rowidx, tmpj) = p.second - newtmp;
+      res[k] = rowA.matrix.value(k) - newtmp;
     }
   }
 }
 
 
 // w update method: TODO : Multi threading by rows of W, restore residual matrix from A and current W and H matrix  
-void restore_residual_w_mt(sharedctx *ctx, udshard<rowmajor_map> &rowA, udshard<rowmajor_map> &rowRes, 
+void restore_residual_w_mt(sharedctx *ctx, udshard<cdmf_rowmat> &rowA, udshard<cdmf_rowmat> &rowRes, 
 			vector<vector<double>>&fulltmpH, vector<vector<double>>&partialW, 
 			   map<int, bool>&mybucket, int maxcnt, int rank, child_thread **childs){
   vector<vector<int>>thbuckets(FLAGS_threads);
@@ -235,25 +242,26 @@ void restore_residual_w_mt(sharedctx *ctx, udshard<rowmajor_map> &rowA, udshard<
 }
 
 // w update method : unit operation 
-double update_1param_w(int rowidx, int t, udshard<rowmajor_map> &rowA, 
+double update_1param_w(int rowidx, int t, udshard<cdmf_rowmat> &rowA, 
 		     double Wit, vector<vector<double>>&H, 
-		     udshard<rowmajor_map> &rowRes, double lambda, double old_wvalue){
+		     udshard<cdmf_rowmat> &rowRes, double lambda, double old_wvalue){
   double new_wvalue=0, sum_m=0, sum_c=0;
-  for (auto p : rowRes.matrix.row(rowidx)) {
-    int tmpj = p.first;  // tmpj: n range  
-    sum_c += (rowRes.matrix.get(rowidx, tmpj) + Wit*H[tmpj][t])*H[tmpj][t];                           
-    sum_m += H[tmpj][t]*H[tmpj][t];                                                            
+  const uint64_t begin = rowA.matrix.nnz_begin(rowidx), end = rowA.matrix.nnz_end(rowidx);
+  const uint32_t *idx = rowA.matrix.idx_array();
+  double *res = rowRes.matrix.res_array(); // residual shares the nonzero layout of A 
+  for (uint64_t k = begin; k < end; k++) {
+    double hjt = H[idx[k]][t];  // idx[k]: n range  
+    sum_c += (res[k] + Wit*hjt)*hjt;                           
+    sum_m += hjt*hjt;                                                            
   }
   new_wvalue = sum_c/(sum_m + lambda);    
-  //  for(auto p : rowA.matrix.row(rowidx)){
-  for(auto p : rowRes.matrix.row(rowidx)){
-    int tmpj = p.first; // tmpj : N range                                                                        
-    rowRes.matrix(rowidx, tmpj) = rowRes.matrix.get(rowidx, tmpj) - H[tmpj][t]*(new_wvalue-old_wvalue);         
+  for(uint64_t k = begin; k < end; k++){
+    res[k] -= H[idx[k]][t]*(new_wvalue-old_wvalue);         
   }
   return new_wvalue;
 }
 
-void set_arg_w(ucommand *tmp, udshard<rowmajor_map> &rowA, udshard<rowmajor_map> &rowRes, 
+void set_arg_w(ucommand *tmp, udshard<cdmf_rowmat> &rowA, udshard<cdmf_rowmat> &rowRes, 
 	     vector<vector<double>>&fulltmpH, vector<vector<double>>&partialW, 
 	       vector<int>&mybucket, int rank, int calctype){
   tmp->mybucket = &mybucket;
@@ -270,7 +278,7 @@ void set_arg_w(ucommand *tmp, udshard<rowmajor_map> &rowA, udshard<rowmajor_map>
 
 }
 
-void set_arg_h(ucommand *tmp, udshard<colmajor_map> &rowA, udshard<colmajor_map> &rowRes, 
+void set_arg_h(ucommand *tmp, udshard<cdmf_colmat> &rowA, udshard<cdmf_colmat> &rowRes, 
 	       vector<vector<double>>&fulltmpH, vector<vector<double>>&partialW, 
 	       vector<int>&mybucket, int rank, int t, int calctype){
 
@@ -288,7 +296,7 @@ void set_arg_h(ucommand *tmp, udshard<colmajor_map> &rowA, udshard<colmajor_map>
 }
 
 
-void balanced_wupdate(int mid, udshard<rowmajor_map> &rowA, map<int, bool>&mybucket, vector<vector<int>>&thbuckets){
+void balanced_wupdate(int mid, udshard<cdmf_rowmat> &rowA, map<int, bool>&mybucket, vector<vector<int>>&thbuckets){
   //  int minidx;
   vector<long>workload(FLAGS_threads, 0);
   for(auto p = mybucket.begin(); p != mybucket.end(); p ++){
@@ -303,7 +311,7 @@ void balanced_wupdate(int mid, udshard<rowmajor_map> &rowA, map<int, bool>&mybuc
     }   
     assert(minidx >= 0 and minidx <= (FLAGS_threads-1));
     thbuckets[minidx].push_back(rowidx);
-    workload[minidx] += rowA.matrix.row(rowidx).size();
+    workload[minidx] += rowA.matrix.nnz(rowidx);
   }
 }
 
@@ -317,16 +325,36 @@ void plainassign_wupdate(map<int, bool>&mybucket, vector<vector<int>>&thbuckets)
   }
 }
 
-void update_parameters_w_mt(sharedctx *ctx, udshard<rowmajor_map> &rowA, udshard<rowmajor_map> &rowRes, 
+// sample prioritized, non conflicting params from my bucket and spread them over child threads
+long scheduled_update(depscheduler *sched, map<int, bool>&mybucket, vector<vector<int>>&thbuckets){
+  vector<int> candidates;
+  candidates.reserve(mybucket.size());
+  for(auto p = mybucket.begin(); p != mybucket.end(); p ++){
+    candidates.push_back(p->first);
+  }
+  long nsamples = (long)ceil(FLAGS_sched_fraction * candidates.size());
+  return sched->schedule(candidates, nsamples, thbuckets);
+}
+
+void update_parameters_w_mt(sharedctx *ctx, udshard<cdmf_rowmat> &rowA, udshard<cdmf_rowmat> &rowRes, 
 			    vector<vector<double>>&fulltmpH, vector<vector<double>>&partialW, 
-			    map<int, bool>&mybucket, int maxcnt, int rank, child_thread **childs){
+			    map<int, bool>&mybucket, int maxcnt, int rank, child_thread **childs, depscheduler *sched){
   vector<vector<int>>thbuckets(FLAGS_threads);
+  vector<double>change;
   int clock = 0;
-  balanced_wupdate(ctx->rank, rowA, mybucket, thbuckets);
+  if(sched != NULL){
+    long scheduled = scheduled_update(sched, mybucket, thbuckets);
+    change.resize(partialW.size(), 0);
+    strads_msg(ERR, "[worker %d] scheduler picked %ld W rows out of %ld (conflicts so far %ld)\n", 
+	       ctx->rank, scheduled, mybucket.size(), sched->m_conflicts);
+  }else{
+    balanced_wupdate(ctx->rank, rowA, mybucket, thbuckets);
+  }
   ucommand **commands = (ucommand **)calloc(sizeof(ucommand *), FLAGS_threads);
   for(int i=0; i<FLAGS_threads; i++){
     ucommand *tmp = (ucommand *)calloc(sizeof(ucommand), 1);
     set_arg_w(tmp, rowA, rowRes, fulltmpH, partialW, thbuckets[i], rank, WMAT);
+    tmp->change = (sched != NULL) ? &change : NULL;
     commands[i]= tmp;
   }
 
@@ -359,13 +387,20 @@ void update_parameters_w_mt(sharedctx *ctx, udshard<rowmajor_map> &rowA, udshard
 
   strads_msg(ERR, "[worker %d] all threads have done their works elapsed time min(%lf) max(%lf): avgtime(%lf) \n", 
 	     ctx->rank, elapsedtime[0], elapsedtime[FLAGS_threads-1], avg/FLAGS_threads);
+  if(sched != NULL){
+    for(int i=0; i<FLAGS_threads; i++){
+      for(auto rowidx : thbuckets[i]){
+	sched->update_priority(rowidx, change[rowidx]);
+      }
+    }
+  }
 }
 
 // w update method 
-double update_w(sharedctx *ctx, udshard<rowmajor_map> &rowA, udshard<rowmajor_map> &rowRes, 
+double update_w(sharedctx *ctx, udshard<cdmf_rowmat> &rowA, udshard<cdmf_rowmat> &rowRes, 
 	      vector<vector<double>>&fullM, vector<vector<double>>&partialM, 
 	      map<int, bool>&partialmattaskmap, int partialmmax, int rank, map<int, bool>&fullmattaskmap, 
-	      int colcnt, child_thread **childs){
+	      int colcnt, child_thread **childs, depscheduler *sched){
   // ctx, rowA, rowRes, fullH, partialW, taskmap, maxcnt, rank
   // if row major A : A[i] return the i-th full row
   // if col major A : A[i] return the i-th full col 
@@ -373,20 +408,20 @@ double update_w(sharedctx *ctx, udshard<rowmajor_map> &rowA, udshard<rowmajor_ma
   restore_residual_w_mt(ctx, rowA, rowRes, fullM, partialM, partialmattaskmap, partialmmax, rank, childs);
   strads_msg(ERR, "[worker %d] For W update updateparam_restore_residualallocated entry A(%ld)  Res(%ld)\n",
 	     ctx->rank, rowA.matrix.allocatedentry(), rowRes.matrix.allocatedentry()); 
-  update_parameters_w_mt(ctx, rowA, rowRes, fullM, partialM, partialmattaskmap, partialmmax, rank, childs);
+  update_parameters_w_mt(ctx, rowA, rowRes, fullM, partialM, partialmattaskmap, partialmmax, rank, childs, sched);
   double ret = get_object_w(ctx, rowA, partialM, partialmattaskmap, partialmmax, FLAGS_lambda, fullM, fullmattaskmap, colcnt, rank, childs);
   return ret;
 }
 
 // h update method 
-double update_h(sharedctx *ctx, udshard<colmajor_map> &rowA, udshard<colmajor_map> &rowRes, 
+double update_h(sharedctx *ctx, udshard<cdmf_colmat> &rowA, udshard<cdmf_colmat> &rowRes, 
 	      vector<vector<double>>&fullM, vector<vector<double>>&partialM, 
 	      map<int, bool>&partialmattaskmap, int partialmmax, int rank, map<int, bool>&fullmattaskmap, 
-	      int colcnt, child_thread **childs){
+	      int colcnt, child_thread **childs, depscheduler *sched){
   restore_residual_h_mt(ctx, rowA, rowRes, fullM, partialM, partialmattaskmap, partialmmax, rank, childs);
   strads_msg(ERR, "[worker %d] For H update updateparam_restore_residualallocated entry A(%ld)  Res(%ld)\n",
   	     ctx->rank, rowA.matrix.allocatedentry(), rowRes.matrix.allocatedentry()); 
-  update_parameters_h_mt(ctx, rowA, rowRes, fullM, partialM, partialmattaskmap, partialmmax, rank, childs);
+  update_parameters_h_mt(ctx, rowA, rowRes, fullM, partialM, partialmattaskmap, partialmmax, rank, childs, sched);
   double ret = get_object_h(ctx, rowA, partialM, partialmattaskmap, partialmmax, FLAGS_lambda, fullM, fullmattaskmap, colcnt, rank, childs);
   return ret;
 }
@@ -406,43 +441,51 @@ void *process_update(void *parg){
 
       vector<int>*pmybucket = cmd->mybucket;
       vector<int>&mybucket = *pmybucket;
-      udshard<rowmajor_map> *prowA = cmd->rowA;
-      udshard<rowmajor_map> *prowRes = cmd->rowRes;
+      udshard<cdmf_rowmat> *prowA = cmd->rowA;
+      udshard<cdmf_rowmat> *prowRes = cmd->rowRes;
       vector<vector<double>>*pfulltmpH = cmd->fulltmpH;
       vector<vector<double>>*ppartialW = cmd->partialW;  
-      udshard<rowmajor_map> &rowA = *prowA;
-      udshard<rowmajor_map> &rowRes = *prowRes;
+      udshard<cdmf_rowmat> &rowA = *prowA;
+      udshard<cdmf_rowmat> &rowRes = *prowRes;
       vector<vector<double>>&fulltmpH = *pfulltmpH;
       vector<vector<double>>&partialW = *ppartialW;  
       if(cmd->type == WMAT){
 	for(int i=0; i < mybucket.size(); i++){ 
 	  int rowidx = mybucket[i];
+	  double change = 0;
 	  for(int t=0; t<rank; t++){
+	    double old = partialW[rowidx][t];
 	    partialW[rowidx][t] = update_1param_w(rowidx, t, rowA, partialW[rowidx][t], fulltmpH, rowRes, FLAGS_lambda, partialW[rowidx][t]); 
+	    change += fabs(partialW[rowidx][t] - old);
 	  }
+	  if(cmd->change != NULL)
+	    (*cmd->change)[rowidx] = change; // rows are disjoint across threads 
+
 	}
       }else if(cmd->type == WMAT_RES){
 	double newtmp=0;
 	uint64_t tmpj;
 	for(int id=0; id<mybucket.size(); id++){
 	    int rowidx = mybucket[id];
-	  for(auto  p : rowA.matrix.row(rowidx)){
-	    tmpj = p.first;  // tmpj : N range                                                             
+	  double *res = rowRes.matrix.res_array();
+	  for(uint64_t k = rowA.matrix.nnz_begin(rowidx); k < rowA.matrix.nnz_end(rowidx); k++){
+	    tmpj = rowA.matrix.minor(k);  // tmpj : N range                                                             
 	    newtmp = 0;
 	    for(long t=0; t < rank; t++){
 	      newtmp += (partialW[rowidx][t]*fulltmpH[tmpj][t]); // Tr(H)                                                                 
 	    }
-	    rowRes.matrix(rowidx, tmpj) = p.second - newtmp;
+	    res[k] = rowA.matrix.value(k) - newtmp;
 	  }
 	}
       }else if(cmd->type == WMAT_OBJ){
 	double sum=0, wihj;
 	for(int id=0; id<mybucket.size(); id++){
 	  int row = mybucket[id];
-	  for(auto p : rowA.matrix.row(row)) {
-	    int tmpcol = p.first;                                                                             
+	  for(uint64_t k = rowA.matrix.nnz_begin(row); k < rowA.matrix.nnz_end(row); k++) {
+	    int tmpcol = rowA.matrix.minor(k);                                                                             
+	    double aval = rowA.matrix.value(k);
 	    wihj = get_wihj(partialW, fulltmpH, row, tmpcol, rank);
-	    sum += ((p.second - wihj)*(p.second - wihj));
+	    sum += ((aval - wihj)*(aval - wihj));
 	  }
 	}
 	// buf fix 
@@ -455,42 +498,50 @@ void *process_update(void *parg){
 
       vector<int>*pmybucket = cmd->mybucket;
       vector<int>&mybucket = *pmybucket;
-      udshard<colmajor_map> *prowA = cmd->colA;
-      udshard<colmajor_map> *prowRes = cmd->colRes;
+      udshard<cdmf_colmat> *prowA = cmd->colA;
+      udshard<cdmf_colmat> *prowRes = cmd->colRes;
       vector<vector<double>>*pfulltmpH = cmd->fulltmpH;
       vector<vector<double>>*ppartialW = cmd->partialW;  
-      udshard<colmajor_map> &rowA = *prowA;
-      udshard<colmajor_map> &rowRes = *prowRes;
+      udshard<cdmf_colmat> &rowA = *prowA;
+      udshard<cdmf_colmat> &rowRes = *prowRes;
       vector<vector<double>>&fulltmpH = *pfulltmpH;
       vector<vector<double>>&partialW = *ppartialW;  
 
       if(cmd->type == HMAT){
 	for(int i=0; i < mybucket.size(); i++){ 
 	  int rowidx = mybucket[i];
+	  double change = 0;
 	  for(int t=0; t<rank; t++){
+	    double old = partialW[rowidx][t];
 	    partialW[rowidx][t] = update_1param_h(rowidx, t, rowA, partialW[rowidx][t], fulltmpH, rowRes, FLAGS_lambda, partialW[rowidx][t]); 
+	    change += fabs(partialW[rowidx][t] - old);
 	  }
+	  if(cmd->change != NULL)
+	    (*cmd->change)[rowidx] = change; // rows are disjoint across threads 
+
 	}
       }else if(cmd->type == HMAT_RES){
 	for(int id=0; id<mybucket.size(); id++){
 	  int rowidx = mybucket[id];	  
-	  for(auto  p : rowA.matrix.col(rowidx)){
-	    uint64_t tmpj = p.first;  // colidx of H,  rowidx of Input or Res                                                               
+	  double *res = rowRes.matrix.res_array();
+	  for(uint64_t k = rowA.matrix.nnz_begin(rowidx); k < rowA.matrix.nnz_end(rowidx); k++){
+	    uint64_t tmpj = rowA.matrix.minor(k);  // colidx of H,  rowidx of Input or Res                                                               
 	    double newtmp = 0;
 	    for(long t=0; t < rank; t++){
 	      newtmp += (partialW[rowidx][t]*fulltmpH[tmpj][t]); // Tr(H)                                                                 
 	    }
-	    rowRes.matrix(tmpj, rowidx) = p.second - newtmp;
+	    res[k] = rowA.matrix.value(k) - newtmp;
 	  }
 	}
       }else if(cmd->type == HMAT_OBJ){
 	double sum=0, wihj;
 	for(int id=0; id<mybucket.size(); id++){
 	  int row = mybucket[id];
-	  for(auto p : rowA.matrix.col(row)) {
-	    int tmpcol = p.first;                                                                             
+	  for(uint64_t k = rowA.matrix.nnz_begin(row); k < rowA.matrix.nnz_end(row); k++) {
+	    int tmpcol = rowA.matrix.minor(k);                                                                             
+	    double aval = rowA.matrix.value(k);
 	    wihj = get_wihj(partialW, fulltmpH, row, tmpcol, rank);
-	    sum += ((p.second - wihj)*(p.second - wihj));
+	    sum += ((aval - wihj)*(aval - wihj));
 	  }
 	}
 	cmd->sum = sum;
@@ -506,26 +557,27 @@ void *process_update(void *parg){
 }
 
 // h update method:  unit operation 
-double update_1param_h(int rowidx, int t, udshard<colmajor_map> &rowA, 
+double update_1param_h(int rowidx, int t, udshard<cdmf_colmat> &rowA, 
 		     double Wit, vector<vector<double>>&H, 
-		     udshard<colmajor_map> &rowRes, double lambda, double old_wvalue){
+		     udshard<cdmf_colmat> &rowRes, double lambda, double old_wvalue){
 
   double new_wvalue=0, sum_m=0, sum_c=0;
-  for (auto p : rowRes.matrix.col(rowidx)) {
-    int tmpj = p.first;  // tmpj: col of H/W but rowidx of A and Res  
-    double hjt = H[tmpj][t];
-    sum_c += (rowRes.matrix.get(tmpj, rowidx) + Wit*hjt)*hjt;                           
+  const uint64_t begin = rowA.matrix.nnz_begin(rowidx), end = rowA.matrix.nnz_end(rowidx);
+  const uint32_t *idx = rowA.matrix.idx_array(); // idx[k]: col of H/W but rowidx of A and Res 
+  double *res = rowRes.matrix.res_array(); // residual shares the nonzero layout of A 
+  for (uint64_t k = begin; k < end; k++) {
+    double hjt = H[idx[k]][t];
+    sum_c += (res[k] + Wit*hjt)*hjt;                           
     sum_m += hjt*hjt;                                                            
   }
   new_wvalue = sum_c/(sum_m + lambda);    
-  for(auto p : rowRes.matrix.col(rowidx)){
-    int tmpj = p.first; // tmpj : col of H/W but  rowidx of Res or A                                                                         
-    rowRes.matrix(tmpj, rowidx) = rowRes.matrix.get(tmpj, rowidx) - H[tmpj][t]*(new_wvalue-old_wvalue);         
+  for(uint64_t k = begin; k < end; k++){
+    res[k] -= H[idx[k]][t]*(new_wvalue-old_wvalue);         
   }
   return new_wvalue;
 }
 
-void balanced_hupdate(int mid, udshard<colmajor_map> &rowA, map<int, bool>&mybucket, vector<vector<int>>&thbuckets){
+void balanced_hupdate(int mid, udshard<cdmf_colmat> &rowA, map<int, bool>&mybucket, vector<vector<int>>&thbuckets){
 
   //  int minidx;
   vector<long>workload(FLAGS_threads, 0);
@@ -541,7 +593,7 @@ void balanced_hupdate(int mid, udshard<colmajor_map> &rowA, map<int, bool>&mybuc
     }   
     assert(minidx >= 0 and minidx <= (FLAGS_threads-1));
     thbuckets[minidx].push_back(rowidx);
-    workload[minidx] += rowA.matrix.col(rowidx).size();
+    workload[minidx] += rowA.matrix.nnz(rowidx);
   }
 }
 
@@ -555,17 +607,26 @@ void plainassign_hupdate(map<int, bool>&mybucket, vector<vector<int>>&thbuckets)
   }
 }
 
-void update_parameters_h_mt(sharedctx *ctx, udshard<colmajor_map> &rowA, udshard<colmajor_map> &rowRes, 
+void update_parameters_h_mt(sharedctx *ctx, udshard<cdmf_colmat> &rowA, udshard<cdmf_colmat> &rowRes, 
 			    vector<vector<double>>&fulltmpH, vector<vector<double>>&partialW, 
-			    map<int, bool>&mybucket, int maxcnt, int rank, child_thread **childs){
+			    map<int, bool>&mybucket, int maxcnt, int rank, child_thread **childs, depscheduler *sched){
 
   vector<vector<int>>thbuckets(FLAGS_threads);
-  balanced_hupdate(ctx->rank, rowA, mybucket, thbuckets);
+  vector<double>change;
+  if(sched != NULL){
+    long scheduled = scheduled_update(sched, mybucket, thbuckets);
+    change.resize(partialW.size(), 0);
+    strads_msg(ERR, "[worker %d] scheduler picked %ld H rows out of %ld (conflicts so far %ld)\n", 
+	       ctx->rank, scheduled, mybucket.size(), sched->m_conflicts);
+  }else{
+    balanced_hupdate(ctx->rank, rowA, mybucket, thbuckets);
+  }
   int clock = 0;  
   ucommand **commands = (ucommand **)calloc(sizeof(ucommand *), FLAGS_threads);
   for(int i=0; i<FLAGS_threads; i++){
     ucommand *tmp = (ucommand *)calloc(sizeof(ucommand), 1); 
     set_arg_h(tmp, rowA, rowRes, fulltmpH, partialW, thbuckets[i], rank, 0, HMAT); // HMAT - HMAT update 
+    tmp->change = (sched != NULL) ? &change : NULL;
     commands[i]= tmp;
   }
 
@@ -596,11 +657,18 @@ void update_parameters_h_mt(sharedctx *ctx, udshard<colmajor_map> &rowA, udshard
   }
   strads_msg(ERR, "[worker %d] all threads have done their works elapsed time min(%lf) max(%lf): Avg(%lf) \n", 
 	     ctx->rank, elapsedtime[0], elapsedtime[FLAGS_threads-1], avg/FLAGS_threads);
+  if(sched != NULL){
+    for(int i=0; i<FLAGS_threads; i++){
+      for(auto rowidx : thbuckets[i]){
+	sched->update_priority(rowidx, change[rowidx]);
+      }
+    }
+  }
 }
 
 
 // h update method :  TODO : Multi threading by rows of W, restore residual matrix from A and current W and H matrix  
-void restore_residual_h_st(sharedctx *ctx, udshard<colmajor_map> &rowA, udshard<colmajor_map> &rowRes, 
+void restore_residual_h_st(sharedctx *ctx, udshard<cdmf_colmat> &rowA, udshard<cdmf_colmat> &rowRes, 
 			vector<vector<double>>&fulltmpH, vector<vector<double>>&partialW, 
 			map<int, bool>&mybucket, int maxcnt, int rank){
   double newtmp=0;
@@ -609,20 +677,21 @@ void restore_residual_h_st(sharedctx *ctx, udshard<colmajor_map> &rowA, udshard<
 	     partialW.size(), maxcnt, mybucket.size(), rowA.matrix.col_size_vector(), rowRes.matrix.col_size_vector());
   for(auto p = mybucket.begin(); p != mybucket.end(); p ++){
     int rowidx = p->first; // rowidx of H       colidx of input or Res  
-    for(auto  p : rowA.matrix.col(rowidx)){
-      tmpj = p.first;  // colidx of H,  rowidx of Input or Res                                                               
+    double *res = rowRes.matrix.res_array();
+    for(uint64_t k = rowA.matrix.nnz_begin(rowidx); k < rowA.matrix.nnz_end(rowidx); k++){
+      tmpj = rowA.matrix.minor(k);  // colidx of H,  rowidx of Input or Res                                                               
       newtmp = 0;
       for(long t=0; t < rank; t++){
         newtmp += (partialW[rowidx][t]*fulltmpH[tmpj][t]); // Tr(H)                                                                 
       }
-      rowRes.matrix(tmpj, rowidx) = p.second - newtmp;
+      res[k] = rowA.matrix.value(k) - newtmp;
     }
   }
   strads_msg(ERR, "FINISH H RESIDUAL UPDATE \n");
 }
 
 // h update method 
-double get_object_h(sharedctx *ctx, udshard<colmajor_map> &rowA, vector<vector<double>>&partialM,
+double get_object_h(sharedctx *ctx, udshard<cdmf_colmat> &rowA, vector<vector<double>>&partialM,
 		  map<int, bool>&partmattaskmap, int maxcnt, double lambda, 
 		    vector<vector<double>>&fullM, map<int, bool>&fullmattakmap, int colcnt, int rank, child_thread **childs){
   double sum=0, wfn, hfn, rval;
@@ -676,7 +745,7 @@ double get_object_h(sharedctx *ctx, udshard<colmajor_map> &rowA, vector<vector<d
 }
 
 // h update method :  TODO : Multi threading by rows of W, restore residual matrix from A and current W and H matrix  
-void restore_residual_h_mt(sharedctx *ctx, udshard<colmajor_map> &rowA, udshard<colmajor_map> &rowRes, 
+void restore_residual_h_mt(sharedctx *ctx, udshard<cdmf_colmat> &rowA, udshard<cdmf_colmat> &rowRes, 
 			vector<vector<double>>&fulltmpH, vector<vector<double>>&partialW, 
 			   map<int, bool>&mybucket, int maxcnt, int rank, child_thread **childs){
   strads_msg(ERR, "H spine size (%ld) maxcnt (%d), mybucketsize(%ld), colA.colvecorsize(%ld) colRes.colvectorsize(%ld) \n", 
@@ -19,23 +19,35 @@
 #include <strads/ds/dshard.hpp>
 #include <strads/ds/spmat.hpp>
 #include <strads/ds/iohandler.hpp>
+#include <strads/include/dep-scheduler.hpp>
 
 using namespace std;
 using namespace strads_sysmsg;
 
+// input A and residual live in compressed shards (CSR for the W pass, CSC for the H pass). 
+// the residual is the mutable array aligned with the nonzeros of A (alloc_residual), so rowA and rowRes 
+// are the same shard. -DCDMF_FLOAT_VALUES stores A in float to halve the value stream  
+#if defined(CDMF_FLOAT_VALUES)
+typedef float cdmf_val_t;
+#else
+typedef double cdmf_val_t;
+#endif
+typedef rowmajor_csr<cdmf_val_t> cdmf_rowmat;
+typedef colmajor_csc<cdmf_val_t> cdmf_colmat;
+
 void init_partialmatrix(vector<vector<double>>&pmat, map<int, bool> &mybucket, int vectorsize, int rank);
 void init_tmpfullmat(vector<vector<double>>&pmat, int rows, int cols);
 void drop_tmpfullmat(vector<vector<double>>&pmat, int rows, int cols);
 
-double update_w(sharedctx *ctx, udshard<rowmajor_map> &rowA, udshard<rowmajor_map> &rowRes, 
+double update_w(sharedctx *ctx, udshard<cdmf_rowmat> &rowA, udshard<cdmf_rowmat> &rowRes, 
 	      vector<vector<double>>&fulltmpH, vector<vector<double>>&partialW, 
 	      map<int, bool>&taskmap, int maxcnt, int rank, map<int, bool>&coltaskmap, int colcnt, 
-	      child_thread **childs);
+	      child_thread **childs, depscheduler *sched);
 
-double update_h(sharedctx *ctx, udshard<colmajor_map> &rowA, udshard<colmajor_map> &rowRes, 
+double update_h(sharedctx *ctx, udshard<cdmf_colmat> &rowA, udshard<cdmf_colmat> &rowRes, 
 	      vector<vector<double>>&fullM, vector<vector<double>>&partialM, 
 	      map<int, bool>&partialmattaskmap, int partialmmax, int rank, map<int, bool>&fullmattaskmap, int colcnt, 
-	      child_thread **childs);
+	      child_thread **childs, depscheduler *sched);
 
 void *process_update(void *parg);
 #endif 
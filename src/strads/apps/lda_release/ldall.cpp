@@ -14,6 +14,7 @@ DEFINE_int32(threads, 1, "The number of threads per machine");  // different mea
 DEFINE_string(logfile, "", "log file to write ll value per iteration");
 DEFINE_string(wtfile_pre, "", "word topic table file prefix ");
 DEFINE_string(dtfile_pre, "", "document topic table file prefix");
+DEFINE_int32(ring_batch_bytes, 256*1024, "Byte budget of a word topic ring message. Many words are packed into one message up to this size");
 
 int main(int argc, char **argv){
 
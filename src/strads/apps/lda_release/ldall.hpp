@@ -34,4 +34,11 @@ typedef struct{
   int *cnt;
 }wpacket;
 
+typedef struct{
+  int blen;   // bytes in use including this header 
+  int nwords; // the number of wpacket records packed after this header 
+  int cap;    // allocated bytes, only meaningful on the sending side 
+  int pad;
+}wbatch;     // ring message : wbatch header followed by nwords wpacket records of WPACKET_BYTES(size) each 
+
 #endif 
@@ -63,9 +63,9 @@ void *relayer_async(void *arg){
     int len=-1;
     recv = ctx->ring_asyncrecv_aux(&len);
     if(recv != NULL){
-      wpacket *pkt = (wpacket *)recv;
-      assert(len == pkt->blen);
-      relay_recvbytes += pkt->blen;
+      wbatch *batch = (wbatch *)recv;
+      assert(len == batch->blen);
+      relay_recvbytes += batch->blen;
       pendjob *newjob = (pendjob *)calloc(sizeof(pendjob), 1);
       newjob->ptr = recv;
       newjob->len = len;
@@ -2,25 +2,6 @@
 
 void dump_parameters(sharedctx *ctx, vector<wtopic> &wtable, int mywords, vector<int> &mybucket, std::unique_ptr<Trainer> &trainer);
 
-wpacket *packet_alloc(int topicsize){
-  int bytes = sizeof(wpacket) + topicsize*sizeof(int)*2;
-  wpacket *pkt = (wpacket *)calloc(bytes, 1); 
-  assert((uintptr_t)pkt % sizeof(long) == 0);
-  pkt->blen = bytes;
-  pkt->size = topicsize;
-  if(topicsize > 0){
-    pkt->topic = (int *)((uintptr_t)pkt+sizeof(wpacket));
-    assert((uintptr_t)pkt->topic % sizeof(int) == 0);
-    pkt->cnt = (int *)((uintptr_t)(pkt->topic) + sizeof(int)*pkt->size);
-    assert((uintptr_t)pkt->cnt % sizeof(int) == 0);
-  }else{
-    pkt->topic = NULL;
-    pkt->cnt = NULL;
-
-  }
-  return pkt;
-}
-
 wpacket *packet_resetptr(wpacket *pkt, int blen){
   if(blen != (sizeof(wpacket) + pkt->size * sizeof(int)*2)){
     strads_msg(ERR, "[worker] Fatal:blen(%d) pkt->size(%d) sizeof(wpacket)(%ld) packet->blen(%d)  pkt->size*sizeof(int)*2:(%ld) \n", 
@@ -61,221 +42,119 @@ bool wait_exit_control(sharedctx *ctx){
   return ret;
 }
 
-void process_single_entry(pendjob *job, std::unique_ptr<Trainer> &trainer){
-
-  int *karray = (int *)calloc(sizeof(int), FLAGS_num_topic);
-  int *topic = (int *)calloc(sizeof(int), FLAGS_num_topic);
-  int *cnt = (int *)calloc(sizeof(int), FLAGS_num_topic);
-  wpacket *entry = (wpacket *)job->ptr;
-  int widx = entry->widx;
-  int size = entry->size;
-  for(int i=0; i<size; i++){
-    topic[i] = entry->topic[i];
-    cnt[i] = entry->cnt[i];
+// O(1) replacement of the linear scan over mybucket when a word comes back to its owner
+void build_owner_index(vector<int> &mybucket, int mywords, int wordmax, vector<char> &owner){
+  owner.assign(wordmax, 0);
+  for(int i=0; i < mywords; i++){
+    assert(mybucket[i] < wordmax);
+    owner[mybucket[i]] = 1;
   }
+}
 
-  assert(entry->blen == job->len);
-
-  packet_resetptr(entry, job->len);
-  trainer->SingleTableEntrybuild(widx, karray);               
+// add my partition's topic counts of pkt->widx to the row and append it to the outgoing batch 
+void merge_local_counts(wpacket *pkt, int *karray, wbatch_sender &sender, std::unique_ptr<Trainer> &trainer){
+  int size = pkt->size;
+  trainer->SingleTableEntrybuild(pkt->widx, karray);               
+  for(int ii=0; ii<size; ii++){
+    assert(pkt->topic[ii] < FLAGS_num_topic);
+    pkt->cnt[ii] += karray[pkt->topic[ii]];
+    karray[pkt->topic[ii]] = 0;
+  }
   int newsize = size;
   for(int k=0; k<FLAGS_num_topic; k++){
-    if(karray[k] == 0)
-      continue;
-    bool found = false;
-    for(int ii=0; ii<size; ii++){
-      if(topic[ii] == k){
-	cnt[ii] += karray[k];
-	found = true;
-      }	 
-    }
-    if(found == false){
-      topic[newsize] = k;
-      cnt[newsize] = karray[k];
+    if(karray[k] != 0)
       newsize++;
-    }
   }
-  if(size != newsize){  // in the first table circulation, word topic row never shrink. 
-    wpacket *pkt = packet_alloc(newsize);
-    for(int i=0; i<newsize; i++){
-      pkt->topic[i] = topic[i];
-      pkt->cnt[i] = cnt[i];
-    }
-    pkt->src=entry->src;
-    pkt->widx=entry->widx;
-    job->ptr = pkt;
-    job->len = pkt->blen;  
-    free(entry);
-  }else{
-    // overwrite entry->topic/cnt with topic/cnt
-    assert(newsize == size);
-    for(int i=0; i<newsize; i++){
-      entry->topic[i] = topic[i];
-      entry->cnt[i] = cnt[i];
-    }
+  // in the first table circulation, word topic row never shrink. 
+  wpacket *out = sender.reserve(pkt->src, pkt->widx, newsize);
+  memcpy(out->topic, pkt->topic, sizeof(int)*size);
+  memcpy(out->cnt, pkt->cnt, sizeof(int)*size);
+  int progress = size;
+  for(int k=0; k<FLAGS_num_topic; k++){
+    if(karray[k] == 0)
+      continue;
+    out->topic[progress] = k;
+    out->cnt[progress] = karray[k];
+    progress++;
   }
-  free(karray);
+  assert(progress == newsize);
+}
+
+void restore_entry(wpacket *pkt, vector<wtopic> &wtable){
+  auto &entry = wtable[pkt->widx];
+  assert(entry.topic.size() == 0);
+  assert(entry.cnt.size() == 0);
+  entry.topic.assign(pkt->topic, pkt->topic + pkt->size);
+  entry.cnt.assign(pkt->cnt, pkt->cnt + pkt->size);
 }
 
 void circulate_table(sharedctx *ctx, vector<wtopic> &wtable, int mywords, vector<int> &mybucket, std::unique_ptr<Trainer> &trainer){
 
-  deque<pendjob *>sendjobq;
-  deque<pendjob *>recvjobq;
+  wbatch_pool pool(FLAGS_ring_batch_bytes);
+  wbatch_sender sender(ctx, &pool);
+  vector<char> owner;
+  build_owner_index(mybucket, mywords, wtable.size(), owner);
+  int *karray = (int *)calloc(sizeof(int), FLAGS_num_topic);
   int recvmsg = 0;
-
-  for(int i=0; i < mywords; i++){  
-    int widx = mybucket[i];
-    auto &entry = wtable[widx];
-    assert(entry.topic.size() == entry.cnt.size());   
-    wpacket *newjob = packet_alloc(entry.cnt.size()); // this is starting point. NO worry about that there is zero cnt here 
-    newjob->widx = widx;
-    for(int j=0; j < entry.cnt.size(); j++){
-      newjob->topic[j] = entry.topic[j];
-      newjob->cnt[j] = entry.cnt[j];
-    }
-    assert(newjob->size == entry.cnt.size());
-
-    newjob->src = ctx->rank;
-    entry.topic.erase(entry.topic.begin(), entry.topic.end());
-    entry.cnt.erase(entry.cnt.begin(), entry.cnt.end());
-    pendjob *qentry = (pendjob *)calloc(sizeof(pendjob), 1);
-    qentry->ptr = (void *)newjob;
-    qentry->len = newjob->blen;
-    sendjobq.push_back(qentry);
-    if(sendjobq.size() > 0){
-      pendjob *job =  sendjobq.front();
-      void *ret = ctx->ring_async_send_aux(job->ptr, job->len);
-      if(ret != NULL){
-	sendjobq.pop_front();
-	free(job->ptr);
-	free(job);
-      }
-    }else{
-      // nothing to send 
-    }
-    void *recv = NULL;   
-    int len=-1;
-    recv = ctx->ring_asyncrecv_aux(&len);
-    if(recv != NULL){
-      wpacket *pkt = (wpacket *)recv;       
-      assert(pkt->blen == len);
-      packet_resetptr(pkt, len);
-
-      int ringsrc = pkt->src;
-      if(ringsrc == ctx->rank){
-	recvmsg++;
-	int widx = pkt->widx;
-	bool found = false;
-	for(int ii=0; ii < mywords; ii++){ 
-	  int idx = mybucket[ii];
-	  if(idx == widx){
-	    found = true;
-	    break;
-	  }
-	}       
-	assert(found); // if not found ,,, fatal error        
-	auto &entry = wtable[widx];
-	assert(entry.topic.size() == 0);
-	assert(entry.cnt.size() == 0);
-	int size = pkt->size;
-	for(int ii=0; ii<size; ii++){
-	  entry.topic.push_back(pkt->topic[ii]);
-	  entry.cnt.push_back(pkt->cnt[ii]);
-	}
-	free(pkt);
-      }else{
-	pendjob *newjob = (pendjob *)calloc(sizeof( pendjob), 1);
-	newjob->ptr = (void *)recv;
-	wpacket *tmp = (wpacket *)recv;
-	assert(tmp->blen == len);
-	newjob->len = len;
-	recvjobq.push_back(newjob);
-      }
-    } // recv != 0
-
-    if(recvjobq.size() >0){
-      pendjob *job = recvjobq.front();     
-      recvjobq.pop_front();
-      process_single_entry(job, trainer);
-      sendjobq.push_back(job);           
-    }
-  }
-
+  int packed = 0;
   bool doneflag = false;
   while(1){
+    // pack up to one batch worth of my own words 
+    while(packed < mywords){
+      int widx = mybucket[packed];
+      auto &entry = wtable[widx];
+      assert(entry.topic.size() == entry.cnt.size());   
+      // this is starting point. NO worry about that there is zero cnt here 
+      wpacket *pkt = sender.reserve(ctx->rank, widx, entry.cnt.size());
+      memcpy(pkt->topic, entry.topic.data(), sizeof(int)*entry.topic.size());
+      memcpy(pkt->cnt, entry.cnt.data(), sizeof(int)*entry.cnt.size());
+      entry.topic.erase(entry.topic.begin(), entry.topic.end());
+      entry.cnt.erase(entry.cnt.begin(), entry.cnt.end());
+      packed++;
+      if(sender.pending())
+	break;
+    }
+
     void *recv = NULL;   
     int len=-1;
     recv = ctx->ring_asyncrecv_aux(&len);
     if(recv != NULL){
-      wpacket *pkt = (wpacket *)recv;
-      assert(pkt->blen == len);
-      packet_resetptr(pkt, len);
-      int ringsrc = pkt->src;
-      if(ringsrc == ctx->rank){
-	recvmsg++;
-	int widx = pkt->widx;
-	bool found = false;
-	for(int ii=0; ii < mywords; ii++){ 
-	  int idx = mybucket[ii];
-	  if(idx == widx){
-	    found = true;
-	    break;
+      wbatch_foreach((wbatch *)recv, len, [&](wpacket *pkt){
+	  if(pkt->src == ctx->rank){
+	    recvmsg++;
+	    assert(owner[pkt->widx]); // if not found ,,, fatal error        
+	    restore_entry(pkt, wtable);
+	  }else{
+	    merge_local_counts(pkt, karray, sender, trainer);
 	  }
-	}       
-	assert(found); // if not found ,,, fatal error        
-	auto &entry = wtable[widx];
-	assert(entry.topic.size() == 0);
-	assert(entry.cnt.size() == 0);
-	int size = pkt->size;
-	for(int ii=0; ii<size; ii++){
-	  entry.topic.push_back(pkt->topic[ii]);
-	  entry.cnt.push_back(pkt->cnt[ii]);
-	}	
-	free(pkt);
-	if(recvmsg % 10000 == 0)
-	  strads_msg(INF, "\t\t progress: worker(%d) got (%d) message I generated \n", ctx->rank, recvmsg);
-	if(recvmsg == mywords){
-	  assert(doneflag == false);
-	  stradslda::worker2coord msg;
-	  msg.set_type(100);
-	  msg.set_ringsrc(ctx->rank);
-	  // send msg 
-	  string *buffstring = new string;
-	  msg.SerializeToString(buffstring);
-	  long len = buffstring->size();
-	  ctx->send((char *)buffstring->c_str(), len);
-	  doneflag = true;
-	}
-      }else{
-	pendjob *newjob = (pendjob *)calloc(sizeof(pendjob), 1);
-	newjob->ptr = recv;
-	newjob->len = len;
-	recvjobq.push_back(newjob);
+	});
+      free(recv);
+      if(recvmsg == mywords && doneflag == false){
+	strads_msg(INF, "\t\t progress: worker(%d) got all (%d) words I generated in (%ld) ring msgs\n", 
+		   ctx->rank, recvmsg, sender.sendmsgs_);
+	stradslda::worker2coord msg;
+	msg.set_type(100);
+	msg.set_ringsrc(ctx->rank);
+	// send msg 
+	string *buffstring = new string;
+	msg.SerializeToString(buffstring);
+	long len = buffstring->size();
+	ctx->send((char *)buffstring->c_str(), len);
+	doneflag = true;
+	delete buffstring;
       }
     }
-    // process recv job 
-    if(recvjobq.size() > 0){
-      pendjob *job = recvjobq.front();     
-      recvjobq.pop_front();
-      process_single_entry(job, trainer);
-      sendjobq.push_back(job);           
-    }
-    if(sendjobq.size() > 0){
-      pendjob *job =  sendjobq.front();
-      wpacket *tmp = (wpacket *)job->ptr;
-      assert(tmp->blen == job->len);
-      void *ret = ctx->ring_async_send_aux(job->ptr, job->len);
-      if(ret == NULL){
-      }else{	 
-	sendjobq.pop_front();
-	free(job->ptr);
-	free(job);       
-      }
+    if(packed == mywords){
+      sender.flush();
+    }else{
+      sender.try_send();
     }
     if(wait_exit_control(ctx)){ // when synchronization is done, exit the loop  
       break;
     }
   }
+  assert(sender.empty());
+  free(karray);
 }
 
 void *worker_mach(void *arg){
@@ -582,98 +461,89 @@ void *one_func(void *arg){
     void *recvcmd = ctx->get_entry_inq_blocking();
     assert(recvcmd != NULL);
     ucommand *scmd = (ucommand *)recvcmd;
-    if(scmd->widx >= 0){ // my own 
-      wtopic *entry = scmd->wentry; 
-      assert(entry->topic.size() == entry->cnt.size());   
-      trainer->TrainOneWord(scmd->widx, *entry, mthid);      
-      int nz=0; // TrainOneWord may set any element's topic cnt in the entry to zero
-                // Therefore, we need to recalc  
-      for(int i=0; i < entry->cnt.size(); i++){
-	if(entry->cnt[i] > 0){
-	  nz++;
-	}
-	assert(entry->cnt[i]>=0);
-      }
-      wpacket *newjob = packet_alloc(nz);
-      newjob->widx = scmd->widx;
-      int progress=0;
-      for(int j=0; j < entry->cnt.size(); j++){	
-	if(entry->cnt[j] > 0){
-	  assert(progress < nz);
-	  newjob->topic[progress] = entry->topic[j];
-	  newjob->cnt[progress] = entry->cnt[j];
-	  progress++;
-	}
-	assert(entry->cnt[j]>= 0);
-      }
-      assert(progress == nz);
-      newjob->size = nz;
-      newjob->src = ctx->get_rank();
-      entry->topic.erase(entry->topic.begin(), entry->topic.end());
-      entry->cnt.erase(entry->cnt.begin(), entry->cnt.end());
-      pendjob *qentry = (pendjob *)calloc(sizeof(pendjob), 1);
-      qentry->ptr = (void *)newjob;
-      qentry->len = newjob->blen;
-      scmd->wentry = NULL;
-      scmd->pjob = qentry;
-    }else{
-      pendjob *job = scmd->taskjob;
-      wpacket *pkt = (wpacket *)job->ptr;
-      packet_resetptr(pkt, job->len);
-      int widx = pkt->widx;
-      int src = pkt->src;
-      auto &entry = wtable[widx];      
-      assert(entry.topic.size() == 0);
-      assert(entry.cnt.size() == 0);
-      int size = pkt->size;
-      for(int ii=0; ii<size; ii++){
-	entry.topic.push_back(pkt->topic[ii]);
-	entry.cnt.push_back(pkt->cnt[ii]);
-      } // for flexible size 
-      trainer->TrainOneWord(widx, entry, mthid);
-      free(pkt);
-      int nz=0;
-      for(int i=0; i < entry.cnt.size(); i++){ // TrainOneWord may set any element's topic cnt in the entry to zero
-	if(entry.cnt[i] > 0)
-	  nz++;
-	assert(entry.cnt[i]>=0);
-      }
-      wpacket *newpkt = packet_alloc(nz);
-      newpkt->src = src;
-      newpkt->widx = widx;
-      newpkt->size = nz;
-      int progress=0;
-      for(int ii=0; ii<entry.cnt.size(); ii++){
-	if(entry.cnt[ii] > 0){
-	  assert(progress < nz);
-	  newpkt->topic[progress] = entry.topic[ii];
-	  newpkt->cnt[progress] = entry.cnt[ii];
-	  progress++;
-	}
-	assert(entry.cnt[ii] >= 0);
-      } // for flexible size 
-      assert(progress == nz);
-      job->ptr = newpkt;
-      job->len = newpkt->blen;
-      entry.topic.erase(entry.topic.begin(), entry.topic.end());
-      entry.cnt.erase(entry.cnt.begin(), entry.cnt.end());
-      scmd->wentry=NULL;
-      scmd->pjob = job;     
+    auto &entry = wtable[scmd->widx];
+    if(scmd->pkt != NULL){ // relayed word : read the record in place from the ring batch 
+      restore_entry(scmd->pkt, wtable);
     }
+    assert(entry.topic.size() == entry.cnt.size());   
+    trainer->TrainOneWord(scmd->widx, entry, mthid);      
     ctx->put_entry_outq((void *)scmd);
   }
   return NULL;
 }
 
+// append the trained row of widx to the outgoing batch and empty the entry. 
+// TrainOneWord may set any element's topic cnt in the entry to zero, those are dropped 
+void pack_entry(wbatch_sender &sender, int src, int widx, vector<wtopic> &wtable){
+  auto &entry = wtable[widx];
+  int nz=0; 
+  for(int i=0; i < entry.cnt.size(); i++){
+    if(entry.cnt[i] > 0)
+      nz++;
+    assert(entry.cnt[i]>=0);
+  }
+  wpacket *pkt = sender.reserve(src, widx, nz);
+  int progress=0;
+  for(int i=0; i < entry.cnt.size(); i++){
+    if(entry.cnt[i] > 0){
+      pkt->topic[progress] = entry.topic[i];
+      pkt->cnt[progress] = entry.cnt[i];
+      progress++;
+    }
+  }
+  assert(progress == nz);
+  entry.topic.clear();
+  entry.cnt.clear();
+}
+
+// queue the records of a received ring batch without copying them 
+long unpack_ring_batch(void *recv, int len, deque<wrecord> &recvjobq){
+  long words = 0;
+  rbatch *batch = (rbatch *)calloc(sizeof(rbatch), 1);
+  batch->buf = recv;
+  batch->refs = ((wbatch *)recv)->nwords;
+  wbatch_foreach((wbatch *)recv, len, [&](wpacket *pkt){
+      wrecord rec;
+      rec.pkt = pkt;
+      rec.batch = batch;
+      recvjobq.push_back(rec);
+      words++;
+    });
+  if(words == 0){
+    free(recv);
+    free(batch);
+  }
+  return words;
+}
+
+void release_record(rbatch *batch){
+  assert(batch->refs > 0);
+  if(--batch->refs == 0){
+    free(batch->buf);
+    free(batch);
+  }
+}
+
+// ucommands are recycled by the main thread, one per word in flight 
+ucommand *ucommand_get(vector<ucommand *> &freecmds){
+  if(freecmds.size() == 0)
+    return (ucommand *)calloc(sizeof(ucommand), 1);
+  ucommand *cmd = freecmds.back();
+  freecmds.pop_back();
+  return cmd;
+}
+
 void circulate_calculation_mt(sharedctx *ctx, vector<wtopic> &wtable, int mywords, vector<int> &mybucket, std::unique_ptr<Trainer> &trainer, child_thread **childs){
 
-  deque<pendjob *>sendjobq;
-  deque<pendjob *>recvjobq;
-  deque<int>myjobq;
+  wbatch_pool pool(FLAGS_ring_batch_bytes);
+  wbatch_sender sender(ctx, &pool);
+  vector<char> owner;
+  build_owner_index(mybucket, mywords, wtable.size(), owner);
+  deque<wrecord>recvjobq;
+  vector<ucommand *>freecmds;
   int recvmsg = 0;
   bool doneflag = false;
   int clock=0;
-  long sendbytes = 0;
   long recvbytes = 0;
   long processedmsg = 0;
   long wtnzcnt=0;
@@ -681,9 +551,11 @@ void circulate_calculation_mt(sharedctx *ctx, vector<wtopic> &wtable, int myword
   for(int i=0; i < mywords; i++){  
     int widx = mybucket[i];
     clock = clock % FLAGS_threads;
-    ucommand *scmd = (ucommand *)calloc(sizeof(ucommand), 1);
+    ucommand *scmd = ucommand_get(freecmds);
     scmd->widx = widx;
-    scmd->wentry = &wtable[widx];
+    scmd->src = ctx->rank;
+    scmd->pkt = NULL;
+    scmd->batch = NULL;
     assert(wtable[widx].topic.size() == wtable[widx].cnt.size() );
     childs[clock]->put_entry_inq((void *)scmd);  
     clock++;
@@ -702,20 +574,10 @@ void circulate_calculation_mt(sharedctx *ctx, vector<wtopic> &wtable, int myword
 	strads_msg(INF, "[worker %d] childs trigger %d commands for my all words (%f)sec \n", 
 		   ctx->rank, donecmd, (end-start)/1000000.0 );     
       }
-      sendjobq.push_back(rcmd->pjob);           
-      if(sendjobq.size() > 0){
-	pendjob *job =  sendjobq.front();
-	void *ret = ctx->ring_async_send_aux(job->ptr, job->len);
-	if(ret == NULL){
-	  // if failed, do nothing 
-	}else{	 
-	  sendbytes += job->len;
-	  sendjobq.pop_front();
-	  free(job->ptr);
-	  free(job);       
-	}
-      }
+      pack_entry(sender, rcmd->src, rcmd->widx, wtable);
+      freecmds.push_back(rcmd);
     }
+    sender.try_send();
     clock++;
     if(donecmd == mywords)
       break;
@@ -724,76 +586,44 @@ void circulate_calculation_mt(sharedctx *ctx, vector<wtopic> &wtable, int myword
     recv = ctx->ring_asyncrecv_aux(&len);
     if(recv != NULL){
       recvbytes += len;
-      pendjob *newjob = (pendjob *)calloc(sizeof(pendjob), 1);
-      newjob->ptr = recv;
-      newjob->len = len;
-      recvjobq.push_back(newjob);
+      unpack_ring_batch(recv, len, recvjobq);
     }
   }
   recvmsg=0;
   while(1){
     clock = clock % FLAGS_threads;
-    if(sendjobq.size() > 0){
-      pendjob *job =  sendjobq.front();
-      void *ret = ctx->ring_async_send_aux(job->ptr, job->len);
-      if(ret == NULL){
-      }else{	 
-	sendbytes += job->len;
-	sendjobq.pop_front();
-	free(job->ptr);
-	free(job);       
-      }
-    }
+    sender.flush();
     void *recv = NULL;
     int len=-1;
     recv = ctx->ring_asyncrecv_aux(&len);
     if(recv != NULL){
       recvbytes += len;
-      pendjob *newjob = (pendjob *)calloc(sizeof(pendjob), 1);
-      newjob->ptr = recv;
-      newjob->len = len;
-      recvjobq.push_back(newjob);
+      unpack_ring_batch(recv, len, recvjobq);
     }
     if(recvjobq.size() > 0){
-      pendjob *job = recvjobq.front();
-      wpacket *pkt = (wpacket *)job->ptr;
-      packet_resetptr(pkt, job->len);
+      wrecord rec = recvjobq.front();
+      recvjobq.pop_front();      
+      wpacket *pkt = rec.pkt;
       int ringsrc = pkt->src;
       if(ringsrc == ctx->rank){
 	recvmsg++;
 	// ** post processing for multi threading candidate
 	int widx = pkt->widx;
-	bool found = false;
-	for(int ii=0; ii < mywords; ii++){ 
-	  int idx = mybucket[ii];
-	  if(idx == widx){
-	    found = true;
-	    break;
-	  }
-	}       
-	assert(found); // if not found ,,, fatal error        
+	assert(owner[widx]); // if not found ,,, fatal error        
 	strads_msg(INF, "[worker %d] I got widx (%d) circulated \n", ctx->rank, widx); 
-	auto &entry = wtable[widx];
-	assert(entry.topic.size() == 0);
-	assert(entry.cnt.size() == 0);
-	int size = pkt->size;
-	
-	for(int ii=0; ii<size; ii++){
+	for(int ii=0; ii<pkt->size; ii++){
 	  assert(pkt->cnt[ii] > 0); // there should be no cnt[any] == 0 
-	  wtnzcnt++;
-	  entry.topic.push_back(pkt->topic[ii]);
-	  entry.cnt.push_back(pkt->cnt[ii]);	   
-	  assert(pkt->cnt >= 0);
-	}	
-	free(pkt);
-	free(job);
+	}
+	wtnzcnt += pkt->size;
+	restore_entry(pkt, wtable);
+	release_record(rec.batch);
 
 	if(recvmsg % 10000 == 0)
 	  strads_msg(INF, "\t\t[worker %d] progress: got (%d) message I generated \n", ctx->rank, recvmsg);
 	if(recvmsg == mywords){
 	  assert(doneflag == false);
-	  strads_msg(INF, "\t\t[worker %d]COGRAGT done (%d) message stat send( %lf KB) recv( %lf KB) procedjob(%ld) wtnzcnt(%ld)\n", 
-		     ctx->rank, recvmsg, sendbytes/1024.0, recvbytes/1024.0, processedmsg, wtnzcnt);
+	  strads_msg(INF, "\t\t[worker %d]COGRAGT done (%d) message stat send( %lf KB in %ld msgs) recv( %lf KB) procedjob(%ld) wtnzcnt(%ld)\n", 
+		     ctx->rank, recvmsg, sender.sendbytes_/1024.0, sender.sendmsgs_, recvbytes/1024.0, processedmsg, wtnzcnt);
 	  stradslda::worker2coord msg;
 	  msg.set_type(100);
 	  msg.set_ringsrc(ctx->rank);
@@ -807,29 +637,34 @@ void circulate_calculation_mt(sharedctx *ctx, vector<wtopic> &wtable, int myword
 	}
       }else{
 	// processing 
-	ucommand *scmd = (ucommand *)calloc(sizeof(ucommand), 1);
-	scmd->widx = -1;
-	scmd->wentry = NULL;
-	scmd->pjob = NULL;
-	scmd->taskjob = job;		
+	ucommand *scmd = ucommand_get(freecmds);
+	scmd->widx = pkt->widx;
+	scmd->src = ringsrc;
+	scmd->pkt = pkt;
+	scmd->batch = rec.batch;
 	childs[clock]->put_entry_inq((void *)scmd);  
       } // end of if(ringsrc == ctx->rank ) 
-      recvjobq.pop_front();      
     }// end of if(recvjobq.size () > 0) 
     void *cmd = childs[clock]->get_entry_outq();
     if(cmd != NULL){
       processedmsg++;      
       ucommand *rcmd = (ucommand*)cmd;
-      sendjobq.push_back(rcmd->pjob);           
+      pack_entry(sender, rcmd->src, rcmd->widx, wtable);
+      release_record(rcmd->batch);
+      freecmds.push_back(rcmd);
     }
     clock++;
     if(wait_exit_control(ctx)){
       break;
     }
   }
+  assert(sender.empty());
+  for(auto it = freecmds.begin(); it != freecmds.end(); it++){
+    free(*it);
+  }
 
-  strads_msg(INF, "\t\t[worker %d] @@@ STAT (%d) send( %lf KB) recv( %lf KB) procedjob(%ld) wtnzcnt(%ld)\n", 
-	     ctx->rank, recvmsg, sendbytes/1024.0, recvbytes/1024.0, processedmsg, wtnzcnt);
+  strads_msg(INF, "\t\t[worker %d] @@@ STAT (%d) send( %lf KB in %ld msgs) recv( %lf KB) procedjob(%ld) wtnzcnt(%ld)\n", 
+	     ctx->rank, recvmsg, sender.sendbytes_/1024.0, sender.sendmsgs_, recvbytes/1024.0, processedmsg, wtnzcnt);
   return;
 }
 
@@ -16,6 +16,7 @@
 #include "lda.pb.hpp"
 #include "util.hpp"
 #include "ldall.hpp"
+#include "ringbatch.hpp"
 #include <mutex>
 #include <thread>
 
@@ -27,6 +28,7 @@ DECLARE_int32(eval_interval);
 DECLARE_int32(threads);  // different meaning from multi thread one 
 DECLARE_string(wtfile_pre);
 DECLARE_string(dtfile_pre);
+DECLARE_int32(ring_batch_bytes);
 
 DEFINE_int32(sendmsgs, 100, "Send Message Test");
 
@@ -37,11 +39,24 @@ typedef struct{
   unique_ptr<Trainer> *tr;
 }myarg;
 
+// received ring batch, freed once the last of its records is processed 
+typedef struct{
+  void *buf;
+  int refs;
+}rbatch;
+
+// a word record read in place from a received ring batch 
+typedef struct{
+  wpacket *pkt;
+  rbatch *batch;
+}wrecord;
+
+// a word to train. On return, its row is in wtable[widx] and the main thread packs it 
 typedef struct{
   int widx;
-  wtopic *wentry;
-  pendjob *pjob; // for return 
-  pendjob *taskjob; // for task assignment 
+  int src;      // owner of the word 
+  wpacket *pkt; // record of a relayed word, NULL for my own words 
+  rbatch *batch; // ring batch that holds pkt 
 }ucommand;
 
 void get_summary(sharedctx *ctx, int *gsummary, std::unique_ptr<Trainer> &trainer);
@@ -0,0 +1,96 @@
+#include "ringbatch.hpp"
+#include <string.h>
+
+wbatch_pool::wbatch_pool(int budget):budget_(budget){
+  assert(budget_ >= (int)sizeof(wbatch));
+}
+
+wbatch_pool::~wbatch_pool(){
+  for(auto it = free_.begin(); it != free_.end(); it++){
+    free(*it);
+  }
+}
+
+wbatch *wbatch_pool::get(int minbytes){
+  wbatch *batch;
+  if(minbytes <= budget_ && free_.size() > 0){
+    batch = free_.back();
+    free_.pop_back();
+  }else{
+    int cap = (minbytes > budget_) ? minbytes : budget_;
+    batch = (wbatch *)malloc(cap);
+    assert((uintptr_t)batch % sizeof(long) == 0);
+    batch->cap = cap;
+  }
+  batch->blen = sizeof(wbatch);
+  batch->nwords = 0;
+  return batch;
+}
+
+void wbatch_pool::put(wbatch *batch){
+  if(batch->cap == budget_){
+    free_.push_back(batch);
+  }else{ // oversized one for a single huge word, do not keep it
+    free(batch);
+  }
+}
+
+wbatch_sender::wbatch_sender(sharedctx *ctx, wbatch_pool *pool):
+  sendbytes_(0), sendmsgs_(0), ctx_(ctx), pool_(pool), open_(NULL){}
+
+wbatch_sender::~wbatch_sender(){
+  assert(empty());
+}
+
+wpacket *wbatch_sender::reserve(int src, int widx, int size){
+  int bytes = WPACKET_BYTES(size);
+  if(open_ != NULL && open_->blen + bytes > open_->cap){
+    seal();
+  }
+  if(open_ == NULL){
+    open_ = pool_->get(sizeof(wbatch) + bytes);
+  }
+  wpacket *pkt = (wpacket *)((uintptr_t)open_ + open_->blen);
+  pkt->src = src;
+  pkt->widx = widx;
+  pkt->blen = bytes;
+  pkt->size = size;
+  packet_resetptr(pkt, bytes);
+  open_->blen += bytes;
+  open_->nwords++;
+  return pkt;
+}
+
+void wbatch_sender::append(wpacket *pkt){
+  wpacket *rec = reserve(pkt->src, pkt->widx, pkt->size);
+  memcpy(rec->topic, pkt->topic, sizeof(int)*pkt->size);
+  memcpy(rec->cnt, pkt->cnt, sizeof(int)*pkt->size);
+}
+
+void wbatch_sender::seal(void){
+  if(open_ != NULL){
+    sealed_.push_back(open_);
+    open_ = NULL;
+  }
+}
+
+void wbatch_sender::flush(void){
+  if(sealed_.size() == 0){
+    seal();
+  }
+  try_send();
+}
+
+void wbatch_sender::try_send(void){
+  while(sealed_.size() > 0){
+    wbatch *batch = sealed_.front();
+    void *ret = ctx_->ring_async_send_aux((void *)batch, batch->blen);
+    if(ret == NULL){ // out of ring token, try later
+      break;
+    }
+    sendbytes_ += batch->blen;
+    sendmsgs_++;
+    sealed_.pop_front();
+    pool_->put(batch); // ring_async_send_aux copies the payload
+  }
+}
@@ -0,0 +1,68 @@
+#ifndef _RINGBATCH_HPP_
+#define _RINGBATCH_HPP_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <assert.h>
+#include <strads/include/common.hpp>
+#include <vector>
+#include <deque>
+#include "ldall.hpp"
+
+#define WPACKET_BYTES(size) ((int)(sizeof(wpacket) + (size)*sizeof(int)*2))
+
+// free list of batch buffers with budget bytes capacity.
+// Not thread safe : only the thread that drives the ring uses it.
+class wbatch_pool {
+public:
+  wbatch_pool(int budget);
+  ~wbatch_pool();
+  wbatch *get(int minbytes); // empty batch that can hold at least minbytes
+  void put(wbatch *batch);
+  int budget(void){ return budget_; }
+private:
+  int budget_;
+  std::vector<wbatch *> free_;
+};
+
+// packs word records into batches and pushes sealed batches to the ring.
+// a batch is sealed when the next record does not fit into the byte budget
+// or when the caller flushes.
+class wbatch_sender {
+public:
+  wbatch_sender(sharedctx *ctx, wbatch_pool *pool);
+  ~wbatch_sender();
+  wpacket *reserve(int src, int widx, int size); // append a record, caller fills topic/cnt
+  void append(wpacket *pkt);  // copy a single word packet into the open batch
+  void seal(void);
+  void flush(void);   // seal the open batch if the ring has nothing pending from us
+  void try_send(void);  // send sealed batches while the ring token allows
+  bool pending(void){ return (sealed_.size() > 0); }
+  bool empty(void){ return (open_ == NULL && sealed_.size() == 0); }
+  long sendbytes_;
+  long sendmsgs_;
+private:
+  sharedctx *ctx_;
+  wbatch_pool *pool_;
+  wbatch *open_;
+  std::deque<wbatch *> sealed_;
+};
+
+wpacket *packet_resetptr(wpacket *pkt, int blen);
+
+// visit each record of a received batch. pkt->topic/cnt are valid inside fn
+template<typename Fn>
+void wbatch_foreach(wbatch *batch, int len, Fn fn){
+  assert(batch->blen == len);
+  int offset = sizeof(wbatch);
+  for(int i=0; i < batch->nwords; i++){
+    wpacket *pkt = (wpacket *)((uintptr_t)batch + offset);
+    assert(offset + pkt->blen <= len);
+    packet_resetptr(pkt, pkt->blen);
+    fn(pkt);
+    offset += pkt->blen;
+  }
+  assert(offset == len);
+}
+
+#endif
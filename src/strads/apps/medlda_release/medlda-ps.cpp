@@ -101,6 +101,19 @@ void get_sync(sharedctx *ctx, string &key, string &value){
   ps_get_sync_ll(ctx, key, value);
 }
 
+void multi_put_get_async(sharedctx *ctx, vector<string> &keys, vector<string> &values){
+  ps_multi_put_get_async_ll(ctx, keys, values);
+}
+
+void multi_put_sync(sharedctx *ctx, vector<string> &keys, vector<string> &values){
+  ps_multi_put_sync_ll(ctx, keys, values);
+}
+
+void multi_get_sync(sharedctx *ctx, vector<string> &keys, vector<string> &values){
+  values.assign(keys.size(), string());
+  ps_multi_get_sync_ll(ctx, keys, values);
+}
+
 void worker_barrier(sharedctx *ctx){
   int *src = (int *)calloc(sizeof(int), 1);
   *src = ctx->rank;
@@ -33,6 +33,10 @@ void put_get_async_callback(sharedctx *ctx, std::string &key, std::string &value
 void put_get_async(sharedctx *ctx, std::string &key, std::string &value);
 void put_sync(sharedctx *ctx, std::string &key, std::string &value);
 void get_sync(sharedctx *ctx, std::string &key, std::string &value);
+// batched versions : one round trip per server instead of one per key 
+void multi_put_get_async(sharedctx *ctx, std::vector<std::string> &keys, std::vector<std::string> &values);
+void multi_put_sync(sharedctx *ctx, std::vector<std::string> &keys, std::vector<std::string> &values);
+void multi_get_sync(sharedctx *ctx, std::vector<std::string> &keys, std::vector<std::string> &values);
 
 void server_pgasync(std::string &, std::string &, sharedctx *ctx); // server routines 
 void server_putsync(std::string &, std::string &, sharedctx *ctx); // server routines
@@ -90,10 +90,12 @@ void Trainer::Sync() {
   for (int sync_iter = 0; not stop_sync_; ++sync_iter) {
     Timer sync_timer;
     sync_timer.tic();
+    std::vector<std::string> word_strs(dict_.size()), bytes_vec(dict_.size());
     for (int word_id = 0; word_id < dict_.size(); ++word_id) {
       // lots of lots of copies, sorry..
-      std::string word_str = dict_.get_word(word_id);
-      std::string bytes;
+      std::string &word_str = word_strs[word_id];
+      std::string &bytes = bytes_vec[word_id];
+      word_str = dict_.get_word(word_id);
       TopicCount curr_tc, prev_tc, send_tc;
       stat_.GetCount(word_id, curr_tc);
       prev_stat_.GetCount(word_id, prev_tc);
@@ -102,8 +104,8 @@ void Trainer::Sync() {
       curr_tc.ConvertToMap(&diff);
       prev_stat_.MergeFrom(word_id, diff);
       curr_tc.SerializeTo(bytes);
-      put_get_async(ctx_, word_str, bytes);
     } // end of for each word
+    multi_put_get_async(ctx_, word_strs, bytes_vec);
     if (sync_iter % 100 == 0) {
       LR << "Sync iter " << sync_iter
          << ", took " << sync_timer.toc() << " sec";
@@ -170,23 +172,21 @@ void Trainer::InitParam() {
   Timer init_timer;
   init_timer.tic();
   LR << "Phase 1 start";
+  std::vector<std::string> word_strs(dict_.size()), bytes_vec(dict_.size());
   for (int word_id = 0; word_id < dict_.size(); ++word_id) {
-    std::string word_str = dict_.get_word(word_id);
-    std::string bytes;
-    stat_.GetCountBytes(word_id, bytes);
-    put_sync(ctx_, word_str, bytes);
-    if (word_id % 10000 == 0)
-      LR << "put_sync: word_id " << word_id;
+    word_strs[word_id] = dict_.get_word(word_id);
+    stat_.GetCountBytes(word_id, bytes_vec[word_id]);
   } // end of for each word
+  multi_put_sync(ctx_, word_strs, bytes_vec);
+  LR << "put_sync: " << word_strs.size() << " words";
   LR << "Phase 1 complete. Took " << init_timer.toc() << " sec";
   worker_barrier(ctx_);
   // Phase 2: cecv global counts
   init_timer.tic();
   LR << "Phase 2 start";
+  multi_get_sync(ctx_, word_strs, bytes_vec);
   for (int word_id = 0; word_id < dict_.size(); ++word_id) {
-    std::string word_str = dict_.get_word(word_id);
-    std::string bytes;
-    get_sync(ctx_, word_str, bytes);
+    std::string &bytes = bytes_vec[word_id];
     TopicCount recv_tc, my_tc;
     stat_.GetCount(word_id, my_tc);
     recv_tc.DeSerialize(bytes);
@@ -194,9 +194,8 @@ void Trainer::InitParam() {
     count_map_t diff;
     recv_tc.ConvertToMap(&diff);
     stat_.MergeFrom(word_id, diff);
-    if (word_id % 10000 == 0)
-      LR << "get_sync: word_id " << word_id;
   } // end of for each word
+  LR << "get_sync: " << word_strs.size() << " words";
   LR << "Phase 2 complete. Took " << init_timer.toc() << " sec";
   prev_stat_.CopyFrom(stat_);
   LR << "Initialized parameters";
@@ -470,10 +469,12 @@ void Trainer::SaveResult(std::string dump_prefix) {
   // Compute model
   EMatrix phi(FLAGS_num_topic, dict_.size()); // K x V
   double beta_sum = FLAGS_beta * stat_.num_word_;
+  std::vector<std::string> word_strs(dict_.size()), bytes_vec;
+  for (size_t word_id = 0; word_id < dict_.size(); ++word_id)
+    word_strs[word_id] = dict_.get_word(word_id);
+  multi_get_sync(ctx_, word_strs, bytes_vec);
   for (size_t word_id = 0; word_id < dict_.size(); ++word_id) {
-    auto word_str = dict_.get_word(word_id);
-    std::string bytes;
-    get_sync(ctx_, word_str, bytes);
+    std::string &bytes = bytes_vec[word_id];
     TopicCount recv_tc;
     recv_tc.DeSerialize(bytes);
     for (auto pair : recv_tc.item_) phi(pair.top_, word_id) = pair.cnt_;
@@ -30,4 +30,16 @@ $(ST_SN_OBJ): %.o: %.cpp $(ST_SN_HEADERS) $(ST_COMMON_HEADERS)
 $(ST_COMMON_OBJ): %.o: %.cpp $(ST_COMMON_HEADERS)
 	$(CXX) $(CXXFLAGS) $(INCFLAGS) -c $< -o $@
 
-.PHONY: st_lib
\ No newline at end of file
+# ================== tests ==================
+
+ST_TEST_SRC = $(shell find $(TESTS) -type f -name "*_test.cpp")
+ST_TEST_BIN = $(patsubst $(TESTS)/%.cpp, $(TESTS_BIN)/%, $(ST_TEST_SRC))
+
+st_tests: $(ST_TEST_BIN)
+	for t in $(ST_TEST_BIN); do $$t || exit 1; done
+
+$(ST_TEST_BIN): $(TESTS_BIN)/%: $(TESTS)/%.cpp $(ST_HEADERS) path
+	mkdir -p $(@D)
+	$(CXX) $(CXXFLAGS) $(INCFLAGS) $< -o $@ -lgtest_main $(LDFLAGS)
+
+.PHONY: st_lib st_tests
\ No newline at end of file
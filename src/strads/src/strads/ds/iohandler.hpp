@@ -63,14 +63,14 @@ long mmio_partial_read(int rank, T &mapmatrix, std::map<int,bool> &mybucket, std
     sscanf(chbuffer, "%lu %lu %lf", &tmprow, &tmpcol, &tmpval);   
     assert(tmprow < maxrow); // assume input file follow c origin starting from 0 
     assert(tmpcol < maxcol); // assume input file follow c origin starting from 0
-    if(mapmatrix.m_type == strads_sysmsg::rm_map){
+    if(mapmatrix.m_type == strads_sysmsg::rm_map || mapmatrix.m_type == strads_sysmsg::rm_vec){
       if(mybucket.find(tmprow) != mybucket.end()){// my row 
-	mapmatrix(tmprow, tmpcol) = tmpval;	
+	mapmatrix.add(tmprow, tmpcol, tmpval);	
 	nzprogress++;
       }// else: not belong to my rows. do nothing.  
-    }else if(mapmatrix.m_type == strads_sysmsg::cm_map){
+    }else if(mapmatrix.m_type == strads_sysmsg::cm_map || mapmatrix.m_type == strads_sysmsg::cm_vec){
       if(mybucket.find(tmpcol) != mybucket.end()){// my row 
-	mapmatrix(tmprow, tmpcol) = tmpval;	
+	mapmatrix.add(tmprow, tmpcol, tmpval);	
 	nzprogress++;
       }	//else :  not belong to my cols. do nothing.        
     }
@@ -78,6 +78,8 @@ long mmio_partial_read(int rank, T &mapmatrix, std::map<int,bool> &mybucket, std
       strads_msg(INF, "[worker %d] %ld nz\n", rank, nzprogress);
   }
   fclose(f);
+  free(chbuffer);
+  spmat_finalize(mapmatrix); // compressed types sort and freeze here 
   return nzprogress ;
 }
 #endif
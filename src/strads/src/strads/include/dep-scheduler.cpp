@@ -0,0 +1,111 @@
+#include <math.h>
+#include <algorithm>
+#include <utility>
+#include <strads/include/common.hpp>
+#include <strads/include/dep-scheduler.hpp>
+
+depscheduler::depscheduler(long params, long features, double eta, long maxoverlap, unsigned int seed):
+  m_sampled(0), m_conflicts(0), m_params(params), m_features(features), m_eta(eta),
+  m_maxoverlap(maxoverlap), m_priority(params, 1.0), m_fset(params), m_stamp(features, -1),
+  m_epoch(0), m_rng(seed){
+  assert(m_eta > 0);
+}
+
+void depscheduler::set_features(long param, const std::vector<long unsigned int> &features){
+  assert(param < m_params);
+  m_fset[param] = features;
+  for(auto f : features){
+    assert((long)f < m_features);
+  }
+}
+
+void depscheduler::load_features(udshard<colmajor_map> &shard){
+  long cols = std::min((long)shard.matrix.col_size_vector(), m_params);
+  for(long i=0; i < cols; i++){
+    auto &col = shard.matrix.col(i);
+    m_fset[i].clear();
+    m_fset[i].reserve(col.size());
+    for(auto p : col){
+      assert((long)p.first < m_features);
+      m_fset[i].push_back(p.first);
+    }
+  }
+}
+
+void depscheduler::load_features(udshard<rowmajor_map> &shard){
+  long rows = std::min((long)shard.matrix.row_size_vector(), m_params);
+  for(long i=0; i < rows; i++){
+    auto &row = shard.matrix.row(i);
+    m_fset[i].clear();
+    m_fset[i].reserve(row.size());
+    for(auto p : row){
+      assert((long)p.first < m_features);
+      m_fset[i].push_back(p.first);
+    }
+  }
+}
+
+void depscheduler::update_priority(long param, double change){
+  assert(param < m_params);
+  m_priority[param] = fabs(change) + m_eta;
+}
+
+bool depscheduler::conflict(long param){
+  if(m_maxoverlap < 0)
+    return false;
+  long overlap = 0;
+  for(auto f : m_fset[param]){
+    if(m_stamp[f] == m_epoch){
+      overlap++;
+      if(overlap > m_maxoverlap)
+	return true;
+    }
+  }
+  return false;
+}
+
+void depscheduler::mark(long param){
+  if(m_maxoverlap < 0)
+    return;
+  for(auto f : m_fset[param]){
+    m_stamp[f] = m_epoch;
+  }
+}
+
+long depscheduler::schedule(const std::vector<int> &candidates, long nsamples, std::vector<std::vector<int>> &blocks){
+  assert(blocks.size() > 0);
+  m_epoch++;
+  for(auto &b : blocks){
+    b.clear();
+  }
+  // weighted sampling without replacement : key = u^(1/w), keep the largest keys
+  std::uniform_real_distribution<double> unif(0.0, 1.0);
+  std::vector<std::pair<double, int>> keys;
+  keys.reserve(candidates.size());
+  for(auto param : candidates){
+    assert(param < m_params);
+    double u = unif(m_rng);
+    keys.push_back(std::make_pair(log(u + 1e-300)/m_priority[param], param));
+  }
+  if(nsamples > (long)keys.size())
+    nsamples = keys.size();
+  auto greater = [](const std::pair<double, int> &a, const std::pair<double, int> &b){ return a.first > b.first; };
+  std::partial_sort(keys.begin(), keys.begin() + nsamples, keys.end(), greater);
+
+  std::vector<long> load(blocks.size(), 0);
+  long scheduled = 0;
+  for(long i=0; i < nsamples; i++){
+    int param = keys[i].second;
+    m_sampled++;
+    if(conflict(param)){
+      m_conflicts++;
+      continue;
+    }
+    mark(param);
+    int minidx = std::min_element(load.begin(), load.end()) - load.begin();
+    blocks[minidx].push_back(param);
+    load[minidx] += m_fset[param].size() + 1;
+    scheduled++;
+  }
+  return scheduled;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <stdint.h>
+#include <assert.h>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <strads/ds/dshard.hpp>
+#include <strads/ds/spmat.hpp>
+
+// Dependency aware priority scheduler
+//   - parameter i is sampled with probability proportional to m_priority[i]
+//     (magnitude of its last change plus m_eta so that no parameter starves)
+//   - parameter i touches a set of features (e.g. the rows of column i of a column major shard).
+//     Two parameters conflict when they share more than m_maxoverlap features.
+//     m_maxoverlap < 0 turns the dependency check off (conditionally independent parameters).
+//   - accepted parameters are spread over blocks balancing nonzero counts so that each block
+//     can be handed to one worker thread through its child_thread queue.
+// CAVEAT : not thread safe. Only the thread that dispatches jobs should call it.
+class depscheduler{
+public:
+  depscheduler(long params, long features, double eta, long maxoverlap, unsigned int seed);
+
+  void set_features(long param, const std::vector<long unsigned int> &features);
+
+  // parameter i is column i of a column major shard, features are its rows
+  void load_features(udshard<colmajor_map> &shard);
+  // parameter i is row i of a row major shard, features are its columns
+  void load_features(udshard<rowmajor_map> &shard);
+  // compressed shards : parameter i is major slot i, features are its minor indices
+  template <typename V>
+  void load_features(udshard<colmajor_csc<V>> &shard){ load_compressed(shard.matrix, shard.matrix.col_size_vector()); }
+  template <typename V>
+  void load_features(udshard<rowmajor_csr<V>> &shard){ load_compressed(shard.matrix, shard.matrix.row_size_vector()); }
+
+  void update_priority(long param, double change);
+  double priority(long param){ return m_priority[param]; }
+
+  // sample up to nsamples of candidates by priority, drop conflicting ones and
+  // assign the survivors to blocks. Returns the number of scheduled parameters
+  long schedule(const std::vector<int> &candidates, long nsamples, std::vector<std::vector<int>> &blocks);
+
+  long m_sampled;   // accumulated statistics
+  long m_conflicts;
+
+private:
+  bool conflict(long param);
+  template <typename V>
+  void load_compressed(compressed_spmat<V> &mat, long majors){
+    majors = std::min(majors, m_params);
+    for(long i=0; i < majors; i++){
+      m_fset[i].clear();
+      m_fset[i].reserve(mat.nnz(i));
+      for(uint64_t k = mat.nnz_begin(i); k < mat.nnz_end(i); k++){
+	assert((long)mat.minor(k) < m_features);
+	m_fset[i].push_back(mat.minor(k));
+      }
+    }
+  }
+  void mark(long param);
+
+  long m_params;
+  long m_features;
+  double m_eta;
+  long m_maxoverlap;
+  std::vector<double> m_priority;
+  std::vector<std::vector<long unsigned int>> m_fset;
+  std::vector<long> m_stamp;  // feature -> epoch of the last schedule that took it
+  long m_epoch;
+  std::mt19937 m_rng;
+};
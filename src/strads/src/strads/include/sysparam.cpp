@@ -22,6 +22,7 @@ DEFINE_string(ps_nodefile, "", "PS Node Conf file");
 DEFINE_string(ps_linkfile, "", "PS Link Conf file");
 
 DEFINE_int32(ps_server_thrds, 8, "Threads per Cyclone Server Node");
+DEFINE_int32(ps_batch_bytes, 512*1024, "Cut a multi key ps packet when it grows over this many bytes");
 
 
 
@@ -7,13 +7,18 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <algorithm>
+#include <functional>
 #include <strads/include/child-thread.hpp>
 
 //#define PS_SERVER_THREADS (8)
 DECLARE_int32(ps_server_thrds);
+DECLARE_int32(ps_batch_bytes);
 
 using namespace std;
 void *make_pspacket(void *usrPacket, int usrLen, pspacket *pspkt, int *sendLen, int srcRank);
+void ps_multi_reply_ll(pspacket *packet, int plen, sharedctx *ctx);
+void ps_server_multi_ll(sharedctx *ctx, pspacket *pkt, context *sendctx);
 
 
 void ps_put_get_async_ll(sharedctx *ctx, string &key, string &value){
@@ -150,6 +155,8 @@ void *ps_client_recvthread(void *arg){ // receive
 	pthread_cond_signal(&ctx->m_upsignal_syncget);
 	pthread_mutex_unlock(&ctx->m_lock_syncget);
 	//recvctx[clock]->release_buffer(msg); don't do this 
+      }else if(pkt->cbtype == cb_multiput or pkt->cbtype == cb_multiget or pkt->cbtype == cb_multipgasync){
+	ps_multi_reply_ll(pkt, len, ctx);
       }else{
 	assert(0);
       }
@@ -235,6 +242,182 @@ void md_getKeyOnly(void *bstring, std::string &key){
   return ;
 }
 
+// multi key packets ---------------------------------------------------------------------------
+std::string ps_binkey(uint64_t id){
+  return std::string((const char *)&id, sizeof(uint64_t));
+}
+
+uint64_t ps_binkey_id(const std::string &key){
+  assert(key.size() == sizeof(uint64_t));
+  uint64_t id;
+  memcpy(&id, key.data(), sizeof(uint64_t));
+  return id;
+}
+
+static psrequest *ps_request_new(cb_type type, std::vector<std::string> *values, ps_multicb callback, void *arg){
+  psrequest *req = new psrequest;
+  pthread_mutex_init(&req->lock, NULL);
+  pthread_cond_init(&req->signal, NULL);
+  req->pending = 1; // guard : held by the sender until all packets are out 
+  req->done = false;
+  req->type = type;
+  req->values = values;
+  req->callback = callback;
+  req->arg = arg;
+  return req;
+}
+
+static void ps_request_done(sharedctx *ctx, psrequest *req){
+  pthread_mutex_lock(&req->lock);
+  assert(req->pending > 0);
+  req->pending--;
+  bool last = (req->pending == 0);
+  pthread_mutex_unlock(&req->lock);
+  if(!last)
+    return;
+  if(req->callback != NULL)
+    (*req->callback)(ctx, req);
+  pthread_mutex_lock(&req->lock);
+  req->done = true;
+  pthread_cond_broadcast(&req->signal);
+  pthread_mutex_unlock(&req->lock);
+}
+
+// partition keys over servers, cut a packet whenever it grows over FLAGS_ps_batch_bytes 
+static void ps_multi_send_ll(sharedctx *ctx, cb_type type, std::vector<std::string> &keys, 
+			     std::vector<std::string> &values, psrequest *req){
+  assert(keys.size() == values.size());
+  int servers = ctx->m_sched_machines;
+  std::hash<std::string> string_hash; // same partitioning as md_serialize 
+  std::vector<psbatch_builder> builders(servers);
+  pspacket hdr;
+  memset(&hdr, 0, sizeof(pspacket));
+  hdr.src = ctx->rank;
+  hdr.cbtype = type;
+  hdr.req = (void *)req;
+
+  auto flush = [&](int sid){
+    pspacket *pkt = builders[sid].seal(&hdr);
+    if(req != NULL){
+      pthread_mutex_lock(&req->lock);
+      req->pending++;
+      pthread_mutex_unlock(&req->lock);
+    }else{
+      ctx->increment_async_count();
+    }
+    context *send_ctx = ctx->ps_sendportmap[sid]->ctx;
+    send_ctx->push_ps_entry_outq((void *)pkt, pkt->len); // copied by zmq 
+    builders[sid].reset();
+  };
+
+  for(size_t i=0; i < keys.size(); i++){
+    int sid = string_hash(keys[i]) % servers;
+    const std::string &value = values[i];
+    int vlen = (type == cb_multiget) ? 0 : value.size();
+    builders[sid].append(i, keys[i].data(), keys[i].size(), value.data(), vlen);
+    if(builders[sid].bytes() >= FLAGS_ps_batch_bytes)
+      flush(sid);
+  }
+  for(int sid=0; sid < servers; sid++){
+    if(builders[sid].nkeys() > 0)
+      flush(sid);
+  }
+}
+
+psrequest *ps_multi_get_async_ll(sharedctx *ctx, std::vector<std::string> &keys, std::vector<std::string> &values, 
+				 ps_multicb callback, void *arg){
+  psrequest *req = ps_request_new(cb_multiget, &values, callback, arg);
+  ps_multi_send_ll(ctx, cb_multiget, keys, values, req);
+  ps_request_done(ctx, req); // drop the guard 
+  return req;
+}
+
+psrequest *ps_multi_put_async_ll(sharedctx *ctx, std::vector<std::string> &keys, std::vector<std::string> &values, 
+				 ps_multicb callback, void *arg){
+  psrequest *req = ps_request_new(cb_multiput, &values, callback, arg);
+  ps_multi_send_ll(ctx, cb_multiput, keys, values, req);
+  ps_request_done(ctx, req);
+  return req;
+}
+
+bool ps_test(psrequest *req){
+  pthread_mutex_lock(&req->lock);
+  bool done = req->done;
+  pthread_mutex_unlock(&req->lock);
+  return done;
+}
+
+void ps_wait(psrequest *req){
+  pthread_mutex_lock(&req->lock);
+  while(!req->done)
+    pthread_cond_wait(&req->signal, &req->lock);
+  pthread_mutex_unlock(&req->lock);
+  pthread_mutex_destroy(&req->lock);
+  pthread_cond_destroy(&req->signal);
+  delete req;
+}
+
+void ps_multi_get_sync_ll(sharedctx *ctx, std::vector<std::string> &keys, std::vector<std::string> &values){
+  ps_wait(ps_multi_get_async_ll(ctx, keys, values));
+}
+
+void ps_multi_put_sync_ll(sharedctx *ctx, std::vector<std::string> &keys, std::vector<std::string> &values){
+  ps_wait(ps_multi_put_async_ll(ctx, keys, values));
+}
+
+void ps_multi_put_get_async_ll(sharedctx *ctx, std::vector<std::string> &keys, std::vector<std::string> &values){
+  ps_multi_send_ll(ctx, cb_multipgasync, keys, values, NULL);
+}
+
+// client side : reply of a multi key packet 
+void ps_multi_reply_ll(pspacket *packet, int plen, sharedctx *ctx){
+  assert(packet->len == plen);
+  if(packet->cbtype == cb_multipgasync){
+    ctx->decrement_async_count();
+    assert(ctx->ps_callback_func != NULL); 
+    mkbatch_foreach(packet, [&](mkentry *e, char *key, char *value){
+	string k(key, e->keyLen);
+	string v(value, e->valueLen);
+	(*ctx->ps_callback_func)(ctx, k, v); 
+      });
+  }else{
+    psrequest *req = (psrequest *)packet->req;
+    assert(req != NULL and req->type == packet->cbtype);
+    if(packet->cbtype == cb_multiget){
+      std::vector<std::string> &values = *req->values;
+      mkbatch_foreach(packet, [&](mkentry *e, char *key, char *value){
+	  assert(e->slot < (int)values.size());
+	  values[e->slot].assign(value, e->valueLen);
+	});
+    }
+    ps_request_done(ctx, req);
+  }
+  free((void *)packet);
+}
+
+// server side : run the registered user functions key by key and answer with one packet 
+void ps_server_multi_ll(sharedctx *ctx, pspacket *pkt, context *sendctx){
+  static psbatch_builder reply; // only the server receive thread comes here 
+  reply.reset();
+  string key, value;
+  mkbatch_foreach(pkt, [&](mkentry *e, char *k, char *v){
+      key.assign(k, e->keyLen);
+      value.assign(v, e->valueLen);
+      if(pkt->cbtype == cb_multiput){
+	(*ctx->ps_server_putsyncfunc)(key, value, ctx);
+	reply.append(e->slot, NULL, 0, NULL, 0); // ack only 
+      }else if(pkt->cbtype == cb_multiget){
+	(*ctx->ps_server_getsyncfunc)(key, value, ctx);
+	reply.append(e->slot, NULL, 0, value.data(), value.size());
+      }else{
+	(*ctx->ps_server_pgasyncfunc)(key, value, ctx);	     
+	reply.append(e->slot, key.data(), key.size(), value.data(), value.size());
+      }
+    });
+  pspacket *rpkt = reply.seal(pkt); // keeps src, cbtype and req of the client 
+  sendctx->push_ps_entry_outq((void *)rpkt, rpkt->len);
+}
+
 struct quecmd{  
   pspacket *pkt;
   size_t hash;
@@ -464,6 +647,13 @@ void *ps_server_recvthread(void *arg){ // receive
       pspacket *pkt = (pspacket *)msg;
       int src = pkt->src;
       assert(clock == src);
+      if(pkt->cbtype == cb_multiput or pkt->cbtype == cb_multiget or pkt->cbtype == cb_multipgasync){
+	ps_server_multi_ll(ctx, pkt, sendctx[clock]);
+	free(pkt);
+	clock ++ ;
+	clock = clock % ctx->m_worker_machines;
+	continue;
+      }
       void *ubuf = (void *)((uintptr_t)(pkt) + sizeof(pspacket));
       assert((uintptr_t)ubuf % sizeof(long) == 0);
       void *rbuf=NULL;
@@ -2,9 +2,11 @@
 #define _STRADS_PS_HPP_
 
 #include <strads/include/common.hpp>
+#include <strads/ps/strads-psbatch.hpp>
 #include <pthread.h>
-
-enum cb_type {cb_putgetasync, cb_putsync, cb_getsync};
+#include <stdint.h>
+#include <string>
+#include <vector>
 
 typedef struct{
   sharedctx *parentctx;
@@ -30,22 +32,40 @@ typedef struct{
 void *md_serialize(std::string &key, std::string &value, int servers, int *pLen, int *pServerId);
 void md_deserialize(void *bstring, std::string &key, std::string &value);
 
-typedef struct{
-  int src;
-  cb_type cbtype;
-  int len; // total length of this packet; 
-  // for sync put 
-  pthread_cond_t *putsync_signal; // unique id to identify who is waiting 
-  int *slen; // ack 
-  // for sync get
-  pthread_cond_t *getsync_signal; // unique id to identify who is waitin
-  void **getsync_buf; // receive pkt from the server, and put the packet on syncget_buf of application space
-                      // unique id to identify who is waiting
-  int *rlen;
-  // for user data storage for put_get_async / put_sync functions 
-  void *ubuf; // payload for async/syc put 
-              // should be reset via deserailization
-}pspacket;
+typedef struct psrequest psrequest;
+typedef void (*ps_multicb)(sharedctx *ctx, psrequest *req);
+
+// completion handle of a multi get / multi put 
+//   one packet per server (split at FLAGS_ps_batch_bytes), pending counts the packets in flight 
+//   callback, if any, runs on the ps client receive thread right before waiters are woken up
+struct psrequest{
+  pthread_mutex_t lock;
+  pthread_cond_t signal;
+  int pending; 
+  bool done; 
+  cb_type type;
+  std::vector<std::string> *values; // multi get writes values[slot] 
+  ps_multicb callback;
+  void *arg;
+};
+
+// fixed width binary key for integer ids (8 bytes, little endian) 
+std::string ps_binkey(uint64_t id);
+uint64_t ps_binkey_id(const std::string &key);
+
+// keys are hash partitioned over servers exactly as the single key calls. 
+// values must have keys.size() slots. The vectors must stay alive until ps_wait returns 
+psrequest *ps_multi_get_async_ll(sharedctx *ctx, std::vector<std::string> &keys, std::vector<std::string> &values, 
+				 ps_multicb callback=NULL, void *arg=NULL);
+psrequest *ps_multi_put_async_ll(sharedctx *ctx, std::vector<std::string> &keys, std::vector<std::string> &values, 
+				 ps_multicb callback=NULL, void *arg=NULL);
+bool ps_test(psrequest *req);  // true when all replies arrived 
+void ps_wait(psrequest *req);  // block until done and release req 
+
+void ps_multi_get_sync_ll(sharedctx *ctx, std::vector<std::string> &keys, std::vector<std::string> &values);
+void ps_multi_put_sync_ll(sharedctx *ctx, std::vector<std::string> &keys, std::vector<std::string> &values);
+// batched ps_put_get_async_ll : ps_callback_func runs once per key on the reply 
+void ps_multi_put_get_async_ll(sharedctx *ctx, std::vector<std::string> &keys, std::vector<std::string> &values);
 
 
 void ps_put_get_async_ll(sharedctx *ctx, std::string &key, std::string &value);
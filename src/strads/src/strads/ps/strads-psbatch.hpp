@@ -0,0 +1,131 @@
+#ifndef _STRADS_PSBATCH_HPP_
+#define _STRADS_PSBATCH_HPP_
+
+// wire format of ps packets and the builder of multi key packets.
+// kept free of the zmq/mpi context so the packet layout can be tested alone
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <algorithm>
+
+enum cb_type {cb_putgetasync, cb_putsync, cb_getsync, cb_multiput, cb_multiget, cb_multipgasync};
+
+typedef struct{
+  int src;
+  cb_type cbtype;
+  int len; // total length of this packet; 
+  // for sync put 
+  pthread_cond_t *putsync_signal; // unique id to identify who is waiting 
+  int *slen; // ack 
+  // for sync get
+  pthread_cond_t *getsync_signal; // unique id to identify who is waitin
+  void **getsync_buf; // receive pkt from the server, and put the packet on syncget_buf of application space
+                      // unique id to identify who is waiting
+  int *rlen;
+  // for user data storage for put_get_async / put_sync functions 
+  void *ubuf; // payload for async/syc put 
+              // should be reset via deserailization
+  void *req;  // psrequest of a multi key packet. server echoes it back untouched 
+}pspacket;
+
+// multi key packet : pspacket | mkbatch | mkentry key value (8 byte aligned) | mkentry ...
+typedef struct{
+  int nkeys;
+  int blen; // bytes of the batch including this header 
+}mkbatch;
+
+typedef struct{
+  int slot; // index of the key in the caller's vector 
+  int keyLen;
+  int valueLen;
+  int elen; // bytes of this entry including header and padding 
+}mkentry;
+
+#define PS_ALIGN8(x) (((x) + 7) & ~7)
+
+// growable buffer that keeps space for the pspacket header in front of a mkbatch. 
+// reset() keeps the memory so one builder serves all packets to a server
+class psbatch_builder {
+public:
+  psbatch_builder():buf_(NULL), cap_(0), len_(0){}
+  ~psbatch_builder(){ free(buf_); }
+  void append(int slot, const char *key, int keyLen, const char *value, int valueLen){
+    int elen = PS_ALIGN8(sizeof(mkentry) + keyLen + valueLen);
+    reserve(elen);
+    mkentry *e = (mkentry *)(buf_ + len_);
+    e->slot = slot;
+    e->keyLen = keyLen;
+    e->valueLen = valueLen;
+    e->elen = elen;
+    char *pos = (char *)e + sizeof(mkentry);
+    if(keyLen > 0)
+      memcpy(pos, key, keyLen);
+    if(valueLen > 0)
+      memcpy(pos + keyLen, value, valueLen);
+    len_ += elen;
+    batch()->nkeys++;
+  }
+  int nkeys(void){ return (buf_ == NULL) ? 0 : batch()->nkeys; }
+  int bytes(void){ return len_; }
+  int capacity(void){ return cap_; }
+  // fill the header and return the packet. valid until the next append/reset 
+  pspacket *seal(pspacket *hdr){
+    reserve(0);
+    memcpy(buf_, hdr, sizeof(pspacket));
+    pspacket *pkt = (pspacket *)buf_;
+    pkt->len = len_;
+    pkt->ubuf = (void *)batch();
+    batch()->blen = len_ - sizeof(pspacket);
+    return pkt;
+  }
+  void reset(void){
+    len_ = sizeof(pspacket) + sizeof(mkbatch);
+    if(buf_ != NULL)
+      batch()->nkeys = 0;
+  }
+private:
+  psbatch_builder(const psbatch_builder &);
+  psbatch_builder &operator=(const psbatch_builder &);
+  mkbatch *batch(void){ return (mkbatch *)(buf_ + sizeof(pspacket)); }
+  // make room for more bytes after the current end. the first call lays down the headers 
+  // before the capacity check, so a fresh builder also fits an entry larger than the initial size 
+  void reserve(int more){
+    if(buf_ == NULL){
+      len_ = sizeof(pspacket) + sizeof(mkbatch);
+      cap_ = std::max(len_ + more, len_ + 4096);
+      buf_ = (char *)calloc(cap_, 1);
+      assert(buf_ != NULL);
+      batch()->nkeys = 0;
+    }
+    if(len_ + more > cap_){
+      while(cap_ < len_ + more)
+	cap_ *= 2;
+      buf_ = (char *)realloc(buf_, cap_);
+      assert(buf_ != NULL);
+    }
+    assert((uintptr_t)buf_ % sizeof(long) == 0);
+  }
+  char *buf_;
+  int cap_;
+  int len_;
+};
+
+// visit entries of a received multi key packet 
+template<typename Fn>
+static void mkbatch_foreach(pspacket *pkt, Fn fn){
+  mkbatch *batch = (mkbatch *)((uintptr_t)pkt + sizeof(pspacket));
+  int offset = sizeof(mkbatch);
+  for(int i=0; i < batch->nkeys; i++){
+    mkentry *e = (mkentry *)((uintptr_t)batch + offset);
+    assert(offset + e->elen <= batch->blen);
+    char *key = (char *)e + sizeof(mkentry);
+    fn(e, key, key + e->keyLen);
+    offset += e->elen;
+  }
+  assert(offset == batch->blen);
+}
+
+#endif 
@@ -0,0 +1,54 @@
+#include <strads/ps/strads-psbatch.hpp>
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::vector<std::string> collect_values(pspacket *pkt){
+  std::vector<std::string> values;
+  mkbatch_foreach(pkt, [&](mkentry *e, char *key, char *value){
+      values.push_back(std::string(value, e->valueLen));
+    });
+  return values;
+}
+
+}  // anonymous namespace
+
+// a fresh builder must grow for an entry larger than its initial buffer 
+TEST(PSBatchBuilderTest, FirstEntryLarge) {
+  psbatch_builder builder;
+  std::string key("k");
+  std::string value(64*1024, 'v');
+  builder.append(0, key.data(), key.size(), value.data(), value.size());
+  EXPECT_EQ(1, builder.nkeys());
+  EXPECT_LE(builder.bytes(), builder.capacity());
+
+  pspacket hdr;
+  memset(&hdr, 0, sizeof(pspacket));
+  hdr.cbtype = cb_multiput;
+  pspacket *pkt = builder.seal(&hdr);
+  EXPECT_EQ(builder.bytes(), pkt->len);
+  std::vector<std::string> values = collect_values(pkt);
+  ASSERT_EQ(1, (int)values.size());
+  EXPECT_EQ(value, values[0]);
+}
+
+TEST(PSBatchBuilderTest, ResetKeepsBuffer) {
+  psbatch_builder builder;
+  std::string small(16, 's');
+  std::string large(10*1024, 'l');
+  builder.append(0, NULL, 0, small.data(), small.size());
+  builder.reset();
+  EXPECT_EQ(0, builder.nkeys());
+  builder.append(1, NULL, 0, large.data(), large.size());
+  builder.append(2, NULL, 0, small.data(), small.size());
+  EXPECT_LE(builder.bytes(), builder.capacity());
+
+  pspacket hdr;
+  memset(&hdr, 0, sizeof(pspacket));
+  std::vector<std::string> values = collect_values(builder.seal(&hdr));
+  ASSERT_EQ(2, (int)values.size());
+  EXPECT_EQ(large, values[0]);
+  EXPECT_EQ(small, values[1]);
+}